@@ -53,29 +53,63 @@ static const uint8_t kernel_magic_number[] = { 0x90, 0xab, 0xcd, 0xef };
 
 bool TryReadDil(const char* script_uri,
                 const uint8_t** dil_file,
-                intptr_t* dil_length) {
+                intptr_t* dil_length,
+                bool* is_mapped) {
   *dil_file = NULL;
   *dil_length = -1;
+  *is_mapped = false;
+  File* file = File::Open(script_uri, File::kRead);
+  if (file == NULL) {
+    return false;
+  }
+
+  // Prefer a read-only mapping: the Kernel reader only needs sequential
+  // read access, so there is no reason to copy the file into the heap.
+  intptr_t length = -1;
+  const uint8_t* buffer =
+      reinterpret_cast<const uint8_t*>(file->MapReadOnly(&length));
   bool is_dilfile = false;
-  void* script_file = DartUtils::OpenFile(script_uri, false);
-  if (script_file != NULL) {
-    const uint8_t* buffer = NULL;
-    DartUtils::ReadFile(&buffer, dil_length, script_file);
-    DartUtils::CloseFile(script_file);
-    if (*dil_length > 0 && buffer != NULL) {
-      bool ignore;
-      *dil_file = DartUtils::SniffForMagicNumber(buffer, dil_length, &ignore,
-                                                 &is_dilfile);
-      // If is_dilfile, then dil_file is backed by the same memory as buffer so
-      // we do not leak buffer in that case, provided we do not leak dil_file.
-      if (!is_dilfile) {
-        free(const_cast<uint8_t*>(buffer));
-      }
+  bool ignore;
+  if (buffer != NULL) {
+    file->Release();
+    intptr_t sniffed_length = length;
+    DartUtils::SniffForMagicNumber(buffer, &sniffed_length, &ignore,
+                                   &is_dilfile);
+    if (!is_dilfile) {
+      File::Unmap(const_cast<uint8_t*>(buffer), length);
+      return false;
+    }
+    *dil_file = buffer;
+    *dil_length = length;
+    *is_mapped = true;
+    return true;
+  }
+
+  DartUtils::ReadFile(&buffer, dil_length, file);
+  file->Release();
+  if (*dil_length > 0 && buffer != NULL) {
+    *dil_file = DartUtils::SniffForMagicNumber(buffer, dil_length, &ignore,
+                                               &is_dilfile);
+    // If is_dilfile, then dil_file is backed by the same memory as buffer so
+    // we do not leak buffer in that case, provided we do not leak dil_file.
+    if (!is_dilfile) {
+      free(const_cast<uint8_t*>(buffer));
+      *dil_file = NULL;
     }
   }
   return is_dilfile;
 }
 
+
+void FreeDil(const uint8_t* dil_file, intptr_t dil_length, bool is_mapped) {
+  if (is_mapped) {
+    File::Unmap(const_cast<uint8_t*>(dil_file), dil_length);
+  } else {
+    free(const_cast<uint8_t*>(dil_file));
+  }
+}
+
+
 static bool IsWindowsHost() {
 #if defined(TARGET_OS_WINDOWS)
   return true;
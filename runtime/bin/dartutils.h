@@ -37,10 +37,20 @@ static inline Dart_Handle ThrowIfError(Dart_Handle handle) {
 // returns `true` and sets [dil_file] and [dil_length] to be the memory
 // contents.
 //
-// The caller is responsible for free()ing [dil_file] if `true` was returned.
+// Where the platform supports it the file is mapped read-only rather than
+// copied into the heap, so the reader works directly out of the page cache
+// and several processes loading the same file share its pages. [is_mapped]
+// tells which of the two happened.
+//
+// The caller is responsible for calling [FreeDil] on [dil_file] if `true` was
+// returned.
 bool TryReadDil(const char* script_uri,
                 const uint8_t** dil_file,
-                intptr_t* dil_length);
+                intptr_t* dil_length,
+                bool* is_mapped);
+
+// Releases the memory returned by a successful call to [TryReadDil].
+void FreeDil(const uint8_t* dil_file, intptr_t dil_length, bool is_mapped);
 
 class CommandLineOptions {
  public:
@@ -17,44 +17,112 @@
 namespace dart {
 namespace bin {
 
+TimeoutQueue::TimeoutQueue()
+    : timeouts_(NULL),
+      size_(0),
+      capacity_(0),
+      ports_(&SamePortValue, kInitialCapacity) {}
+
+
+TimeoutQueue::~TimeoutQueue() {
+  for (intptr_t i = 0; i < size_; i++) {
+    delete timeouts_[i];
+  }
+  free(timeouts_);
+}
+
+
 void TimeoutQueue::UpdateTimeout(Dart_Port port, int64_t timeout) {
-  // Find port if present.
-  Timeout* last = NULL;
-  Timeout* current = timeouts_;
-  while (current != NULL) {
-    if (current->port() == port) {
-      // Found.
-      if (timeout < 0) {
-        // Remove from list and delete existing.
-        if (last != NULL) {
-          last->set_next(current->next());
-        } else {
-          timeouts_ = current->next();
-        }
-        delete current;
-      } else {
-        // Update timeout.
-        current->set_timeout(timeout);
+  void* key = GetHashmapKeyFromPort(port);
+  uint32_t hash = GetHashmapHashFromPort(port);
+  HashMap::Entry* entry = ports_.Lookup(key, hash, timeout >= 0);
+  if (entry == NULL) {
+    // Nothing to remove.
+    return;
+  }
+  Timeout* current = reinterpret_cast<Timeout*>(entry->value);
+  if (timeout < 0) {
+    // Remove from heap and delete existing.
+    ASSERT(current != NULL);
+    ports_.Remove(key, hash);
+    Remove(current);
+    delete current;
+  } else if (current == NULL) {
+    // Not found, create a new.
+    if (size_ == capacity_) {
+      capacity_ = (capacity_ == 0) ? kInitialCapacity : (capacity_ * 2);
+      timeouts_ = reinterpret_cast<Timeout**>(
+          realloc(timeouts_, capacity_ * sizeof(*timeouts_)));
+      if (timeouts_ == NULL) {
+        FATAL("Out of memory.");
       }
-      break;
     }
-    last = current;
-    current = current->next();
+    current = new Timeout(port, timeout);
+    entry->value = current;
+    Place(current, size_);
+    size_++;
+    SiftUp(current->index());
+  } else {
+    // Update timeout.
+    int64_t old_timeout = current->timeout();
+    current->set_timeout(timeout);
+    if (timeout < old_timeout) {
+      SiftUp(current->index());
+    } else {
+      SiftDown(current->index());
+    }
   }
-  if (current == NULL && timeout >= 0) {
-    // Not found, create a new.
-    timeouts_ = new Timeout(port, timeout, timeouts_);
+}
+
+
+void TimeoutQueue::Remove(Timeout* timeout) {
+  intptr_t index = timeout->index();
+  ASSERT(timeouts_[index] == timeout);
+  size_--;
+  if (index == size_) {
+    return;
+  }
+  // Fill the hole with the last timeout, which may belong further up or
+  // further down from there.
+  Timeout* last = timeouts_[size_];
+  Place(last, index);
+  SiftUp(index);
+  SiftDown(last->index());
+}
+
+
+void TimeoutQueue::SiftUp(intptr_t index) {
+  Timeout* timeout = timeouts_[index];
+  while (index > 0) {
+    intptr_t parent = (index - 1) / 2;
+    if (timeouts_[parent]->timeout() <= timeout->timeout()) {
+      break;
+    }
+    Place(timeouts_[parent], index);
+    index = parent;
   }
-  // Clear and find next timeout.
-  next_timeout_ = NULL;
-  current = timeouts_;
-  while (current != NULL) {
-    if ((next_timeout_ == NULL) ||
-        (current->timeout() < next_timeout_->timeout())) {
-      next_timeout_ = current;
+  Place(timeout, index);
+}
+
+
+void TimeoutQueue::SiftDown(intptr_t index) {
+  Timeout* timeout = timeouts_[index];
+  while (true) {
+    intptr_t child = (2 * index) + 1;
+    if (child >= size_) {
+      break;
+    }
+    if (((child + 1) < size_) &&
+        (timeouts_[child + 1]->timeout() < timeouts_[child]->timeout())) {
+      child++;
+    }
+    if (timeout->timeout() <= timeouts_[child]->timeout()) {
+      break;
     }
-    current = current->next();
+    Place(timeouts_[child], index);
+    index = child;
   }
+  Place(timeout, index);
 }
 
 
@@ -58,8 +58,8 @@ class TimeoutQueue {
  private:
   class Timeout {
    public:
-    Timeout(Dart_Port port, int64_t timeout, Timeout* next)
-        : port_(port), timeout_(timeout), next_(next) {}
+    Timeout(Dart_Port port, int64_t timeout)
+        : port_(port), timeout_(timeout), index_(-1) {}
 
     Dart_Port port() const { return port_; }
 
@@ -69,45 +69,74 @@ class TimeoutQueue {
       timeout_ = timeout;
     }
 
-    Timeout* next() const { return next_; }
-    void set_next(Timeout* next) {
-      next_ = next;
+    // Position in the heap.
+    intptr_t index() const { return index_; }
+    void set_index(intptr_t index) {
+      index_ = index;
     }
 
    private:
     Dart_Port port_;
     int64_t timeout_;
-    Timeout* next_;
+    intptr_t index_;
   };
 
  public:
-  TimeoutQueue() : next_timeout_(NULL), timeouts_(NULL) {}
+  TimeoutQueue();
+  ~TimeoutQueue();
 
-  ~TimeoutQueue() {
-    while (HasTimeout()) RemoveCurrent();
-  }
-
-  bool HasTimeout() const { return next_timeout_ != NULL; }
+  bool HasTimeout() const { return size_ > 0; }
 
   int64_t CurrentTimeout() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->timeout();
+    ASSERT(HasTimeout());
+    return timeouts_[0]->timeout();
   }
 
   Dart_Port CurrentPort() const {
-    ASSERT(next_timeout_ != NULL);
-    return next_timeout_->port();
+    ASSERT(HasTimeout());
+    return timeouts_[0]->port();
   }
 
   void RemoveCurrent() {
     UpdateTimeout(CurrentPort(), -1);
   }
 
+  // Sets the timeout for 'port', or removes it if 'timeout' is negative.
+  // Takes O(log n) time for n timeouts.
   void UpdateTimeout(Dart_Port port, int64_t timeout);
 
  private:
-  Timeout* next_timeout_;
-  Timeout* timeouts_;
+  static const intptr_t kInitialCapacity = 16;
+
+  static bool SamePortValue(void* key1, void* key2) {
+    return reinterpret_cast<Dart_Port>(key1) ==
+        reinterpret_cast<Dart_Port>(key2);
+  }
+
+  static uint32_t GetHashmapHashFromPort(Dart_Port port) {
+    return static_cast<uint32_t>(port & 0xFFFFFFFF);
+  }
+
+  static void* GetHashmapKeyFromPort(Dart_Port port) {
+    return reinterpret_cast<void*>(port);
+  }
+
+  void Place(Timeout* timeout, intptr_t index) {
+    timeouts_[index] = timeout;
+    timeout->set_index(index);
+  }
+  void Remove(Timeout* timeout);
+  void SiftUp(intptr_t index);
+  void SiftDown(intptr_t index);
+
+  // Binary min-heap of the timeouts ordered by deadline, so that the next
+  // timeout is always at index 0.
+  Timeout** timeouts_;
+  intptr_t size_;
+  intptr_t capacity_;
+
+  // Maps each port with a timeout to its Timeout.
+  HashMap ports_;
 
   DISALLOW_COPY_AND_ASSIGN(TimeoutQueue);
 };
@@ -14,6 +14,7 @@
 #include <fcntl.h>  // NOLINT
 #include <pthread.h>  // NOLINT
 #include <stdio.h>  // NOLINT
+#include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
 #include <sys/epoll.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
@@ -31,6 +32,8 @@
 namespace dart {
 namespace bin {
 
+extern bool prefetch_socket_reads;
+
 intptr_t DescriptorInfo::GetPollEvents() {
   // Do not ask for EPOLLERR and EPOLLHUP explicitly as they are
   // triggered anyway.
@@ -79,6 +82,20 @@ static void AddToEpollInstance(intptr_t epoll_fd_, DescriptorInfo* di) {
 }
 
 
+// Make epoll report the descriptor again if it is ready for any of the
+// registered events, even though it has not changed since the last report.
+static void RearmEpollInstance(intptr_t epoll_fd_, DescriptorInfo* di) {
+  ASSERT(!di->IsListeningSocket());
+  struct epoll_event event;
+  event.events = EPOLLRDHUP | EPOLLET | di->GetPollEvents();
+  event.data.ptr = di;
+  VOID_NO_RETRY_EXPECTED(epoll_ctl(epoll_fd_,
+                                   EPOLL_CTL_MOD,
+                                   di->fd(),
+                                   &event));
+}
+
+
 EventHandlerImplementation::EventHandlerImplementation()
     : socket_map_(&HashMap::SamePointerValue, 16) {
   intptr_t result;
@@ -172,6 +189,15 @@ DescriptorInfo* EventHandlerImplementation::GetDescriptorInfo(
       di = new DescriptorInfoMultiple(fd);
     } else {
       di = new DescriptorInfoSingle(fd);
+      if (prefetch_socket_reads) {
+        // Only stream sockets can be read ahead of the isolate; datagrams
+        // must be received one at a time and pipes may be terminals.
+        int type;
+        socklen_t len = sizeof(type);
+        int status = NO_RETRY_EXPECTED(
+            getsockopt(fd, SOL_SOCKET, SO_TYPE, &type, &len));
+        di->set_prefetch_reads((status == 0) && (type == SOCK_STREAM));
+      }
     }
     entry->value = di;
   }
@@ -346,6 +372,81 @@ intptr_t EventHandlerImplementation::GetPollEvents(intptr_t events,
 }
 
 
+void EventHandlerImplementation::PostPrefetchedData(Dart_Port port,
+                                                    DescriptorInfo* di,
+                                                    intptr_t event_mask) {
+  // Once the peer has closed the connection, all remaining data is read and
+  // posted in one message, as there will be no further events for it. The
+  // amount is bounded by the receive buffer of the socket.
+  const bool drain = (event_mask & (1 << kCloseEvent)) != 0;
+  uint8_t* buffer = prefetch_buffer_;
+  intptr_t capacity = kPrefetchBufferSize;
+  intptr_t length = 0;
+  bool would_block = false;
+  ssize_t bytes;
+  do {
+    if (length == capacity) {
+      capacity *= 2;
+      if (buffer == prefetch_buffer_) {
+        buffer = reinterpret_cast<uint8_t*>(malloc(capacity));
+        memmove(buffer, prefetch_buffer_, length);
+      } else {
+        buffer = reinterpret_cast<uint8_t*>(realloc(buffer, capacity));
+      }
+    }
+    bytes = TEMP_FAILURE_RETRY_NO_SIGNAL_BLOCKER(
+        read(di->fd(), buffer + length, capacity - length));
+    if (bytes > 0) {
+      length += bytes;
+    } else {
+      would_block = (bytes == -1) && (errno == EWOULDBLOCK);
+    }
+  } while (drain && (bytes > 0));
+  if (length == 0) {
+    if (would_block) {
+      // Spurious wakeup. The read event is not passed on, as the isolate
+      // must not read from the socket while data read here may still be on
+      // its way.
+      event_mask &= ~(1 << kInEvent);
+    }
+    // Leave end of file and errors to the isolate.
+    DartUtils::PostInt32(port, event_mask);
+    return;
+  }
+  // The isolate only reads the data sent along with the events.
+  event_mask &= ~(1 << kInEvent);
+  if (!drain &&
+      (length == kPrefetchBufferSize) &&
+      ((di->Mask() & (1 << kInEvent)) != 0)) {
+    // More data may be pending, which would not cause a new event as the
+    // descriptor is edge triggered. Register it again so epoll reports it
+    // again if it is still readable. Once the isolate stops listening for
+    // reads or runs out of tokens, it is no longer registered for reading
+    // and the data stays in the socket.
+    RearmEpollInstance(epoll_fd_, di);
+  }
+  // Post [event_mask, data]. The data is copied into the message, so the
+  // buffer can be reused right away.
+  Dart_CObject events;
+  events.type = Dart_CObject_kInt32;
+  events.value.as_int32 = event_mask;
+  Dart_CObject data;
+  data.type = Dart_CObject_kTypedData;
+  data.value.as_typed_data.type = Dart_TypedData_kUint8;
+  data.value.as_typed_data.length = length;
+  data.value.as_typed_data.values = buffer;
+  Dart_CObject* values[2] = { &events, &data };
+  Dart_CObject message;
+  message.type = Dart_CObject_kArray;
+  message.value.as_array.length = 2;
+  message.value.as_array.values = values;
+  Dart_PostCObject(port, &message);
+  if (buffer != prefetch_buffer_) {
+    free(buffer);
+  }
+}
+
+
 void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
                                               int size) {
   bool interrupt_seen = false;
@@ -375,7 +476,12 @@ void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
         Dart_Port port = di->NextNotifyDartPort(event_mask);
         ASSERT(port != 0);
         UpdateEpollInstance(old_mask, di);
-        DartUtils::PostInt32(port, event_mask);
+        const intptr_t kReadEvents = (1 << kInEvent) | (1 << kCloseEvent);
+        if (di->prefetch_reads() && ((event_mask & kReadEvents) != 0)) {
+          PostPrefetchedData(port, di, event_mask);
+        } else {
+          DartUtils::PostInt32(port, event_mask);
+        }
       }
     }
   }
@@ -389,7 +495,7 @@ void EventHandlerImplementation::HandleEvents(struct epoll_event* events,
 
 void EventHandlerImplementation::Poll(uword args) {
   ThreadSignalBlocker signal_blocker(SIGPROF);
-  static const intptr_t kMaxEvents = 16;
+  static const intptr_t kMaxEvents = 64;
   struct epoll_event events[kMaxEvents];
   EventHandler* handler = reinterpret_cast<EventHandler*>(args);
   EventHandlerImplementation* handler_impl = &handler->delegate_;
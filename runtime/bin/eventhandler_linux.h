@@ -23,18 +23,26 @@ namespace bin {
 
 class DescriptorInfo : public DescriptorInfoBase {
  public:
-  explicit DescriptorInfo(intptr_t fd) : DescriptorInfoBase(fd) { }
+  explicit DescriptorInfo(intptr_t fd)
+      : DescriptorInfoBase(fd), prefetch_reads_(false) { }
 
   virtual ~DescriptorInfo() { }
 
   intptr_t GetPollEvents();
 
+  // Whether the event handler reads the data itself when the descriptor
+  // becomes readable. See --prefetch_socket_reads.
+  bool prefetch_reads() const { return prefetch_reads_; }
+  void set_prefetch_reads(bool value) { prefetch_reads_ = value; }
+
   virtual void Close() {
     VOID_TEMP_FAILURE_RETRY(close(fd_));
     fd_ = -1;
   }
 
  private:
+  bool prefetch_reads_;
+
   DISALLOW_COPY_AND_ASSIGN(DescriptorInfo);
 };
 
@@ -84,6 +92,9 @@ class EventHandlerImplementation {
   void HandleInterruptFd();
   void SetPort(intptr_t fd, Dart_Port dart_port, intptr_t mask);
   intptr_t GetPollEvents(intptr_t events, DescriptorInfo* di);
+  void PostPrefetchedData(Dart_Port port,
+                          DescriptorInfo* di,
+                          intptr_t event_mask);
   static void* GetHashmapKeyFromFd(intptr_t fd);
   static uint32_t GetHashmapHashFromFd(intptr_t fd);
 
@@ -94,6 +105,11 @@ class EventHandlerImplementation {
   int epoll_fd_;
   int timer_fd_;
 
+  // Buffer the event handler thread reads prefetched socket data into before
+  // posting it to the isolate.
+  static const intptr_t kPrefetchBufferSize = 16 * KB;
+  uint8_t prefetch_buffer_[kPrefetchBufferSize];
+
   DISALLOW_COPY_AND_ASSIGN(EventHandlerImplementation);
 };
 
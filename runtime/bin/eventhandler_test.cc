@@ -4,6 +4,8 @@
 
 #include "bin/eventhandler.h"
 #include "platform/assert.h"
+#include "vm/benchmark_test.h"
+#include "vm/timer.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -87,5 +89,69 @@ UNIT_TEST_CASE(CircularLinkedList) {
   list.Remove(4242);
 }
 
+
+#if !defined(DART_IO_DISABLED)
+UNIT_TEST_CASE(TimeoutQueue) {
+  TimeoutQueue queue;
+  EXPECT(!queue.HasTimeout());
+
+  // Test: The earliest timeout is current, regardless of insertion order.
+  const intptr_t kNumPorts = 100;
+  for (intptr_t i = 1; i <= kNumPorts; i++) {
+    queue.UpdateTimeout(i, ((i * 37) % kNumPorts) + 1000);
+  }
+  EXPECT(queue.HasTimeout());
+  EXPECT_EQ(1000, queue.CurrentTimeout());
+  EXPECT_EQ(kNumPorts, queue.CurrentPort());
+
+  // Test: Updating a timeout moves it in either direction.
+  queue.UpdateTimeout(5, 10);
+  EXPECT_EQ(5, queue.CurrentPort());
+  EXPECT_EQ(10, queue.CurrentTimeout());
+  queue.UpdateTimeout(5, 5000);
+  EXPECT_EQ(kNumPorts, queue.CurrentPort());
+
+  // Test: Removing ports, including ones without a timeout.
+  for (intptr_t i = 1; i <= kNumPorts; i += 2) {
+    queue.UpdateTimeout(i, -1);
+  }
+  queue.UpdateTimeout(4242, -1);
+
+  // Test: Timeouts come out in order.
+  intptr_t count = 0;
+  int64_t last_timeout = 0;
+  while (queue.HasTimeout()) {
+    EXPECT((queue.CurrentPort() % 2) == 0);
+    EXPECT(queue.CurrentTimeout() >= last_timeout);
+    last_timeout = queue.CurrentTimeout();
+    queue.RemoveCurrent();
+    count++;
+  }
+  EXPECT_EQ(kNumPorts / 2, count);
+  EXPECT_EQ(5000, last_timeout);
+}
+
+
+BENCHMARK(TimeoutQueueUpdate) {
+  const intptr_t kNumTimers = 100000;
+  TimeoutQueue queue;
+  Timer timer(true, "TimeoutQueue update benchmark");
+  timer.Start();
+  // Out-of-order deadlines, each rescheduled once as with idle timeouts.
+  for (intptr_t i = 0; i < kNumTimers; i++) {
+    queue.UpdateTimeout(i + 1, (i * 7919) % kNumTimers);
+  }
+  for (intptr_t i = 0; i < kNumTimers; i++) {
+    queue.UpdateTimeout(i + 1, ((i * 7919) % kNumTimers) + kNumTimers);
+  }
+  while (queue.HasTimeout()) {
+    queue.RemoveCurrent();
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+#endif  // !defined(DART_IO_DISABLED)
+
 }  // namespace bin
 }  // namespace dart
@@ -90,6 +90,15 @@ class File : public ReferenceCounted<File> {
 
   void* MapExecutable(intptr_t* num_bytes);
 
+  // Maps the whole file read-only, hinting the OS that it will be read
+  // sequentially. Returns NULL and sets num_bytes to -1 if the file cannot be
+  // mapped on this platform, in which case callers should fall back to Read.
+  void* MapReadOnly(intptr_t* num_bytes);
+
+  // Releases a mapping obtained from MapReadOnly. The mapping stays valid
+  // after the File itself has been closed.
+  static void Unmap(void* address, intptr_t num_bytes);
+
   // Read/Write attempt to transfer num_bytes to/from buffer. It returns
   // the number of bytes read/written.
   int64_t Read(void* buffer, int64_t num_bytes);
@@ -81,6 +81,17 @@ void* File::MapExecutable(intptr_t* len) {
 }
 
 
+void* File::MapReadOnly(intptr_t* len) {
+  *len = -1;
+  return NULL;
+}
+
+
+void File::Unmap(void* address, intptr_t num_bytes) {
+  UNREACHABLE();
+}
+
+
 int64_t File::Read(void* buffer, int64_t num_bytes) {
   ASSERT(handle_->fd() >= 0);
   return NO_RETRY_EXPECTED(read(handle_->fd(), buffer, num_bytes));
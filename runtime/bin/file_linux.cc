@@ -92,6 +92,33 @@ void* File::MapExecutable(intptr_t* len) {
 }
 
 
+void* File::MapReadOnly(intptr_t* len) {
+  ASSERT(handle_->fd() >= 0);
+  intptr_t length = Length();
+  if (length <= 0) {
+    *len = -1;
+    return NULL;
+  }
+  void* addr = mmap(0, length, PROT_READ, MAP_PRIVATE, handle_->fd(), 0);
+  if (addr == MAP_FAILED) {
+    *len = -1;
+    return NULL;
+  }
+  // The mapping is consumed front to back by the reader, so ask for
+  // aggressive read-ahead. Failure here only costs performance.
+  madvise(addr, length, MADV_SEQUENTIAL);
+  madvise(addr, length, MADV_WILLNEED);
+  *len = length;
+  return addr;
+}
+
+
+void File::Unmap(void* address, intptr_t num_bytes) {
+  ASSERT(address != NULL);
+  VOID_NO_RETRY_EXPECTED(munmap(address, num_bytes));
+}
+
+
 int64_t File::Read(void* buffer, int64_t num_bytes) {
   ASSERT(handle_->fd() >= 0);
   return TEMP_FAILURE_RETRY(read(handle_->fd(), buffer, num_bytes));
@@ -59,5 +59,28 @@ TEST_CASE(FilePosition) {
   file->Release();
 }
 
+
+TEST_CASE(FileMapReadOnly) {
+  const char* kFilename =
+      GetFileName("runtime/tests/vm/data/fixed_length_file");
+  File* file = File::Open(kFilename, File::kRead);
+  EXPECT(file != NULL);
+  intptr_t length = 0;
+  void* address = file->MapReadOnly(&length);
+  if (address == NULL) {
+    // Mapping is not supported on every platform.
+    EXPECT_EQ(-1, length);
+    file->Release();
+    return;
+  }
+  EXPECT_EQ(42, length);
+  char buf[42];
+  EXPECT(file->ReadFully(buf, 42));
+  file->Release();
+  // The mapping outlives the file handle.
+  EXPECT(memcmp(buf, address, 42) == 0);
+  File::Unmap(address, length);
+}
+
 }  // namespace bin
 }  // namespace dart
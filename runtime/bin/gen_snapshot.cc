@@ -645,6 +645,10 @@ static void PrintUsage() {
 "    Example:                                                                \n"
 "      dart:something,SomeClass,doSomething                                  \n"
 "                                                                            \n"
+"  Instead of a Dart script, a kernel binary (.dil) produced by dartk can be \n"
+"  precompiled. Its functions are then compiled directly from the kernel     \n"
+"  AST; kernel binaries cannot be used for non-precompiled snapshots.        \n"
+"                                                                            \n"
 "  Supported options:                                                        \n"
 "    --vm_isolate_snapshot=<file>      A full snapshot is a compact          \n"
 "    --isolate_snapshot=<file>         representation of the dart vm isolate \n"
@@ -1315,7 +1319,20 @@ int main(int argc, char** argv) {
 
     intptr_t payload_bytes = 0;
     const uint8_t* payload = NULL;
-    bool is_dilfile = TryReadDil(app_script_name, &payload, &payload_bytes);
+    bool payload_is_mapped = false;
+    bool is_dilfile = TryReadDil(app_script_name, &payload, &payload_bytes,
+                                 &payload_is_mapped);
+    if (is_dilfile && !IsSnapshottingForPrecompilation()) {
+      // Functions loaded from a kernel binary refer to the kernel AST, which
+      // does not survive in a script snapshot.
+      Log::PrintErr("Kernel binaries can only be snapshotted for "
+                    "precompilation.\n\n");
+      FreeDil(payload, payload_bytes, payload_is_mapped);
+      exit(255);
+    }
+    if (is_dilfile) {
+      isolate_data->set_dil_file(payload, payload_bytes, payload_is_mapped);
+    }
     Dart_Isolate isolate = is_dilfile
         ? Dart_CreateIsolateFromKernel(
             NULL, NULL, payload, payload_bytes, NULL, isolate_data, &error)
@@ -1334,7 +1351,6 @@ int main(int argc, char** argv) {
 
     if (is_dilfile) {
       Dart_Handle library = Dart_LoadDil(payload, payload_bytes);
-      free(const_cast<uint8_t*>(payload));
       if (Dart_IsError(library)) FATAL("Failed to load app from Kernel IR");
 
       SetupStubNativeResolversForPrecompilation(entry_points);
@@ -126,12 +126,15 @@ namespace bin {
   V(Socket_Read, 2)                                                            \
   V(Socket_RecvFrom, 1)                                                        \
   V(Socket_WriteList, 4)                                                       \
+  V(Socket_WriteBuffers, 4)                                                    \
+  V(Socket_SendFile, 4)                                                        \
   V(Socket_SendTo, 6)                                                          \
   V(Socket_GetPort, 1)                                                         \
   V(Socket_GetRemotePeer, 1)                                                   \
   V(Socket_GetError, 1)                                                        \
   V(Socket_GetStdioHandle, 2)                                                  \
   V(Socket_GetType, 1)                                                         \
+  V(Socket_PrefetchReads, 1)                                                   \
   V(Socket_GetOption, 3)                                                       \
   V(Socket_SetOption, 4)                                                       \
   V(Socket_JoinMulticast, 4)                                                   \
@@ -16,6 +16,9 @@ namespace bin {
 class EventHandler;
 class Loader;
 
+// Defined in dartutils.cc.
+void FreeDil(const uint8_t* dil_file, intptr_t dil_length, bool is_mapped);
+
 // Data associated with every isolate in the standalone VM
 // embedding. This is used to free external resources for each isolate
 // when the isolate shuts down.
@@ -29,7 +32,10 @@ class IsolateData {
         packages_file(NULL),
         udp_receive_buffer(NULL),
         builtin_lib_(NULL),
-        loader_(NULL) {
+        loader_(NULL),
+        dil_file_(NULL),
+        dil_length_(0),
+        dil_is_mapped_(false) {
     if (package_root != NULL) {
       ASSERT(packages_file == NULL);
       this->package_root = strdup(package_root);
@@ -47,6 +53,10 @@ class IsolateData {
     packages_file = NULL;
     free(udp_receive_buffer);
     udp_receive_buffer = NULL;
+    if (dil_file_ != NULL) {
+      FreeDil(dil_file_, dil_length_, dil_is_mapped_);
+      dil_file_ = NULL;
+    }
     if (builtin_lib_ != NULL) {
       Dart_DeletePersistentHandle(builtin_lib_);
     }
@@ -80,9 +90,23 @@ class IsolateData {
     loader_ = loader;
   }
 
+  // The Kernel binary the isolate is loaded from. The VM reads function
+  // bodies out of it on demand, so it lives as long as the isolate.
+  void set_dil_file(const uint8_t* dil_file,
+                    intptr_t dil_length,
+                    bool is_mapped) {
+    ASSERT(dil_file_ == NULL);
+    dil_file_ = dil_file;
+    dil_length_ = dil_length;
+    dil_is_mapped_ = is_mapped;
+  }
+
  private:
   Dart_Handle builtin_lib_;
   Loader* loader_;
+  const uint8_t* dil_file_;
+  intptr_t dil_length_;
+  bool dil_is_mapped_;
 
   DISALLOW_COPY_AND_ASSIGN(IsolateData);
 };
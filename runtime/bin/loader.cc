@@ -382,6 +382,9 @@ bool Loader::ProcessResultLocked(Loader* loader, Loader::IOResult* result) {
       if (is_snapshot) {
         dart_result = Dart_LoadScriptFromSnapshot(payload, payload_length);
       } else if (is_dilfile) {
+        // The program keeps reading function bodies out of the payload.
+        loader->isolate_data_->set_dil_file(payload, payload_length, false);
+        result->payload = NULL;
         dart_result = Dart_LoadDil(payload, payload_length);
       } else {
         dart_result = Dart_LoadScript(uri, resolved_uri, source, 0, 0);
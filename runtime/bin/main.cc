@@ -480,6 +480,8 @@ extern bool short_socket_read;
 
 extern bool short_socket_write;
 
+extern bool prefetch_socket_reads;
+
 static bool ProcessShortSocketReadOption(const char* arg,
                                          CommandLineOptions* vm_options) {
   short_socket_read = true;
@@ -494,6 +496,13 @@ static bool ProcessShortSocketWriteOption(const char* arg,
 }
 
 
+static bool ProcessPrefetchSocketReadsOption(const char* arg,
+                                             CommandLineOptions* vm_options) {
+  prefetch_socket_reads = true;
+  return true;
+}
+
+
 static struct {
   const char* option_name;
   bool (*process)(const char* option, CommandLineOptions* vm_options);
@@ -522,6 +531,7 @@ static struct {
   { "--hot-reload-rollback-test-mode", ProcessHotReloadRollbackTestModeOption },
   { "--short_socket_read", ProcessShortSocketReadOption },
   { "--short_socket_write", ProcessShortSocketWriteOption },
+  { "--prefetch_socket_reads", ProcessPrefetchSocketReadsOption },
   { NULL, NULL }
 };
 
@@ -762,17 +772,23 @@ static Dart_Isolate CreateIsolateAndSetupHelper(const char* script_uri,
   // script.
   const uint8_t* dil_file = NULL;
   intptr_t dil_length = -1;
+  bool dil_is_mapped = false;
   bool is_dilfile = !run_app_snapshot &&
-                    TryReadDil(script_uri, &dil_file, &dil_length);
+      TryReadDil(script_uri, &dil_file, &dil_length, &dil_is_mapped);
 
   IsolateData* isolate_data =
       new IsolateData(script_uri, package_root, packages_config);
+  if (is_dilfile) {
+    // The same buffer (usually a read-only mapping of the file) serves both
+    // bootstrapping and loading the program, and stays alive with the
+    // isolate.
+    isolate_data->set_dil_file(dil_file, dil_length, dil_is_mapped);
+  }
   Dart_Isolate isolate = is_dilfile
       ? Dart_CreateIsolateFromKernel(script_uri, main, dil_file, dil_length,
                                      flags, isolate_data, error)
       : Dart_CreateIsolate(script_uri, main, isolate_snapshot_buffer, flags,
                            isolate_data, error);
-  if (is_dilfile) free(const_cast<uint8_t*>(dil_file));
 
   if (isolate == NULL) {
     delete isolate_data;
@@ -781,19 +797,15 @@ static Dart_Isolate CreateIsolateAndSetupHelper(const char* script_uri,
 
   Dart_EnterScope();
 
-  // Set up the library tag handler for this isolate.
-  Dart_Handle result = Dart_SetLibraryTagHandler(Loader::LibraryTagHandler);
-  CHECK_RESULT(result);
-
   if (is_dilfile) {
-    // TODO(kustermann): We should not read the dil file again!
-    if (!TryReadDil(script_uri, &dil_file, &dil_length)) {
-      FATAL("Failed to read dil second time");
-    }
     Dart_Handle result = Dart_LoadDil(dil_file, dil_length);
-    free(const_cast<uint8_t*>(dil_file));
     CHECK_RESULT(result);
   }
+
+  // Set up the library tag handler for this isolate.
+  Dart_Handle result = Dart_SetLibraryTagHandler(Loader::LibraryTagHandler);
+  CHECK_RESULT(result);
+
   if (is_dilfile || isolate_snapshot_buffer != NULL) {
     // Setup the native resolver as the snapshot does not carry it.
     Builtin::SetNativeResolver(Builtin::kBuiltinLibrary);
@@ -978,6 +990,10 @@ static void PrintUsage() {
 "  enables the VM service and listens on specified port for connections\n"
 "  (default port number is 8181, default bind address is 127.0.0.1).\n"
 "\n"
+"--prefetch_socket_reads\n"
+"  lets the event handler read from TCP sockets as they become readable\n"
+"  and pass the data along with the event (Linux only)\n"
+"\n"
 "The following options are only used for VM development and may\n"
 "be changed in any future version:\n");
     const char* print_flags = "--print_flags";
@@ -7,6 +7,7 @@
 #include "bin/socket.h"
 
 #include "bin/dartutils.h"
+#include "bin/file.h"
 #include "bin/io_buffer.h"
 #include "bin/isolate_data.h"
 #include "bin/lockers.h"
@@ -29,6 +30,8 @@ bool short_socket_read = false;
 
 bool short_socket_write = false;
 
+bool prefetch_socket_reads = false;
+
 void ListeningSocketRegistry::Initialize() {
   ASSERT(globalTcpListeningSocketRegistry == NULL);
   globalTcpListeningSocketRegistry = new ListeningSocketRegistry();
@@ -499,6 +502,122 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_WriteBuffers)(Dart_NativeArguments args) {
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  Dart_Handle buffers_obj = Dart_GetNativeArgument(args, 1);
+  Dart_Handle offsets_obj = Dart_GetNativeArgument(args, 2);
+  Dart_Handle lengths_obj = Dart_GetNativeArgument(args, 3);
+  intptr_t count;
+  ThrowIfError(Dart_ListLength(buffers_obj, &count));
+  bool short_write = false;
+  if (short_socket_write) {
+    count = Utils::Minimum<intptr_t>(count, 1);
+  }
+  Dart_Handle buffer_objs[Socket::kMaxWriteVBuffers];
+  const void* buffers[Socket::kMaxWriteVBuffers];
+  intptr_t lengths[Socket::kMaxWriteVBuffers];
+  intptr_t total_written = 0;
+  // Write the buffers in chunks of at most kMaxWriteVBuffers, stopping at the
+  // first chunk the socket does not accept completely.
+  for (intptr_t start = 0; start < count; start += Socket::kMaxWriteVBuffers) {
+    intptr_t chunk_count =
+        Utils::Minimum(count - start, Socket::kMaxWriteVBuffers);
+    intptr_t offsets[Socket::kMaxWriteVBuffers];
+    for (intptr_t i = 0; i < chunk_count; i++) {
+      buffer_objs[i] = ThrowIfError(Dart_ListGetAt(buffers_obj, start + i));
+      offsets[i] = DartUtils::GetIntptrValue(
+          ThrowIfError(Dart_ListGetAt(offsets_obj, start + i)));
+      lengths[i] = DartUtils::GetIntptrValue(
+          ThrowIfError(Dart_ListGetAt(lengths_obj, start + i)));
+    }
+    if (short_socket_write) {
+      if (lengths[0] > 1) {
+        short_write = true;
+      }
+      lengths[0] = (lengths[0] + 1) / 2;
+    }
+    // No other API calls can be made while the data is acquired, so all list
+    // elements are read above before acquiring any of them.
+    intptr_t chunk_bytes = 0;
+    for (intptr_t i = 0; i < chunk_count; i++) {
+      Dart_TypedData_Type type;
+      uint8_t* buffer = NULL;
+      intptr_t len;
+      Dart_Handle result = Dart_TypedDataAcquireData(
+          buffer_objs[i], &type, reinterpret_cast<void**>(&buffer), &len);
+      if (Dart_IsError(result)) {
+        for (intptr_t j = 0; j < i; j++) {
+          Dart_TypedDataReleaseData(buffer_objs[j]);
+        }
+        Dart_PropagateError(result);
+      }
+      ASSERT((offsets[i] + lengths[i]) <= len);
+      buffers[i] = buffer + offsets[i];
+      chunk_bytes += lengths[i];
+    }
+    intptr_t bytes_written =
+        Socket::WriteV(socket, buffers, lengths, chunk_count);
+    if (bytes_written < 0) {
+      // Extract OSError before we release data, as it may override the error.
+      OSError os_error;
+      for (intptr_t i = 0; i < chunk_count; i++) {
+        Dart_TypedDataReleaseData(buffer_objs[i]);
+      }
+      if (total_written > 0) {
+        break;
+      }
+      Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+      return;
+    }
+    for (intptr_t i = 0; i < chunk_count; i++) {
+      Dart_TypedDataReleaseData(buffer_objs[i]);
+    }
+    total_written += bytes_written;
+    if (bytes_written < chunk_bytes) {
+      break;
+    }
+  }
+  // As for Socket_WriteList, a forced short write is indicated by returning
+  // the negative number of bytes.
+  Dart_SetReturnValue(
+      args, Dart_NewInteger(short_write ? -total_written : total_written));
+}
+
+
+void FUNCTION_NAME(Socket_SendFile)(Dart_NativeArguments args) {
+  intptr_t socket =
+      Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
+  // The file pointer was retained by _RandomAccessFile._pointer() and must be
+  // released here.
+  File* file = reinterpret_cast<File*>(
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 1)));
+  ASSERT(file != NULL);
+  int64_t offset = DartUtils::GetIntegerValue(Dart_GetNativeArgument(args, 2));
+  intptr_t length =
+      DartUtils::GetIntptrValue(Dart_GetNativeArgument(args, 3));
+  bool short_write = false;
+  if (short_socket_write) {
+    if (length > 1) {
+      short_write = true;
+    }
+    length = (length + 1) / 2;
+  }
+  intptr_t bytes_sent = Socket::SendFile(socket, file->GetFD(), offset, length);
+  if (bytes_sent >= 0) {
+    file->Release();
+    Dart_SetReturnValue(
+        args, Dart_NewInteger(short_write ? -bytes_sent : bytes_sent));
+  } else {
+    // Extract OSError before we release the file, as it may override the
+    // error.
+    OSError os_error;
+    file->Release();
+    Dart_SetReturnValue(args, DartUtils::NewDartOSError(&os_error));
+  }
+}
+
+
 void FUNCTION_NAME(Socket_SendTo)(Dart_NativeArguments args) {
   intptr_t socket =
       Socket::GetSocketIdNativeField(Dart_GetNativeArgument(args, 0));
@@ -603,6 +722,16 @@ void FUNCTION_NAME(Socket_GetType)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_PrefetchReads)(Dart_NativeArguments args) {
+  // Only the Linux event handler reads ahead of the isolate.
+#if defined(TARGET_OS_LINUX)
+  Dart_SetReturnValue(args, Dart_NewBoolean(prefetch_socket_reads));
+#else
+  Dart_SetReturnValue(args, Dart_False());
+#endif
+}
+
+
 void FUNCTION_NAME(Socket_GetStdioHandle)(Dart_NativeArguments args) {
   int64_t num = DartUtils::GetInt64ValueCheckRange(
       Dart_GetNativeArgument(args, 1), 0, 2);
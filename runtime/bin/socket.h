@@ -259,10 +259,30 @@ class Socket {
     kReverseLookupRequest = 2,
   };
 
+  // Maximum number of buffers passed to a single call of WriteV.
+  static const intptr_t kMaxWriteVBuffers = 64;
+
   static bool Initialize();
   static intptr_t Available(intptr_t fd);
   static intptr_t Read(intptr_t fd, void* buffer, intptr_t num_bytes);
   static intptr_t Write(intptr_t fd, const void* buffer, intptr_t num_bytes);
+  // Write the |count| buffers in order using a single gathered write where
+  // the platform supports it. Returns the total number of bytes written,
+  // which is less than the sum of |lengths| if the socket would block.
+  static intptr_t WriteV(intptr_t fd,
+                         const void* const* buffers,
+                         const intptr_t* lengths,
+                         intptr_t count);
+  // Send |num_bytes| bytes starting at |offset| of the open file |file_fd|
+  // to the socket without copying them through user space where the
+  // platform supports it. The file position is not changed. Returns the
+  // number of bytes sent, 0 if the socket would block or -1 on error.
+  // Reaching the end of the file before |num_bytes| > 0 bytes could be sent
+  // is an error.
+  static intptr_t SendFile(intptr_t fd,
+                           intptr_t file_fd,
+                           int64_t offset,
+                           intptr_t num_bytes);
   // Send data on a socket. The port to send to is specified in the port
   // component of the passed RawAddr structure. The RawAddr structure is only
   // used for datagram sockets.
@@ -15,7 +15,9 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/sendfile.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
+#include <sys/uio.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 
 #include "bin/fdutils.h"
@@ -152,6 +154,45 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
   return written_bytes;
 }
 
+intptr_t Socket::WriteV(intptr_t fd,
+                        const void* const* buffers,
+                        const intptr_t* lengths,
+                        intptr_t count) {
+  ASSERT(fd >= 0);
+  ASSERT((count > 0) && (count <= kMaxWriteVBuffers));
+  struct iovec iov[kMaxWriteVBuffers];
+  for (intptr_t i = 0; i < count; i++) {
+    iov[i].iov_base = const_cast<void*>(buffers[i]);
+    iov[i].iov_len = lengths[i];
+  }
+  ssize_t written_bytes = TEMP_FAILURE_RETRY(writev(fd, iov, count));
+  if ((written_bytes == -1) && (errno == EWOULDBLOCK)) {
+    written_bytes = 0;
+  }
+  return written_bytes;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  ASSERT(fd >= 0);
+  ASSERT(file_fd >= 0);
+  off_t file_offset = offset;
+  ssize_t sent_bytes =
+      TEMP_FAILURE_RETRY(sendfile(fd, file_fd, &file_offset, num_bytes));
+  if ((sent_bytes == -1) && (errno == EWOULDBLOCK)) {
+    sent_bytes = 0;
+  } else if ((sent_bytes == 0) && (num_bytes > 0)) {
+    // sendfile returns 0 at the end of the file, which would otherwise look
+    // like a socket that would block.
+    errno = ENODATA;
+    sent_bytes = -1;
+  }
+  return sent_bytes;
+}
+
 
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
@@ -76,6 +76,24 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::WriteV(intptr_t fd,
+                        const void* const* buffers,
+                        const intptr_t* lengths,
+                        intptr_t count) {
+  UNIMPLEMENTED();
+  return -1;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  UNIMPLEMENTED();
+  return -1;
+}
+
+
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
   UNIMPLEMENTED();
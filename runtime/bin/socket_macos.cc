@@ -17,7 +17,10 @@
 #include <stdio.h>  // NOLINT
 #include <stdlib.h>  // NOLINT
 #include <string.h>  // NOLINT
+#include <sys/socket.h>  // NOLINT
 #include <sys/stat.h>  // NOLINT
+#include <sys/types.h>  // NOLINT
+#include <sys/uio.h>  // NOLINT
 #include <unistd.h>  // NOLINT
 
 #include "bin/fdutils.h"
@@ -153,6 +156,48 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
   return written_bytes;
 }
 
+intptr_t Socket::WriteV(intptr_t fd,
+                        const void* const* buffers,
+                        const intptr_t* lengths,
+                        intptr_t count) {
+  ASSERT(fd >= 0);
+  ASSERT((count > 0) && (count <= kMaxWriteVBuffers));
+  struct iovec iov[kMaxWriteVBuffers];
+  for (intptr_t i = 0; i < count; i++) {
+    iov[i].iov_base = const_cast<void*>(buffers[i]);
+    iov[i].iov_len = lengths[i];
+  }
+  ssize_t written_bytes = TEMP_FAILURE_RETRY(writev(fd, iov, count));
+  if ((written_bytes == -1) && (errno == EWOULDBLOCK)) {
+    written_bytes = 0;
+  }
+  return written_bytes;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  ASSERT(fd >= 0);
+  ASSERT(file_fd >= 0);
+  // On Mac OS sendfile reports the number of bytes sent through |length|,
+  // also when it fails with EAGAIN or EINTR after a partial write.
+  ThreadSignalBlocker signal_blocker(SIGPROF);
+  off_t length = num_bytes;
+  int result = sendfile(file_fd, fd, offset, &length, NULL, 0);
+  if ((result == -1) && (errno != EWOULDBLOCK) && (errno != EINTR)) {
+    return -1;
+  }
+  if ((result == 0) && (length == 0) && (num_bytes > 0)) {
+    // Nothing was sent without the socket blocking, so the end of the file
+    // has been reached.
+    errno = ENODATA;
+    return -1;
+  }
+  return length;
+}
+
 
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
@@ -315,6 +315,18 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
 
   int available = 0;
 
+  // Data already read from the socket by the event handler when running with
+  // --prefetch_socket_reads. It is handed out by read before reading from the
+  // socket again, and is included in available.
+  ListQueue<Uint8List> prefetched;
+  int prefetchedOffset = 0;
+  int prefetchedBytes = 0;
+  // Whether the event handler reads ahead for this socket. If so, it is only
+  // registered for reading while read events are wanted, so data is left in
+  // the socket while the socket is paused. Set when the event mask is sent.
+  bool prefetchReads = false;
+  bool readInterest = false;
+
   int tokens = 0;
 
   bool sendReadEvents = false;
@@ -583,7 +595,7 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     if (isClosing || isClosed) return null;
     len = min(available, len == null ? available : len);
     if (len == 0) return null;
-    var result = nativeRead(len);
+    var result = prefetchedBytes > 0 ? readPrefetched(len) : nativeRead(len);
     if (result is OSError) {
       reportError(result, "Read failed");
       return null;
@@ -604,6 +616,25 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     return result;
   }
 
+  Uint8List readPrefetched(int len) {
+    Uint8List data = prefetched.first;
+    int end = min(data.length, prefetchedOffset + len);
+    Uint8List result;
+    if (prefetchedOffset == 0 && end == data.length) {
+      result = data;
+    } else {
+      result = data.sublist(prefetchedOffset, end);
+    }
+    if (end == data.length) {
+      prefetched.removeFirst();
+      prefetchedOffset = 0;
+    } else {
+      prefetchedOffset = end;
+    }
+    prefetchedBytes -= result.length;
+    return result;
+  }
+
   Datagram receive() {
     if (isClosing || isClosed) return null;
     var result = nativeRecvFrom();
@@ -654,6 +685,66 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
         _ensureFastAndSerializableByteData(buffer, offset, offset + bytes);
     var result =
         nativeWrite(bufferAndStart.buffer, bufferAndStart.start, bytes);
+    return _didWrite(result, bytes);
+  }
+
+  // Writes the bytes of all of [buffers], in order, using a single gathered
+  // write where the platform supports it. The first buffer is written from
+  // [offset]. Returns the number of bytes written, which is less than the
+  // total if the socket would block.
+  int writeBuffers(List<List<int>> buffers, [int offset = 0]) {
+    if (buffers is! List || offset is! int) throw new ArgumentError();
+    if (isClosing || isClosed) return 0;
+    int count = buffers.length;
+    var fastBuffers = new List(count);
+    var offsets = new List<int>(count);
+    var lengths = new List<int>(count);
+    int bytes = 0;
+    for (int i = 0; i < count; i++) {
+      List<int> buffer = buffers[i];
+      if (buffer is! List) throw new ArgumentError();
+      int start = (i == 0) ? offset : 0;
+      if (start < 0 || start > buffer.length) {
+        throw new RangeError.value(start);
+      }
+      _BufferAndStart bufferAndStart =
+          _ensureFastAndSerializableByteData(buffer, start, buffer.length);
+      fastBuffers[i] = bufferAndStart.buffer;
+      offsets[i] = bufferAndStart.start;
+      lengths[i] = buffer.length - start;
+      bytes += buffer.length - start;
+    }
+    if (bytes == 0) return 0;
+    var result = nativeWriteBuffers(fastBuffers, offsets, lengths);
+    return _didWrite(result, bytes);
+  }
+
+  // Sends [bytes] bytes of [file] starting at [offset] directly from the
+  // file to the socket, without copying the data through the Dart heap. The
+  // range must not extend past the end of the file, reaching the end of the
+  // file is reported as a write error. The position of [file] is not
+  // changed. Returns the number of bytes sent.
+  int sendFile(RandomAccessFile file, int offset, int bytes) {
+    if (file is! _RandomAccessFile) throw new ArgumentError();
+    if (offset is! int || bytes is! int) {
+      throw new ArgumentError("Invalid arguments to sendFile on Socket");
+    }
+    if (offset < 0) throw new RangeError.value(offset);
+    if (bytes < 0) throw new RangeError.value(bytes);
+    _RandomAccessFile randomAccessFile = file;
+    if (randomAccessFile.closed) {
+      throw new FileSystemException("File closed", randomAccessFile.path);
+    }
+    if (isClosing || isClosed) return 0;
+    if (bytes == 0) return 0;
+    // _pointer() retains the native file, the native call releases it.
+    var result = nativeSendFile(randomAccessFile._pointer(), offset, bytes);
+    return _didWrite(result, bytes);
+  }
+
+  // Handles the result of a native write of [bytes] bytes and returns the
+  // number of bytes actually written.
+  int _didWrite(result, int bytes) {
     if (result is OSError) {
       scheduleMicrotask(() => reportError(result, "Write failed"));
       result = 0;
@@ -791,7 +882,26 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   }
 
   // Multiplexes socket events to the socket handlers.
-  void multiplex(int events) {
+  void multiplex(eventsOrData) {
+    int events;
+    if (eventsOrData is List) {
+      // The event handler read the data already and sent it along with the
+      // events. It never includes a read event then, so the socket is not
+      // read here while more data read by the event handler may be on its
+      // way.
+      events = eventsOrData[0];
+      assert((events & (1 << READ_EVENT)) == 0);
+      if (!isClosing && !isClosedRead) {
+        if (prefetched == null) prefetched = new ListQueue<Uint8List>();
+        Uint8List data = eventsOrData[1];
+        prefetched.add(data);
+        prefetchedBytes += data.length;
+        available = prefetchedBytes;
+        issueReadEvent();
+      }
+    } else {
+      events = eventsOrData;
+    }
     for (int i = FIRST_EVENT; i <= LAST_EVENT; i++) {
       if (((events & (1 << i)) != 0)) {
         if ((i == CLOSED_EVENT || i == READ_EVENT) && isClosedRead) continue;
@@ -815,7 +925,7 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
           if (isListening) {
             available++;
           } else {
-            available = nativeAvailable();
+            available = prefetchedBytes + nativeAvailable();
             issueReadEvent();
             continue;
           }
@@ -881,13 +991,21 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
     if (write) issueWriteEvent();
     if (!flagsSent && !isClosing) {
       flagsSent = true;
-      int flags = 1 << SET_EVENT_MASK_COMMAND;
-      if (!isClosedRead) flags |= 1 << READ_EVENT;
-      if (!isClosedWrite) flags |= 1 << WRITE_EVENT;
-      sendToEventHandler(flags);
+      prefetchReads = isTcp && !isListening && nativePrefetchReads();
+      sendEventMask();
+    } else if (prefetchReads && !isClosing && (read != readInterest)) {
+      sendEventMask();
     }
   }
 
+  void sendEventMask() {
+    int flags = 1 << SET_EVENT_MASK_COMMAND;
+    readInterest = !isClosedRead && (sendReadEvents || !prefetchReads);
+    if (readInterest) flags |= 1 << READ_EVENT;
+    if (!isClosedWrite) flags |= 1 << WRITE_EVENT;
+    sendToEventHandler(flags);
+  }
+
   Future close() {
     if (!isClosing && !isClosed) {
       sendToEventHandler(1 << CLOSE_COMMAND);
@@ -1073,6 +1191,10 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   nativeRecvFrom() native "Socket_RecvFrom";
   nativeWrite(List<int> buffer, int offset, int bytes)
       native "Socket_WriteList";
+  nativeWriteBuffers(List buffers, List<int> offsets, List<int> lengths)
+      native "Socket_WriteBuffers";
+  nativeSendFile(int filePointer, int offset, int bytes)
+      native "Socket_SendFile";
   nativeSendTo(List<int> buffer, int offset, int bytes,
                List<int> address, int port)
       native "Socket_SendTo";
@@ -1091,6 +1213,7 @@ class _NativeSocket extends _NativeSocketNativeWrapper with _ServiceObject {
   int nativeGetPort() native "Socket_GetPort";
   List nativeGetRemotePeer() native "Socket_GetRemotePeer";
   int nativeGetSocketId() native "Socket_GetSocketId";
+  bool nativePrefetchReads() native "Socket_PrefetchReads";
   OSError nativeGetError() native "Socket_GetError";
   nativeGetOption(int option, int protocol) native "Socket_GetOption";
   bool nativeSetOption(int option, int protocol, value)
@@ -1301,6 +1424,12 @@ class _RawSocket extends Stream<RawSocketEvent>
   int write(List<int> buffer, [int offset, int count]) =>
       _socket.write(buffer, offset, count);
 
+  int _writeBuffers(List<List<int>> buffers, [int offset = 0]) =>
+      _socket.writeBuffers(buffers, offset);
+
+  int _sendFile(RandomAccessFile file, int offset, int count) =>
+      _socket.sendFile(file, offset, count);
+
   Future close() => _socket.close().then((_) => this);
 
   void shutdown(SocketDirection direction) => _socket.shutdown(direction);
@@ -1416,27 +1545,53 @@ class _ServerSocket extends Stream<Socket>
 
 
 class _SocketStreamConsumer extends StreamConsumer<List<int>> {
+  // While the socket is not writable, data keeps being accepted from the
+  // stream up to these limits and is then written with a single gathered
+  // write, instead of one write for every buffer.
+  static const int MAX_PENDING_BYTES = 64 * 1024;
+  static const int MAX_PENDING_BUFFERS = 64;
+
   StreamSubscription subscription;
   final _Socket socket;
-  int offset;
-  List<int> buffer;
+  // Data not written yet. The first buffer has been written up to [offset].
+  final List<List<int>> buffers = <List<int>>[];
+  int offset = 0;
+  int pendingBytes = 0;
   bool paused = false;
+  // Set when the stream is done before all of its data has been written.
+  bool doneWhenWritten = false;
   Completer streamCompleter;
 
+  // State of sending a file stream, see [sendFileStream].
+  bool sendingFile = false;
+  RandomAccessFile file;
+  int filePosition;
+  int fileEnd;
+
   _SocketStreamConsumer(this.socket);
 
   Future<Socket> addStream(Stream<List<int>> stream) {
     socket._ensureRawSocketSubscription();
     streamCompleter = new Completer<Socket>();
     if (socket._raw != null) {
+      if (stream is _FileStream &&
+          stream._path != null &&
+          socket._raw is _RawSocket) {
+        sendFileStream(stream);
+        return streamCompleter.future;
+      }
       subscription = stream.listen(
           (data) {
             assert(!paused);
-            assert(buffer == null);
-            buffer = data;
-            offset = 0;
+            buffers.add(data);
+            pendingBytes += data.length;
             try {
-              write();
+              if (buffers.length == 1) {
+                write();
+              } else {
+                // Waiting for the socket to become writable.
+                pauseIfFull();
+              }
             } catch (e) {
               socket.destroy();
               stop();
@@ -1448,7 +1603,11 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
             done(error, stackTrace);
           },
           onDone: () {
-            done();
+            if (buffers.isEmpty) {
+              done();
+            } else {
+              doneWhenWritten = true;
+            }
           },
           cancelOnError: true);
     }
@@ -1461,18 +1620,36 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
   }
 
   void write() {
+    if (sendingFile) {
+      writeFile();
+      return;
+    }
     if (subscription == null) return;
-    assert(buffer != null);
+    assert(buffers.isNotEmpty);
     // Write as much as possible.
-    offset += socket._write(buffer, offset, buffer.length - offset);
-    if (offset < buffer.length) {
-      if (!paused) {
-        paused = true;
-        subscription.pause();
-      }
+    int written;
+    if (buffers.length == 1) {
+      written = socket._write(buffers[0], offset, buffers[0].length - offset);
+    } else {
+      written = socket._writeBuffers(buffers, offset);
+    }
+    pendingBytes -= written;
+    offset += written;
+    int count = 0;
+    while (count < buffers.length && offset >= buffers[count].length) {
+      offset -= buffers[count].length;
+      count++;
+    }
+    buffers.removeRange(0, count);
+    if (buffers.isNotEmpty) {
+      pauseIfFull();
       socket._enableWriteEvent();
     } else {
-      buffer = null;
+      assert(offset == 0 && pendingBytes == 0);
+      if (doneWhenWritten) {
+        doneWhenWritten = false;
+        done();
+      }
       if (paused) {
         paused = false;
         subscription.resume();
@@ -1480,7 +1657,90 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
     }
   }
 
+  void pauseIfFull() {
+    if (!paused &&
+        (pendingBytes >= MAX_PENDING_BYTES ||
+         buffers.length >= MAX_PENDING_BUFFERS)) {
+      paused = true;
+      subscription.pause();
+    }
+  }
+
+  // Sends the part of the file read by [stream] from the file to the socket
+  // with [_RawSocket._sendFile], instead of reading it into the Dart heap.
+  // The range is checked as [_FileStream] would.
+  void sendFileStream(_FileStream stream) {
+    sendingFile = true;
+    int position = stream._position;
+    if (position < 0) {
+      sendFileDone(new RangeError("Bad start position: $position"));
+      socket.destroy();
+      return;
+    }
+    if (stream._end != null && stream._end < position) {
+      sendFileDone(new RangeError("Bad end position: ${stream._end}"));
+      socket.destroy();
+      return;
+    }
+    new File(stream._path).open().then((opened) {
+      if (!sendingFile) return opened.close().then((_) => null);
+      file = opened;
+      return opened.length();
+    }).then((length) {
+      if (!sendingFile) return;
+      filePosition = position;
+      fileEnd = (stream._end == null) ? length : min(stream._end, length);
+      if (fileEnd < filePosition) fileEnd = filePosition;
+      writeFile();
+    }).catchError((error, stackTrace) {
+      if (!sendingFile) return;
+      sendFileDone(error, stackTrace);
+      socket.destroy();
+    });
+  }
+
+  void writeFile() {
+    if (file == null) return;
+    try {
+      filePosition +=
+          socket._sendFile(file, filePosition, fileEnd - filePosition);
+    } catch (e) {
+      sendFileDone(e);
+      socket.destroy();
+      return;
+    }
+    if (filePosition < fileEnd) {
+      socket._enableWriteEvent();
+    } else {
+      sendFileDone();
+    }
+  }
+
+  void sendFileDone([error, stackTrace]) {
+    sendingFile = false;
+    if (file != null) {
+      var opened = file;
+      file = null;
+      opened.close().then((_) {
+        done(error, stackTrace);
+      }, onError: (closeError, closeStackTrace) {
+        if (error == null) {
+          done(closeError, closeStackTrace);
+        } else {
+          done(error, stackTrace);
+        }
+      });
+    } else {
+      done(error, stackTrace);
+    }
+  }
+
   void done([error, stackTrace]) {
+    if (sendingFile) {
+      // The socket failed while sending the file.
+      sendFileDone(error, stackTrace);
+      return;
+    }
     if (streamCompleter != null) {
       if (error != null) {
         streamCompleter.completeError(error, stackTrace);
@@ -1492,10 +1752,23 @@ class _SocketStreamConsumer extends StreamConsumer<List<int>> {
   }
 
   void stop() {
+    if (sendingFile) {
+      sendingFile = false;
+      if (file != null) {
+        file.close().catchError((_) {});
+        file = null;
+      }
+      socket._disableWriteEvent();
+      return;
+    }
     if (subscription == null) return;
     subscription.cancel();
     subscription = null;
+    buffers.clear();
+    offset = 0;
+    pendingBytes = 0;
     paused = false;
+    doneWhenWritten = false;
     socket._disableWriteEvent();
   }
 }
@@ -1612,7 +1885,7 @@ class _Socket extends Stream<List<int>> implements Socket {
     _detachReady = new Completer();
     _sink.close();
     return _detachReady.future.then((_) {
-      assert(_consumer.buffer == null);
+      assert(_consumer.buffers.isEmpty && !_consumer.sendingFile);
       var raw = _raw;
       _raw = null;
       return [raw, _subscription];
@@ -1695,6 +1968,20 @@ class _Socket extends Stream<List<int>> implements Socket {
   int _write(List<int> data, int offset, int length) =>
       _raw.write(data, offset, length);
 
+  int _writeBuffers(List<List<int>> buffers, int offset) {
+    if (_raw is _RawSocket) {
+      _RawSocket raw = _raw;
+      return raw._writeBuffers(buffers, offset);
+    }
+    // Other raw sockets, like secure sockets, write one buffer at a time.
+    return _raw.write(buffers[0], offset, buffers[0].length - offset);
+  }
+
+  int _sendFile(RandomAccessFile file, int offset, int length) {
+    _RawSocket raw = _raw;
+    return raw._sendFile(file, offset, length);
+  }
+
   void _enableWriteEvent() {
     _raw.writeEventsEnabled = true;
   }
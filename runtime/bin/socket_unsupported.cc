@@ -15,6 +15,8 @@ bool short_socket_read = false;
 
 bool short_socket_write = false;
 
+bool prefetch_socket_reads = false;
+
 void FUNCTION_NAME(InternetAddress_Parse)(Dart_NativeArguments args) {
   Dart_ThrowException(DartUtils::NewDartArgumentError(
       "Sockets unsupported on this platform"));
@@ -75,6 +77,18 @@ void FUNCTION_NAME(Socket_WriteList)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_WriteBuffers)(Dart_NativeArguments args) {
+  Dart_ThrowException(DartUtils::NewDartArgumentError(
+      "Sockets unsupported on this platform"));
+}
+
+
+void FUNCTION_NAME(Socket_SendFile)(Dart_NativeArguments args) {
+  Dart_ThrowException(DartUtils::NewDartArgumentError(
+      "Sockets unsupported on this platform"));
+}
+
+
 void FUNCTION_NAME(Socket_SendTo)(Dart_NativeArguments args) {
   Dart_ThrowException(DartUtils::NewDartArgumentError(
       "Sockets unsupported on this platform"));
@@ -105,6 +119,12 @@ void FUNCTION_NAME(Socket_GetType)(Dart_NativeArguments args) {
 }
 
 
+void FUNCTION_NAME(Socket_PrefetchReads)(Dart_NativeArguments args) {
+  Dart_ThrowException(DartUtils::NewDartArgumentError(
+      "Sockets unsupported on this platform"));
+}
+
+
 void FUNCTION_NAME(Socket_GetStdioHandle)(Dart_NativeArguments args) {
   Dart_ThrowException(DartUtils::NewDartArgumentError(
       "Sockets unsupported on this platform"));
@@ -10,6 +10,8 @@
 #include "bin/socket.h"
 #include "bin/socket_win.h"
 
+#include <io.h>  // NOLINT
+
 #include "bin/builtin.h"
 #include "bin/eventhandler.h"
 #include "bin/file.h"
@@ -97,6 +99,58 @@ intptr_t Socket::Write(intptr_t fd, const void* buffer, intptr_t num_bytes) {
 }
 
 
+intptr_t Socket::WriteV(intptr_t fd,
+                        const void* const* buffers,
+                        const intptr_t* lengths,
+                        intptr_t count) {
+  // Writes are already queued as overlapped operations by the Handle, so
+  // there is no gathered write to forward to. Write the buffers one at a time
+  // until one of them is only partially accepted.
+  Handle* handle = reinterpret_cast<Handle*>(fd);
+  intptr_t total_written = 0;
+  for (intptr_t i = 0; i < count; i++) {
+    intptr_t written = handle->Write(buffers[i], lengths[i]);
+    if (written < 0) {
+      return (total_written > 0) ? total_written : written;
+    }
+    total_written += written;
+    if (written < lengths[i]) {
+      break;
+    }
+  }
+  return total_written;
+}
+
+
+intptr_t Socket::SendFile(intptr_t fd,
+                          intptr_t file_fd,
+                          int64_t offset,
+                          intptr_t num_bytes) {
+  // There is no sendfile equivalent usable with the overlapped socket
+  // handles, so copy one chunk of the file through a native buffer.
+  static const intptr_t kBufferSize = 64 * KB;
+  uint8_t buffer[kBufferSize];
+  int64_t position = _lseeki64(file_fd, 0, SEEK_CUR);
+  if ((position < 0) || (_lseeki64(file_fd, offset, SEEK_SET) < 0)) {
+    return -1;
+  }
+  int bytes_read = _read(
+      file_fd, buffer, static_cast<unsigned int>(
+          Utils::Minimum(num_bytes, kBufferSize)));
+  _lseeki64(file_fd, position, SEEK_SET);
+  if (bytes_read < 0) {
+    return -1;
+  }
+  if ((bytes_read == 0) && (num_bytes > 0)) {
+    // Returning 0 would mean that the socket would block.
+    SetLastError(ERROR_HANDLE_EOF);
+    return -1;
+  }
+  Handle* handle = reinterpret_cast<Handle*>(fd);
+  return handle->Write(buffer, bytes_read);
+}
+
+
 intptr_t Socket::SendTo(
     intptr_t fd, const void* buffer, intptr_t num_bytes, const RawAddr& addr) {
   Handle* handle = reinterpret_cast<Handle*>(fd);
@@ -892,7 +892,8 @@ DART_EXPORT Dart_Isolate Dart_CreateIsolate(const char* script_uri,
  *   Provided only for advisory purposes to improve debugging messages.
  * \param main The name of the main entry point this isolate will run.
  *   Provided only for advisory purposes to improve debugging messages.
- * \param dil_fil A buffer containing the Dart Kernel binary.
+ * \param dil_fil A buffer containing the Dart Kernel binary. It has to stay
+ *   valid until the isolate shuts down.
  * \param dil_length The length of the Kernel buffer.
  * \param flags Pointer to VM specific flags or NULL for default flags.
  * \param callback_data Embedder data.  This data will be passed to
@@ -2827,6 +2828,9 @@ DART_EXPORT Dart_Handle Dart_LoadScriptFromSnapshot(const uint8_t* buffer,
 
 /**
  * Loads a dart application which was compiled to a dill file
+ *
+ * Function bodies are read from the buffer on demand, so it has to stay
+ * valid until the isolate shuts down.
  */
 DART_EXPORT Dart_Handle Dart_LoadDil(const uint8_t* buffer,
                                      intptr_t buffer_len);
@@ -0,0 +1,741 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/bootstrap_natives.h"
+
+#if defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32)
+#include <emmintrin.h>  // NOLINT
+#elif defined(HOST_ARCH_ARM64)
+#include <arm_neon.h>  // NOLINT
+#endif
+
+#include "platform/utils.h"
+#include "vm/double_conversion.h"
+#include "vm/growable_array.h"
+#include "vm/native_entry.h"
+#include "vm/object.h"
+#include "vm/symbols.h"
+#include "vm/unicode.h"
+
+namespace dart {
+
+static bool IsJsonWhitespace(int32_t c) {
+  return (c == ' ') || (c == '\n') || (c == '\r') || (c == '\t');
+}
+
+
+static bool IsDigit(int32_t c) {
+  return (c >= '0') && (c <= '9');
+}
+
+
+// Characters that end a run of string content which can be copied as is.
+static bool IsStringSpecial(int32_t c) {
+  return (c == '"') || (c == '\\') || (c < 0x20);
+}
+
+
+// Returns the length of the prefix of 'chars' that contains no quote,
+// backslash or control character. Strings make up most of a typical JSON
+// text, so the bytes are checked 16 at a time where the host allows it.
+static intptr_t StringRunLength(const uint8_t* chars, intptr_t length) {
+  static const intptr_t kBlockSize = 16;
+  intptr_t i = 0;
+#if defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i max_control = _mm_set1_epi8(0x1F);
+  for (; (i + kBlockSize) <= length; i += kBlockSize) {
+    const __m128i block =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(&chars[i]));
+    // An unsigned byte is a control character iff min(byte, 0x1F) == byte.
+    const __m128i special = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(block, quote),
+                     _mm_cmpeq_epi8(block, backslash)),
+        _mm_cmpeq_epi8(_mm_min_epu8(block, max_control), block));
+    const int mask = _mm_movemask_epi8(special);
+    if (mask != 0) {
+      return i + Utils::CountTrailingZeros(mask);
+    }
+  }
+#elif defined(HOST_ARCH_ARM64)
+  const uint8x16_t quote = vdupq_n_u8('"');
+  const uint8x16_t backslash = vdupq_n_u8('\\');
+  const uint8x16_t space = vdupq_n_u8(' ');
+  for (; (i + kBlockSize) <= length; i += kBlockSize) {
+    const uint8x16_t block = vld1q_u8(&chars[i]);
+    const uint8x16_t special = vorrq_u8(
+        vorrq_u8(vceqq_u8(block, quote), vceqq_u8(block, backslash)),
+        vcltq_u8(block, space));
+    if (vmaxvq_u8(special) != 0) {
+      break;  // The scalar loop below finds the exact position.
+    }
+  }
+#endif
+  for (; i < length; i++) {
+    if (IsStringSpecial(chars[i])) {
+      break;
+    }
+  }
+  return i;
+}
+
+
+static intptr_t StringRunLength(const uint16_t* chars, intptr_t length) {
+  intptr_t i = 0;
+  while ((i < length) && !IsStringSpecial(chars[i])) {
+    i++;
+  }
+  return i;
+}
+
+
+static RawString* NewString(const uint8_t* chars,
+                            intptr_t length,
+                            bool is_utf8) {
+  if (!is_utf8) {
+    return String::FromLatin1(chars, length);
+  }
+  if (!Utf8::IsValid(chars, length)) {
+    return String::null();
+  }
+  return String::FromUTF8(chars, length);
+}
+
+
+static RawString* NewString(const uint16_t* chars,
+                            intptr_t length,
+                            bool is_utf8) {
+  ASSERT(!is_utf8);
+  return String::FromUTF16(chars, length);
+}
+
+
+// Number literals are ASCII, so one-byte input is used in place.
+static const char* NumberChars(Zone* zone,
+                               const uint8_t* chars,
+                               intptr_t length) {
+  return reinterpret_cast<const char*>(chars);
+}
+
+
+static const char* NumberChars(Zone* zone,
+                               const uint16_t* chars,
+                               intptr_t length) {
+  char* result = zone->Alloc<char>(length);
+  for (intptr_t i = 0; i < length; i++) {
+    result[i] = static_cast<char>(chars[i]);
+  }
+  return result;
+}
+
+
+// Decodes a complete JSON text into the objects that _BuildJsonListener in
+// convert_patch.dart builds: growable lists, linked hash maps, strings,
+// integers, doubles, booleans and null.
+//
+// The parser only accepts well-formed input. On any error it gives up and
+// the caller runs the Dart parser instead, which reports the error with its
+// exact position.
+//
+// Parsing is iterative, so deeply nested input cannot overflow the native
+// stack. The values of all open containers are kept on one heap allocated
+// stack and moved into their container when it is closed.
+//
+// Object keys are canonicalized: every occurrence of a key in the text maps
+// to the same String, which is an existing symbol if there is one. New keys
+// are not added to the symbol table, as the input is untrusted and symbols
+// are never collected.
+template<typename CharType>
+class JsonParser : public ValueObject {
+ public:
+  JsonParser(Thread* thread,
+             const CharType* chars,
+             intptr_t length,
+             bool is_utf8)
+      : thread_(thread),
+        zone_(thread->zone()),
+        chars_(chars),
+        length_(length),
+        position_(0),
+        is_utf8_(is_utf8),
+        values_(GrowableObjectArray::Handle(zone_,
+                                            GrowableObjectArray::New())),
+        containers_(zone_, 16),
+        buffer_(NULL),
+        buffer_length_(0),
+        buffer_capacity_(0),
+        keys_(GrowableObjectArray::Handle(zone_, GrowableObjectArray::New())),
+        key_hashes_(zone_, 16),
+        key_maps_(zone_, 16),
+        key_slots_(zone_, 16),
+        key_ids_(zone_, 16),
+        key_table_(NULL),
+        key_table_capacity_(0),
+        num_maps_(0),
+        value_(Object::Handle(zone_)),
+        element_(Object::Handle(zone_)),
+        string_(String::Handle(zone_)) {
+    ASSERT(!is_utf8 || (sizeof(CharType) == 1));
+  }
+
+  // Returns false if the input is not a well-formed JSON text.
+  bool Parse(Object* result) {
+    bool expect_value = true;
+    while (true) {
+      SkipWhitespace();
+      if (expect_value) {
+        if (AtEnd()) {
+          return false;
+        }
+        const int32_t c = chars_[position_];
+        if ((c == '[') || (c == '{')) {
+          position_++;
+          const bool is_map = (c == '{');
+          containers_.Add((values_.Length() << 1) | (is_map ? 1 : 0));
+          SkipWhitespace();
+          if (Match(is_map ? '}' : ']')) {
+            CloseContainer();
+            expect_value = false;
+          } else if (is_map && !ParseKey()) {
+            return false;
+          }
+        } else {
+          if (!ParseScalar(c)) {
+            return false;
+          }
+          expect_value = false;
+        }
+      } else {
+        if (containers_.is_empty()) {
+          if (!AtEnd()) {
+            return false;
+          }
+          *result = values_.At(0);
+          return true;
+        }
+        if (AtEnd()) {
+          return false;
+        }
+        const bool in_map = (containers_.Last() & 1) != 0;
+        const int32_t c = chars_[position_++];
+        if (c == ',') {
+          if (in_map) {
+            SkipWhitespace();
+            if (!ParseKey()) {
+              return false;
+            }
+          }
+          expect_value = true;
+        } else if (c == (in_map ? '}' : ']')) {
+          CloseContainer();
+        } else {
+          return false;
+        }
+      }
+    }
+  }
+
+ private:
+  static const intptr_t kMinBuffer = 64;
+
+  bool AtEnd() const { return position_ == length_; }
+
+  bool Match(int32_t c) {
+    if (!AtEnd() && (chars_[position_] == c)) {
+      position_++;
+      return true;
+    }
+    return false;
+  }
+
+  bool MatchLiteral(const char* literal) {
+    for (intptr_t i = 0; literal[i] != '\0'; i++) {
+      if (!Match(literal[i])) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  void SkipWhitespace() {
+    while (!AtEnd() && IsJsonWhitespace(chars_[position_])) {
+      position_++;
+    }
+  }
+
+  bool SkipDigits() {
+    const intptr_t start = position_;
+    while (!AtEnd() && IsDigit(chars_[position_])) {
+      position_++;
+    }
+    return position_ > start;
+  }
+
+  // Parses a string, number or literal and pushes its value.
+  bool ParseScalar(int32_t c) {
+    if (c == '"') {
+      position_++;
+      if (!ParseString()) {
+        return false;
+      }
+    } else if (c == 't') {
+      if (!MatchLiteral("true")) {
+        return false;
+      }
+      value_ = Bool::True().raw();
+    } else if (c == 'f') {
+      if (!MatchLiteral("false")) {
+        return false;
+      }
+      value_ = Bool::False().raw();
+    } else if (c == 'n') {
+      if (!MatchLiteral("null")) {
+        return false;
+      }
+      value_ = Object::null();
+    } else if ((c == '-') || IsDigit(c)) {
+      if (!ParseNumber()) {
+        return false;
+      }
+    } else {
+      return false;
+    }
+    values_.Add(value_);
+    return true;
+  }
+
+  // Parses the rest of a string value after its opening quote.
+  bool ParseString() {
+    const intptr_t start = position_;
+    const intptr_t run = StringRunLength(&chars_[start], length_ - start);
+    position_ += run;
+    if (AtEnd()) {
+      return false;
+    }
+    if (chars_[position_] == '"') {
+      // No escapes, so the string is copied straight from the input.
+      position_++;
+      if (run == 0) {
+        value_ = Symbols::Empty().raw();
+        return true;
+      }
+      value_ = NewString(&chars_[start], run, is_utf8_);
+      return !value_.IsNull();
+    }
+    buffer_length_ = 0;
+    if (!AppendToBuffer(start, run) || !DecodeString()) {
+      return false;
+    }
+    value_ = String::FromUTF16(buffer_, buffer_length_);
+    return true;
+  }
+
+  // Decodes the rest of a string into the buffer, up to and including the
+  // closing quote.
+  bool DecodeString() {
+    while (true) {
+      const intptr_t start = position_;
+      const intptr_t run = StringRunLength(&chars_[start], length_ - start);
+      if (!AppendToBuffer(start, run)) {
+        return false;
+      }
+      position_ += run;
+      if (AtEnd()) {
+        return false;
+      }
+      const int32_t c = chars_[position_++];
+      if (c == '"') {
+        return true;
+      }
+      if ((c != '\\') || !DecodeEscape()) {
+        return false;  // A control character or a bad escape.
+      }
+    }
+  }
+
+  bool DecodeEscape() {
+    if (AtEnd()) {
+      return false;
+    }
+    int32_t c = chars_[position_++];
+    switch (c) {
+      case 'b': c = 0x08; break;
+      case 'f': c = 0x0C; break;
+      case 'n': c = 0x0A; break;
+      case 'r': c = 0x0D; break;
+      case 't': c = 0x09; break;
+      case '/':
+      case '\\':
+      case '"':
+        break;
+      case 'u': {
+        if ((length_ - position_) < 4) {
+          return false;
+        }
+        c = 0;
+        for (intptr_t i = 0; i < 4; i++) {
+          const int32_t digit = chars_[position_++];
+          c <<= 4;
+          if (IsDigit(digit)) {
+            c |= digit - '0';
+          } else if (((digit | 0x20) >= 'a') && ((digit | 0x20) <= 'f')) {
+            c |= (digit | 0x20) - 'a' + 10;
+          } else {
+            return false;
+          }
+        }
+        break;
+      }
+      default:
+        return false;
+    }
+    EnsureBufferCapacity(1);
+    buffer_[buffer_length_++] = c;
+    return true;
+  }
+
+  void EnsureBufferCapacity(intptr_t additional) {
+    const intptr_t needed = buffer_length_ + additional;
+    if (needed > buffer_capacity_) {
+      const intptr_t new_capacity =
+          Utils::RoundUpToPowerOfTwo(Utils::Maximum(needed, kMinBuffer));
+      buffer_ = zone_->Realloc<uint16_t>(buffer_,
+                                         buffer_capacity_,
+                                         new_capacity);
+      buffer_capacity_ = new_capacity;
+    }
+  }
+
+  // Appends string content without escapes to the buffer. Returns false if
+  // UTF-8 input is malformed.
+  bool AppendToBuffer(intptr_t start, intptr_t length) {
+    if (length == 0) {
+      return true;
+    }
+    const CharType* chars = &chars_[start];
+    if (is_utf8_) {
+      const uint8_t* utf8 = reinterpret_cast<const uint8_t*>(chars);
+      if (!Utf8::IsValid(utf8, length)) {
+        return false;
+      }
+      Utf8::Type type;
+      const intptr_t count = Utf8::CodeUnitCount(utf8, length, &type);
+      EnsureBufferCapacity(count);
+      if (!Utf8::DecodeToUTF16(utf8, length, &buffer_[buffer_length_],
+                               count)) {
+        return false;
+      }
+      buffer_length_ += count;
+      return true;
+    }
+    EnsureBufferCapacity(length);
+    for (intptr_t i = 0; i < length; i++) {
+      buffer_[buffer_length_ + i] = chars[i];
+    }
+    buffer_length_ += length;
+    return true;
+  }
+
+  // Parses an object key, including the colon after it, and pushes it.
+  bool ParseKey() {
+    if (!Match('"')) {
+      return false;
+    }
+    buffer_length_ = 0;
+    if (!DecodeString()) {
+      return false;
+    }
+    const intptr_t id = InternKey();
+    SkipWhitespace();
+    if (!Match(':')) {
+      return false;
+    }
+    element_ = keys_.At(id);
+    values_.Add(element_);
+    key_ids_.Add(id);
+    return true;
+  }
+
+  // Returns the id of the key in the buffer, adding it to the key cache if
+  // this is its first occurrence in the input.
+  intptr_t InternKey() {
+    const intptr_t hash = String::Hash(buffer_, buffer_length_);
+    if ((key_hashes_.length() + 1) * 2 > key_table_capacity_) {
+      GrowKeyTable();
+    }
+    const intptr_t mask = key_table_capacity_ - 1;
+    intptr_t index = hash & mask;
+    while (key_table_[index] != 0) {
+      const intptr_t id = key_table_[index] - 1;
+      if (key_hashes_[id] == hash) {
+        string_ ^= keys_.At(id);
+        if (string_.Equals(buffer_, buffer_length_)) {
+          return id;
+        }
+      }
+      index = (index + 1) & mask;
+    }
+    string_ = Symbols::LookupFromUTF16(thread_, buffer_, buffer_length_);
+    if (string_.IsNull()) {
+      string_ = String::FromUTF16(buffer_, buffer_length_);
+    }
+    const intptr_t id = key_hashes_.length();
+    keys_.Add(string_);
+    key_hashes_.Add(hash);
+    key_maps_.Add(0);
+    key_slots_.Add(0);
+    key_table_[index] = id + 1;
+    return id;
+  }
+
+  void GrowKeyTable() {
+    const intptr_t new_capacity =
+        (key_table_capacity_ == 0) ? 64 : (key_table_capacity_ * 2);
+    const intptr_t mask = new_capacity - 1;
+    intptr_t* new_table = zone_->Alloc<intptr_t>(new_capacity);
+    memset(new_table, 0, new_capacity * sizeof(*new_table));
+    for (intptr_t id = 0; id < key_hashes_.length(); id++) {
+      intptr_t index = key_hashes_[id] & mask;
+      while (new_table[index] != 0) {
+        index = (index + 1) & mask;
+      }
+      new_table[index] = id + 1;
+    }
+    key_table_ = new_table;
+    key_table_capacity_ = new_capacity;
+  }
+
+  bool ParseNumber() {
+    const intptr_t start = position_;
+    const bool is_negative = Match('-');
+    const intptr_t digits_start = position_;
+    if (Match('0')) {
+      // A leading zero is a number on its own.
+    } else if (!SkipDigits()) {
+      return false;
+    }
+    const intptr_t num_digits = position_ - digits_start;
+    bool is_double = false;
+    if (Match('.')) {
+      is_double = true;
+      if (!SkipDigits()) {
+        return false;
+      }
+    }
+    if (Match('e') || Match('E')) {
+      is_double = true;
+      if (!Match('+')) {
+        Match('-');
+      }
+      if (!SkipDigits()) {
+        return false;
+      }
+    }
+    if (!is_double && (num_digits <= 18)) {
+      // Fits in an int64_t without overflow.
+      int64_t value = 0;
+      for (intptr_t i = digits_start; i < position_; i++) {
+        value = value * 10 + (chars_[i] - '0');
+      }
+      value_ = Integer::New(is_negative ? -value : value);
+      return true;
+    }
+    const intptr_t length = position_ - start;
+    const char* number = NumberChars(zone_, &chars_[start], length);
+    if (!is_double) {
+      string_ = String::FromLatin1(reinterpret_cast<const uint8_t*>(number),
+                                   length);
+      value_ = Integer::New(string_);
+      return true;
+    }
+    double value;
+    if (!CStringToDouble(number, length, &value)) {
+      return false;
+    }
+    value_ = Double::New(value);
+    return true;
+  }
+
+  // Moves the values of the innermost container from the value stack into
+  // a new list or map, which replaces them on the stack.
+  void CloseContainer() {
+    const intptr_t entry = containers_.RemoveLast();
+    const intptr_t start = entry >> 1;
+    const intptr_t count = values_.Length() - start;
+    if ((entry & 1) != 0) {
+      value_ = NewMap(start, count);
+    } else {
+      value_ = NewList(start, count);
+    }
+    values_.SetLength(start);
+    values_.Add(value_);
+  }
+
+  RawGrowableObjectArray* NewList(intptr_t start, intptr_t count) {
+    if (count == 0) {
+      return GrowableObjectArray::New();
+    }
+    const Array& data = Array::Handle(zone_, Array::New(count));
+    for (intptr_t i = 0; i < count; i++) {
+      element_ = values_.At(start + i);
+      data.SetAt(i, element_);
+    }
+    const GrowableObjectArray& list =
+        GrowableObjectArray::Handle(zone_, GrowableObjectArray::New(data));
+    list.SetLength(count);
+    return list.raw();
+  }
+
+  // Builds a map the way the snapshot reader does: the key/value pairs are
+  // stored in order and the map regenerates its index on first use. Later
+  // values of a repeated key replace earlier ones, as with map[key] = value.
+  RawLinkedHashMap* NewMap(intptr_t start, intptr_t count) {
+    ASSERT((count & 1) == 0);
+    const intptr_t num_pairs = count >> 1;
+    const intptr_t first_key = key_ids_.length() - num_pairs;
+    const intptr_t map_id = ++num_maps_;
+    intptr_t num_keys = 0;
+    for (intptr_t i = 0; i < num_pairs; i++) {
+      const intptr_t id = key_ids_[first_key + i];
+      if (key_maps_[id] != map_id) {
+        key_maps_[id] = map_id;
+        key_slots_[id] = num_keys++;
+      }
+      // Reuse the entry to remember where the pair goes.
+      key_ids_[first_key + i] = key_slots_[id];
+    }
+    const LinkedHashMap& map =
+        LinkedHashMap::Handle(zone_, LinkedHashMap::NewWithoutIndex(num_keys));
+    const Array& data = Array::Handle(zone_, map.data());
+    for (intptr_t i = 0; i < num_pairs; i++) {
+      const intptr_t slot = key_ids_[first_key + i];
+      element_ = values_.At(start + (i << 1));
+      data.SetAt(slot << 1, element_);
+      element_ = values_.At(start + (i << 1) + 1);
+      data.SetAt((slot << 1) + 1, element_);
+    }
+    key_ids_.TruncateTo(first_key);
+    return map.raw();
+  }
+
+  Thread* thread_;
+  Zone* zone_;
+  const CharType* chars_;
+  const intptr_t length_;
+  intptr_t position_;
+  const bool is_utf8_;
+
+  // Values of the open containers, innermost last.
+  const GrowableObjectArray& values_;
+  // For each open container, its start on the value stack shifted left by
+  // one, with the low bit set for maps.
+  GrowableArray<intptr_t> containers_;
+
+  // Code units of the string being decoded, if it has escapes.
+  uint16_t* buffer_;
+  intptr_t buffer_length_;
+  intptr_t buffer_capacity_;
+
+  // The key cache. A key's id indexes keys_ and the key_* arrays, and
+  // key_table_ is an open addressing hash table of ids plus one.
+  const GrowableObjectArray& keys_;
+  GrowableArray<intptr_t> key_hashes_;
+  GrowableArray<intptr_t> key_maps_;
+  GrowableArray<intptr_t> key_slots_;
+  // Ids of the keys on the value stack.
+  GrowableArray<intptr_t> key_ids_;
+  intptr_t* key_table_;
+  intptr_t key_table_capacity_;
+  intptr_t num_maps_;
+
+  Object& value_;
+  Object& element_;
+  String& string_;
+
+  DISALLOW_COPY_AND_ASSIGN(JsonParser);
+};
+
+
+template<typename CharType>
+static RawObject* ParseJson(Thread* thread,
+                            const CharType* chars,
+                            intptr_t length,
+                            bool is_utf8,
+                            const Instance& not_parsed) {
+  JsonParser<CharType> parser(thread, chars, length, is_utf8);
+  Object& result = Object::Handle(thread->zone());
+  if (!parser.Parse(&result)) {
+    return not_parsed.raw();
+  }
+  return result.raw();
+}
+
+
+// Parses a complete JSON text given as a String or as the UTF-8 bytes in a
+// Uint8List. Returns 'not_parsed' for other inputs and for input that is
+// not well-formed, in which case the Dart parser takes over.
+//
+// The input is copied first, as an internal string or typed data may be
+// moved by a collection during parsing.
+DEFINE_NATIVE_ENTRY(JsonDecoder_parse, 2) {
+  const Instance& input =
+      Instance::CheckedHandle(zone, arguments->NativeArgAt(0));
+  const Instance& not_parsed =
+      Instance::CheckedHandle(zone, arguments->NativeArgAt(1));
+  if (input.IsString()) {
+    const String& string = String::Cast(input);
+    const intptr_t length = string.Length();
+    if (length == 0) {
+      return not_parsed.raw();
+    }
+    if (string.CharSize() == String::kOneByteChar) {
+      uint8_t* chars = zone->Alloc<uint8_t>(length);
+      string.ToLatin1(chars, length);
+      return ParseJson(thread, chars, length, false, not_parsed);
+    }
+    uint16_t* chars = zone->Alloc<uint16_t>(length);
+    string.ToUTF16(chars, length);
+    return ParseJson(thread, chars, length, false, not_parsed);
+  }
+
+  Instance& data = Instance::Handle(zone, input.raw());
+  intptr_t offset = 0;
+  intptr_t length = 0;
+  switch (input.GetClassId()) {
+    case kTypedDataUint8ArrayCid:
+    case kTypedDataUint8ClampedArrayCid:
+      length = TypedData::Cast(input).Length();
+      break;
+    case kExternalTypedDataUint8ArrayCid:
+    case kExternalTypedDataUint8ClampedArrayCid:
+      length = ExternalTypedData::Cast(input).Length();
+      break;
+    case kTypedDataUint8ArrayViewCid:
+    case kTypedDataUint8ClampedArrayViewCid:
+      data = TypedDataView::Data(input);
+      offset = Smi::Value(TypedDataView::OffsetInBytes(input));
+      length = Smi::Value(TypedDataView::Length(input));
+      if (!data.IsTypedData() && !data.IsExternalTypedData()) {
+        return not_parsed.raw();
+      }
+      break;
+    default:
+      return not_parsed.raw();
+  }
+  if (length == 0) {
+    return not_parsed.raw();
+  }
+  uint8_t* chars = zone->Alloc<uint8_t>(length);
+  {
+    NoSafepointScope no_safepoint;
+    const void* bytes = data.IsTypedData()
+        ? TypedData::Cast(data).DataAddr(offset)
+        : ExternalTypedData::Cast(data).DataAddr(offset);
+    memmove(chars, bytes, length);
+  }
+  return ParseJson(thread, chars, length, true, not_parsed);
+}
+
+}  // namespace dart
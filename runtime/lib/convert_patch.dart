@@ -7,6 +7,10 @@ import "dart:_internal" show POWERS_OF_TEN;
 // JSON conversion.
 
 @patch _parseJson(String json, reviver(var key, var value)) {
+  if (reviver == null) {
+    var result = _parseJsonNative(json, _JSON_NOT_PARSED);
+    if (!identical(result, _JSON_NOT_PARSED)) return result;
+  }
   _BuildJsonListener listener;
   if (reviver == null) {
     listener = new _BuildJsonListener();
@@ -21,6 +25,20 @@ import "dart:_internal" show POWERS_OF_TEN;
   return listener.result;
 }
 
+/// Returned by [_parseJsonNative] when the Dart parser has to take over.
+const _JSON_NOT_PARSED = const Object();
+
+/**
+ * Parses a complete JSON text natively, building the same objects as
+ * [_BuildJsonListener].
+ *
+ * The [input] is either a [String] or a [Uint8List] with UTF-8 encoded
+ * JSON. Returns [notParsed] for any other input, and for input that is not
+ * well-formed, which the Dart parser then rejects with a precise
+ * [FormatException].
+ */
+_parseJsonNative(input, Object notParsed) native "JsonDecoder_parse";
+
 @patch class Utf8Decoder {
   @patch
   Converter<List<int>, dynamic/*=T*/> fuse/*<T>*/(
@@ -37,8 +55,27 @@ import "dart:_internal" show POWERS_OF_TEN;
   @patch
   static String _convertIntercepted(
       bool allowMalformed, List<int> codeUnits, int start, int end) {
-    return null;  // This call was not intercepted.
+    if (codeUnits is! Uint8List) {
+      return null;  // This call was not intercepted.
+    }
+    end = RangeError.checkValidRange(start, end, codeUnits.length);
+    // Skip a leading byte order mark, like the Dart decoder does.
+    if ((end - start >= 3) &&
+        (codeUnits[start] == 0xEF) &&
+        (codeUnits[start + 1] == 0xBB) &&
+        (codeUnits[start + 2] == 0xBF)) {
+      start += 3;
+    }
+    // Returns null for malformed input, which the Dart decoder then
+    // reports or replaces.
+    return _decodeSlice(codeUnits, start, end);
   }
+
+  // Decodes well-formed UTF-8 from a Uint8List in one native call, using
+  // the VM's vectorized ASCII scan. Returns null if [codeUnits] is not a
+  // Uint8List or the bytes are malformed.
+  static String _decodeSlice(List<int> codeUnits, int start, int end)
+      native "Utf8Decoder_decodeSlice";
 }
 
 class _JsonUtf8Decoder extends Converter<List<int>, Object> {
@@ -48,6 +85,10 @@ class _JsonUtf8Decoder extends Converter<List<int>, Object> {
   _JsonUtf8Decoder(this._reviver, this._allowMalformed);
 
   Object convert(List<int> input) {
+    if (_reviver == null && input is Uint8List) {
+      var result = _parseJsonNative(input, _JSON_NOT_PARSED);
+      if (!identical(result, _JSON_NOT_PARSED)) return result;
+    }
     var parser = _JsonUtf8DecoderSink._createParser(_reviver, _allowMalformed);
     parser.chunk = input;
     parser.chunkEnd = input.length;
@@ -1691,6 +1732,10 @@ class _JsonUtf8Parser extends _ChunkedJsonParser {
     if (bits <= maxAsciiChar) {
       return new String.fromCharCodes(chunk, start, end);
     }
+    if (chunk is Uint8List) {
+      String result = Utf8Decoder._decodeSlice(chunk, start, end);
+      if (result != null) return result;
+    }
     beginString();
     if (start < end) addSliceToString(start, end);
     String result = endString();
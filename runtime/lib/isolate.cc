@@ -127,6 +127,110 @@ DEFINE_NATIVE_ENTRY(SendPortImpl_sendInternal_, 2) {
 }
 
 
+// Returns the address of the first byte of 'instance' and stores its length
+// in bytes in 'length_in_bytes', or returns NULL if 'instance' is not typed
+// data, external typed data or a view on either. Addresses into the Dart heap
+// are only stable while no safepoint can be reached.
+static uint8_t* TypedDataBytes(Zone* zone,
+                               const Instance& instance,
+                               intptr_t* length_in_bytes) {
+  const intptr_t cid = instance.GetClassId();
+  if (RawObject::IsTypedDataClassId(cid)) {
+    const TypedData& data = TypedData::Cast(instance);
+    *length_in_bytes = data.LengthInBytes();
+    return reinterpret_cast<uint8_t*>(data.DataAddr(0));
+  }
+  if (RawObject::IsExternalTypedDataClassId(cid)) {
+    const ExternalTypedData& data = ExternalTypedData::Cast(instance);
+    *length_in_bytes = data.LengthInBytes();
+    return reinterpret_cast<uint8_t*>(data.DataAddr(0));
+  }
+  if (RawObject::IsTypedDataViewClassId(cid)) {
+    const intptr_t length = Smi::Value(TypedDataView::Length(instance));
+    const intptr_t offset = Smi::Value(TypedDataView::OffsetInBytes(instance));
+    *length_in_bytes = length * TypedDataView::ElementSizeInBytes(cid);
+    const Instance& data =
+        Instance::Handle(zone, TypedDataView::Data(instance));
+    if (TypedData::IsTypedData(data)) {
+      return reinterpret_cast<uint8_t*>(
+          TypedData::Cast(data).DataAddr(offset));
+    }
+    ASSERT(ExternalTypedData::IsExternalTypedData(data));
+    return reinterpret_cast<uint8_t*>(
+        ExternalTypedData::Cast(data).DataAddr(offset));
+  }
+  return NULL;
+}
+
+
+DEFINE_NATIVE_ENTRY(TransferableTypedData_factory, 2) {
+  ASSERT(TypeArguments::CheckedHandle(arguments->NativeArgAt(0)).IsNull());
+  GET_NON_NULL_NATIVE_ARGUMENT(Array, array, arguments->NativeArgAt(1));
+
+  const intptr_t max_bytes =
+      ExternalTypedData::MaxElements(kExternalTypedDataUint8ArrayCid);
+  Instance& instance = Instance::Handle(zone);
+  intptr_t total_bytes = 0;
+  for (intptr_t i = 0; i < array.Length(); i++) {
+    instance ^= array.At(i);
+    intptr_t length_in_bytes = 0;
+    if (instance.IsNull() ||
+        (TypedDataBytes(zone, instance, &length_in_bytes) == NULL)) {
+      Exceptions::ThrowArgumentError(instance);
+    }
+    if (length_in_bytes > (max_bytes - total_bytes)) {
+      Exceptions::ThrowArgumentError(String::Handle(zone,
+          String::New("TransferableTypedData is too large")));
+    }
+    total_bytes += length_in_bytes;
+  }
+
+  // This is the only copy: from here on the bytes change owners without
+  // being touched, whichever isolate they end up in.
+  uint8_t* data = reinterpret_cast<uint8_t*>(
+      malloc(Utils::Maximum(total_bytes, static_cast<intptr_t>(1))));
+  if (data == NULL) {
+    Exceptions::ThrowOOM();
+  }
+  intptr_t offset = 0;
+  for (intptr_t i = 0; i < array.Length(); i++) {
+    instance ^= array.At(i);
+    NoSafepointScope no_safepoint;
+    intptr_t length_in_bytes = 0;
+    uint8_t* bytes = TypedDataBytes(zone, instance, &length_in_bytes);
+    memmove(data + offset, bytes, length_in_bytes);
+    offset += length_in_bytes;
+  }
+  ASSERT(offset == total_bytes);
+  return TransferableTypedData::New(data, total_bytes);
+}
+
+
+static void MaterializedDataFinalizer(void* isolate_callback_data,
+                                      Dart_WeakPersistentHandle handle,
+                                      void* peer) {
+  free(peer);
+}
+
+
+DEFINE_NATIVE_ENTRY(TransferableTypedData_materialize, 1) {
+  GET_NON_NULL_NATIVE_ARGUMENT(TransferableTypedData, transferable,
+                               arguments->NativeArgAt(0));
+  TransferableTypedDataPeer* peer = transferable.peer();
+  if (peer->IsDetached()) {
+    Exceptions::ThrowArgumentError(String::Handle(zone, String::New(
+        "Attempt to materialize object that was transferred already.")));
+  }
+  uint8_t* data = peer->data();
+  const intptr_t length = peer->length();
+  const ExternalTypedData& typed_data = ExternalTypedData::Handle(zone,
+      ExternalTypedData::New(kExternalTypedDataUint8ArrayCid, data, length));
+  peer->Detach(isolate);
+  typed_data.AddFinalizer(data, &MaterializedDataFinalizer, length);
+  return typed_data.raw();
+}
+
+
 static void ThrowIsolateSpawnException(const String& message) {
   const Array& args = Array::Handle(Array::New(1));
   args.SetAt(0, message);
@@ -4,6 +4,7 @@
 
 import "dart:collection" show HashMap;
 import "dart:_internal";
+import "dart:typed_data" show ByteBuffer, TypedData, Uint8List;
 
 @patch class ReceivePort {
   @patch factory ReceivePort() = _ReceivePortImpl;
@@ -193,6 +194,28 @@ class _SendPortImpl implements SendPort {
   void _sendInternal(var message) native "SendPortImpl_sendInternal_";
 }
 
+@patch class TransferableTypedData {
+  @patch factory TransferableTypedData.fromList(List<TypedData> list) {
+    if (list == null) {
+      throw new ArgumentError.notNull("list");
+    }
+    return new _TransferableTypedDataImpl(
+        new List<TypedData>.from(list, growable: false));
+  }
+}
+
+class _TransferableTypedDataImpl implements TransferableTypedData {
+  factory _TransferableTypedDataImpl(List<TypedData> list)
+      native "TransferableTypedData_factory";
+
+  ByteBuffer materialize() {
+    return _materializeIntoUint8List().buffer;
+  }
+
+  Uint8List _materializeIntoUint8List()
+      native "TransferableTypedData_materialize";
+}
+
 typedef _MainFunction();
 typedef _MainFunctionArgs(args);
 typedef _MainFunctionArgsMessage(args, message);
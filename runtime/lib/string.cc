@@ -624,4 +624,69 @@ DEFINE_NATIVE_ENTRY(StringBuffer_createStringFromUint16Array, 3) {
   return result.raw();
 }
 
+
+// If 'list' is a Uint8List, sets 'data' to the typed data holding its bytes,
+// 'offset' to the offset of its first byte within 'data' and 'length' to its
+// length, and returns true.
+static bool GetUint8ListBytes(const Instance& list,
+                              Instance* data,
+                              intptr_t* offset,
+                              intptr_t* length) {
+  switch (list.GetClassId()) {
+    case kTypedDataUint8ArrayCid:
+    case kTypedDataUint8ClampedArrayCid:
+      *data = list.raw();
+      *offset = 0;
+      *length = TypedData::Cast(list).Length();
+      return true;
+    case kExternalTypedDataUint8ArrayCid:
+    case kExternalTypedDataUint8ClampedArrayCid:
+      *data = list.raw();
+      *offset = 0;
+      *length = ExternalTypedData::Cast(list).Length();
+      return true;
+    case kTypedDataUint8ArrayViewCid:
+    case kTypedDataUint8ClampedArrayViewCid:
+      *data = TypedDataView::Data(list);
+      *offset = Smi::Value(TypedDataView::OffsetInBytes(list));
+      *length = Smi::Value(TypedDataView::Length(list));
+      return data->IsTypedData() || data->IsExternalTypedData();
+    default:
+      return false;
+  }
+}
+
+
+// Decodes the UTF-8 bytes in [start, end) of a Uint8List. Returns null if
+// the list is not a Uint8List or the bytes are malformed, in which case the
+// caller falls back to the Dart decoder to report or replace them.
+DEFINE_NATIVE_ENTRY(Utf8Decoder_decodeSlice, 3) {
+  const Instance& list = Instance::CheckedHandle(zone,
+                                                 arguments->NativeArgAt(0));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, start_obj, arguments->NativeArgAt(1));
+  GET_NON_NULL_NATIVE_ARGUMENT(Smi, end_obj, arguments->NativeArgAt(2));
+  const intptr_t start = start_obj.Value();
+  const intptr_t end = end_obj.Value();
+  Instance& data = Instance::Handle(zone);
+  intptr_t offset = 0;
+  intptr_t length = 0;
+  if (!GetUint8ListBytes(list, &data, &offset, &length) ||
+      (start < 0) || (start > end) || (end > length)) {
+    return Object::null();
+  }
+  if (start == end) {
+    return Symbols::Empty().raw();
+  }
+  {
+    NoSafepointScope no_safepoint;
+    const void* utf8 = data.IsTypedData()
+        ? TypedData::Cast(data).DataAddr(offset + start)
+        : ExternalTypedData::Cast(data).DataAddr(offset + start);
+    if (!Utf8::IsValid(reinterpret_cast<const uint8_t*>(utf8), end - start)) {
+      return Object::null();
+    }
+  }
+  return String::FromUTF8(data, offset + start, end - start);
+}
+
 }  // namespace dart
@@ -0,0 +1,114 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test elementwise Float32List loops, including the elements left over by
+// the vectorized loop and loops where the arrays alias.
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation --loop_vectorization
+
+import 'dart:typed_data';
+import "package:expect/expect.dart";
+
+void add(Float32List a, Float32List b, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] + b[i];
+  }
+}
+
+void sub(Float32List a, Float32List b, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] - b[i];
+  }
+}
+
+void mul(Float32List a, Float32List b, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] * b[i];
+  }
+}
+
+void div(Float32List a, Float32List b, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] / b[i];
+  }
+}
+
+void scale(Float32List a, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] * 0.5;
+  }
+}
+
+void copy(Float32List a, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i];
+  }
+}
+
+// Not exactly representable in single precision: the product is rounded
+// once, from double precision.
+void scaleByTenth(Float32List a, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] * 0.1;
+  }
+}
+
+// Rounded once, from double precision.
+void multiplyAdd(Float32List a, Float32List b, Float32List c) {
+  for (var i = 0; i < c.length; i++) {
+    c[i] = a[i] * b[i] + a[i];
+  }
+}
+
+Float32List makeList(int length, double seed) {
+  var list = new Float32List(length);
+  for (var i = 0; i < length; i++) {
+    list[i] = seed * (i + 1) / 7.0;
+  }
+  return list;
+}
+
+double round(double x) => (new Float32List(1)..[0] = x)[0];
+
+void testLength(int length) {
+  var a = makeList(length, 1.5);
+  var b = makeList(length, -2.25);
+  var c = new Float32List(length);
+
+  add(a, b, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] + b[i]), c[i]);
+  sub(a, b, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] - b[i]), c[i]);
+  mul(a, b, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] * b[i]), c[i]);
+  div(a, b, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] / b[i]), c[i]);
+  scale(a, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] * 0.5), c[i]);
+  copy(a, c);
+  for (var i = 0; i < length; i++) Expect.equals(a[i], c[i]);
+  scaleByTenth(a, c);
+  for (var i = 0; i < length; i++) Expect.equals(round(a[i] * 0.1), c[i]);
+  multiplyAdd(a, b, c);
+  for (var i = 0; i < length; i++) {
+    Expect.equals(round(a[i] * b[i] + a[i]), c[i]);
+  }
+
+  // In place.
+  var expected = new Float32List(length);
+  for (var i = 0; i < length; i++) expected[i] = a[i] * a[i];
+  mul(a, a, a);
+  for (var i = 0; i < length; i++) Expect.equals(expected[i], a[i]);
+}
+
+main() {
+  for (var iteration = 0; iteration < 20; iteration++) {
+    for (var length = 0; length < 14; length++) {
+      testLength(length);
+    }
+  }
+  // Out of bounds accesses still throw.
+  Expect.throws(() => add(new Float32List(3), new Float32List(4),
+                          new Float32List(5)));
+}
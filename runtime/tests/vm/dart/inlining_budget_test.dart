@@ -0,0 +1,116 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test that static, monomorphic and polymorphic calls compute the same results
+// when inlined within an instruction budget, and that code which inlined
+// calls within the budget still deoptimizes when its assumptions fail.
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation --inlining_budget=1
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation --inlining_budget=50
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation --inlining_budget=1000
+
+import "package:expect/expect.dart";
+
+class Point {
+  final x, y;
+  Point(this.x, this.y);
+  get sum => x + y;
+  scale(factor) => new Point(x * factor, y * factor);
+}
+
+abstract class Shape {
+  area();
+}
+
+class Square extends Shape {
+  final side;
+  Square(this.side);
+  area() => side * side;
+}
+
+class Rectangle extends Shape {
+  final width, height;
+  Rectangle(this.width, this.height);
+  area() => width * height;
+}
+
+class Triangle extends Shape {
+  final base, height;
+  Triangle(this.base, this.height);
+  area() => base * height ~/ 2;
+}
+
+// Another receiver of 'sum' and 'scale', only seen after optimization.
+class Pair {
+  final first, second;
+  Pair(this.first, this.second);
+  get sum => "$first$second";
+  scale(factor) => new Pair(first * factor, second * factor);
+}
+
+square(x) => x * x;
+
+addSquares(x, y) => square(x) + square(y);
+
+// Larger than most budgets, so it is only inlined with a large one.
+polynomial(x) {
+  var result = 0;
+  for (var i = 0; i < 4; i++) {
+    result = result * x + i;
+  }
+  return result;
+}
+
+staticCalls(xs) {
+  var result = 0;
+  for (var x in xs) {
+    result += addSquares(x, 2) + polynomial(x) + square(3);
+  }
+  return result;
+}
+
+staticCallsExpected(xs) {
+  var result = 0;
+  for (var x in xs) {
+    result += (x * x + 4) + ((x + 2) * x + 3) + 9;
+  }
+  return result;
+}
+
+monomorphicCalls(p) => p.scale(2).sum + p.sum;
+
+polymorphicCalls(shapes) {
+  var result = 0;
+  for (var shape in shapes) {
+    result += shape.area();
+  }
+  return result;
+}
+
+main() {
+  var shapes = [new Square(3), new Rectangle(2, 5), new Triangle(4, 3)];
+  for (var i = 0; i < 50; i++) {
+    var ints = new List.generate(i, (j) => j);
+    Expect.equals(staticCallsExpected(ints), staticCalls(ints));
+    Expect.equals(3 * (i + 1), monomorphicCalls(new Point(i, 1)));
+    Expect.equals(9 + 10 + 6, polymorphicCalls(shapes));
+  }
+
+  // Optimized code speculated on the receivers and arguments seen so far.
+  Expect.equals("42" "21", monomorphicCalls(new Pair(2, 1)));
+  Expect.equals(3 * 2.5, monomorphicCalls(new Point(1.5, 1)));
+  Expect.equals(9 + 10 + 6 + 4.0,
+                polymorphicCalls(shapes..add(new Square(2.0))));
+  // 1.5 * 1.5 + 4 + ((1.5 + 2) * 1.5 + 3) + 9
+  Expect.equals(23.5, staticCalls([1.5]));
+
+  // Reoptimized after deoptimizing.
+  for (var i = 0; i < 50; i++) {
+    var ints = new List.generate(i, (j) => j);
+    Expect.equals(staticCallsExpected(ints), staticCalls(ints));
+    Expect.equals(3 * (i + 1), monomorphicCalls(new Point(i, 1)));
+    Expect.equals("${2 * i}2" "${i}1", monomorphicCalls(new Pair(i, 1)));
+    Expect.equals(9 + 10 + 6 + 4.0, polymorphicCalls(shapes));
+  }
+}
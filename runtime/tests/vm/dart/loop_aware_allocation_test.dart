@@ -0,0 +1,94 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test loops with more live values than registers, where values are spilled
+// around loops and across calls inside of them.
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation
+// VMOptions=--optimization_counter_threshold=10 --no-use-osr --no-background-compilation --loop_aware_allocation
+
+import 'dart:typed_data';
+import "package:expect/expect.dart";
+
+int accumulators(List<int> a) {
+  var s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0;
+  var s6 = 0, s7 = 0, s8 = 0, s9 = 0, s10 = 0, s11 = 0;
+  for (var i = 0; i < a.length; i++) {
+    var x = a[i];
+    s0 += x; s1 ^= x; s2 |= x; s3 &= x; s4 += x << 1; s5 -= x;
+    s6 += x & 7; s7 += x >> 1; s8 ^= x << 2; s9 += x * 3;
+    s10 -= x & 3; s11 |= x << 3;
+  }
+  return s0 + s1 + s2 + s3 + s4 + s5 + s6 + s7 + s8 + s9 + s10 + s11;
+}
+
+int accumulatorsExpected(List<int> a) {
+  var s = 0;
+  var s1 = 0, s2 = 0, s8 = 0, s11 = 0;
+  for (var x in a) {
+    s += x + (x << 1) - x + (x & 7) + (x >> 1) + x * 3 - (x & 3);
+    s1 ^= x; s2 |= x; s8 ^= x << 2; s11 |= x << 3;
+  }
+  return s + s1 + s2 + s8 + s11;
+}
+
+int callInLoop(List<int> a, int x, int y, int z) {
+  var p = x * y, q = y * z, r = x * z;
+  var sum = 0;
+  for (var i = 0; i < a.length; i++) {
+    sum += a[i].toString().length;
+  }
+  return sum + p + q + r;
+}
+
+int nestedCallInLoop(List<int> a, int x, int y) {
+  var p = x + y, q = x - y;
+  var sum = 0;
+  for (var i = 0; i < a.length; i++) {
+    for (var j = 0; j < i; j++) {
+      sum += (a[j] + p).toString().length;
+    }
+    sum += q;
+  }
+  return sum + p * q;
+}
+
+double matrixMultiply(Float64List a, Float64List b, Float64List c, int n) {
+  for (var i = 0; i < n; i++) {
+    for (var j = 0; j < n; j++) {
+      var sum = 0.0;
+      for (var k = 0; k < n; k++) {
+        sum += a[i * n + k] * b[k * n + j];
+      }
+      c[i * n + j] = sum;
+    }
+  }
+  return c[n * n - 1];
+}
+
+main() {
+  var list = new List<int>.generate(50, (i) => i * 7);
+  var digits = 0;
+  for (var x in list) digits += x.toString().length;
+
+  var n = 4;
+  var a = new Float64List(n * n);
+  var b = new Float64List(n * n);
+  var c = new Float64List(n * n);
+  for (var i = 0; i < n * n; i++) {
+    a[i] = i.toDouble();
+    b[i] = 1.0;
+  }
+
+  // Not optimized yet.
+  var nested = nestedCallInLoop(list, 5, 1);
+
+  for (var iteration = 0; iteration < 50; iteration++) {
+    Expect.equals(accumulatorsExpected(list), accumulators(list));
+    Expect.equals(digits + 2 * 3 + 3 * 4 + 2 * 4,
+                  callInLoop(list, 2, 3, 4));
+    Expect.equals(nested, nestedCallInLoop(list, 5, 1));
+    // The last row of a sums up to 12 + 13 + 14 + 15.
+    Expect.equals(54.0, matrixMultiply(a, b, c, n));
+  }
+}
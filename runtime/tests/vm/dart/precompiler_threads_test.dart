@@ -0,0 +1,114 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Test that functions compiled on several precompiler threads at once,
+// including callees which are inlined into each other, compute the same
+// results as when compiled one after the other.
+// VMOptions=
+// VMOptions=--precompiler_threads=4
+
+import "package:expect/expect.dart";
+
+abstract class Shape {
+  double get area;
+  int get corners;
+}
+
+class Square implements Shape {
+  final double side;
+  Square(this.side);
+  double get area => side * side;
+  int get corners => 4;
+}
+
+class Rectangle implements Shape {
+  final double width, height;
+  Rectangle(this.width, this.height);
+  double get area => width * height;
+  int get corners => 4;
+}
+
+class Triangle implements Shape {
+  final double base, height;
+  Triangle(this.base, this.height);
+  double get area => base * height / 2;
+  int get corners => 3;
+}
+
+class Circle implements Shape {
+  final double radius;
+  Circle(this.radius);
+  double get area => 3.0 * radius * radius;
+  int get corners => 0;
+}
+
+int fib(int n) => n < 2 ? n : fib(n - 1) + fib(n - 2);
+
+int gcd(int a, int b) => b == 0 ? a : gcd(b, a % b);
+
+int sumOfDigits(int n) {
+  var sum = 0;
+  while (n > 0) {
+    sum += n % 10;
+    n ~/= 10;
+  }
+  return sum;
+}
+
+String reverse(String s) => new String.fromCharCodes(s.codeUnits.reversed);
+
+List<int> primes(int limit) {
+  var sieve = new List<bool>.filled(limit, true);
+  var result = <int>[];
+  for (var i = 2; i < limit; i++) {
+    if (!sieve[i]) continue;
+    result.add(i);
+    for (var j = i * i; j < limit; j += i) sieve[j] = false;
+  }
+  return result;
+}
+
+Function adder(int x) => (int y) => x + y;
+
+Function composer(Function f, Function g) => (x) => f(g(x));
+
+double totalArea(List<Shape> shapes) {
+  var total = 0.0;
+  for (var shape in shapes) total += shape.area;
+  return total;
+}
+
+int totalCorners(List<Shape> shapes) =>
+    shapes.fold(0, (sum, shape) => sum + shape.corners);
+
+main() {
+  Expect.equals(55, fib(10));
+  Expect.equals(6, gcd(48, 18));
+  Expect.equals(15, sumOfDigits(12345));
+  Expect.equals("cba", reverse("abc"));
+  Expect.listEquals([2, 3, 5, 7, 11, 13, 17, 19], primes(20));
+
+  var addFive = adder(5);
+  var twice = composer(addFive, addFive);
+  Expect.equals(12, addFive(7));
+  Expect.equals(17, twice(7));
+
+  var shapes = <Shape>[
+      new Square(2.0), new Rectangle(2.0, 3.0),
+      new Triangle(4.0, 2.0), new Circle(1.0)];
+  Expect.equals(4.0 + 6.0 + 4.0 + 3.0, totalArea(shapes));
+  Expect.equals(11, totalCorners(shapes));
+
+  var words = ["delta", "alpha", "charlie", "bravo"]..sort();
+  Expect.listEquals(["alpha", "bravo", "charlie", "delta"], words);
+  Expect.equals("alpha,bravo,charlie,delta", words.join(","));
+
+  var counts = <String, int>{};
+  for (var word in "a b a c b a".split(" ")) {
+    counts[word] = (counts[word] ?? 0) + 1;
+  }
+  Expect.equals(3, counts["a"]);
+  Expect.equals(2, counts["b"]);
+  Expect.equals(1, counts["c"]);
+}
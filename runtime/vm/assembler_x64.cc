@@ -2945,6 +2945,24 @@ void Assembler::StoreIntoObject(Register object,
                                 bool can_value_be_smi) {
   ASSERT(object != value);
   movq(dest, value);
+  if (FLAG_concurrent_mark) {
+    // While the old generation is marked concurrently, the stored value must
+    // not be missed by the marker.
+    Label not_marking;
+    cmpq(Address(THR, Thread::marking_stack_block_offset()), Immediate(0));
+    j(EQUAL, &not_marking, Assembler::kNearJump);
+    if (value != RDX) {
+      pushq(RDX);
+      movq(RDX, value);
+    }
+    pushq(CODE_REG);
+    movq(CODE_REG, Address(THR, Thread::marking_barrier_code_offset()));
+    movq(TMP, Address(THR, Thread::marking_barrier_entry_point_offset()));
+    call(TMP);
+    popq(CODE_REG);
+    if (value != RDX) popq(RDX);
+    Bind(&not_marking);
+  }
   Label done;
   if (can_value_be_smi) {
     StoreIntoObjectFilter(object, value, &done);
@@ -41,6 +41,10 @@ class AtomicOperations : public AllStatic {
   // that are accessed by generated code.
   static void DecrementBy(intptr_t* p, intptr_t value);
 
+  // Issues a full memory barrier: no load or store before the fence is
+  // reordered with any load or store after it.
+  static void ThreadFence();
+
   // Atomically compare *ptr to old_value, and if equal, store new_value.
   // Returns the original value at ptr.
   //
@@ -41,6 +41,11 @@ inline void AtomicOperations::DecrementBy(intptr_t* p, intptr_t value) {
 }
 
 
+inline void AtomicOperations::ThreadFence() {
+  __sync_synchronize();
+}
+
+
 #if !defined(USING_SIMULATOR_ATOMICS)
 inline uword AtomicOperations::CompareAndSwapWord(uword* ptr,
                                                   uword old_value,
@@ -77,6 +77,11 @@ inline void AtomicOperations::DecrementBy(intptr_t* p, intptr_t value) {
 }
 
 
+inline void AtomicOperations::ThreadFence() {
+  MemoryBarrier();
+}
+
+
 #if !defined(USING_SIMULATOR)
 inline uword AtomicOperations::CompareAndSwapWord(uword* ptr,
                                                   uword old_value,
@@ -76,36 +76,25 @@ static void ForwardObjectTo(RawObject* before_obj, RawObject* after_obj) {
 }
 
 
-class ForwardPointersVisitor : public ObjectPointerVisitor {
- public:
-  explicit ForwardPointersVisitor(Isolate* isolate)
-      : ObjectPointerVisitor(isolate), visiting_object_(NULL), count_(0) { }
-
-  virtual void VisitPointers(RawObject** first, RawObject** last) {
-    for (RawObject** p = first; p <= last; p++) {
-      RawObject* old_target = *p;
-      if (IsForwardingObject(old_target)) {
-        RawObject* new_target = GetForwardedObject(old_target);
-        if (visiting_object_ == NULL) {
-          *p = new_target;
-        } else {
-          visiting_object_->StorePointer(p, new_target);
-        }
-        count_++;
+ForwardPointersVisitor::ForwardPointersVisitor(Isolate* isolate)
+    : ObjectPointerVisitor(isolate), visiting_object_(NULL), count_(0) { }
+
+
+void ForwardPointersVisitor::VisitPointers(RawObject** first,
+                                           RawObject** last) {
+  for (RawObject** p = first; p <= last; p++) {
+    RawObject* old_target = *p;
+    if (IsForwardingObject(old_target)) {
+      RawObject* new_target = GetForwardedObject(old_target);
+      if (visiting_object_ == NULL) {
+        *p = new_target;
+      } else {
+        visiting_object_->StorePointer(p, new_target);
       }
+      count_++;
     }
   }
-
-  void VisitingObject(RawObject* obj) { visiting_object_ = obj; }
-
-  intptr_t count() const { return count_; }
-
- private:
-  RawObject* visiting_object_;
-  intptr_t count_;
-
-  DISALLOW_COPY_AND_ASSIGN(ForwardPointersVisitor);
-};
+}
 
 
 class ForwardHeapPointersVisitor : public ObjectVisitor {
@@ -125,57 +114,34 @@ class ForwardHeapPointersVisitor : public ObjectVisitor {
 };
 
 
-class ForwardHeapPointersHandleVisitor : public HandleVisitor {
- public:
-  ForwardHeapPointersHandleVisitor()
-      : HandleVisitor(Thread::Current()), count_(0) { }
-
-  virtual void VisitHandle(uword addr) {
-    FinalizablePersistentHandle* handle =
-        reinterpret_cast<FinalizablePersistentHandle*>(addr);
-    if (IsForwardingObject(handle->raw())) {
-      *handle->raw_addr() = GetForwardedObject(handle->raw());
-      count_++;
-    }
-  }
-
-  intptr_t count() const { return count_; }
+ForwardHeapPointersHandleVisitor::ForwardHeapPointersHandleVisitor()
+    : HandleVisitor(Thread::Current()), count_(0) { }
 
- private:
-  int count_;
 
-  DISALLOW_COPY_AND_ASSIGN(ForwardHeapPointersHandleVisitor);
-};
+void ForwardHeapPointersHandleVisitor::VisitHandle(uword addr) {
+  FinalizablePersistentHandle* handle =
+      reinterpret_cast<FinalizablePersistentHandle*>(addr);
+  if (IsForwardingObject(handle->raw())) {
+    *handle->raw_addr() = GetForwardedObject(handle->raw());
+    count_++;
+  }
+}
 
 
-// On IA32, object pointers are embedded directly in the instruction stream,
-// which is normally write-protected, so we need to make it temporarily writable
-// to forward the pointers. On all other architectures, object pointers are
-// accessed through ObjectPools.
 #if defined(TARGET_ARCH_IA32)
-class WritableCodeLiteralsScope : public ValueObject {
- public:
-  explicit WritableCodeLiteralsScope(Heap* heap) : heap_(heap) {
-    if (FLAG_write_protect_code) {
-      heap_->WriteProtectCode(false);
-    }
+WritableCodeLiteralsScope::WritableCodeLiteralsScope(Heap* heap)
+    : heap_(heap) {
+  if (FLAG_write_protect_code) {
+    heap_->WriteProtectCode(false);
   }
+}
 
-  ~WritableCodeLiteralsScope() {
-    if (FLAG_write_protect_code) {
-      heap_->WriteProtectCode(true);
-    }
-  }
 
- private:
-  Heap* heap_;
-};
-#else
-class WritableCodeLiteralsScope : public ValueObject {
- public:
-  explicit WritableCodeLiteralsScope(Heap* heap) { }
-  ~WritableCodeLiteralsScope() { }
-};
+WritableCodeLiteralsScope::~WritableCodeLiteralsScope() {
+  if (FLAG_write_protect_code) {
+    heap_->WriteProtectCode(true);
+  }
+}
 #endif
 
 
@@ -261,6 +227,13 @@ void Become::ElementsForwardIdentity(const Array& before, const Array& after) {
     }
 
     ForwardObjectTo(before_obj, after_obj);
+    if (thread->is_marking() &&
+        after_obj->IsOldObject() &&
+        !after_obj->IsMarked()) {
+      // References from objects that were already marked concurrently are
+      // redirected below without going through the write barrier.
+      thread->MarkingStackAddObject(after_obj);
+    }
 
     // Forward the identity hash too if it has one.
     intptr_t hash = heap->GetHash(before_obj);
@@ -6,11 +6,14 @@
 #define VM_BECOME_H_
 
 #include "vm/allocation.h"
+#include "vm/handles.h"
 #include "vm/raw_object.h"
+#include "vm/visitor.h"
 
 namespace dart {
 
 class Array;
+class Heap;
 
 // Objects that are a source in a become are tranformed into forwarding
 // corpses pointing to the corresponding target. Forwarding corpses have the
@@ -71,6 +74,65 @@ class ForwardingCorpse {
   DISALLOW_IMPLICIT_CONSTRUCTORS(ForwardingCorpse);
 };
 
+// Redirects visited pointers to forwarding corpses to their targets. While an
+// object is being visited (see VisitingObject), its slots are updated through
+// the write barrier; root slots are updated directly.
+class ForwardPointersVisitor : public ObjectPointerVisitor {
+ public:
+  explicit ForwardPointersVisitor(Isolate* isolate);
+
+  virtual void VisitPointers(RawObject** first, RawObject** last);
+
+  void VisitingObject(RawObject* obj) { visiting_object_ = obj; }
+
+  intptr_t count() const { return count_; }
+
+ private:
+  RawObject* visiting_object_;
+  intptr_t count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardPointersVisitor);
+};
+
+
+// Redirects weak persistent handles to forwarding corpses to their targets.
+class ForwardHeapPointersHandleVisitor : public HandleVisitor {
+ public:
+  ForwardHeapPointersHandleVisitor();
+
+  virtual void VisitHandle(uword addr);
+
+  intptr_t count() const { return count_; }
+
+ private:
+  int count_;
+
+  DISALLOW_COPY_AND_ASSIGN(ForwardHeapPointersHandleVisitor);
+};
+
+
+// On IA32, object pointers are embedded directly in the instruction stream,
+// which is normally write-protected, so we need to make it temporarily writable
+// to forward the pointers. On all other architectures, object pointers are
+// accessed through ObjectPools.
+#if defined(TARGET_ARCH_IA32)
+class WritableCodeLiteralsScope : public ValueObject {
+ public:
+  explicit WritableCodeLiteralsScope(Heap* heap);
+  ~WritableCodeLiteralsScope();
+
+ private:
+  Heap* heap_;
+};
+#else
+class WritableCodeLiteralsScope : public ValueObject {
+ public:
+  explicit WritableCodeLiteralsScope(Heap* heap) { }
+  ~WritableCodeLiteralsScope() { }
+};
+#endif
+
+
 // TODO(johnmccutchan): Refactor this class so that it is not all static and
 // provides utility methods for building the mapping of before and after.
 class Become : public AllStatic {
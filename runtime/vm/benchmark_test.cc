@@ -12,15 +12,25 @@
 #include "platform/globals.h"
 
 #include "vm/clustered_snapshot.h"
+#include "vm/compiler.h"
 #include "vm/compiler_stats.h"
 #include "vm/dart_api_impl.h"
+#include "vm/dil.h"
+#include "vm/dispatch_table.h"
+#include "vm/growable_array.h"
+#include "vm/lockers.h"
+#include "vm/message_handler.h"
+#include "vm/port.h"
 #include "vm/stack_frame.h"
+#include "vm/thread_pool.h"
 #include "vm/unit_test.h"
 
 using dart::bin::File;
 
 namespace dart {
 
+DECLARE_FLAG(bool, loop_aware_allocation);
+
 Benchmark* Benchmark::first_ = NULL;
 Benchmark* Benchmark::tail_ = NULL;
 const char* Benchmark::executable_ = NULL;
@@ -198,6 +208,138 @@ BENCHMARK(Dart2JSCompilerStats) {
 }
 
 
+//
+// Measure the quality of register allocation in loops: the size of the
+// optimized code and the number of spilled live ranges for loops with high
+// register pressure, with and without loop aware live range splitting.
+//
+static const char* kLoopAllocationScriptChars =
+    "import 'dart:typed_data';\n"
+    "\n"
+    "int accumulators(List<int> a) {\n"
+    "  var s0 = 0, s1 = 0, s2 = 0, s3 = 0, s4 = 0, s5 = 0;\n"
+    "  var s6 = 0, s7 = 0, s8 = 0, s9 = 0, s10 = 0, s11 = 0;\n"
+    "  for (var i = 0; i < a.length; i++) {\n"
+    "    var x = a[i];\n"
+    "    s0 += x; s1 ^= x; s2 |= x; s3 &= x; s4 += x << 1; s5 -= x;\n"
+    "    s6 += x & 7; s7 += x >> 1; s8 ^= x << 2; s9 += x * 3;\n"
+    "    s10 -= x & 3; s11 |= x << 3;\n"
+    "  }\n"
+    "  return s0 + s1 + s2 + s3 + s4 + s5 + s6 + s7 + s8 + s9 + s10 + s11;\n"
+    "}\n"
+    "\n"
+    "int callInLoop(List<int> a, int x, int y, int z) {\n"
+    "  var p = x * y, q = y * z, r = x * z;\n"
+    "  var sum = 0;\n"
+    "  for (var i = 0; i < a.length; i++) {\n"
+    "    sum += a[i].toString().length;\n"
+    "  }\n"
+    "  return sum + p + q + r;\n"
+    "}\n"
+    "\n"
+    "double matrixMultiply(Float64List a, Float64List b, Float64List c,\n"
+    "                      int n) {\n"
+    "  for (var i = 0; i < n; i++) {\n"
+    "    for (var j = 0; j < n; j++) {\n"
+    "      var sum = 0.0;\n"
+    "      for (var k = 0; k < n; k++) {\n"
+    "        sum += a[i * n + k] * b[k * n + j];\n"
+    "      }\n"
+    "      c[i * n + j] = sum;\n"
+    "    }\n"
+    "  }\n"
+    "  return c[0];\n"
+    "}\n"
+    "\n"
+    "main() {\n"
+    "  var list = new List<int>.generate(100, (i) => i);\n"
+    "  var n = 8;\n"
+    "  var a = new Float64List(n * n);\n"
+    "  var b = new Float64List(n * n);\n"
+    "  var c = new Float64List(n * n);\n"
+    "  for (var i = 0; i < 10; i++) {\n"
+    "    accumulators(list);\n"
+    "    callInLoop(list, i, i + 1, i + 2);\n"
+    "    matrixMultiply(a, b, c, n);\n"
+    "  }\n"
+    "}\n";
+
+
+static void CompileLoopAllocationSuite(Thread* thread,
+                                       bool loop_aware,
+                                       int64_t* instr_size,
+                                       int64_t* spilled_ranges) {
+  const char* kFunctions[] = {
+    "accumulators",
+    "callInLoop",
+    "matrixMultiply",
+  };
+
+  // Warm up to collect type feedback for the optimizing compiler.
+  Dart_Handle lib = TestCase::LoadTestScript(kLoopAllocationScriptChars, NULL);
+  EXPECT_VALID(lib);
+  EXPECT_VALID(Dart_Invoke(lib, NewString("main"), 0, NULL));
+
+  TransitionNativeToVM transition(thread);
+  const Library& library =
+      Library::Handle(Library::RawCast(Api::UnwrapHandle(lib)));
+  const bool old_stats_flag = FLAG_compiler_stats;
+  const bool old_allocation_flag = FLAG_loop_aware_allocation;
+  FLAG_compiler_stats = true;
+  FLAG_loop_aware_allocation = loop_aware;
+  CompilerStats* stats = thread->compiler_stats();
+  ASSERT(stats != NULL);
+  stats->Clear();
+
+  Function& function = Function::Handle();
+  Error& error = Error::Handle();
+  for (size_t i = 0; i < ARRAY_SIZE(kFunctions); i++) {
+    function = library.LookupLocalFunction(
+        String::Handle(String::New(kFunctions[i])));
+    EXPECT(!function.IsNull());
+    error = Compiler::CompileOptimizedFunction(thread, function);
+    EXPECT(error.IsNull());
+  }
+
+  *instr_size = stats->total_instr_size;
+  *spilled_ranges = stats->num_spilled_ranges;
+  FLAG_loop_aware_allocation = old_allocation_flag;
+  FLAG_compiler_stats = old_stats_flag;
+}
+
+
+BENCHMARK_SIZE(LoopAllocationCodeSize) {
+  int64_t instr_size = 0;
+  int64_t spilled_ranges = 0;
+  CompileLoopAllocationSuite(thread, false, &instr_size, &spilled_ranges);
+  benchmark->set_score(instr_size);
+}
+
+
+BENCHMARK_SIZE(LoopAwareAllocationCodeSize) {
+  int64_t instr_size = 0;
+  int64_t spilled_ranges = 0;
+  CompileLoopAllocationSuite(thread, true, &instr_size, &spilled_ranges);
+  benchmark->set_score(instr_size);
+}
+
+
+BENCHMARK_SPILLS(LoopAllocationSpills) {
+  int64_t instr_size = 0;
+  int64_t spilled_ranges = 0;
+  CompileLoopAllocationSuite(thread, false, &instr_size, &spilled_ranges);
+  benchmark->set_score(spilled_ranges);
+}
+
+
+BENCHMARK_SPILLS(LoopAwareAllocationSpills) {
+  int64_t instr_size = 0;
+  int64_t spilled_ranges = 0;
+  CompileLoopAllocationSuite(thread, true, &instr_size, &spilled_ranges);
+  benchmark->set_score(spilled_ranges);
+}
+
+
 #endif  // !PRODUCT
 
 
@@ -328,6 +470,57 @@ BENCHMARK(UseDartApi) {
 }
 
 
+//
+// Measure time of megamorphic instance calls, dispatched through the
+// dispatch table.
+//
+BENCHMARK(MegamorphicCall) {
+  const int kNumIterations = 10000000;
+  const char* kScriptChars =
+      "class A0 { int foo() => 0; }\n"
+      "class A1 { int foo() => 1; }\n"
+      "class A2 { int foo() => 2; }\n"
+      "class A3 { int foo() => 3; }\n"
+      "class A4 { int foo() => 4; }\n"
+      "class A5 { int foo() => 5; }\n"
+      "class A6 { int foo() => 6; }\n"
+      "class A7 { int foo() => 7; }\n"
+      "class A8 extends A0 { int foo() => 8; }\n"
+      "class A9 extends A1 { }\n"
+      "\n"
+      "int benchmark(int count) {\n"
+      "  var receivers = [new A0(), new A1(), new A2(), new A3(), new A4(),\n"
+      "                   new A5(), new A6(), new A7(), new A8(), new A9()];\n"
+      "  int sum = 0;\n"
+      "  for (int i = 0; i < count; i++) {\n"
+      "    sum += receivers[i % receivers.length].foo();\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+
+  // Megamorphic caches take the dispatch table when they are created.
+  const bool old_flag = FLAG_use_dispatch_table;
+  FLAG_use_dispatch_table = true;
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib);
+
+  Dart_Handle args[1];
+  args[0] = Dart_NewInteger(kNumIterations);
+
+  // Warmup first to optimize the loop, which makes the call megamorphic.
+  EXPECT_VALID(Dart_Invoke(lib, NewString("benchmark"), 1, args));
+
+  Timer timer(true, "MegamorphicCall benchmark");
+  timer.Start();
+  Dart_Handle result = Dart_Invoke(lib, NewString("benchmark"), 1, args);
+  timer.Stop();
+  EXPECT_VALID(result);
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+  FLAG_use_dispatch_table = old_flag;
+}
+
+
 //
 // Measure time accessing internal and external strings.
 //
@@ -695,6 +888,102 @@ BENCHMARK(SimpleMessage) {
 }
 
 
+// A message handler which bounces a Smi counter back and forth with a
+// partner handler until the counter reaches a limit, then closes its port.
+class PingPongHandler : public MessageHandler {
+ public:
+  PingPongHandler(intptr_t rounds, Monitor* done_monitor, intptr_t* done)
+      : rounds_(rounds),
+        port_(ILLEGAL_PORT),
+        partner_(ILLEGAL_PORT),
+        done_monitor_(done_monitor),
+        done_(done) {
+    port_ = PortMap::CreatePort(this);
+    PortMap::SetPortState(port_, PortMap::kLivePort);
+  }
+
+  const char* name() const { return "PingPongHandler"; }
+
+  Dart_Port port() const { return port_; }
+  void set_partner(Dart_Port partner) { partner_ = partner; }
+
+  MessageStatus HandleMessage(Message* message) {
+    ASSERT(message->IsRaw());
+    const intptr_t count = Smi::Value(
+        reinterpret_cast<RawSmi*>(message->raw_obj()));
+    delete message;
+    if (count <= rounds_) {
+      PortMap::PostMessage(new Message(partner_,
+                                       Smi::New(count + 1),
+                                       Message::kNormalPriority));
+    }
+    if (count >= rounds_) {
+      PortMap::ClosePort(port_);
+    }
+    return kOK;
+  }
+
+  static void EndCallback(CallbackData data) {
+    PingPongHandler* handler = reinterpret_cast<PingPongHandler*>(data);
+    MonitorLocker ml(handler->done_monitor_);
+    (*handler->done_)++;
+    ml.Notify();
+  }
+
+ private:
+  const intptr_t rounds_;
+  Dart_Port port_;
+  Dart_Port partner_;
+  Monitor* done_monitor_;
+  intptr_t* done_;
+};
+
+
+//
+// Measure message passing between pairs of message handlers running
+// concurrently on a thread pool.
+//
+BENCHMARK(PingPongMessages) {
+  const intptr_t kNumPairs = 8;
+  const intptr_t kRounds = 20000;
+  ThreadPool pool;
+  Monitor done_monitor;
+  intptr_t done = 0;
+  PingPongHandler* handlers[2 * kNumPairs];
+  for (intptr_t i = 0; i < 2 * kNumPairs; i++) {
+    handlers[i] = new PingPongHandler(kRounds, &done_monitor, &done);
+  }
+  for (intptr_t i = 0; i < kNumPairs; i++) {
+    handlers[2 * i]->set_partner(handlers[2 * i + 1]->port());
+    handlers[2 * i + 1]->set_partner(handlers[2 * i]->port());
+  }
+  Timer timer(true, "Ping Pong Messages");
+  timer.Start();
+  for (intptr_t i = 0; i < 2 * kNumPairs; i++) {
+    handlers[i]->Run(&pool, NULL, PingPongHandler::EndCallback,
+                     reinterpret_cast<MessageHandler::CallbackData>(
+                         handlers[i]));
+  }
+  for (intptr_t i = 0; i < kNumPairs; i++) {
+    PortMap::PostMessage(new Message(handlers[2 * i]->port(),
+                                     Smi::New(0),
+                                     Message::kNormalPriority));
+  }
+  {
+    MonitorLocker ml(&done_monitor);
+    while (done < 2 * kNumPairs) {
+      ml.Wait();
+    }
+  }
+  timer.Stop();
+  for (intptr_t i = 0; i < 2 * kNumPairs; i++) {
+    delete handlers[i];
+  }
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  benchmark->set_score(elapsed_time);
+}
+
+
 BENCHMARK(LargeMap) {
   const char* kScript =
       "makeMap() {\n"
@@ -730,4 +1019,41 @@ BENCHMARK(LargeMap) {
   benchmark->set_score(elapsed_time);
 }
 
+
+//
+// Measure reading of a kernel (.dil) program into its in-memory AST.
+//
+static const intptr_t kDilProcedureCount = 10000;
+
+
+BENCHMARK(DilRead) {
+  DilBufferWriter writer;
+  WriteDilProgram(&writer, kDilProcedureCount);
+  const intptr_t kLoopCount = 20;
+  int64_t nodes = 0;
+  Timer timer(true, "Dil Read");
+  timer.Start();
+  for (intptr_t i = 0; i < kLoopCount; i++) {
+    dil::Program* program =
+        ReadPrecompiledDilFromBuffer(writer.buffer(), writer.length());
+    nodes += program->arena()->allocation_count();
+    delete program;
+  }
+  timer.Stop();
+  int64_t elapsed_time = timer.TotalElapsedTime();
+  // Nodes (and the lists and strings they hold) read per second.
+  benchmark->set_score(nodes * kMicrosecondsPerSecond /
+                       (elapsed_time > 0 ? elapsed_time : 1));
+}
+
+
+BENCHMARK_SIZE(DilReadAllocatedBytes) {
+  DilBufferWriter writer;
+  WriteDilProgram(&writer, kDilProcedureCount);
+  dil::Program* program =
+      ReadPrecompiledDilFromBuffer(writer.buffer(), writer.length());
+  benchmark->set_score(program->arena()->size_in_bytes());
+  delete program;
+}
+
 }  // namespace dart
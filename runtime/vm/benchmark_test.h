@@ -48,6 +48,7 @@ extern const uint8_t* isolate_snapshot_buffer;
 
 #define BENCHMARK(name) BENCHMARK_HELPER(name, "RunTime")
 #define BENCHMARK_SIZE(name) BENCHMARK_HELPER(name, "CodeSize")
+#define BENCHMARK_SPILLS(name) BENCHMARK_HELPER(name, "SpilledRanges")
 
 
 inline Dart_Handle NewString(const char* str) {
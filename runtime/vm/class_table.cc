@@ -412,11 +412,14 @@ void ClassTable::UpdateAllocatedNew(intptr_t cid, intptr_t size) {
 }
 
 
-void ClassTable::UpdateAllocatedOld(intptr_t cid, intptr_t size) {
+void ClassTable::UpdateAllocatedOld(intptr_t cid,
+                                    intptr_t size,
+                                    intptr_t count) {
   ClassHeapStats* stats = PreliminaryStatsAt(cid);
   ASSERT(stats != NULL);
   ASSERT(size != 0);
-  stats->recent.AddOld(size);
+  ASSERT(count > 0);
+  stats->recent.AddOld(size, count);
 }
 
 
@@ -594,11 +597,12 @@ void ClassTable::UpdateLiveOld(intptr_t cid, intptr_t size, intptr_t count) {
 }
 
 
-void ClassTable::UpdateLiveNew(intptr_t cid, intptr_t size) {
+void ClassTable::UpdateLiveNew(intptr_t cid, intptr_t size, intptr_t count) {
   ClassHeapStats* stats = PreliminaryStatsAt(cid);
   ASSERT(stats != NULL);
   ASSERT(size >= 0);
-  stats->post_gc.AddNew(size);
+  ASSERT(count >= 0);
+  stats->post_gc.AddNew(size, count);
 }
 #endif  // !PRODUCT
 
@@ -34,8 +34,8 @@ class AllocStats {
     new_size = 0;
   }
 
-  void AddNew(T size) {
-    new_count++;
+  void AddNew(T size, T count = 1) {
+    new_count += count;
     new_size += size;
   }
 
@@ -212,7 +212,7 @@ class ClassTable {
 #ifndef PRODUCT
   // Called whenever a class is allocated in the runtime.
   void UpdateAllocatedNew(intptr_t cid, intptr_t size);
-  void UpdateAllocatedOld(intptr_t cid, intptr_t size);
+  void UpdateAllocatedOld(intptr_t cid, intptr_t size, intptr_t count = 1);
 
   // Called whenever a old GC occurs.
   void ResetCountersOld();
@@ -272,7 +272,7 @@ class ClassTable {
   // May not have updated size for variable size classes.
   ClassHeapStats* PreliminaryStatsAt(intptr_t cid);
   void UpdateLiveOld(intptr_t cid, intptr_t size, intptr_t count = 1);
-  void UpdateLiveNew(intptr_t cid, intptr_t size);
+  void UpdateLiveNew(intptr_t cid, intptr_t size, intptr_t count = 1);
 #endif  // !PRODUCT
 
   DISALLOW_COPY_AND_ASSIGN(ClassTable);
@@ -631,6 +631,8 @@ class FunctionDeserializationCluster : public DeserializationCluster {
         func->ptr()->optimized_instruction_count_ = d->Read<uint16_t>();
         func->ptr()->optimized_call_site_count_ = d->Read<uint16_t>();
       }
+      // The kernel nodes of the snapshotting isolate are not serialized.
+      func->ptr()->dil_function_ = 0;
     }
   }
 
@@ -650,12 +652,25 @@ class FunctionDeserializationCluster : public DeserializationCluster {
     } else if (kind == Snapshot::kAppWithJIT) {
       Function& func = Function::Handle(zone);
       Code& code = Code::Handle(zone);
+      ObjectStore* object_store = Isolate::Current()->object_store();
+      GrowableObjectArray& optimized_functions = GrowableObjectArray::Handle(
+          zone, object_store->snapshot_optimized_functions());
       for (intptr_t i = start_index_; i < stop_index_; i++) {
         func ^= refs.At(i);
         code ^= func.unoptimized_code();
         if (!code.IsNull()) {
           func.SetInstructions(code);
           func.set_was_compiled(true);
+          // Only functions that had optimized code were written with a
+          // non-zero usage counter, see WriteFill.
+          if (func.usage_counter() > 0) {
+            if (optimized_functions.IsNull()) {
+              optimized_functions = GrowableObjectArray::New(Heap::kOld);
+              object_store->set_snapshot_optimized_functions(
+                  optimized_functions);
+            }
+            optimized_functions.Add(func, Heap::kOld);
+          }
         } else {
           func.ClearCode();
           func.set_was_compiled(false);
@@ -969,6 +984,7 @@ class FieldDeserializationCluster : public DeserializationCluster {
         field->ptr()->is_nullable_ = d->ReadCid();
       }
       field->ptr()->kind_bits_ = d->Read<uint8_t>();
+      field->ptr()->dil_field_ = 0;
     }
   }
 
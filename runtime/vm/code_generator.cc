@@ -12,6 +12,7 @@
 #include "vm/dart_entry.h"
 #include "vm/debugger.h"
 #include "vm/deopt_instructions.h"
+#include "vm/dispatch_table.h"
 #include "vm/exceptions.h"
 #include "vm/flags.h"
 #include "vm/object_store.h"
@@ -1344,6 +1345,10 @@ DEFINE_RUNTIME_ENTRY(MegamorphicCacheMissHandler, 3) {
     }
   } else {
     const MegamorphicCache& cache = MegamorphicCache::Cast(ic_data_or_cache);
+    if (cache.dispatch_offset() == DispatchTable::kUnbuiltOffset) {
+      cache.set_dispatch_offset(
+          DispatchTable::AddSelector(isolate, name, descriptor));
+    }
     // Insert function found into cache and return it.
     cache.EnsureCapacity();
     const Smi& class_id = Smi::Handle(zone, Smi::New(cls.id()));
@@ -31,6 +31,7 @@
 #include "vm/il_printer.h"
 #include "vm/jit_optimizer.h"
 #include "vm/longjump.h"
+#include "vm/loop_vectorizer.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/os.h"
@@ -49,6 +50,12 @@ namespace dart {
 
 DEFINE_FLAG(bool, allocation_sinking, true,
     "Attempt to sink temporary allocations to side exits");
+DEFINE_FLAG(bool, background_compile_callees, false,
+    "Compile the static callees of a newly compiled function in the "
+    "background, before they are first called.");
+DEFINE_FLAG(int, background_compiler_threads, 1,
+    "Number of tasks optimizing functions in the background for each "
+    "isolate.");
 DEFINE_FLAG(bool, common_subexpression_elimination, true,
     "Do common subexpression elimination.");
 DEFINE_FLAG(bool, constant_propagation, true,
@@ -58,6 +65,9 @@ DEFINE_FLAG(int, max_deoptimization_counter_threshold, 16,
 DEFINE_FLAG(bool, loop_invariant_code_motion, true,
     "Do loop invariant code motion.");
 DEFINE_FLAG(charp, optimization_filter, NULL, "Optimize only named function");
+DEFINE_FLAG(bool, optimize_snapshot_functions_eagerly, true,
+    "When loading an app JIT snapshot, queue the functions that were "
+    "optimized when it was created for background compilation right away.");
 DEFINE_FLAG(bool, print_flow_graph, false, "Print the IR flow graph.");
 DEFINE_FLAG(bool, print_flow_graph_optimized, false,
     "Print the IR flow graph when optimizing.");
@@ -80,6 +90,7 @@ DEFINE_FLAG(bool, verify_compiler, false,
     "Enable compiler verification assertions");
 
 DECLARE_FLAG(bool, huge_method_cutoff_in_code_size);
+DECLARE_FLAG(bool, loop_vectorization);
 DECLARE_FLAG(bool, trace_failed_optimization_attempts);
 DECLARE_FLAG(bool, trace_irregexp);
 
@@ -181,7 +192,11 @@ CompilationPipeline* CompilationPipeline::New(Zone* zone,
 //   Arg0: function object.
 DEFINE_RUNTIME_ENTRY(CompileFunction, 1) {
   const Function& function = Function::CheckedHandle(arguments.ArgAt(0));
-  ASSERT(!function.HasCode());
+  if (function.HasCode()) {
+    // Compiled in the background since it was called.
+    ASSERT(FLAG_background_compile_callees);
+    return;
+  }
   const Error& error =
       Error::Handle(Compiler::CompileFunction(thread, function));
   if (!error.IsNull()) {
@@ -253,6 +268,46 @@ bool Compiler::CanOptimizeFunction(Thread* thread, const Function& function) {
 }
 
 
+void Compiler::OptimizeSnapshotFunctions(Thread* thread) {
+  Isolate* isolate = thread->isolate();
+  Zone* zone = thread->zone();
+  ObjectStore* object_store = isolate->object_store();
+  const GrowableObjectArray& functions = GrowableObjectArray::Handle(zone,
+      object_store->snapshot_optimized_functions());
+  if (functions.IsNull()) {
+    return;
+  }
+  object_store->set_snapshot_optimized_functions(GrowableObjectArray::Handle());
+  if (!FLAG_optimize_snapshot_functions_eagerly ||
+      !FLAG_background_compilation ||
+      BackgroundCompiler::IsDisabled()) {
+    // The functions keep their usage counters from the snapshot and are
+    // optimized when they are next invoked.
+    return;
+  }
+  BackgroundCompiler::EnsureInit(thread);
+  ASSERT(isolate->background_compiler() != NULL);
+  Function& function = Function::Handle(zone);
+  for (intptr_t i = 0; i < functions.Length(); i++) {
+    function ^= functions.At(i);
+    if (!CanOptimizeFunction(thread, function)) {
+      continue;
+    }
+    if (FLAG_trace_compiler || FLAG_trace_optimizing_compiler) {
+      THR_Print("Queueing snapshot function for optimization: '%s'\n",
+                function.ToFullyQualifiedCString());
+    }
+    // As in OptimizeInvokedFunction, keep invocations from requesting
+    // optimization again while the function is queued. The compiled code is
+    // checked against the current class hierarchy and field guards, so
+    // feedback from the previous run that no longer holds only costs a
+    // deoptimization.
+    function.set_usage_counter(INT_MIN);
+    isolate->background_compiler()->CompileOptimized(function);
+  }
+}
+
+
 bool Compiler::IsBackgroundCompilation() {
   // For now: compilation in non mutator thread is the background compoilation.
   return !Thread::Current()->IsMutatorThread();
@@ -646,6 +701,17 @@ NOT_IN_PRODUCT(
         field.RegisterDependentCode(code);
       }
     }
+  } else if (Compiler::IsBackgroundCompilation() &&
+             (function.HasCode() ||
+              (FLAG_support_debugger &&
+               isolate()->debugger()->HasBreakpoint(function, zone)))) {
+    // Compiled ahead of its first call, but the mutator compiled it in the
+    // meantime, or it needs its breakpoints set by the mutator: drop the code.
+  } else if (FLAG_background_compile_callees &&
+             (function.unoptimized_code() != Object::null())) {
+    // Compiled on the mutator while the code compiled in the background was
+    // installed: keep the installed code and its IC data.
+    ASSERT(thread()->IsMutatorThread());
   } else {  // not optimized.
     if (function.ic_data_array() == Array::null()) {
       function.SaveICDataMap(
@@ -1011,6 +1077,15 @@ bool CompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
         }
 
+        if (FLAG_loop_vectorization) {
+          NOT_IN_PRODUCT(TimelineDurationScope tds2(thread(),
+                                                    compiler_timeline,
+                                                    "LoopVectorizer"));
+          // Needs the bounds checks eliminated by range analysis.
+          LoopVectorizer::Optimize(flow_graph);
+          DEBUG_ASSERT(flow_graph->VerifyUseLists());
+        }
+
         // Recompute types after code movement was done to ensure correct
         // reaching types for hoisted values.
         FlowGraphTypePropagator::Propagate(flow_graph);
@@ -1332,6 +1407,11 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
         // We got an error during compilation.
         error = thread->sticky_error();
         thread->clear_sticky_error();
+        if (Compiler::IsBackgroundCompilation()) {
+          // Compilation ahead of the first call: the mutator compiles the
+          // function again when it is called, and reports any error.
+          return Error::null();
+        }
         // The non-optimizing compiler should not bail out.
         ASSERT(error.IsLanguageError() &&
                LanguageError::Cast(error).kind() != Report::kBailout);
@@ -1349,7 +1429,9 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
                 per_compile_timer.TotalElapsedTime());
     }
 
-    if (FLAG_support_debugger) {
+    // Functions compiled ahead of their first call in the background have
+    // no breakpoints (see FinalizeCompilation).
+    if (FLAG_support_debugger && !Compiler::IsBackgroundCompilation()) {
       isolate->debugger()->NotifyCompilation(function);
     }
 
@@ -1384,6 +1466,11 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
     // Unoptimized compilation or precompilation may encounter compile-time
     // errors, but regular optimized compilation should not.
     ASSERT(!optimized);
+    if (Compiler::IsBackgroundCompilation()) {
+      // Compilation ahead of the first call: the mutator compiles the
+      // function again when it is called, and reports the error.
+      return Error::null();
+    }
     // Do not attempt to optimize functions that can cause errors.
     function.set_is_optimizable(false);
     return error.raw();
@@ -1393,6 +1480,42 @@ static RawError* CompileFunctionHelper(CompilationPipeline* pipeline,
 }
 
 
+// Queues the static callees of 'function' that have no code yet for
+// compilation in the background. Their targets are recorded in the IC data of
+// the unoptimized code.
+static void CompileCalleesInBackground(Thread* thread,
+                                       const Function& function) {
+  if (!FLAG_background_compilation || BackgroundCompiler::IsDisabled()) {
+    return;
+  }
+  Isolate* isolate = thread->isolate();
+  if (FLAG_support_debugger && isolate->debugger()->IsStepping()) {
+    return;
+  }
+  Zone* zone = thread->zone();
+  const Array& ic_data_array = Array::Handle(zone, function.ic_data_array());
+  if (ic_data_array.IsNull()) {
+    return;
+  }
+  ICData& ic_data = ICData::Handle(zone);
+  Function& target = Function::Handle(zone);
+  for (intptr_t i = 1; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    if (!ic_data.is_static_call() || (ic_data.NumberOfChecks() == 0)) {
+      continue;
+    }
+    target = ic_data.GetTargetAt(0);
+    // TODO(srdjan): Fix background compilation of regular expressions.
+    if (target.HasCode() || target.IsIrregexpFunction()) {
+      continue;
+    }
+    BackgroundCompiler::EnsureInit(thread);
+    ASSERT(isolate->background_compiler() != NULL);
+    isolate->background_compiler()->CompileUnoptimized(target);
+  }
+}
+
+
 RawError* Compiler::CompileFunction(Thread* thread,
                                     const Function& function) {
 #ifdef DART_PRECOMPILER
@@ -1416,10 +1539,17 @@ NOT_IN_PRODUCT(
   CompilationPipeline* pipeline =
       CompilationPipeline::New(thread->zone(), function);
 
-  return CompileFunctionHelper(pipeline,
-                               function,
-                               /* optimized = */ false,
-                               kNoOSRDeoptId);
+  const Error& error = Error::Handle(thread->zone(),
+      CompileFunctionHelper(pipeline,
+                            function,
+                            /* optimized = */ false,
+                            kNoOSRDeoptId));
+  if (FLAG_background_compile_callees &&
+      error.IsNull() &&
+      thread->IsMutatorThread()) {
+    CompileCalleesInBackground(thread, function);
+  }
+  return error.raw();
 }
 
 
@@ -1765,9 +1895,11 @@ NOT_IN_PRODUCT(
 // C-heap allocated background compilation queue element.
 class QueueElement {
  public:
-  explicit QueueElement(const Function& function)
+  QueueElement(const Function& function, bool optimized, intptr_t priority)
       : next_(NULL),
-        function_(function.raw()) {
+        function_(function.raw()),
+        optimized_(optimized),
+        priority_(priority) {
   }
 
   virtual ~QueueElement() {
@@ -1777,6 +1909,8 @@ class QueueElement {
 
   RawFunction* Function() const { return function_; }
 
+  bool optimized() const { return optimized_; }
+  intptr_t priority() const { return priority_; }
 
   void set_next(QueueElement* elem) { next_ = elem; }
   QueueElement* next() const { return next_; }
@@ -1789,43 +1923,48 @@ class QueueElement {
  private:
   QueueElement* next_;
   RawFunction* function_;
+  bool optimized_;
+  intptr_t priority_;
 
   DISALLOW_COPY_AND_ASSIGN(QueueElement);
 };
 
 
 // Allocated in C-heap. Handles both input and output of background compilation.
-// It implements a FIFO queue, using Peek, Add, Remove operations.
+// Pending elements are kept in decreasing order of priority, first in first
+// out for equal priorities. Elements taken by a compiler task stay in the
+// queue, in a separate list, until the task is done with them.
 class BackgroundCompilationQueue {
  public:
-  BackgroundCompilationQueue() : first_(NULL), last_(NULL) {}
+  BackgroundCompilationQueue() : first_(NULL), in_progress_(NULL) {}
   virtual ~BackgroundCompilationQueue() {
     Clear();
   }
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor) {
     ASSERT(visitor != NULL);
-    QueueElement* p = first_;
-    while (p != NULL) {
-      visitor->VisitPointer(p->function_ptr());
-      p = p->next();
-    }
+    VisitList(first_, visitor);
+    VisitList(in_progress_, visitor);
   }
 
+  // True if there is no pending element.
   bool IsEmpty() const { return first_ == NULL; }
 
   void Add(QueueElement* value) {
     ASSERT(value != NULL);
     ASSERT(value->next() == NULL);
-    if (first_ == NULL) {
+    if ((first_ == NULL) || (first_->priority() < value->priority())) {
+      value->set_next(first_);
       first_ = value;
-      ASSERT(last_ == NULL);
-    } else {
-      ASSERT(last_ != NULL);
-      last_->set_next(value);
+      return;
     }
-    last_ = value;
-    ASSERT(first_ != NULL && last_ != NULL);
+    QueueElement* p = first_;
+    while ((p->next() != NULL) &&
+           (p->next()->priority() >= value->priority())) {
+      p = p->next();
+    }
+    value->set_next(p->next());
+    p->set_next(value);
   }
 
   QueueElement* Peek() const {
@@ -1845,21 +1984,35 @@ class BackgroundCompilationQueue {
     ASSERT(first_ != NULL);
     QueueElement* result = first_;
     first_ = first_->next();
-    if (first_ == NULL) {
-      last_ = NULL;
-    }
+    result->set_next(NULL);
     return result;
   }
 
-  bool ContainsObj(const Object& obj) const {
-    QueueElement* p = first_;
-    while (p != NULL) {
-      if (p->function() == obj.raw()) {
-        return true;
+  // Moves the first pending element to the in progress list.
+  QueueElement* Take() {
+    QueueElement* result = Remove();
+    result->set_next(in_progress_);
+    in_progress_ = result;
+    return result;
+  }
+
+  // Removes an element returned by Take.
+  void Done(QueueElement* value) {
+    if (in_progress_ == value) {
+      in_progress_ = value->next();
+    } else {
+      QueueElement* p = in_progress_;
+      while (p->next() != value) {
+        p = p->next();
+        ASSERT(p != NULL);
       }
-      p = p->next();
+      p->set_next(value->next());
     }
-    return false;
+    value->set_next(NULL);
+  }
+
+  bool ContainsObj(const Object& obj) const {
+    return ListContains(first_, obj) || ListContains(in_progress_, obj);
   }
 
   void Clear() {
@@ -1867,36 +2020,98 @@ class BackgroundCompilationQueue {
       QueueElement* e = Remove();
       delete e;
     }
-    ASSERT((first_ == NULL) && (last_ == NULL));
+    while (in_progress_ != NULL) {
+      QueueElement* e = in_progress_;
+      in_progress_ = e->next();
+      delete e;
+    }
+    ASSERT((first_ == NULL) && (in_progress_ == NULL));
   }
 
  private:
+  static void VisitList(QueueElement* p, ObjectPointerVisitor* visitor) {
+    while (p != NULL) {
+      visitor->VisitPointer(p->function_ptr());
+      p = p->next();
+    }
+  }
+
+  static bool ListContains(QueueElement* p, const Object& obj) {
+    while (p != NULL) {
+      if (p->function() == obj.raw()) {
+        return true;
+      }
+      p = p->next();
+    }
+    return false;
+  }
+
   QueueElement* first_;
-  QueueElement* last_;
+  QueueElement* in_progress_;
 
   DISALLOW_COPY_AND_ASSIGN(BackgroundCompilationQueue);
 };
 
 
-BackgroundCompiler::BackgroundCompiler(Isolate* isolate)
-    : isolate_(isolate), running_(true), done_(new bool()),
+class BackgroundCompilerTask : public ThreadPool::Task {
+ public:
+  explicit BackgroundCompilerTask(BackgroundCompiler* compiler)
+      : compiler_(compiler) { }
+
+  virtual void Run() {
+    compiler_->Run();
+  }
+
+ private:
+  BackgroundCompiler* compiler_;
+
+  DISALLOW_COPY_AND_ASSIGN(BackgroundCompilerTask);
+};
+
+
+BackgroundCompiler::BackgroundCompiler(Isolate* isolate, intptr_t num_workers)
+    : isolate_(isolate), running_(true), running_workers_(num_workers),
       queue_monitor_(new Monitor()), done_monitor_(new Monitor()),
       function_queue_(new BackgroundCompilationQueue()) {
-  *done_ = false;
 }
 
 
-// Fields all deleted in ::Stop; here clear them.
 BackgroundCompiler::~BackgroundCompiler() {
+  delete function_queue_;
+  delete done_monitor_;
+  delete queue_monitor_;
   isolate_ = NULL;
   running_ = false;
-  done_ = NULL;
   queue_monitor_ = NULL;
   done_monitor_ = NULL;
   function_queue_ = NULL;
 }
 
 
+// The number of calls made from the unoptimized code of 'function' and of
+// the iterations of its loops.
+static intptr_t FunctionHotness(Zone* zone, const Function& function) {
+  const Array& ic_data_array = Array::Handle(zone, function.ic_data_array());
+  if (ic_data_array.IsNull()) {
+    return 0;
+  }
+  intptr_t hotness = 0;
+  const Array& edge_counters = Array::Handle(zone,
+      Array::RawCast(ic_data_array.At(0)));
+  if (!edge_counters.IsNull()) {
+    for (intptr_t i = 0; i < edge_counters.Length(); i++) {
+      hotness += Smi::Value(Smi::RawCast(edge_counters.At(i)));
+    }
+  }
+  ICData& ic_data = ICData::Handle(zone);
+  for (intptr_t i = 1; i < ic_data_array.Length(); i++) {
+    ic_data ^= ic_data_array.At(i);
+    hotness += ic_data.AggregateCount();
+  }
+  return hotness;
+}
+
+
 void BackgroundCompiler::Run() {
   while (running_) {
     // Maybe something is already in the queue, check first before waiting
@@ -1909,47 +2124,66 @@ void BackgroundCompiler::Run() {
       Zone* zone = stack_zone.GetZone();
       HANDLESCOPE(thread);
       Function& function = Function::Handle(zone);
+      QueueElement* qelem = NULL;
       { MonitorLocker ml(queue_monitor_);
-        function = function_queue()->PeekFunction();
+        if (running_ && !function_queue()->IsEmpty() &&
+            !isolate_->IsTopLevelParsing()) {
+          qelem = function_queue()->Take();
+        }
       }
-      while (running_ && !function.IsNull() && !isolate_->IsTopLevelParsing()) {
+      while (qelem != NULL) {
+        function = qelem->Function();
         // Check that we have aggregated and cleared the stats.
         ASSERT(thread->compiler_stats()->IsCleared());
-        const Error& error = Error::Handle(zone,
-            Compiler::CompileOptimizedFunction(thread,
-                                               function,
-                                               Compiler::kNoOSRDeoptId));
-        // TODO(srdjan): We do not expect errors while compiling optimized
-        // code, any errors should have been caught when compiling
-        // unoptimized code. Any issues while optimizing are flagged by
-        // making the result invalid.
-        ASSERT(error.IsNull());
-#ifndef PRODUCT
-        Isolate* isolate = thread->isolate();
-        isolate->aggregate_compiler_stats()->Add(*thread->compiler_stats());
-        thread->compiler_stats()->Clear();
-#endif  // PRODUCT
+        if (qelem->optimized()) {
+          const Error& error = Error::Handle(zone,
+              Compiler::CompileOptimizedFunction(thread,
+                                                 function,
+                                                 Compiler::kNoOSRDeoptId));
+          // TODO(srdjan): We do not expect errors while compiling optimized
+          // code, any errors should have been caught when compiling
+          // unoptimized code. Any issues while optimizing are flagged by
+          // making the result invalid.
+          ASSERT(error.IsNull());
+        } else if (!function.HasCode()) {
+          // Errors are reported when the mutator compiles the function.
+          const Error& error = Error::Handle(zone,
+              Compiler::CompileFunction(thread, function));
+          ASSERT(error.IsNull());
+        }
 
-        QueueElement* qelem = NULL;
+        QueueElement* done_qelem = NULL;
         { MonitorLocker ml(queue_monitor_);
-          if (function_queue()->IsEmpty()) {
+#ifndef PRODUCT
+          // The other compiler tasks aggregate their stats as well.
+          Isolate* isolate = thread->isolate();
+          isolate->aggregate_compiler_stats()->Add(*thread->compiler_stats());
+          thread->compiler_stats()->Clear();
+#endif  // PRODUCT
+          if (!running_) {
             // We are shutting down, queue was cleared.
-            function = Function::null();
+            qelem = NULL;
           } else {
-            qelem = function_queue()->Remove();
-            const Function& old = Function::Handle(qelem->Function());
-            if ((!old.HasOptimizedCode() && old.IsOptimizable()) ||
-                 FLAG_stress_test_background_compilation) {
-              if (Compiler::CanOptimizeFunction(thread, old)) {
-                QueueElement* repeat_qelem = new QueueElement(old);
+            function_queue()->Done(qelem);
+            if (qelem->optimized() &&
+                ((!function.HasOptimizedCode() && function.IsOptimizable()) ||
+                 FLAG_stress_test_background_compilation)) {
+              if (Compiler::CanOptimizeFunction(thread, function)) {
+                QueueElement* repeat_qelem =
+                    new QueueElement(function, true, qelem->priority());
                 function_queue()->Add(repeat_qelem);
               }
             }
-            function = function_queue()->PeekFunction();
+            done_qelem = qelem;
+            qelem = NULL;
+            if (!function_queue()->IsEmpty() &&
+                !isolate_->IsTopLevelParsing()) {
+              qelem = function_queue()->Take();
+            }
           }
         }
-        if (qelem != NULL) {
-          delete qelem;
+        if (done_qelem != NULL) {
+          delete done_qelem;
         }
       }
     }
@@ -1965,9 +2199,9 @@ void BackgroundCompiler::Run() {
   }  // while running
 
   {
-    // Notify that the thread is done.
+    // Notify that the task is done.
     MonitorLocker ml_done(done_monitor_);
-    *done_ = true;
+    running_workers_--;
     ml_done.Notify();
   }
 }
@@ -1980,19 +2214,38 @@ void BackgroundCompiler::CompileOptimized(const Function& function) {
   if (isolate_->heap()->NeedsGarbageCollection()) {
     isolate_->heap()->CollectAllGarbage();
   }
+  const intptr_t priority =
+      FunctionHotness(Thread::Current()->zone(), function);
   {
     MonitorLocker ml(queue_monitor_);
     ASSERT(running_);
     if (function_queue()->ContainsObj(function)) {
       return;
     }
-    QueueElement* elem = new QueueElement(function);
+    QueueElement* elem = new QueueElement(function, true, priority);
     function_queue()->Add(elem);
     ml.Notify();
   }
 }
 
 
+void BackgroundCompiler::CompileUnoptimized(const Function& function) {
+  ASSERT(Thread::Current()->IsMutatorThread());
+  // Only the mutator may read a kernel body which has not been read yet.
+  // Bodies of callees inlined in the background are still aborted on.
+  dil::ReadLazyBody(function);
+  MonitorLocker ml(queue_monitor_);
+  ASSERT(running_);
+  if (function_queue()->ContainsObj(function)) {
+    return;
+  }
+  // Ahead of any optimization: the function is about to be called.
+  QueueElement* elem = new QueueElement(function, false, kIntptrMax);
+  function_queue()->Add(elem);
+  ml.Notify();
+}
+
+
 void BackgroundCompiler::VisitPointers(ObjectPointerVisitor* visitor) {
   function_queue_->VisitObjectPointers(visitor);
 }
@@ -2004,31 +2257,21 @@ void BackgroundCompiler::Stop(Isolate* isolate) {
     // Nothing to stop.
     return;
   }
-  BackgroundCompilationQueue* function_queue = task->function_queue();
-
-  Monitor* queue_monitor = task->queue_monitor_;
-  Monitor* done_monitor = task->done_monitor_;
-  bool* task_done = task->done_;
-  // Wake up compiler task and stop it.
+  // Wake up compiler tasks and stop them.
   {
-    MonitorLocker ml(queue_monitor);
+    MonitorLocker ml(task->queue_monitor_);
     task->running_ = false;
-    function_queue->Clear();
-    // 'task' will be deleted by thread pool.
-    task = NULL;
-    ml.Notify();   // Stop waiting for the queue.
+    task->function_queue()->Clear();
+    ml.NotifyAll();   // Stop waiting for the queue.
   }
 
   {
-    MonitorLocker ml_done(done_monitor);
-    while (!(*task_done)) {
+    MonitorLocker ml_done(task->done_monitor_);
+    while (task->running_workers_ > 0) {
       ml_done.WaitWithSafepointCheck(Thread::Current());
     }
   }
-  delete task_done;
-  delete done_monitor;
-  delete queue_monitor;
-  delete function_queue;
+  delete task;
   isolate->set_background_compiler(NULL);
 }
 
@@ -2083,18 +2326,24 @@ void BackgroundCompiler::EnsureInit(Thread* thread) {
   error = cls.EnsureIsFinalized(thread);
   ASSERT(error.IsNull());
 
-  bool start_task = false;
+  const intptr_t num_workers =
+      Utils::Maximum(FLAG_background_compiler_threads, 1);
+  bool start_tasks = false;
   Isolate* isolate = thread->isolate();
   {
     MutexLocker ml(isolate->mutex());
     if (isolate->background_compiler() == NULL) {
-      BackgroundCompiler* task = new BackgroundCompiler(isolate);
-      isolate->set_background_compiler(task);
-      start_task = true;
+      BackgroundCompiler* compiler = new BackgroundCompiler(isolate,
+                                                            num_workers);
+      isolate->set_background_compiler(compiler);
+      start_tasks = true;
     }
   }
-  if (start_task) {
-    Dart::thread_pool()->Run(isolate->background_compiler());
+  if (start_tasks) {
+    for (intptr_t i = 0; i < num_workers; i++) {
+      Dart::thread_pool()->Run(
+          new BackgroundCompilerTask(isolate->background_compiler()));
+    }
   }
 }
 
@@ -2135,6 +2384,11 @@ bool Compiler::CanOptimizeFunction(Thread* thread, const Function& function) {
 }
 
 
+void Compiler::OptimizeSnapshotFunctions(Thread* thread) {
+  UNREACHABLE();
+}
+
+
 RawError* Compiler::Compile(const Library& library, const Script& script) {
   UNREACHABLE();
   return Error::null();
@@ -2211,6 +2465,11 @@ void BackgroundCompiler::CompileOptimized(const Function& function) {
 }
 
 
+void BackgroundCompiler::CompileUnoptimized(const Function& function) {
+  UNREACHABLE();
+}
+
+
 void BackgroundCompiler::VisitPointers(ObjectPointerVisitor* visitor) {
   UNREACHABLE();
 }
@@ -85,6 +85,11 @@ class Compiler : public AllStatic {
   // The result for a function may change if debugging gets turned on/off.
   static bool CanOptimizeFunction(Thread* thread, const Function& function);
 
+  // Queues the functions that had optimized code when the app JIT snapshot
+  // the current isolate was loaded from was created for background
+  // optimization, using the IC data restored from the snapshot.
+  static void OptimizeSnapshotFunctions(Thread* thread);
+
   // Extracts top level entities from the script and populates
   // the class dictionary of the library.
   //
@@ -153,13 +158,16 @@ class Compiler : public AllStatic {
 };
 
 
-// Class to run optimizing compilation in a background thread.
-// Current implementation: one task per isolate, it dies with the owning
-// isolate.
+// Class to run optimizing compilation in background threads, and unoptimized
+// compilation of the callees of newly compiled functions
+// (FLAG_background_compile_callees).
+// Current implementation: FLAG_background_compiler_threads tasks per isolate
+// share one queue, ordered by the hotness of the functions at the time they
+// were queued. The compiler dies with the owning isolate.
 // No OSR compilation in the background compiler.
-class BackgroundCompiler : public ThreadPool::Task {
+class BackgroundCompiler {
  public:
-  virtual ~BackgroundCompiler();
+  ~BackgroundCompiler();
 
   static void EnsureInit(Thread* thread);
 
@@ -177,21 +185,29 @@ class BackgroundCompiler : public ThreadPool::Task {
   // compilation queue.
   void CompileOptimized(const Function& function);
 
+  // Call to compile a function that has no code yet in the background, ahead
+  // of its first call. The code is only installed if the function was not
+  // compiled by the mutator in the meantime.
+  void CompileUnoptimized(const Function& function);
+
   void VisitPointers(ObjectPointerVisitor* visitor);
 
   BackgroundCompilationQueue* function_queue() const { return function_queue_; }
   bool is_running() const { return running_; }
 
  private:
-  explicit BackgroundCompiler(Isolate* isolate);
+  friend class BackgroundCompilerTask;
+
+  BackgroundCompiler(Isolate* isolate, intptr_t num_workers);
 
-  virtual void Run();
+  // Body of each of the compiler tasks.
+  void Run();
 
   Isolate* isolate_;
   bool running_;       // While true, will try to read queue and compile.
-  bool* done_;         // True if the thread is done.
+  intptr_t running_workers_;  // Number of tasks that are not done yet.
   Monitor* queue_monitor_;  // Controls access to the queue.
-  Monitor* done_monitor_;   // Notify/wait that the thread is done.
+  Monitor* done_monitor_;   // Notify/wait that the tasks are done.
 
   BackgroundCompilationQueue* function_queue_;
 
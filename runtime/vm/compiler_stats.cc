@@ -196,6 +196,8 @@ char* CompilerStats::BenchmarkOutput() {
 
   log.Print("CodeDensity: %" Pd64 " tokens/KB\n", code_density);
   log.Print("InstrSize: %" Pd64 " KB\n", total_instr_size / 1024);
+  log.Print("NumSpilledRanges: %" Pd64 "\n", num_spilled_ranges);
+  log.Print("NumSpillSlots: %" Pd64 "\n", num_spill_slots);
   log.Flush();
   char* benchmark_text = text;
   text = NULL;
@@ -296,6 +298,8 @@ char* CompilerStats::PrintToZone() {
   log.Print("Functions parsed:        %" Pd64 "\n", num_functions_parsed);
   log.Print("Functions compiled:      %" Pd64 "\n", num_functions_compiled);
   log.Print("  optimized:             %" Pd64 "\n", num_functions_optimized);
+  log.Print("Spilled live ranges:     %" Pd64 "\n", num_spilled_ranges);
+  log.Print("  Spill slots:           %" Pd64 "\n", num_spill_slots);
   log.Print("Compiler time:           %" Pd64 " ms\n", compile_usecs / 1000);
   log.Print("Tokens compiled:         %" Pd64 "\n", num_func_tokens_compiled);
   log.Print("Compilation speed:       %" Pd64 " tokens/ms\n", compile_speed);
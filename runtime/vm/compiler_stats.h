@@ -49,6 +49,8 @@ DECLARE_FLAG(bool, compiler_benchmark);
   V(num_func_tokens_compiled)                                                  \
   V(num_implicit_final_getters)                                                \
   V(num_method_extractors)                                                     \
+  V(num_spilled_ranges)                                                        \
+  V(num_spill_slots)                                                           \
   V(src_length)                                                                \
   V(total_code_size)                                                           \
   V(total_instr_size)                                                          \
@@ -94,6 +96,8 @@ class CompilerStats {
   int64_t num_func_tokens_compiled;
   int64_t num_implicit_final_getters;
   int64_t num_method_extractors;
+  int64_t num_spilled_ranges;        // Live ranges assigned to spill slots.
+  int64_t num_spill_slots;           // Spill slots allocated.
 
   int64_t src_length;          // Total number of characters in source.
   int64_t total_code_size;     // Bytes allocated for code and meta info.
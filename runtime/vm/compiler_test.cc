@@ -15,6 +15,9 @@
 
 namespace dart {
 
+DECLARE_FLAG(bool, background_compile_callees);
+DECLARE_FLAG(int, background_compiler_threads);
+
 VM_TEST_CASE(CompileScript) {
   const char* kScriptChars =
       "class A {\n"
@@ -113,6 +116,119 @@ VM_TEST_CASE(CompileFunctionOnHelperThread) {
 }
 
 
+VM_TEST_CASE(CompileFunctionsOnHelperThreads) {
+  // Create a few functions and optimize them with several compiler tasks.
+  const char* kScriptChars =
+            "class A {\n"
+            "  static foo0() { return 42; }\n"
+            "  static foo1() { return 43; }\n"
+            "  static foo2() { return 44; }\n"
+            "  static foo3() { return 45; }\n"
+            "}\n";
+  String& url = String::Handle(
+      String::New("dart-test:CompileFunctionsOnHelperThreads"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url,
+                                              source,
+                                              RawScript::kScriptTag));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::ProcessPendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(Symbols::New(thread, "A"))));
+  EXPECT(!cls.IsNull());
+  const intptr_t kNumFunctions = 4;
+  const char* kFunctionNames[kNumFunctions] = {
+    "foo0", "foo1", "foo2", "foo3"
+  };
+  GrowableArray<const Function*> functions;
+  for (intptr_t i = 0; i < kNumFunctions; i++) {
+    const Function& func = Function::ZoneHandle(cls.LookupStaticFunction(
+        String::Handle(String::New(kFunctionNames[i]))));
+    EXPECT(!func.IsNull());
+    CompilerTest::TestCompileFunction(func);
+    EXPECT(func.HasCode());
+    EXPECT(!func.HasOptimizedCode());
+    functions.Add(&func);
+  }
+#if !defined(PRODUCT)
+  // Constant in product mode.
+  FLAG_background_compilation = true;
+#endif
+  const intptr_t old_threads = FLAG_background_compiler_threads;
+  FLAG_background_compiler_threads = 2;
+  BackgroundCompiler::EnsureInit(thread);
+  FLAG_background_compiler_threads = old_threads;
+  Isolate* isolate = thread->isolate();
+  ASSERT(isolate->background_compiler() != NULL);
+  for (intptr_t i = 0; i < kNumFunctions; i++) {
+    isolate->background_compiler()->CompileOptimized(*functions[i]);
+  }
+  Monitor* m = new Monitor();
+  {
+    MonitorLocker ml(m);
+    for (intptr_t i = 0; i < kNumFunctions; i++) {
+      while (!functions[i]->HasOptimizedCode()) {
+        ml.WaitWithSafepointCheck(thread, 1);
+      }
+    }
+  }
+  delete m;
+  BackgroundCompiler::Stop(isolate);
+}
+
+
+VM_TEST_CASE(CompileCalleesOnHelperThread) {
+  // Compile a function and wait for its static callee to be compiled ahead of
+  // its first call.
+  const char* kScriptChars =
+            "class A {\n"
+            "  static foo() { return bar(); }\n"
+            "  static bar() { return 42; }\n"
+            "}\n";
+  String& url = String::Handle(
+      String::New("dart-test:CompileCalleesOnHelperThread"));
+  String& source = String::Handle(String::New(kScriptChars));
+  Script& script = Script::Handle(Script::New(url,
+                                              source,
+                                              RawScript::kScriptTag));
+  Library& lib = Library::Handle(Library::CoreLibrary());
+  EXPECT(CompilerTest::TestCompileScript(lib, script));
+  EXPECT(ClassFinalizer::ProcessPendingClasses());
+  Class& cls = Class::Handle(
+      lib.LookupClass(String::Handle(Symbols::New(thread, "A"))));
+  EXPECT(!cls.IsNull());
+  Function& foo = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New("foo"))));
+  Function& bar = Function::Handle(
+      cls.LookupStaticFunction(String::Handle(String::New("bar"))));
+  EXPECT(!foo.IsNull());
+  EXPECT(!bar.IsNull());
+#if !defined(PRODUCT)
+  // Constant in product mode.
+  FLAG_background_compilation = true;
+#endif
+  const bool old_flag = FLAG_background_compile_callees;
+  FLAG_background_compile_callees = true;
+  EXPECT(Compiler::CompileFunction(thread, foo) == Error::null());
+  EXPECT(foo.HasCode());
+  Isolate* isolate = thread->isolate();
+  if (FLAG_background_compilation) {
+    ASSERT(isolate->background_compiler() != NULL);
+    Monitor* m = new Monitor();
+    {
+      MonitorLocker ml(m);
+      while (!bar.HasCode()) {
+        ml.WaitWithSafepointCheck(thread, 1);
+      }
+    }
+    delete m;
+    BackgroundCompiler::Stop(isolate);
+  }
+  FLAG_background_compile_callees = old_flag;
+}
+
+
 TEST_CASE(RegenerateAllocStubs) {
   const char* kScriptChars =
             "class A {\n"
@@ -7,6 +7,7 @@
 #include "vm/become.h"
 #include "vm/clustered_snapshot.h"
 #include "vm/code_observers.h"
+#include "vm/compiler.h"
 #include "vm/cpu.h"
 #include "vm/dart_api_state.h"
 #include "vm/dart_entry.h"
@@ -624,6 +625,12 @@ RawError* Dart::InitializeIsolate(const uint8_t* snapshot_buffer,
     I->set_deoptimized_code_array(
         GrowableObjectArray::Handle(GrowableObjectArray::New()));
   }
+#if !defined(DART_PRECOMPILED_RUNTIME)
+  if ((snapshot_kind_ == Snapshot::kAppWithJIT) &&
+      !ServiceIsolate::IsServiceIsolate(I)) {
+    Compiler::OptimizeSnapshotFunctions(T);
+  }
+#endif
   return Error::null();
 }
 
@@ -645,6 +652,10 @@ const char* Dart::FeaturesString(Snapshot::Kind kind) {
     buffer.AddString(FLAG_enable_asserts ? " asserts" : " no-asserts");
     buffer.AddString(FLAG_enable_type_checks ? " type-checks"
                                              : " no-type-checks");
+    // Stores in code compiled without concurrent marking have no marking
+    // barrier, so the marker would miss them.
+    buffer.AddString(FLAG_concurrent_mark ? " concurrent-mark"
+                                          : " no-concurrent-mark");
 
     // Generated code must match the host architecture and ABI.
 #if defined(TARGET_ARCH_ARM)
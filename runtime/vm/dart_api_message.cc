@@ -707,6 +707,20 @@ Dart_CObject* ApiMessageReader::ReadInternalVMObject(intptr_t class_id,
       AddBackRef(object_id, object, kIsDeserialized);
       return object;
     }
+    case kTransferableTypedDataCid: {
+      // Native ports see a plain Uint8 list; the transferred bytes are
+      // owned by this message and freed once copied.
+      uint8_t* data = reinterpret_cast<uint8_t*>(ReadRawPointerValue());
+      intptr_t len = Read<int64_t>();
+      Dart_CObject* object =
+          AllocateDartCObjectTypedData(Dart_TypedData_kUint8, len);
+      AddBackRef(object_id, object, kIsDeserialized);
+      if (len > 0) {
+        memmove(object->value.as_typed_data.values, data, len);
+      }
+      free(data);
+      return object;
+    }
 
 #define READ_TYPED_DATA_HEADER(type)                                           \
       intptr_t len = ReadSmiValue();                                           \
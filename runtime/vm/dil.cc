@@ -4,10 +4,101 @@
 
 #include "vm/dil.h"
 
+#include "platform/utils.h"
+
 namespace dart {
 
 namespace dil {
 
+class Arena::Segment {
+ public:
+  Segment* next;
+  intptr_t size;
+
+  uword start() {
+    return Utils::RoundUp(reinterpret_cast<uword>(this + 1), kAlignment);
+  }
+
+  static Segment* New(intptr_t size, Segment* next) {
+    intptr_t total = size + sizeof(Segment) + kAlignment;
+    Segment* segment = reinterpret_cast<Segment*>(malloc(total));
+    if (segment == NULL) {
+      FATAL("Out of memory.\n");
+    }
+    segment->next = next;
+    segment->size = size;
+    return segment;
+  }
+
+  // Prepends the chain starting at [other] to [chain].
+  static void AppendChain(Segment** chain, Segment* other) {
+    if (other == NULL) return;
+    Segment* last = other;
+    while (last->next != NULL) last = last->next;
+    last->next = *chain;
+    *chain = other;
+  }
+
+  static void DeleteChain(Segment* segment) {
+    while (segment != NULL) {
+      Segment* next = segment->next;
+      free(segment);
+      segment = next;
+    }
+  }
+};
+
+Arena::Arena()
+    : head_(NULL),
+      large_head_(NULL),
+      position_(0),
+      limit_(0),
+      size_in_bytes_(0),
+      allocation_count_(0) {}
+
+Arena::~Arena() {
+  Segment::DeleteChain(head_);
+  Segment::DeleteChain(large_head_);
+}
+
+void* Arena::Allocate(intptr_t size) {
+  ASSERT(size >= 0);
+  size = Utils::RoundUp(size, kAlignment);
+  size_in_bytes_ += size;
+  allocation_count_++;
+
+  if (size > static_cast<intptr_t>(limit_ - position_)) {
+    if (size > kSegmentSize / 4) {
+      return AllocateLarge(size);
+    }
+    head_ = Segment::New(kSegmentSize, head_);
+    position_ = head_->start();
+    limit_ = position_ + kSegmentSize;
+  }
+  void* result = reinterpret_cast<void*>(position_);
+  position_ += size;
+  return result;
+}
+
+void* Arena::AllocateLarge(intptr_t size) {
+  // Large allocations get a segment of their own so they do not waste the
+  // remainder of the current one.
+  large_head_ = Segment::New(size, large_head_);
+  return reinterpret_cast<void*>(large_head_->start());
+}
+
+void Arena::Adopt(Arena* other) {
+  // Keep allocating from our own current segment; the other arena's
+  // segments are only kept alive.
+  Segment::AppendChain(&large_head_, other->head_);
+  Segment::AppendChain(&large_head_, other->large_head_);
+  size_in_bytes_ += other->size_in_bytes_;
+  allocation_count_ += other->allocation_count_;
+  other->head_ = other->large_head_ = NULL;
+  other->position_ = other->limit_ = 0;
+  other->size_in_bytes_ = other->allocation_count_ = 0;
+}
+
 template<typename T>
 void VisitList(List<T>& list, Visitor* visitor) {
   for (int i = 0; i < list.length(); ++i) {
@@ -750,7 +841,12 @@ void TypeParameter::VisitChildren(Visitor* visitor) {
   bound()->AcceptDartTypeVisitor(visitor);
 }
 
-Program::~Program() {}
+Program::~Program() {
+  if ((buffer_release_ != NULL) && (buffer_ != NULL)) {
+    buffer_release_(buffer_, buffer_length_);
+  }
+  delete arena_;
+}
 void Program::AcceptTreeVisitor(TreeVisitor* visitor) {
   visitor->VisitProgram(this);
 }
@@ -132,15 +132,74 @@ class TreeNode;
 class TypeParameter;
 class Writer;
 
-// Boxes a value of type `T*` and `delete`s it on destruction.
+// A bump allocator holding all nodes of a [Program].  Reading a program
+// makes many thousands of small allocations which all die together, so
+// instead of allocating and freeing them one by one we carve them out of
+// large segments and release all of them at once when the arena is deleted.
+//
+// An arena is not thread safe.
+class Arena {
+ public:
+  Arena();
+  ~Arena();
+
+  void* Allocate(intptr_t size);
+
+  template<typename T>
+  T* Alloc(intptr_t length) {
+    return reinterpret_cast<T*>(Allocate(length * sizeof(T)));
+  }
+
+  // Takes over all memory of [other], which is left empty.
+  void Adopt(Arena* other);
+
+  // The number of bytes handed out, and the number of allocations.
+  intptr_t size_in_bytes() const { return size_in_bytes_; }
+  intptr_t allocation_count() const { return allocation_count_; }
+
+ private:
+  class Segment;
+
+  static const intptr_t kSegmentSize = 64 * KB;
+  static const intptr_t kAlignment = 8;
+
+  void* AllocateLarge(intptr_t size);
+
+  Segment* head_;
+  Segment* large_head_;
+  uword position_;
+  uword limit_;
+  intptr_t size_in_bytes_;
+  intptr_t allocation_count_;
+
+  DISALLOW_COPY_AND_ASSIGN(Arena);
+};
+
+// Base class for everything that lives in an [Arena].  Such objects are
+// never deleted individually (and their destructors are never run), the
+// arena releases their memory all at once.
+class ArenaAllocated {
+ public:
+  ArenaAllocated() {}
+
+  void* operator new(size_t size, Arena* arena) {
+    return arena->Allocate(size);
+  }
+
+  // Only called if a constructor throws; the arena owns the memory.
+  void operator delete(void* pointer, Arena* arena) {}
+
+  // Arena allocated objects must not be deleted.
+  void operator delete(void* pointer) { UNREACHABLE(); }
+};
+
+// Boxes a value of type `T*` which is owned by the parent node.
 template<typename T>
 class Child {
  public:
   Child() : pointer_(NULL) {}
   explicit Child(T* value) : pointer_(value) {}
 
-  ~Child() { delete pointer_; }
-
   // Support `Child<T> box = T* obj`.
   T*& operator=(T* value) {
     ASSERT(pointer_ == NULL);
@@ -182,7 +241,6 @@ template<typename T>
 class List {
  public:
   List() : array_(NULL), length_(0) { }
-  ~List();
 
   template<typename IT>
   void ReadFrom(Reader* reader);
@@ -201,17 +259,17 @@ class List {
   // Extends the array to at least be able to hold [length] elements.
   //
   // Free places will be filled with `NULL` values.
-  void EnsureInitialized(int length);
+  void EnsureInitialized(Arena* arena, int length);
 
   // Returns element at [index].
   //
   // If the array is not big enough, it will be grown via `EnsureInitialized`.
-  // If the element doesn't exist, it will be created via `new IT()`.
+  // If the element doesn't exist, it will be created via `new(arena) IT()`.
   template<typename IT>
-  IT* GetOrCreate(int index);
+  IT* GetOrCreate(Arena* arena, int index);
 
   template<typename IT, typename PT>
-  IT* GetOrCreate(int index, PT* parent);
+  IT* GetOrCreate(Arena* arena, int index, PT* parent);
 
   // Returns element at [index].
   T*& operator[](int index) {
@@ -237,7 +295,7 @@ class TypeParameterList : public List<TypeParameter> {
 };
 
 template<typename A, typename B>
-class Tuple {
+class Tuple : public ArenaAllocated {
  public:
   static Tuple<A, B>* ReadFrom(Reader* reader);
   void WriteTo(Writer* writer);
@@ -255,21 +313,18 @@ class Tuple {
   Child<B> second_;
 };
 
-class String {
+class String : public ArenaAllocated {
  public:
   static String* ReadFrom(Reader* reader);
   static String* ReadFromImpl(Reader* reader);
   void WriteTo(Writer* writer);
   void WriteToImpl(Writer* writer);
 
-  String(const uint8_t* utf8, int length) {
-    buffer_ = new uint8_t[length];
+  String(Arena* arena, const uint8_t* utf8, int length) {
+    buffer_ = arena->Alloc<uint8_t>(length);
     size_ = length;
     memcpy(buffer_, utf8, length);
   }
-  ~String() {
-    delete[] buffer_;
-  }
 
   uint8_t* buffer() { return buffer_; }
   int size() { return size_; }
@@ -303,12 +358,6 @@ class LineStartingTable {
  public:
   void ReadFrom(Reader* reader);
   void WriteTo(Writer* writer);
-  ~LineStartingTable() {
-    for (intptr_t i = 0; i < size_; ++i) {
-      delete[] values_[i];
-    }
-    delete[] values_;
-  }
 
   intptr_t size() { return size_; }
   intptr_t* valuesFor(int i) { return values_[i]; }
@@ -350,7 +399,7 @@ DIL_VISITORS_DO(DO)
   DEFINE_IS_OPERATION(TreeNode)               \
   DIL_TREE_NODES_DO(DEFINE_IS_OPERATION)
 
-class Node {
+class Node : public ArenaAllocated {
  public:
   virtual ~Node();
 
@@ -836,6 +885,12 @@ class FunctionNode : public TreeNode {
   static FunctionNode* ReadFrom(Reader* reader);
   void WriteTo(Writer* writer);
 
+  // Reads/writes the function of a [Constructor] or [Procedure].  Unlike
+  // nested functions, the bodies of these can be skipped when reading and
+  // deserialized on first use (see [body]).
+  static FunctionNode* ReadFrom(Reader* reader, Member* member);
+  void WriteTo(Writer* writer, bool is_member);
+
   virtual ~FunctionNode();
 
   DEFINE_CASTING_OPERATIONS(FunctionNode);
@@ -850,11 +905,39 @@ class FunctionNode : public TreeNode {
   List<VariableDeclaration>& named_parameters() { return named_parameters_; }
   DartType* return_type() { return return_type_; }
   InferredValue* inferred_return_value() { return inferred_return_value_; }
-  Statement* body() { return body_; }
+
+  // The body of a member function is only deserialized when it is first
+  // accessed, usually when the function is first compiled.  This must happen
+  // on the thread that owns the program (i.e. the mutator).
+  Statement* body() {
+    if (lazy_body_ != NULL) ReadLazyBody();
+    return body_;
+  }
+
+  // Whether the body has not been deserialized yet, see body().
+  bool has_lazy_body() { return lazy_body_ != NULL; }
 
  private:
+  // Where to find a body which has not been deserialized yet.
+  class LazyBody : public ArenaAllocated {
+   public:
+    LazyBody(Program* program, Class* klass, intptr_t offset)
+        : program_(program), klass_(klass), offset_(offset) {}
+
+    Program* program() { return program_; }
+    Class* klass() { return klass_; }
+    intptr_t offset() { return offset_; }
+
+   private:
+    Program* program_;
+    Class* klass_;
+    intptr_t offset_;
+  };
+
   DISALLOW_COPY_AND_ASSIGN(FunctionNode);
-  FunctionNode() {}
+  FunctionNode() : lazy_body_(NULL) {}
+
+  void ReadLazyBody();
 
   AsyncMarker async_marker_;
   TypeParameterList type_parameters_;
@@ -864,6 +947,7 @@ class FunctionNode : public TreeNode {
   Child<DartType> return_type_;
   Child<InferredValue> inferred_return_value_;
   Child<Statement> body_;
+  LazyBody* lazy_body_;
 };
 
 class Expression : public TreeNode {
@@ -2519,7 +2603,14 @@ class TypeParameter : public TreeNode {
 
 class Program : public TreeNode {
  public:
-  static Program* ReadFrom(Reader* reader);
+  // Unlike all other nodes, the program itself is heap allocated.  It owns
+  // the [Arena] holding the rest of the tree.
+  void* operator new(size_t size) { return malloc(size); }
+  void operator delete(void* pointer) { free(pointer); }
+
+  // If the binary carries a program index, up to [num_tasks] helper tasks
+  // are used to read libraries in parallel.
+  static Program* ReadFrom(Reader* reader, intptr_t num_tasks = 0);
   void WriteTo(Writer* writer);
 
   virtual ~Program();
@@ -2535,15 +2626,35 @@ class Program : public TreeNode {
   List<Library>& libraries() { return libraries_; }
   Procedure* main_method() { return main_method_; }
 
+  // The binary the program was read from, if some function bodies have not
+  // been deserialized yet.  Unless adopted, it is owned by the caller of
+  // [ReadFrom] and has to outlive the program.
+  const uint8_t* buffer() { return buffer_; }
+  intptr_t buffer_length() { return buffer_length_; }
+
+  // Makes the program release its buffer with [release] when it is deleted.
+  typedef void (*BufferRelease)(const uint8_t* buffer, intptr_t length);
+  void AdoptBuffer(BufferRelease release) { buffer_release_ = release; }
+
+  Arena* arena() { return arena_; }
+
  private:
   DISALLOW_COPY_AND_ASSIGN(Program);
-  Program() {}
+  Program()
+      : buffer_(NULL),
+        buffer_length_(0),
+        buffer_release_(NULL),
+        arena_(new Arena()) {}
 
   List<Library> libraries_;
   Ref<Procedure> main_method_;
   StringTable string_table_;
   StringTable source_uri_table_;
   LineStartingTable line_starting_table_;
+  const uint8_t* buffer_;
+  intptr_t buffer_length_;
+  BufferRelease buffer_release_;
+  Arena* arena_;
 };
 
 class Reference {
@@ -2753,16 +2864,8 @@ class RecursiveVisitor : public Visitor {
 
 
 template<typename T>
-List<T>::~List() {
-  for (int i = 0; i < length_; i++) {
-    delete array_[i];
-  }
-  delete[] array_;
-}
-
-template<typename T>
-void List<T>::EnsureInitialized(int length) {
-  if (length < length_) return;
+void List<T>::EnsureInitialized(Arena* arena, int length) {
+  if (length <= length_) return;
 
   T** old_array = array_;
   int old_length = length_;
@@ -2770,7 +2873,7 @@ void List<T>::EnsureInitialized(int length) {
   // TODO: Mabe we should use double-growth instead to avoid running into the
   // quadratic case.
   length_ = length;
-  array_ = new T*[length_];
+  array_ = arena->Alloc<T*>(length_);
 
   // Move old elements at the start (if necessary).
   int offset = 0;
@@ -2784,18 +2887,16 @@ void List<T>::EnsureInitialized(int length) {
   for (; offset < length_; offset++) {
     array_[offset] = NULL;
   }
-
-  delete[] old_array;
 }
 
 template<typename T>
 template<typename IT>
-IT* List<T>::GetOrCreate(int index) {
-  EnsureInitialized(index + 1);
+IT* List<T>::GetOrCreate(Arena* arena, int index) {
+  EnsureInitialized(arena, index + 1);
 
   T* member = array_[index];
   if (member == NULL) {
-    member = array_[index] = new IT();
+    member = array_[index] = new(arena) IT();
   }
   return IT::Cast(member);
 }
@@ -2803,12 +2904,12 @@ IT* List<T>::GetOrCreate(int index) {
 
 template<typename T>
 template<typename IT, typename PT>
-IT* List<T>::GetOrCreate(int index, PT* parent) {
-  EnsureInitialized(index + 1);
+IT* List<T>::GetOrCreate(Arena* arena, int index, PT* parent) {
+  EnsureInitialized(arena, index + 1);
 
   T* member = array_[index];
   if (member == NULL) {
-    member = array_[index] = new IT();
+    member = array_[index] = new(arena) IT();
     member->parent_ = parent;
   } else {
     ASSERT(member->parent_ == parent);
@@ -2818,8 +2919,11 @@ IT* List<T>::GetOrCreate(int index, PT* parent) {
 
 }  // namespace dil
 
+// The program reads function bodies out of [buffer] on demand, so the buffer
+// has to outlive it.
 dil::Program* ReadPrecompiledDilFromBuffer(const uint8_t* buffer,
-                                           intptr_t buffer_length);
+                                           intptr_t buffer_length,
+                                           intptr_t num_tasks = 0);
 dil::Program* ReadPrecompiledDil(const char* filename);
 bool WritePrecompiledDil(const char* filename, dil::Program* program);
 
@@ -8,12 +8,18 @@
 
 #include <errno.h>
 #include <fcntl.h>
+#include <sys/mman.h>
 #include <sys/stat.h>
 #include <unistd.h>
 
 #include "vm/dil.h"
 
 #include "platform/signal_blocker.h"
+#include "vm/atomic.h"
+#include "vm/dart.h"
+#include "vm/lockers.h"
+#include "vm/os.h"
+#include "vm/thread_pool.h"
 
 #if 0
 #define TRACE_READ_OFFSET() reader->DumpOffset(__PRETTY_FUNCTION__);
@@ -25,50 +31,93 @@
 
 namespace dart {
 
+// Provides the contents of a dil file.  The file is mapped read-only so the
+// reader works directly out of the page cache (which is shared between
+// processes loading the same file); if mapping fails we fall back to reading
+// it into a heap buffer.
 class InputFile {
  public:
   explicit InputFile(const char* filename)
-      : filename_(filename), buffer_(NULL), size_(-1) {}
+      : filename_(filename), buffer_(NULL), size_(-1), mapped_(false) {}
 
   ~InputFile() {
-    delete[] buffer_;
+    if (buffer_ == NULL) return;
+    if (mapped_) {
+      munmap(buffer_, size_);
+    } else {
+      delete[] buffer_;
+    }
   }
 
   bool ReadAll() {
-    size_ = FileSize();
-    if (size_ > 0) {
-      // TODO(kustermann): We could consider simply mmap()ing the file, but
-      // that might not work so easily on windows.
-      int fd = TEMP_FAILURE_RETRY(open(filename_, O_RDONLY));
-      if (fd < 0) return false;
-      buffer_ = new uint8_t[size_];
-      long offset = 0;
-      while (offset < size_) {
-        ssize_t bytes = TEMP_FAILURE_RETRY(read(fd, buffer_, size_ - offset));
-        if (bytes < 0) FATAL("Error during reading dil file.");
-        offset += bytes;
-      }
+    int fd = TEMP_FAILURE_RETRY(open(filename_, O_RDONLY));
+    if (fd < 0) return false;
+    size_ = FileSize(fd);
+    if (size_ <= 0) {
       TEMP_FAILURE_RETRY(close(fd));
-      return true;
+      return false;
     }
-    return false;
+    if (!Map(fd)) {
+      Read(fd);
+    }
+    TEMP_FAILURE_RETRY(close(fd));
+    return true;
   }
 
   uint8_t* buffer() { return buffer_; }
   long size() { return size_; }
+  bool mapped() { return mapped_; }
+
+  // Hands the buffer over to the caller.
+  uint8_t* Release() {
+    uint8_t* buffer = buffer_;
+    buffer_ = NULL;
+    return buffer;
+  }
+
+  static void Unmap(const uint8_t* buffer, intptr_t size) {
+    munmap(const_cast<uint8_t*>(buffer), size);
+  }
+
+  static void Delete(const uint8_t* buffer, intptr_t size) {
+    delete[] buffer;
+  }
 
  private:
-  int FileSize() {
+  long FileSize(int fd) {
     struct stat file_stat;
-    if (stat(filename_, &file_stat) == 0) {
+    if (fstat(fd, &file_stat) == 0) {
       return file_stat.st_size;
     }
     return -1;
   }
 
+  bool Map(int fd) {
+    void* address = mmap(NULL, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (address == MAP_FAILED) return false;
+    // The binary reader walks the file front to back exactly once.
+    madvise(address, size_, MADV_SEQUENTIAL);
+    madvise(address, size_, MADV_WILLNEED);
+    buffer_ = reinterpret_cast<uint8_t*>(address);
+    mapped_ = true;
+    return true;
+  }
+
+  void Read(int fd) {
+    buffer_ = new uint8_t[size_];
+    long offset = 0;
+    while (offset < size_) {
+      ssize_t bytes = TEMP_FAILURE_RETRY(
+          read(fd, buffer_ + offset, size_ - offset));
+      if (bytes <= 0) FATAL("Error during reading dil file.");
+      offset += bytes;
+    }
+  }
+
   const char* filename_;
   uint8_t* buffer_;
   long size_;
+  bool mapped_;
 };
 
 class OutputFile {
@@ -135,6 +184,9 @@ namespace dil {
 
 static const uint32_t kMagicProgramFile = 0x90ABCDEFu;
 
+// Optionally written after the program, see [ProgramIndex].
+static const uint32_t kMagicProgramIndex = 0x90AB0D1Eu;
+
 // Keep in sync with package:dynamo/lib/binary/tag.dart
 enum Tag {
   kNothing = 0,
@@ -252,6 +304,8 @@ enum Tag {
 
 static const int SpecializedIntLiteralBias = 3;
 
+class ProgramIndex;
+
 template<typename T>
 class BlockStack {
  public:
@@ -434,7 +488,8 @@ class ReaderHelper {
 class Reader {
  public:
   Reader(const uint8_t* buffer, long size)
-      : buffer_(buffer), size_(size), offset_(0) {}
+      : buffer_(buffer), size_(size), offset_(0), index_(NULL),
+        arena_(NULL) {}
 
   uint32_t ReadUInt32() {
     ASSERT(offset_ + 4 <= size_);
@@ -519,6 +574,28 @@ class Reader {
     return old;
   }
 
+  const uint8_t* buffer() { return buffer_; }
+  long size() { return size_; }
+  long offset() { return offset_; }
+  void set_offset(long offset) {
+    ASSERT(offset >= 0 && offset <= size_);
+    offset_ = offset;
+  }
+
+  ProgramIndex* index() { return index_; }
+  void set_index(ProgramIndex* index) { index_ = index; }
+
+  // The arena all nodes read by this reader are allocated in.  Defaults to
+  // the arena of the program being read.
+  Arena* arena() {
+    return arena_ != NULL ? arena_ : builder_.program()->arena();
+  }
+  void set_arena(Arena* arena) { arena_ = arena; }
+
+  // If the function body at the current offset is listed in the program
+  // index, moves past it and returns true.
+  bool SkipIndexedFunctionBody();
+
   void EnsureEnd() {
     if (offset_ != size_) {
       FATAL2("Reading Dil file: Expected to be at EOF (offset: %ld, size: %ld)", offset_, size_);
@@ -549,8 +626,225 @@ class Reader {
   long size_;
   long offset_;
   ReaderHelper builder_;
+  ProgramIndex* index_;
+  Arena* arena_;
+};
+
+// The optional index appended to a program by [Program::WriteTo]:
+//
+//   UInt32 function body count
+//   (UInt32 start, UInt32 end)*   // Member function bodies, in file order.
+//   UInt32 library count
+//   LibraryEntry*
+//   UInt32 libraries end          // Offset of the main method reference.
+//   UInt32 index offset
+//   UInt32 kMagicProgramIndex
+//
+// where a LibraryEntry is
+//
+//   UInt32 library offset
+//   UInt32 class count
+//   (UInt32 tag, UInt32 fields, UInt32 constructors, UInt32 procedures)*
+//   UInt32 fields
+//   UInt32 procedures
+//
+// The function bodies allow skipping member bodies until they are used (see
+// [FunctionNode::body]).  The library entries allow creating every library,
+// class and member node upfront, after which libraries can be read
+// independently of each other, and thus in parallel.
+//
+// Readers which do not know about the index stop after the main method and
+// never see it.
+class ProgramIndex {
+ public:
+  struct ClassEntry {
+    Tag tag;
+    intptr_t field_count;
+    intptr_t constructor_count;
+    intptr_t procedure_count;
+  };
+
+  struct LibraryEntry {
+    long offset;
+    std::vector<ClassEntry> classes;
+    intptr_t field_count;
+    intptr_t procedure_count;
+  };
+
+  ProgramIndex() : libraries_end_(-1) {}
+
+  // Reads the index from the end of the reader's buffer, if it has one.
+  bool ReadFrom(Reader* reader);
+
+  // Creates all library, class and member nodes of [program].
+  void CreateSkeleton(Program* program);
+
+  // Returns the end of the function body starting at [start], or -1 if
+  // there is no such body in the index.
+  long FunctionBodyEnd(long start);
+
+  std::vector<LibraryEntry>& libraries() { return libraries_; }
+  long libraries_end() { return libraries_end_; }
+
+ private:
+  static const long kFooterSize = 8;
+
+  bool ReadEntries(Reader* reader, long limit);
+  bool ReadUInts(Reader* reader, long limit, intptr_t count, uint32_t* values);
+
+  std::vector<std::pair<long, long> > function_bodies_;
+  std::vector<LibraryEntry> libraries_;
+  long libraries_end_;
 };
 
+bool ProgramIndex::ReadUInts(Reader* reader,
+                             long limit,
+                             intptr_t count,
+                             uint32_t* values) {
+  if (count < 0 || reader->offset() + count * 4 > limit) return false;
+  for (intptr_t i = 0; i < count; i++) {
+    values[i] = reader->ReadUInt32();
+  }
+  return true;
+}
+
+bool ProgramIndex::ReadFrom(Reader* reader) {
+  long size = reader->size();
+  if (size < kFooterSize) return false;
+  long limit = size - kFooterSize;
+
+  long saved_offset = reader->offset();
+  reader->set_offset(limit);
+  long index_offset = reader->ReadUInt32();
+  uint32_t magic = reader->ReadUInt32();
+  bool valid = false;
+  if (magic == kMagicProgramIndex && index_offset <= limit) {
+    reader->set_offset(index_offset);
+    valid = ReadEntries(reader, limit) && reader->offset() == limit;
+  }
+  reader->set_offset(saved_offset);
+
+  if (!valid) {
+    function_bodies_.clear();
+    libraries_.clear();
+    libraries_end_ = -1;
+  }
+  return valid;
+}
+
+bool ProgramIndex::ReadEntries(Reader* reader, long limit) {
+  // Every count is validated against the remaining size before we allocate
+  // anything, so a corrupt index cannot make us allocate huge vectors.
+  uint32_t values[4];
+  if (!ReadUInts(reader, limit, 1, values)) return false;
+  if (static_cast<int64_t>(values[0]) * 8 > limit - reader->offset()) {
+    return false;
+  }
+  function_bodies_.resize(values[0]);
+  for (size_t i = 0; i < function_bodies_.size(); i++) {
+    if (!ReadUInts(reader, limit, 2, values)) return false;
+    function_bodies_[i] = std::make_pair(values[0], values[1]);
+  }
+
+  if (!ReadUInts(reader, limit, 1, values)) return false;
+  if (static_cast<int64_t>(values[0]) * 16 > limit - reader->offset()) {
+    return false;
+  }
+  libraries_.resize(values[0]);
+  for (size_t i = 0; i < libraries_.size(); i++) {
+    LibraryEntry& library = libraries_[i];
+    if (!ReadUInts(reader, limit, 2, values)) return false;
+    library.offset = values[0];
+    if (static_cast<int64_t>(values[1]) * 16 > limit - reader->offset()) {
+      return false;
+    }
+    library.classes.resize(values[1]);
+    for (size_t j = 0; j < library.classes.size(); j++) {
+      if (!ReadUInts(reader, limit, 4, values)) return false;
+      library.classes[j].tag = static_cast<Tag>(values[0]);
+      library.classes[j].field_count = values[1];
+      library.classes[j].constructor_count = values[2];
+      library.classes[j].procedure_count = values[3];
+    }
+    if (!ReadUInts(reader, limit, 2, values)) return false;
+    library.field_count = values[0];
+    library.procedure_count = values[1];
+  }
+
+  if (!ReadUInts(reader, limit, 1, values)) return false;
+  libraries_end_ = values[0];
+  return true;
+}
+
+long ProgramIndex::FunctionBodyEnd(long start) {
+  // Bodies are sorted by their start offset.
+  intptr_t low = 0;
+  intptr_t high = function_bodies_.size() - 1;
+  while (low <= high) {
+    intptr_t mid = low + (high - low) / 2;
+    long mid_start = function_bodies_[mid].first;
+    if (mid_start == start) {
+      return function_bodies_[mid].second;
+    } else if (mid_start < start) {
+      low = mid + 1;
+    } else {
+      high = mid - 1;
+    }
+  }
+  return -1;
+}
+
+void ProgramIndex::CreateSkeleton(Program* program) {
+  Arena* arena = program->arena();
+  List<Library>& libraries = program->libraries();
+  libraries.EnsureInitialized(arena, libraries_.size());
+  for (size_t i = 0; i < libraries_.size(); i++) {
+    LibraryEntry& entry = libraries_[i];
+    Library* library = libraries.GetOrCreate<Library>(arena, i);
+
+    library->classes().EnsureInitialized(arena, entry.classes.size());
+    for (size_t j = 0; j < entry.classes.size(); j++) {
+      ClassEntry& class_entry = entry.classes[j];
+      Class* klass;
+      if (class_entry.tag == kNormalClass) {
+        klass = library->classes().GetOrCreate<NormalClass>(arena, j, library);
+      } else {
+        ASSERT(class_entry.tag == kMixinClass);
+        klass = library->classes().GetOrCreate<MixinClass>(arena, j, library);
+      }
+      klass->fields().EnsureInitialized(arena, class_entry.field_count);
+      for (intptr_t k = 0; k < class_entry.field_count; k++) {
+        klass->fields().GetOrCreate<Field>(arena, k, klass);
+      }
+      klass->constructors().EnsureInitialized(arena, class_entry.constructor_count);
+      for (intptr_t k = 0; k < class_entry.constructor_count; k++) {
+        klass->constructors().GetOrCreate<Constructor>(arena, k, klass);
+      }
+      klass->procedures().EnsureInitialized(arena, class_entry.procedure_count);
+      for (intptr_t k = 0; k < class_entry.procedure_count; k++) {
+        klass->procedures().GetOrCreate<Procedure>(arena, k, klass);
+      }
+    }
+
+    library->fields().EnsureInitialized(arena, entry.field_count);
+    for (intptr_t k = 0; k < entry.field_count; k++) {
+      library->fields().GetOrCreate<Field>(arena, k, library);
+    }
+    library->procedures().EnsureInitialized(arena, entry.procedure_count);
+    for (intptr_t k = 0; k < entry.procedure_count; k++) {
+      library->procedures().GetOrCreate<Procedure>(arena, k, library);
+    }
+  }
+}
+
+bool Reader::SkipIndexedFunctionBody() {
+  if (index_ == NULL) return false;
+  long end = index_->FunctionBodyEnd(offset_);
+  if (end < 0) return false;
+  offset_ = end;
+  return true;
+}
+
 class WriterHelper {
  public:
   WriterHelper() : labels_(NULL) {}
@@ -607,6 +901,14 @@ class WriterHelper {
   BlockMap<LabeledStatement>* labels() { return labels_; }
   void set_labels(BlockMap<LabeledStatement>* labels) { labels_ = labels; }
 
+  // [start, end) offsets of the member function bodies written so far.
+  std::vector<std::pair<long, long> >& function_bodies() {
+    return function_bodies_;
+  }
+
+  // Offsets of the libraries written so far.
+  std::vector<long>& library_offsets() { return library_offsets_; }
+
  private:
   Program* program_;
 
@@ -621,6 +923,8 @@ class WriterHelper {
   BlockMap<TypeParameter> type_parameters_;
   BlockMap<SwitchCase> switch_cases_;
   BlockMap<LabeledStatement>* labels_;
+  std::vector<std::pair<long, long> > function_bodies_;
+  std::vector<long> library_offsets_;
 };
 
 class Writer {
@@ -725,6 +1029,8 @@ class Writer {
 
   WriterHelper* helper() { return &helper_; }
 
+  long offset() { return offset_; }
+
   void Flush() { out_->Flush(); }
 
  private:
@@ -739,10 +1045,10 @@ void List<T>::ReadFrom(Reader* reader, TreeNode* parent) {
   TRACE_READ_OFFSET();
   ASSERT(parent != NULL);
   int length = reader->ReadListLength();
-  EnsureInitialized(length);
+  EnsureInitialized(reader->arena(), length);
 
   for (int i = 0; i < length_; i++) {
-    IT* object = GetOrCreate<IT>(i, parent);
+    IT* object = GetOrCreate<IT>(reader->arena(), i, parent);
     object->ReadFrom(reader);
   }
 }
@@ -752,10 +1058,10 @@ template<typename IT>
 void List<T>::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   int length = reader->ReadListLength();
-  EnsureInitialized(length);
+  EnsureInitialized(reader->arena(), length);
 
   for (int i = 0; i < length_; i++) {
-    GetOrCreate<IT>(i)->ReadFrom(reader);
+    GetOrCreate<IT>(reader->arena(), i)->ReadFrom(reader);
   }
 }
 
@@ -764,7 +1070,7 @@ template<typename IT>
 void List<T>::ReadFromStatic(Reader* reader) {
   TRACE_READ_OFFSET();
   int length = reader->ReadListLength();
-  EnsureInitialized(length);
+  EnsureInitialized(reader->arena(), length);
 
   for (int i = 0; i < length_; i++) {
     ASSERT(array_[i] == NULL);
@@ -804,11 +1110,11 @@ void TypeParameterList::ReadFrom(Reader* reader) {
   // the second type parameter. This means we need to create [TypeParameter]
   // objects before reading the bounds.
   int length = reader->ReadListLength();
-  EnsureInitialized(length);
+  EnsureInitialized(reader->arena(), length);
 
   // Make all [TypeParameter]s available in scope.
   for (int i = 0; i < length; i++) {
-    TypeParameter* parameter = (*this)[i] = new TypeParameter();
+    TypeParameter* parameter = (*this)[i] = new(reader->arena()) TypeParameter();
     reader->helper()->type_parameters().Push(parameter);
   }
 
@@ -839,7 +1145,7 @@ Tuple<A, B>* Tuple<A, B>::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   A* first = A::ReadFrom(reader);
   B* second = B::ReadFrom(reader);
-  return new Tuple<A, B>(first, second);
+  return new(reader->arena()) Tuple<A, B>(first, second);
 }
 
 template<typename A, typename B>
@@ -892,7 +1198,8 @@ String* String::ReadFrom(Reader* reader) {
 String* String::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
   uint32_t bytes = reader->ReadUInt();
-  String* string = new String(reader->Consume(bytes), bytes);
+  String* string = new(reader->arena()) String(
+      reader->arena(), reader->Consume(bytes), bytes);
   return string;
 }
 
@@ -923,10 +1230,10 @@ void StringTable::WriteTo(Writer* writer) {
 
 void LineStartingTable::ReadFrom(Reader* reader) {
   size_ = reader->helper()->program()->source_uri_table().strings().length();
-  values_ = new intptr_t*[size_];
+  values_ = reader->arena()->Alloc<intptr_t*>(size_);
   for (intptr_t i = 0; i < size_; ++i) {
     intptr_t line_count = reader->ReadUInt();
-    intptr_t* line_starts = new intptr_t[line_count + 1];
+    intptr_t* line_starts = reader->arena()->Alloc<intptr_t>(line_count + 1);
     line_starts[0] = line_count;
     intptr_t previous_line_start = 0;
     for (intptr_t j = 0; j < line_count; ++j) {
@@ -962,15 +1269,15 @@ Library* Library::ReadFrom(Reader* reader) {
   source_uri_index_ = reader->ReadUInt();
 
   int num_classes = reader->ReadUInt();
-  classes().EnsureInitialized(num_classes);
+  classes().EnsureInitialized(reader->arena(), num_classes);
   for (int i = 0; i < num_classes; i++) {
     Tag tag = reader->ReadTag();
     if (tag == kNormalClass) {
-      NormalClass* klass = classes().GetOrCreate<NormalClass>(i, this);
+      NormalClass* klass = classes().GetOrCreate<NormalClass>(reader->arena(), i, this);
       klass->ReadFrom(reader);
     } else {
       ASSERT(tag == kMixinClass);
-      MixinClass* klass = classes().GetOrCreate<MixinClass>(i, this);
+      MixinClass* klass = classes().GetOrCreate<MixinClass>(reader->arena(), i, this);
       klass->ReadFrom(reader);
     }
   }
@@ -982,6 +1289,7 @@ Library* Library::ReadFrom(Reader* reader) {
 
 void Library::WriteTo(Writer* writer) {
   TRACE_WRITE_OFFSET();
+  writer->WriteFlags(0);  // External libraries are not supported.
   name_->WriteTo(writer);
   import_uri_->WriteTo(writer);
   writer->WriteUInt(source_uri_index_);
@@ -1086,14 +1394,14 @@ Member* Reference::ReadMemberFrom(Reader* reader, bool allow_null) {
     case kLibraryFieldReference: {
       int library_idx = reader->ReadUInt();
       int field_idx = reader->ReadUInt();
-      Library* library = program->libraries().GetOrCreate<Library>(library_idx);
-      return library->fields().GetOrCreate<Field>(field_idx, library);
+      Library* library = program->libraries().GetOrCreate<Library>(reader->arena(), library_idx);
+      return library->fields().GetOrCreate<Field>(reader->arena(), field_idx, library);
     }
     case kLibraryProcedureReference: {
       int library_idx = reader->ReadUInt();
       int procedure_idx = reader->ReadUInt();
-      Library* library = program->libraries().GetOrCreate<Library>(library_idx);
-      return library->procedures().GetOrCreate<Procedure>(procedure_idx, library);
+      Library* library = program->libraries().GetOrCreate<Library>(reader->arena(), library_idx);
+      return library->procedures().GetOrCreate<Procedure>(reader->arena(), procedure_idx, library);
     }
     case kClassFieldReference:
     case kClassConstructorReference:
@@ -1101,14 +1409,14 @@ Member* Reference::ReadMemberFrom(Reader* reader, bool allow_null) {
       Class* klass = Reference::ReadClassFrom(reader);
       if (tag == kClassFieldReference) {
         int field_idx = reader->ReadUInt();
-        return klass->fields().GetOrCreate<Field>(field_idx, klass);
+        return klass->fields().GetOrCreate<Field>(reader->arena(), field_idx, klass);
       } else if (tag == kClassConstructorReference) {
         int constructor_idx = reader->ReadUInt();
-        return klass->constructors().GetOrCreate<Constructor>(constructor_idx, klass);
+        return klass->constructors().GetOrCreate<Constructor>(reader->arena(), constructor_idx, klass);
       } else {
         ASSERT(tag == kClassProcedureReference);
         int procedure_idx = reader->ReadUInt();
-        return klass->procedures().GetOrCreate<Procedure>(procedure_idx, klass);
+        return klass->procedures().GetOrCreate<Procedure>(reader->arena(), procedure_idx, klass);
       }
     }
     case kNullReference:
@@ -1190,13 +1498,13 @@ Class* Reference::ReadClassFrom(Reader* reader, bool allow_null) {
   int library_idx = reader->ReadUInt();
   int class_idx = reader->ReadUInt();
 
-  Library* library = program->libraries().GetOrCreate<Library>(library_idx);
+  Library* library = program->libraries().GetOrCreate<Library>(reader->arena(), library_idx);
   Class* klass;
   if (klass_member_tag == kNormalClassReference) {
-    klass = library->classes().GetOrCreate<NormalClass>(class_idx, library);
+    klass = library->classes().GetOrCreate<NormalClass>(reader->arena(), class_idx, library);
   } else {
     ASSERT(klass_member_tag == kMixinClassReference);
-    klass = library->classes().GetOrCreate<MixinClass>(class_idx, library);
+    klass = library->classes().GetOrCreate<MixinClass>(reader->arena(), class_idx, library);
   }
   return klass;
 }
@@ -1271,7 +1579,7 @@ Constructor* Constructor::ReadFrom(Reader* reader) {
   flags_ = reader->ReadFlags();
   name_ = Name::ReadFrom(reader);
   annotations_.ReadFromStatic<Expression>(reader);
-  function_ = FunctionNode::ReadFrom(reader);
+  function_ = FunctionNode::ReadFrom(reader, this);
   initializers_.ReadFromStatic<Initializer>(reader);
   return this;
 }
@@ -1284,7 +1592,7 @@ void Constructor::WriteTo(Writer* writer) {
   writer->WriteFlags(flags_);
   name_->WriteTo(writer);
   annotations_.WriteTo(writer);
-  function_->WriteTo(writer);
+  function_->WriteTo(writer, true);
   initializers_.WriteTo(writer);
 }
 
@@ -1299,7 +1607,12 @@ Procedure* Procedure::ReadFrom(Reader* reader) {
   name_ = Name::ReadFrom(reader);
   source_uri_index_ = reader->ReadUInt();
   annotations_.ReadFromStatic<Expression>(reader);
-  function_ = reader->ReadOptional<FunctionNode>();
+  tag = reader->ReadTag();
+  if (tag == kSomething) {
+    function_ = FunctionNode::ReadFrom(reader, this);
+  } else {
+    ASSERT(tag == kNothing);
+  }
   return this;
 }
 
@@ -1313,7 +1626,12 @@ void Procedure::WriteTo(Writer* writer) {
   name_->WriteTo(writer);
   writer->WriteUInt(source_uri_index_);
   annotations_.WriteTo(writer);
-  writer->WriteOptional<FunctionNode>(function_);
+  if (function_ == NULL) {
+    writer->WriteTag(kNothing);
+  } else {
+    writer->WriteTag(kSomething);
+    function_->WriteTo(writer, true);
+  }
 }
 
 Initializer* Initializer::ReadFrom(Reader* reader) {
@@ -1338,7 +1656,7 @@ Initializer* Initializer::ReadFrom(Reader* reader) {
 
 InvalidInitializer* InvalidInitializer::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new InvalidInitializer();
+  return new(reader->arena()) InvalidInitializer();
 }
 
 void InvalidInitializer::WriteTo(Writer* writer) {
@@ -1348,7 +1666,7 @@ void InvalidInitializer::WriteTo(Writer* writer) {
 
 FieldInitializer* FieldInitializer::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  FieldInitializer* initializer = new FieldInitializer();
+  FieldInitializer* initializer = new(reader->arena()) FieldInitializer();
   initializer->field_ = Field::Cast(Reference::ReadMemberFrom(reader));
   initializer->value_ = Expression::ReadFrom(reader);
   return initializer;
@@ -1363,7 +1681,7 @@ void FieldInitializer::WriteTo(Writer* writer) {
 
 SuperInitializer* SuperInitializer::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  SuperInitializer* init = new SuperInitializer();
+  SuperInitializer* init = new(reader->arena()) SuperInitializer();
   init->target_ = Constructor::Cast(Reference::ReadMemberFrom(reader));
   init->arguments_ = Arguments::ReadFrom(reader);
   return init;
@@ -1378,7 +1696,7 @@ void SuperInitializer::WriteTo(Writer* writer) {
 
 RedirectingInitializer* RedirectingInitializer::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  RedirectingInitializer* init = new RedirectingInitializer();
+  RedirectingInitializer* init = new(reader->arena()) RedirectingInitializer();
   init->target_ = Constructor::Cast(Reference::ReadMemberFrom(reader));
   init->arguments_ = Arguments::ReadFrom(reader);
   return init;
@@ -1393,7 +1711,7 @@ void RedirectingInitializer::WriteTo(Writer* writer) {
 
 LocalInitializer* LocalInitializer::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  LocalInitializer* init = new LocalInitializer();
+  LocalInitializer* init = new(reader->arena()) LocalInitializer();
   init->variable_ = VariableDeclaration::ReadFromImpl(reader);
   return init;
 }
@@ -1507,7 +1825,7 @@ Expression* Expression::ReadFrom(Reader* reader) {
 
 InvalidExpression* InvalidExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new InvalidExpression();
+  return new(reader->arena()) InvalidExpression();
 }
 
 void InvalidExpression::WriteTo(Writer* writer) {
@@ -1517,7 +1835,7 @@ void InvalidExpression::WriteTo(Writer* writer) {
 
 VariableGet* VariableGet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  VariableGet* get = new VariableGet();
+  VariableGet* get = new(reader->arena()) VariableGet();
   get->variable_ = reader->helper()->variables().Lookup(reader->ReadUInt());
   reader->ReadOptional<DartType>();  // Unused promoted type.
   return get;
@@ -1525,7 +1843,7 @@ VariableGet* VariableGet::ReadFrom(Reader* reader) {
 
 VariableGet* VariableGet::ReadFrom(Reader* reader, uint8_t payload) {
   TRACE_READ_OFFSET();
-  VariableGet* get = new VariableGet();
+  VariableGet* get = new(reader->arena()) VariableGet();
   get->variable_ = reader->helper()->variables().Lookup(payload);
   return get;
 }
@@ -1544,7 +1862,7 @@ void VariableGet::WriteTo(Writer* writer) {
 
 VariableSet* VariableSet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  VariableSet* set = new VariableSet();
+  VariableSet* set = new(reader->arena()) VariableSet();
   set->variable_ = reader->helper()->variables().Lookup(reader->ReadUInt());
   set->expression_ = Expression::ReadFrom(reader);
   return set;
@@ -1552,7 +1870,7 @@ VariableSet* VariableSet::ReadFrom(Reader* reader) {
 
 VariableSet* VariableSet::ReadFrom(Reader* reader, uint8_t payload) {
   TRACE_READ_OFFSET();
-  VariableSet* set = new VariableSet();
+  VariableSet* set = new(reader->arena()) VariableSet();
   set->variable_ = reader->helper()->variables().Lookup(payload);
   set->expression_ = Expression::ReadFrom(reader);
   return set;
@@ -1572,7 +1890,7 @@ void VariableSet::WriteTo(Writer* writer) {
 
 PropertyGet* PropertyGet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  PropertyGet* get = new PropertyGet();
+  PropertyGet* get = new(reader->arena()) PropertyGet();
   get->position_ = reader->ReadPosition();
   get->receiver_ = Expression::ReadFrom(reader);
   get->name_ = Name::ReadFrom(reader);
@@ -1591,7 +1909,7 @@ void PropertyGet::WriteTo(Writer* writer) {
 
 PropertySet* PropertySet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  PropertySet* set = new PropertySet();
+  PropertySet* set = new(reader->arena()) PropertySet();
   set->position_ = reader->ReadPosition();
   set->receiver_ = Expression::ReadFrom(reader);
   set->name_ = Name::ReadFrom(reader);
@@ -1612,7 +1930,7 @@ void PropertySet::WriteTo(Writer* writer) {
 
 DirectPropertyGet* DirectPropertyGet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  DirectPropertyGet* get = new DirectPropertyGet();
+  DirectPropertyGet* get = new(reader->arena()) DirectPropertyGet();
   get->receiver_ = Expression::ReadFrom(reader);
   get->target_ = Reference::ReadMemberFrom(reader);
   return get;
@@ -1627,7 +1945,7 @@ void DirectPropertyGet::WriteTo(Writer* writer) {
 
 DirectPropertySet* DirectPropertySet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  DirectPropertySet* set = new DirectPropertySet();
+  DirectPropertySet* set = new(reader->arena()) DirectPropertySet();
   set->receiver_ = Expression::ReadFrom(reader);
   set->target_ = Reference::ReadMemberFrom(reader);
   set->value_ = Expression::ReadFrom(reader);
@@ -1644,7 +1962,7 @@ void DirectPropertySet::WriteTo(Writer* writer) {
 
 StaticGet* StaticGet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  StaticGet* get = new StaticGet();
+  StaticGet* get = new(reader->arena()) StaticGet();
   get->position_ = reader->ReadPosition();
   get->target_ = Reference::ReadMemberFrom(reader);
   return get;
@@ -1659,7 +1977,7 @@ void StaticGet::WriteTo(Writer* writer) {
 
 StaticSet* StaticSet::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  StaticSet* set = new StaticSet();
+  StaticSet* set = new(reader->arena()) StaticSet();
   set->target_ = Reference::ReadMemberFrom(reader);
   set->expression_ = Expression::ReadFrom(reader);
   return set;
@@ -1674,7 +1992,7 @@ void StaticSet::WriteTo(Writer* writer) {
 
 Arguments* Arguments::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  Arguments* arguments = new Arguments();
+  Arguments* arguments = new(reader->arena()) Arguments();
   arguments->types().ReadFromStatic<DartType>(reader);
   arguments->positional().ReadFromStatic<Expression>(reader);
   arguments->named().ReadFromStatic<NamedExpression>(reader);
@@ -1692,7 +2010,7 @@ NamedExpression* NamedExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   String* name = Reference::ReadStringFrom(reader);
   Expression* expression = Expression::ReadFrom(reader);
-  return new NamedExpression(name, expression);
+  return new(reader->arena()) NamedExpression(name, expression);
 }
 
 void NamedExpression::WriteTo(Writer* writer) {
@@ -1703,7 +2021,7 @@ void NamedExpression::WriteTo(Writer* writer) {
 
 MethodInvocation* MethodInvocation::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  MethodInvocation* invocation = new MethodInvocation();
+  MethodInvocation* invocation = new(reader->arena()) MethodInvocation();
   invocation->position_ = reader->ReadPosition();
   invocation->receiver_ = Expression::ReadFrom(reader);
   invocation->name_ = Name::ReadFrom(reader);
@@ -1724,7 +2042,7 @@ void MethodInvocation::WriteTo(Writer* writer) {
 
 DirectMethodInvocation* DirectMethodInvocation::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  DirectMethodInvocation* invocation = new DirectMethodInvocation();
+  DirectMethodInvocation* invocation = new(reader->arena()) DirectMethodInvocation();
   invocation->receiver_ = Expression::ReadFrom(reader);
   invocation->target_ = Procedure::Cast(Reference::ReadMemberFrom(reader));
   invocation->arguments_ = Arguments::ReadFrom(reader);
@@ -1741,7 +2059,7 @@ void DirectMethodInvocation::WriteTo(Writer* writer) {
 
 StaticInvocation* StaticInvocation::ReadFrom(Reader* reader, bool is_const) {
   TRACE_READ_OFFSET();
-  StaticInvocation* invocation = new StaticInvocation();
+  StaticInvocation* invocation = new(reader->arena()) StaticInvocation();
   invocation->is_const_ = is_const;
   invocation->position_ = reader->ReadPosition();
   invocation->procedure_ = Procedure::Cast(Reference::ReadMemberFrom(reader));
@@ -1759,7 +2077,7 @@ void StaticInvocation::WriteTo(Writer* writer) {
 
 ConstructorInvocation* ConstructorInvocation::ReadFrom(Reader* reader, bool is_const) {
   TRACE_READ_OFFSET();
-  ConstructorInvocation* invocation = new ConstructorInvocation();
+  ConstructorInvocation* invocation = new(reader->arena()) ConstructorInvocation();
   invocation->is_const_ = is_const;
   invocation->position_ = reader->ReadPosition();
   invocation->target_ = Constructor::Cast(Reference::ReadMemberFrom(reader));
@@ -1777,7 +2095,7 @@ void ConstructorInvocation::WriteTo(Writer* writer) {
 
 Not* Not::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  Not* n = new Not();
+  Not* n = new(reader->arena()) Not();
   n->expression_ = Expression::ReadFrom(reader);
   return n;
 }
@@ -1790,7 +2108,7 @@ void Not::WriteTo(Writer* writer) {
 
 LogicalExpression* LogicalExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  LogicalExpression* expr = new LogicalExpression();
+  LogicalExpression* expr = new(reader->arena()) LogicalExpression();
   expr->left_ = Expression::ReadFrom(reader);
   expr->operator_ = static_cast<Operator>(reader->ReadByte());
   expr->right_ = Expression::ReadFrom(reader);
@@ -1807,7 +2125,7 @@ void LogicalExpression::WriteTo(Writer* writer) {
 
 ConditionalExpression* ConditionalExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  ConditionalExpression* expr = new ConditionalExpression();
+  ConditionalExpression* expr = new(reader->arena()) ConditionalExpression();
   expr->condition_ = Expression::ReadFrom(reader);
   expr->then_ = Expression::ReadFrom(reader);
   expr->otherwise_ = Expression::ReadFrom(reader);
@@ -1826,7 +2144,7 @@ void ConditionalExpression::WriteTo(Writer* writer) {
 
 StringConcatenation* StringConcatenation::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  StringConcatenation* concat = new StringConcatenation();
+  StringConcatenation* concat = new(reader->arena()) StringConcatenation();
   concat->expressions_.ReadFromStatic<Expression>(reader);
   return concat;
 }
@@ -1839,7 +2157,7 @@ void StringConcatenation::WriteTo(Writer* writer) {
 
 IsExpression* IsExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  IsExpression* expr = new IsExpression();
+  IsExpression* expr = new(reader->arena()) IsExpression();
   expr->operand_ = Expression::ReadFrom(reader);
   expr->type_ = DartType::ReadFrom(reader);
   return expr;
@@ -1854,7 +2172,7 @@ void IsExpression::WriteTo(Writer* writer) {
 
 AsExpression* AsExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  AsExpression* expr = new AsExpression();
+  AsExpression* expr = new(reader->arena()) AsExpression();
   expr->operand_ = Expression::ReadFrom(reader);
   expr->type_ = DartType::ReadFrom(reader);
   return expr;
@@ -1869,7 +2187,7 @@ void AsExpression::WriteTo(Writer* writer) {
 
 StringLiteral* StringLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new StringLiteral(Reference::ReadStringFrom(reader));
+  return new(reader->arena()) StringLiteral(Reference::ReadStringFrom(reader));
 }
 
 void StringLiteral::WriteTo(Writer* writer) {
@@ -1880,7 +2198,7 @@ void StringLiteral::WriteTo(Writer* writer) {
 
 BigintLiteral* BigintLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new BigintLiteral(Reference::ReadStringFrom(reader));
+  return new(reader->arena()) BigintLiteral(Reference::ReadStringFrom(reader));
 }
 
 void BigintLiteral::WriteTo(Writer* writer) {
@@ -1891,14 +2209,14 @@ void BigintLiteral::WriteTo(Writer* writer) {
 
 IntLiteral* IntLiteral::ReadFrom(Reader* reader, bool is_negative) {
   TRACE_READ_OFFSET();
-  IntLiteral* literal = new IntLiteral();
+  IntLiteral* literal = new(reader->arena()) IntLiteral();
   literal->value_ = is_negative ? -static_cast<int64_t>(reader->ReadUInt()) : reader->ReadUInt();
   return literal;
 }
 
 IntLiteral* IntLiteral::ReadFrom(Reader* reader, uint8_t payload) {
   TRACE_READ_OFFSET();
-  IntLiteral* literal = new IntLiteral();
+  IntLiteral* literal = new(reader->arena()) IntLiteral();
   literal->value_ = static_cast<int32_t>(payload) - SpecializedIntLiteralBias;
   return literal;
 }
@@ -1916,7 +2234,7 @@ void IntLiteral::WriteTo(Writer* writer) {
 
 DoubleLiteral* DoubleLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  DoubleLiteral* literal = new DoubleLiteral();
+  DoubleLiteral* literal = new(reader->arena()) DoubleLiteral();
   literal->value_ = Reference::ReadStringFrom(reader);
   return literal;
 }
@@ -1929,7 +2247,7 @@ void DoubleLiteral::WriteTo(Writer* writer) {
 
 BoolLiteral* BoolLiteral::ReadFrom(Reader* reader, bool value) {
   TRACE_READ_OFFSET();
-  BoolLiteral* lit = new BoolLiteral();
+  BoolLiteral* lit = new(reader->arena()) BoolLiteral();
   lit->value_ = value;
   return lit;
 }
@@ -1941,7 +2259,7 @@ void BoolLiteral::WriteTo(Writer* writer) {
 
 NullLiteral* NullLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new NullLiteral();
+  return new(reader->arena()) NullLiteral();
 }
 
 void NullLiteral::WriteTo(Writer* writer) {
@@ -1951,7 +2269,7 @@ void NullLiteral::WriteTo(Writer* writer) {
 
 SymbolLiteral* SymbolLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  SymbolLiteral* lit = new SymbolLiteral();
+  SymbolLiteral* lit = new(reader->arena()) SymbolLiteral();
   lit->value_ = Reference::ReadStringFrom(reader);
   return lit;
 }
@@ -1964,7 +2282,7 @@ void SymbolLiteral::WriteTo(Writer* writer) {
 
 TypeLiteral* TypeLiteral::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  TypeLiteral* literal = new TypeLiteral();
+  TypeLiteral* literal = new(reader->arena()) TypeLiteral();
   literal->type_ = DartType::ReadFrom(reader);
   return literal;
 }
@@ -1977,7 +2295,7 @@ void TypeLiteral::WriteTo(Writer* writer) {
 
 ThisExpression* ThisExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new ThisExpression();
+  return new(reader->arena()) ThisExpression();
 }
 
 void ThisExpression::WriteTo(Writer* writer) {
@@ -1987,7 +2305,7 @@ void ThisExpression::WriteTo(Writer* writer) {
 
 Rethrow* Rethrow::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new Rethrow();
+  return new(reader->arena()) Rethrow();
 }
 
 void Rethrow::WriteTo(Writer* writer) {
@@ -1997,7 +2315,7 @@ void Rethrow::WriteTo(Writer* writer) {
 
 Throw* Throw::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  Throw* t = new Throw();
+  Throw* t = new(reader->arena()) Throw();
   t->position_ = reader->ReadPosition();
   t->expression_ = Expression::ReadFrom(reader);
   return t;
@@ -2012,7 +2330,7 @@ void Throw::WriteTo(Writer* writer) {
 
 ListLiteral* ListLiteral::ReadFrom(Reader* reader, bool is_const) {
   TRACE_READ_OFFSET();
-  ListLiteral* literal = new ListLiteral();
+  ListLiteral* literal = new(reader->arena()) ListLiteral();
   literal->is_const_ = is_const;
   literal->type_ = DartType::ReadFrom(reader);
   literal->expressions_.ReadFromStatic<Expression>(reader);
@@ -2028,7 +2346,7 @@ void ListLiteral::WriteTo(Writer* writer) {
 
 MapLiteral* MapLiteral::ReadFrom(Reader* reader, bool is_const) {
   TRACE_READ_OFFSET();
-  MapLiteral* literal = new MapLiteral();
+  MapLiteral* literal = new(reader->arena()) MapLiteral();
   literal->is_const_ = is_const;
   literal->key_type_ = DartType::ReadFrom(reader);
   literal->value_type_ = DartType::ReadFrom(reader);
@@ -2045,7 +2363,7 @@ void MapLiteral::WriteTo(Writer* writer) {
 }
 
 MapEntry* MapEntry::ReadFrom(Reader* reader) {
-  MapEntry* entry = new MapEntry();
+  MapEntry* entry = new(reader->arena()) MapEntry();
   entry->key_ = Expression::ReadFrom(reader);
   entry->value_ = Expression::ReadFrom(reader);
   return entry;
@@ -2059,7 +2377,7 @@ void MapEntry::WriteTo(Writer* writer) {
 
 AwaitExpression* AwaitExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  AwaitExpression* await = new AwaitExpression();
+  AwaitExpression* await = new(reader->arena()) AwaitExpression();
   await->operand_ = Expression::ReadFrom(reader);
   return await;
 }
@@ -2073,7 +2391,7 @@ void AwaitExpression::WriteTo(Writer* writer) {
 FunctionExpression* FunctionExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> parameters(reader->helper());
-  FunctionExpression* expr = new FunctionExpression();
+  FunctionExpression* expr = new(reader->arena()) FunctionExpression();
   expr->function_ = FunctionNode::ReadFrom(reader);
   return expr;
 }
@@ -2088,7 +2406,7 @@ void FunctionExpression::WriteTo(Writer* writer) {
 Let* Let::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> vars(reader->helper());
-  Let* let = new Let();
+  Let* let = new(reader->arena()) Let();
   let->variable_ = VariableDeclaration::ReadFromImpl(reader);
   let->body_ = Expression::ReadFrom(reader);
   return let;
@@ -2104,7 +2422,7 @@ void Let::WriteTo(Writer* writer) {
 
 BlockExpression* BlockExpression::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  BlockExpression* be = new BlockExpression();
+  BlockExpression* be = new(reader->arena()) BlockExpression();
   be->body_ = Block::ReadFromImpl(reader);
   be->value_ = Expression::ReadFrom(reader);
   return be;
@@ -2171,7 +2489,7 @@ Statement* Statement::ReadFrom(Reader* reader) {
 
 InvalidStatement* InvalidStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new InvalidStatement();
+  return new(reader->arena()) InvalidStatement();
 }
 
 void InvalidStatement::WriteTo(Writer* writer) {
@@ -2181,7 +2499,7 @@ void InvalidStatement::WriteTo(Writer* writer) {
 
 ExpressionStatement* ExpressionStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new ExpressionStatement(Expression::ReadFrom(reader));
+  return new(reader->arena()) ExpressionStatement(Expression::ReadFrom(reader));
 }
 
 void ExpressionStatement::WriteTo(Writer* writer) {
@@ -2193,7 +2511,7 @@ void ExpressionStatement::WriteTo(Writer* writer) {
 Block* Block::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> vars(reader->helper());
-  Block* block = new Block();
+  Block* block = new(reader->arena()) Block();
   block->statements().ReadFromStatic<Statement>(reader);
   return block;
 }
@@ -2211,7 +2529,7 @@ void Block::WriteToImpl(Writer* writer) {
 
 EmptyStatement* EmptyStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new EmptyStatement();
+  return new(reader->arena()) EmptyStatement();
 }
 
 void EmptyStatement::WriteTo(Writer* writer) {
@@ -2221,7 +2539,7 @@ void EmptyStatement::WriteTo(Writer* writer) {
 
 AssertStatement* AssertStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  AssertStatement* stmt = new AssertStatement();
+  AssertStatement* stmt = new(reader->arena()) AssertStatement();
   stmt->condition_ = Expression::ReadFrom(reader);
   stmt->message_ = reader->ReadOptional<Expression>();
   return stmt;
@@ -2236,7 +2554,7 @@ void AssertStatement::WriteTo(Writer* writer) {
 
 LabeledStatement* LabeledStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  LabeledStatement* stmt = new LabeledStatement();
+  LabeledStatement* stmt = new(reader->arena()) LabeledStatement();
   reader->helper()->labels()->Push(stmt);
   stmt->body_ = Statement::ReadFrom(reader);
   reader->helper()->labels()->Pop(stmt);
@@ -2253,7 +2571,7 @@ void LabeledStatement::WriteTo(Writer* writer) {
 
 BreakStatement* BreakStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  BreakStatement* stmt = new BreakStatement();
+  BreakStatement* stmt = new(reader->arena()) BreakStatement();
   stmt->target_ = reader->helper()->labels()->Lookup(reader->ReadUInt());
   return stmt;
 }
@@ -2266,7 +2584,7 @@ void BreakStatement::WriteTo(Writer* writer) {
 
 WhileStatement* WhileStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  WhileStatement* stmt = new WhileStatement();
+  WhileStatement* stmt = new(reader->arena()) WhileStatement();
   stmt->condition_ = Expression::ReadFrom(reader);
   stmt->body_ = Statement::ReadFrom(reader);
   return stmt;
@@ -2281,7 +2599,7 @@ void WhileStatement::WriteTo(Writer* writer) {
 
 DoStatement* DoStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  DoStatement* dostmt = new DoStatement();
+  DoStatement* dostmt = new(reader->arena()) DoStatement();
   dostmt->body_ = Statement::ReadFrom(reader);
   dostmt->condition_ = Expression::ReadFrom(reader);
   return dostmt;
@@ -2297,7 +2615,7 @@ void DoStatement::WriteTo(Writer* writer) {
 ForStatement* ForStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> vars(reader->helper());
-  ForStatement* forstmt = new ForStatement();
+  ForStatement* forstmt = new(reader->arena()) ForStatement();
   forstmt->variables_.ReadFromStatic<VariableDeclarationImpl>(reader);
   forstmt->condition_ = reader->ReadOptional<Expression>();
   forstmt->updates_.ReadFromStatic<Expression>(reader);
@@ -2318,7 +2636,7 @@ void ForStatement::WriteTo(Writer* writer) {
 ForInStatement* ForInStatement::ReadFrom(Reader* reader, bool is_async) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> vars(reader->helper());
-  ForInStatement* forinstmt = new ForInStatement();
+  ForInStatement* forinstmt = new(reader->arena()) ForInStatement();
   forinstmt->is_async_ = is_async;
   forinstmt->variable_ = VariableDeclaration::ReadFromImpl(reader);
   forinstmt->iterable_ = Expression::ReadFrom(reader);
@@ -2338,14 +2656,14 @@ void ForInStatement::WriteTo(Writer* writer) {
 SwitchStatement* SwitchStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   SwitchCaseScope<ReaderHelper> scope(reader->helper());
-  SwitchStatement* stmt = new SwitchStatement();
+  SwitchStatement* stmt = new(reader->arena()) SwitchStatement();
   stmt->condition_ = Expression::ReadFrom(reader);
   // We need to explicitly create empty [SwitchCase]s first in order to add them
   // to the [SwitchCaseScope]. This is necessary since a [Statement] in a switch
   // case can refer to one defined later on.
   int count = reader->ReadUInt();
   for (int i = 0; i < count; i++) {
-    SwitchCase* sc = stmt->cases_.GetOrCreate<SwitchCase>(i);
+    SwitchCase* sc = stmt->cases_.GetOrCreate<SwitchCase>(reader->arena(), i);
     reader->helper()->switch_cases().Push(sc);
   }
   for (int i = 0; i < count; i++) {
@@ -2383,7 +2701,7 @@ void SwitchCase::WriteTo(Writer* writer) {
 
 ContinueSwitchStatement* ContinueSwitchStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  ContinueSwitchStatement* stmt =  new ContinueSwitchStatement();
+  ContinueSwitchStatement* stmt = new(reader->arena()) ContinueSwitchStatement();
   stmt->target_ = reader->helper()->switch_cases().Lookup(reader->ReadUInt());
   return stmt;
 }
@@ -2396,7 +2714,7 @@ void ContinueSwitchStatement::WriteTo(Writer* writer) {
 
 IfStatement* IfStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  IfStatement* ifstmt = new IfStatement();
+  IfStatement* ifstmt = new(reader->arena()) IfStatement();
   ifstmt->condition_ = Expression::ReadFrom(reader);
   ifstmt->then_= Statement::ReadFrom(reader);
   ifstmt->otherwise_ = Statement::ReadFrom(reader);
@@ -2413,7 +2731,7 @@ void IfStatement::WriteTo(Writer* writer) {
 
 ReturnStatement* ReturnStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  ReturnStatement* ret = new ReturnStatement();
+  ReturnStatement* ret = new(reader->arena()) ReturnStatement();
   ret->expression_ = reader->ReadOptional<Expression>();
   return ret;
 }
@@ -2426,7 +2744,7 @@ void ReturnStatement::WriteTo(Writer* writer) {
 
 TryCatch* TryCatch::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  TryCatch* tc = new TryCatch();
+  TryCatch* tc = new(reader->arena()) TryCatch();
   tc->body_ = Statement::ReadFrom(reader);
   tc->catches_.ReadFromStatic<Catch>(reader);
   return tc;
@@ -2442,7 +2760,7 @@ void TryCatch::WriteTo(Writer* writer) {
 Catch* Catch::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   VariableScope<ReaderHelper> vars(reader->helper());
-  Catch* c = new Catch();
+  Catch* c = new(reader->arena()) Catch();
   c->guard_ = DartType::ReadFrom(reader);
   c->exception_ = reader->ReadOptional<VariableDeclaration, VariableDeclarationImpl>();
   c->stack_trace_ = reader->ReadOptional<VariableDeclaration, VariableDeclarationImpl>();
@@ -2461,7 +2779,7 @@ void Catch::WriteTo(Writer* writer) {
 
 TryFinally* TryFinally::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  TryFinally* tf = new TryFinally();
+  TryFinally* tf = new(reader->arena()) TryFinally();
   tf->body_ = Statement::ReadFrom(reader);
   tf->finalizer_ = Statement::ReadFrom(reader);
   return tf;
@@ -2476,7 +2794,7 @@ void TryFinally::WriteTo(Writer* writer) {
 
 YieldStatement* YieldStatement::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  YieldStatement* stmt = new YieldStatement();
+  YieldStatement* stmt = new(reader->arena()) YieldStatement();
   stmt->flags_ = reader->ReadByte();
   stmt->expression_ = Expression::ReadFrom(reader);
   return stmt;
@@ -2498,7 +2816,7 @@ VariableDeclaration* VariableDeclaration::ReadFrom(Reader* reader) {
 
 VariableDeclaration* VariableDeclaration::ReadFromImpl(Reader* reader) {
   TRACE_READ_OFFSET();
-  VariableDeclaration* decl = new VariableDeclaration();
+  VariableDeclaration* decl = new(reader->arena()) VariableDeclaration();
   decl->flags_ = reader->ReadFlags();
   decl->name_ = Reference::ReadStringFrom(reader);
   decl->type_ = DartType::ReadFrom(reader);
@@ -2526,7 +2844,7 @@ void VariableDeclaration::WriteToImpl(Writer* writer) {
 
 FunctionDeclaration* FunctionDeclaration::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  FunctionDeclaration* decl = new FunctionDeclaration();
+  FunctionDeclaration* decl = new(reader->arena()) FunctionDeclaration();
   decl->variable_ = VariableDeclaration::ReadFromImpl(reader);
   VariableScope<ReaderHelper> parameters(reader->helper());
   decl->function_ = FunctionNode::ReadFrom(reader);
@@ -2545,10 +2863,10 @@ Name* Name::ReadFrom(Reader* reader) {
   String* string = Reference::ReadStringFrom(reader);
   if (string->size() >= 1 && string->buffer()[0] == '_') {
     int lib_index = reader->ReadUInt();
-    Library* library = reader->helper()->program()->libraries().GetOrCreate<Library>(lib_index);
-    return new Name(string, library);
+    Library* library = reader->helper()->program()->libraries().GetOrCreate<Library>(reader->arena(), lib_index);
+    return new(reader->arena()) Name(string, library);
   } else {
-    return new Name(string, NULL);
+    return new(reader->arena()) Name(string, NULL);
   }
 }
 
@@ -2563,7 +2881,7 @@ void Name::WriteTo(Writer* writer) {
 }
 
 InferredValue* InferredValue::ReadFrom(Reader* reader) {
-  InferredValue* type = new InferredValue();
+  InferredValue* type = new(reader->arena()) InferredValue();
   type->klass_ = Reference::ReadClassFrom(reader, true);
   type->kind_ = static_cast<BaseClassKind>(reader->ReadByte());
   type->value_bits_ = reader->ReadByte();
@@ -2605,7 +2923,7 @@ DartType* DartType::ReadFrom(Reader* reader) {
 
 InvalidType* InvalidType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new InvalidType();
+  return new(reader->arena()) InvalidType();
 }
 
 void InvalidType::WriteTo(Writer* writer) {
@@ -2615,7 +2933,7 @@ void InvalidType::WriteTo(Writer* writer) {
 
 DynamicType* DynamicType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new DynamicType();
+  return new(reader->arena()) DynamicType();
 }
 
 void DynamicType::WriteTo(Writer* writer) {
@@ -2625,7 +2943,7 @@ void DynamicType::WriteTo(Writer* writer) {
 
 VoidType* VoidType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  return new VoidType();
+  return new(reader->arena()) VoidType();
 }
 
 void VoidType::WriteTo(Writer* writer) {
@@ -2636,7 +2954,7 @@ void VoidType::WriteTo(Writer* writer) {
 InterfaceType* InterfaceType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
   Class* klass = Reference::ReadClassFrom(reader);
-  InterfaceType* type = new InterfaceType(klass);
+  InterfaceType* type = new(reader->arena()) InterfaceType(klass);
   type->type_arguments().ReadFromStatic<DartType>(reader);
   return type;
 }
@@ -2644,7 +2962,7 @@ InterfaceType* InterfaceType::ReadFrom(Reader* reader) {
 InterfaceType* InterfaceType::ReadFrom(Reader* reader, bool _without_type_arguments_) {
   TRACE_READ_OFFSET();
   Class* klass = Reference::ReadClassFrom(reader);
-  InterfaceType* type = new InterfaceType(klass);
+  InterfaceType* type = new(reader->arena()) InterfaceType(klass);
   ASSERT(_without_type_arguments_);
   return type;
 }
@@ -2663,7 +2981,7 @@ void InterfaceType::WriteTo(Writer* writer) {
 
 FunctionType* FunctionType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  FunctionType* type = new FunctionType();
+  FunctionType* type = new(reader->arena()) FunctionType();
   TypeParameterScope<ReaderHelper> scope(reader->helper());
   type->type_parameters().ReadFrom(reader);
   type->required_parameter_count_ = reader->ReadUInt();
@@ -2675,7 +2993,7 @@ FunctionType* FunctionType::ReadFrom(Reader* reader) {
 
 FunctionType* FunctionType::ReadFrom(Reader* reader, bool _is_simple_) {
   TRACE_READ_OFFSET();
-  FunctionType* type = new FunctionType();
+  FunctionType* type = new(reader->arena()) FunctionType();
   ASSERT(_is_simple_);
   type->positional_parameters().ReadFromStatic<DartType>(reader);
   type->required_parameter_count_ = type->positional_parameters().length();
@@ -2706,7 +3024,7 @@ void FunctionType::WriteTo(Writer* writer) {
 
 TypeParameterType* TypeParameterType::ReadFrom(Reader* reader) {
   TRACE_READ_OFFSET();
-  TypeParameterType* type = new TypeParameterType();
+  TypeParameterType* type = new(reader->arena()) TypeParameterType();
   type->parameter_ = reader->helper()->type_parameters().Lookup(reader->ReadUInt());
   return type;
 }
@@ -2717,7 +3035,68 @@ void TypeParameterType::WriteTo(Writer* writer) {
   writer->WriteUInt(writer->helper()->type_parameters().Lookup(parameter_));
 }
 
-Program* Program::ReadFrom(Reader* reader) {
+// Reads libraries of a program with a [ProgramIndex], claiming them one at
+// a time from a shared counter.  Each task allocates into an arena of its
+// own, which the program adopts once the task is done.
+class LibraryReaderTask : public ThreadPool::Task {
+ public:
+  LibraryReaderTask(Program* program,
+                    const uint8_t* buffer,
+                    long size,
+                    ProgramIndex* index,
+                    uintptr_t* next_library,
+                    Monitor* monitor,
+                    intptr_t* pending_tasks)
+      : program_(program),
+        buffer_(buffer),
+        size_(size),
+        index_(index),
+        next_library_(next_library),
+        monitor_(monitor),
+        pending_tasks_(pending_tasks) {}
+
+  virtual void Run() {
+    ReadLibraries();
+    MonitorLocker ml(monitor_);
+    program_->arena()->Adopt(&arena_);
+    (*pending_tasks_)--;
+    ml.Notify();
+  }
+
+  Arena* arena() { return &arena_; }
+
+  void ReadLibraries() {
+    std::vector<ProgramIndex::LibraryEntry>& entries = index_->libraries();
+    while (true) {
+      uintptr_t i = AtomicOperations::FetchAndIncrement(next_library_);
+      if (i >= entries.size()) break;
+
+      // Every library starts with empty scopes, so each one gets a fresh
+      // reader.  All nodes it can reference already exist, see
+      // [ProgramIndex::CreateSkeleton].
+      Reader reader(buffer_, size_);
+      reader.helper()->set_program(program_);
+      reader.set_index(index_);
+      reader.set_arena(&arena_);
+      reader.set_offset(entries[i].offset);
+      program_->libraries()[i]->ReadFrom(&reader);
+    }
+  }
+
+ private:
+  Program* program_;
+  const uint8_t* buffer_;
+  long size_;
+  ProgramIndex* index_;
+  uintptr_t* next_library_;
+  Monitor* monitor_;
+  intptr_t* pending_tasks_;
+  Arena arena_;
+
+  DISALLOW_COPY_AND_ASSIGN(LibraryReaderTask);
+};
+
+Program* Program::ReadFrom(Reader* reader, intptr_t num_tasks) {
   TRACE_READ_OFFSET();
   uint32_t magic = reader->ReadUInt32();
   if (magic != kMagicProgramFile) FATAL("Invalid magic identifier");
@@ -2729,13 +3108,69 @@ Program* Program::ReadFrom(Reader* reader) {
   program->source_uri_table_.ReadFrom(reader);
   program->line_starting_table_.ReadFrom(reader);
 
-  int libraries = reader->ReadUInt();
-  program->libraries().EnsureInitialized(libraries);
-  for (int i = 0; i < libraries; i++) {
-    program->libraries().GetOrCreate<Library>(i)->ReadFrom(reader);
+  ProgramIndex index;
+  if (!index.ReadFrom(reader)) {
+    int libraries = reader->ReadUInt();
+    program->libraries().EnsureInitialized(reader->arena(), libraries);
+    for (int i = 0; i < libraries; i++) {
+      program->libraries().GetOrCreate<Library>(reader->arena(), i)->ReadFrom(reader);
+    }
+    program->main_method_ = Procedure::Cast(Reference::ReadMemberFrom(reader));
+    return program;
+  }
+
+  // With an index we can skip member bodies now and read them on demand, out
+  // of the caller's buffer.  The caller keeps it alive as long as the
+  // program, see [ReadPrecompiledDilFromBuffer].
+  program->buffer_ = reader->buffer();
+  program->buffer_length_ = reader->size();
+  reader->set_index(&index);
+
+  intptr_t library_count = reader->ReadUInt();
+  ASSERT(library_count == static_cast<intptr_t>(index.libraries().size()));
+  if (num_tasks > library_count - 1) num_tasks = library_count - 1;
+  ThreadPool* pool = Dart::thread_pool();
+  if (num_tasks <= 0 || pool == NULL) {
+    for (intptr_t i = 0; i < library_count; i++) {
+      program->libraries().GetOrCreate<Library>(reader->arena(), i)->ReadFrom(reader);
+    }
+  } else {
+    // Libraries only reference each other through nodes which we create
+    // upfront, so they can be read concurrently.  The current thread reads
+    // libraries as well and then waits for the helpers.
+    index.CreateSkeleton(program);
+    uintptr_t next_library = 0;
+    Monitor monitor;
+    intptr_t pending_tasks = num_tasks;
+    for (intptr_t i = 0; i < num_tasks; i++) {
+      pool->Run(new LibraryReaderTask(program,
+                                      program->buffer_,
+                                      program->buffer_length_,
+                                      &index,
+                                      &next_library,
+                                      &monitor,
+                                      &pending_tasks));
+    }
+    LibraryReaderTask task(program,
+                           program->buffer_,
+                           program->buffer_length_,
+                           &index,
+                           &next_library,
+                           &monitor,
+                           &pending_tasks);
+    task.ReadLibraries();
+    {
+      MonitorLocker ml(&monitor);
+      program->arena()->Adopt(task.arena());
+      while (pending_tasks > 0) {
+        ml.Wait();
+      }
+    }
+    reader->set_offset(index.libraries_end());
   }
 
   program->main_method_ = Procedure::Cast(Reference::ReadMemberFrom(reader));
+  reader->set_index(NULL);
 
   return program;
 }
@@ -2743,7 +3178,8 @@ Program* Program::ReadFrom(Reader* reader) {
 void Program::WriteTo(Writer* writer) {
   TRACE_WRITE_OFFSET();
 
-  writer->helper()->SetProgram(this);
+  WriterHelper* helper = writer->helper();
+  helper->SetProgram(this);
 
   writer->WriteUInt32(kMagicProgramFile);
 
@@ -2757,15 +3193,51 @@ void Program::WriteTo(Writer* writer) {
   source_uri_table_.WriteTo(writer);
   line_starting_table_.WriteTo(writer);
 
-  libraries_.WriteTo(writer);
+  writer->WriteListLength(libraries_.length());
+  for (int i = 0; i < libraries_.length(); i++) {
+    helper->library_offsets().push_back(writer->offset());
+    libraries_[i]->WriteTo(writer);
+  }
+  long libraries_end = writer->offset();
   Reference::WriteMemberTo(writer, main_method_);
+
+  // Append the [ProgramIndex].
+  long index_offset = writer->offset();
+  std::vector<std::pair<long, long> >& bodies = helper->function_bodies();
+  writer->WriteUInt32(bodies.size());
+  for (size_t i = 0; i < bodies.size(); i++) {
+    writer->WriteUInt32(bodies[i].first);
+    writer->WriteUInt32(bodies[i].second);
+  }
+  writer->WriteUInt32(libraries_.length());
+  for (int i = 0; i < libraries_.length(); i++) {
+    Library* library = libraries_[i];
+    writer->WriteUInt32(helper->library_offsets()[i]);
+    writer->WriteUInt32(library->classes().length());
+    for (int j = 0; j < library->classes().length(); j++) {
+      Class* klass = library->classes()[j];
+      writer->WriteUInt32(klass->IsNormalClass() ? kNormalClass : kMixinClass);
+      writer->WriteUInt32(klass->fields().length());
+      writer->WriteUInt32(klass->constructors().length());
+      writer->WriteUInt32(klass->procedures().length());
+    }
+    writer->WriteUInt32(library->fields().length());
+    writer->WriteUInt32(library->procedures().length());
+  }
+  writer->WriteUInt32(libraries_end);
+  writer->WriteUInt32(index_offset);
+  writer->WriteUInt32(kMagicProgramIndex);
 }
 
 FunctionNode* FunctionNode::ReadFrom(Reader* reader) {
+  return ReadFrom(reader, NULL);
+}
+
+FunctionNode* FunctionNode::ReadFrom(Reader* reader, Member* member) {
   TRACE_READ_OFFSET();
   TypeParameterScope<ReaderHelper> scope(reader->helper());
 
-  FunctionNode* function = new FunctionNode();
+  FunctionNode* function = new(reader->arena()) FunctionNode();
   function->async_marker_ = static_cast<FunctionNode::AsyncMarker>(reader->ReadByte());
   function->type_parameters().ReadFrom(reader);
   function->required_parameter_count_ = reader->ReadUInt();
@@ -2774,6 +3246,17 @@ FunctionNode* FunctionNode::ReadFrom(Reader* reader) {
   function->return_type_ = DartType::ReadFrom(reader);
   function->inferred_return_value_ = reader->ReadOptional<InferredValue>();
 
+  Program* program = reader->helper()->program();
+  if (member != NULL && program->buffer() != NULL) {
+    intptr_t offset = reader->offset();
+    if (reader->SkipIndexedFunctionBody()) {
+      TreeNode* parent = member->parent();
+      Class* klass = parent->IsClass() ? Class::Cast(parent) : NULL;
+      function->lazy_body_ = new(reader->arena()) LazyBody(program, klass, offset);
+      return function;
+    }
+  }
+
   LabelScope<ReaderHelper, BlockStack<LabeledStatement> > labels(
       reader->helper());
   VariableScope<ReaderHelper> vars(reader->helper());
@@ -2781,7 +3264,50 @@ FunctionNode* FunctionNode::ReadFrom(Reader* reader) {
   return function;
 }
 
+void FunctionNode::ReadLazyBody() {
+  TRACE_READ_OFFSET();
+  LazyBody* lazy = lazy_body_;
+  lazy_body_ = NULL;
+
+  Program* program = lazy->program();
+  Reader reader(program->buffer(), program->buffer_length());
+  reader.set_offset(lazy->offset());
+  ReaderHelper* helper = reader.helper();
+  helper->set_program(program);
+
+  // Recreate the scopes which were active when the body was skipped: the
+  // type parameters of the enclosing class and of the function, and the
+  // function's parameters.
+  TypeParameterScope<ReaderHelper> class_scope(helper);
+  if (lazy->klass() != NULL) {
+    List<TypeParameter>& class_type_parameters =
+        lazy->klass()->type_parameters();
+    for (int i = 0; i < class_type_parameters.length(); i++) {
+      helper->type_parameters().Push(class_type_parameters[i]);
+    }
+  }
+  TypeParameterScope<ReaderHelper> function_scope(helper);
+  for (int i = 0; i < type_parameters().length(); i++) {
+    helper->type_parameters().Push(type_parameters()[i]);
+  }
+  VariableScope<ReaderHelper> parameters(helper);
+  for (int i = 0; i < positional_parameters().length(); i++) {
+    helper->variables().Push(positional_parameters()[i]);
+  }
+  for (int i = 0; i < named_parameters().length(); i++) {
+    helper->variables().Push(named_parameters()[i]);
+  }
+
+  LabelScope<ReaderHelper, BlockStack<LabeledStatement> > labels(helper);
+  VariableScope<ReaderHelper> vars(helper);
+  body_ = reader.ReadOptional<Statement>();
+}
+
 void FunctionNode::WriteTo(Writer* writer) {
+  WriteTo(writer, false);
+}
+
+void FunctionNode::WriteTo(Writer* writer, bool is_member) {
   TRACE_WRITE_OFFSET();
   TypeParameterScope<WriterHelper> scope(writer->helper());
 
@@ -2796,7 +3322,12 @@ void FunctionNode::WriteTo(Writer* writer) {
   LabelScope<WriterHelper, BlockMap<LabeledStatement> > labels(
       writer->helper());
   VariableScope<WriterHelper> vars(writer->helper());
-  writer->WriteOptional<Statement>(body_);
+  long start = writer->offset();
+  writer->WriteOptional<Statement>(body());
+  if (is_member) {
+    writer->helper()->function_bodies().push_back(
+        std::make_pair(start, writer->offset()));
+  }
 }
 
 TypeParameter* TypeParameter::ReadFrom(Reader* reader) {
@@ -2819,16 +3350,24 @@ dil::Program* ReadPrecompiledDil(const char* filename) {
     InputFile file(filename);
     if (file.ReadAll()) {
 			dil::Reader reader(file.buffer(), file.size());
-      return dil::Program::ReadFrom(&reader);
+      dil::Program* program = dil::Program::ReadFrom(&reader);
+      if (program->buffer() != NULL) {
+        // Some function bodies are still to be read from the file.
+        program->AdoptBuffer(file.mapped() ? InputFile::Unmap
+                                           : InputFile::Delete);
+        file.Release();
+      }
+      return program;
     }
   }
   return NULL;
 }
 
 dil::Program* ReadPrecompiledDilFromBuffer(const uint8_t* buffer,
-                                           intptr_t buffer_length) {
+                                           intptr_t buffer_length,
+                                           intptr_t num_tasks) {
   dil::Reader reader(buffer, buffer_length);
-  return dil::Program::ReadFrom(&reader);
+  return dil::Program::ReadFrom(&reader, num_tasks);
 }
 
 bool WritePrecompiledDil(const char* filename, dil::Program* program) {
@@ -0,0 +1,62 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include <stdlib.h>
+#include <unistd.h>
+
+#include "platform/assert.h"
+#include "vm/dil.h"
+#include "vm/os.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+static const intptr_t kProcedureCount = 20;
+
+
+static void ExpectBodies(dil::Program* program) {
+  dil::Library* library = program->libraries()[0];
+  EXPECT_EQ(kProcedureCount, library->procedures().length());
+  for (intptr_t i = 0; i < kProcedureCount; i++) {
+    dil::Statement* body = library->procedures()[i]->function()->body();
+    dil::ReturnStatement* ret = dil::ReturnStatement::Cast(body);
+    dil::IntLiteral* literal = dil::IntLiteral::Cast(ret->expression());
+    // See [WriteDilProgram].
+    EXPECT_EQ((i & 7) - 3, literal->value());
+  }
+}
+
+
+// Writing a program appends the index of member bodies. Reading it back
+// skips the bodies and reads them out of the mapped file on first use.
+TEST_CASE(DilReadIndexedProgram) {
+  DilBufferWriter writer;
+  WriteDilProgram(&writer, kProcedureCount);
+  dil::Program* program =
+      ReadPrecompiledDilFromBuffer(writer.buffer(), writer.length());
+  ASSERT(program != NULL);
+  // Without an index all bodies are read eagerly.
+  EXPECT(program->buffer() == NULL);
+  ExpectBodies(program);
+
+  const char* temp_dir = getenv("TMPDIR");
+  if (temp_dir == NULL) temp_dir = "/tmp";
+  char* filename = OS::SCreate(NULL, "%s/dil_binary_test_%" Pd ".dil",
+                               temp_dir, static_cast<intptr_t>(getpid()));
+  EXPECT(WritePrecompiledDil(filename, program));
+  delete program;
+
+  dil::Program* indexed = ReadPrecompiledDil(filename);
+  // The program owns the file contents now, so the file itself can go.
+  unlink(filename);
+  free(filename);
+  ASSERT(indexed != NULL);
+  EXPECT(indexed->buffer() != NULL);
+  ExpectBodies(indexed);
+  // Bodies which have been read are not read again.
+  ExpectBodies(indexed);
+  delete indexed;
+}
+
+}  // namespace dart
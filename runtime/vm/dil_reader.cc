@@ -7,12 +7,18 @@
 #include <string.h>
 
 #include "vm/dart_api_impl.h"
+#include "vm/flags.h"
 #include "vm/longjump.h"
 #include "vm/object_store.h"
 #include "vm/parser.h"
 #include "vm/symbols.h"
 
 namespace dart {
+
+DEFINE_FLAG(int, dil_reader_tasks, 0,
+            "The number of helper tasks used to read the libraries of an "
+            "indexed kernel program (0 means read on the main thread only).");
+
 namespace dil {
 
 #define Z (zone_)
@@ -98,7 +104,8 @@ RawClass* BuildingTranslationHelper::LookupClassByDilClass(Class* klass) {
 }
 
 Program* DilReader::ReadPrecompiledProgram() {
-  Program* program = ReadPrecompiledDilFromBuffer(buffer_, buffer_length_);
+  Program* program = ReadPrecompiledDilFromBuffer(buffer_, buffer_length_,
+                                                  FLAG_dil_reader_tasks);
   if (program == NULL) return NULL;
   intptr_t source_file_count = program->line_starting_table().size();
   scripts_ = Array::New(source_file_count);
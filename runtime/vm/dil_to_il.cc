@@ -223,9 +223,46 @@ static bool IsStaticInitializer(const Function& function, Zone* zone) {
 }
 
 
+static FunctionNode* FunctionNodeOf(TreeNode* node) {
+  if (node == NULL) return NULL;
+  if (node->IsProcedure()) return Procedure::Cast(node)->function();
+  if (node->IsConstructor()) return Constructor::Cast(node)->function();
+  if (node->IsFunctionNode()) return FunctionNode::Cast(node);
+  return NULL;
+}
+
+
+bool HasLazyBody(TreeNode* node) {
+  FunctionNode* function = FunctionNodeOf(node);
+  return (function != NULL) && function->has_lazy_body();
+}
+
+
+void ReadLazyBody(const dart::Function& function) {
+  ASSERT(Thread::Current()->IsMutatorThread());
+  if (function.dil_function() == 0) return;
+  FunctionNode* node =
+      FunctionNodeOf(reinterpret_cast<TreeNode*>(function.dil_function()));
+  if (node != NULL) node->body();
+}
+
+
+// Background compilations leave functions whose body has not been read yet
+// to the mutator, which is the only thread allowed to read it. This also
+// covers the callees considered for inlining.
+static void AbortIfLazyBody(TreeNode* node) {
+  if (Compiler::IsBackgroundCompilation() && HasLazyBody(node)) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Function body not read yet");
+  }
+}
+
+
 ScopeBuildingResult* ScopeBuilder::BuildScopes() {
   if (result_ != NULL) return result_;
 
+  AbortIfLazyBody(node_);
+
   ASSERT(scope_ == NULL && depth_.loop_ == 0 && depth_.function_ == 0);
   result_ = new(Z) ScopeBuildingResult();
 
@@ -1355,6 +1392,10 @@ RawObject* ConstantEvaluator::EvaluateConstConstructorCall(
   arg_values.SetAt((0 + kNumExtraArgs), argument);
   const Array& args_descriptor = Array::Handle(Z,
       ArgumentsDescriptor::New(num_arguments, Object::empty_array()));
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Constant evaluated while compiling");
+  }
   const Object& result = Object::Handle(Z,
       DartEntry::InvokeFunction(constructor, arg_values, args_descriptor));
   ASSERT(!result.IsError());
@@ -1709,6 +1750,10 @@ const Object& ConstantEvaluator::RunFunction(const Function& function,
                                              const Array& names) {
   const Array& args_descriptor = Array::Handle(Z,
       ArgumentsDescriptor::New(arguments.Length(), names));
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Constant evaluated while compiling");
+  }
   const Object& result = Object::Handle(Z,
       DartEntry::InvokeFunction(function, arguments, args_descriptor));
   if (result.IsError()) {
@@ -2725,6 +2770,8 @@ FlowGraph* FlowGraphBuilder::BuildGraph() {
 
   if (function.IsConstructorClosureFunction()) return NULL;
 
+  AbortIfLazyBody(node_);
+
   dart::Class& klass = dart::Class::Handle(zone_,
       parsed_function_->function().Owner());
 
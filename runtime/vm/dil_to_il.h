@@ -860,6 +860,15 @@ class FlowGraphBuilder : public TreeVisitor {
   friend class TryFinallyBlock;
 };
 
+// Member bodies are deserialized on first use, which must happen on the
+// mutator thread (see FunctionNode::body()). Returns whether the body of the
+// function 'node' has not been deserialized yet.
+bool HasLazyBody(TreeNode* node);
+
+// Deserializes the body of 'function' if it is a member whose body has not
+// been deserialized yet, so that it can be compiled on another thread.
+void ReadLazyBody(const dart::Function& function);
+
 }  // namespace dil
 }  // namespace dart
 
@@ -0,0 +1,389 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/dispatch_table.h"
+
+#include "vm/cha.h"
+#include "vm/class_table.h"
+#include "vm/dart_entry.h"
+#include "vm/growable_array.h"
+#include "vm/hash_table.h"
+#include "vm/isolate.h"
+#include "vm/object.h"
+#include "vm/object_store.h"
+#include "vm/os.h"
+#include "vm/resolver.h"
+#include "vm/symbols.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, use_dispatch_table, false,
+    "Dispatch megamorphic instance calls through a table indexed by the "
+    "class id of the receiver.");
+
+// The class ids of the receivers of one selector, in increasing order, with
+// their targets.
+struct DispatchRow : public ZoneAllocated {
+  const String* name;
+  const Array* descriptor;
+  GrowableArray<intptr_t> cids;
+  GrowableArray<const Function*> targets;
+};
+
+
+static void CollectTargets(Thread* thread, DispatchRow* row) {
+  Zone* zone = thread->zone();
+  const String& name = *row->name;
+  // Resolving a closurizing getter ("get:#...") creates a method extractor.
+  if (Field::IsGetterName(name) &&
+      (name.Length() > Symbols::GetterPrefix().Length()) &&
+      (name.CharAt(Symbols::GetterPrefix().Length()) == '#')) {
+    return;
+  }
+
+  ClassTable* class_table = thread->isolate()->class_table();
+  const intptr_t num_cids = class_table->NumCids();
+
+  // Only the concrete subclasses of the classes declaring a function of that
+  // name can have a target. CHA does not track the subclasses of Object, in
+  // which case all classes are candidates.
+  bool* is_candidate = zone->Alloc<bool>(num_cids);
+  for (intptr_t cid = 0; cid < num_cids; cid++) {
+    is_candidate[cid] = false;
+  }
+  bool all_classes = false;
+  {
+    CHA cha(thread);
+    GrowableArray<intptr_t> subclasses;
+    Class& cls = Class::Handle(zone);
+    Function& function = Function::Handle(zone);
+    for (intptr_t cid = kIllegalCid + 1;
+         (cid < num_cids) && !all_classes;
+         cid++) {
+      if (!class_table->HasValidClassAt(cid)) continue;
+      cls = class_table->At(cid);
+      if (!cls.is_finalized()) continue;
+      function = cls.LookupDynamicFunction(name);
+      if (function.IsNull()) continue;
+      subclasses.Clear();
+      if (!cha.ConcreteSubclasses(cls, &subclasses)) {
+        all_classes = true;
+        break;
+      }
+      for (intptr_t i = 0; i < subclasses.length(); i++) {
+        is_candidate[subclasses[i]] = true;
+      }
+    }
+  }
+
+  ArgumentsDescriptor args_desc(*row->descriptor);
+  Class& cls = Class::Handle(zone);
+  Function& target = Function::Handle(zone);
+  for (intptr_t cid = kIllegalCid + 1; cid < num_cids; cid++) {
+    if (!all_classes && !is_candidate[cid]) continue;
+    if (!class_table->HasValidClassAt(cid)) continue;
+    cls = class_table->At(cid);
+    if (!cls.is_finalized() || cls.is_abstract()) continue;
+    target = Resolver::ResolveDynamicForReceiverClass(
+        cls, name, args_desc, /* allow_add = */ false);
+    if (target.IsNull()) continue;
+    if (FLAG_precompiled_mode && !target.HasCode()) continue;
+    row->cids.Add(cid);
+    row->targets.Add(&Function::ZoneHandle(zone, target.raw()));
+  }
+}
+
+
+// The first entry of a row is reserved by the row itself, so that no two rows
+// have the same offset: no receiver has kIllegalCid.
+static bool RowFits(const Array& table,
+                    intptr_t offset,
+                    const GrowableArray<intptr_t>& cids) {
+  const intptr_t length = table.Length();
+  if ((offset < length) && (table.At(offset) != Object::null())) {
+    return false;
+  }
+  for (intptr_t i = 0; i < cids.length(); i++) {
+    const intptr_t index = offset + DispatchTable::kEntryLength * cids[i];
+    if (index >= length) {
+      break;
+    }
+    if (table.At(index) != Object::null()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+
+static intptr_t PlaceRow(Isolate* isolate, const DispatchRow& row) {
+  if (row.cids.is_empty()) {
+    return DispatchTable::kNoOffset;
+  }
+  ObjectStore* object_store = isolate->object_store();
+  Array& table = Array::Handle(object_store->dispatch_table());
+  if (table.IsNull()) {
+    table = Object::empty_array().raw();
+  }
+
+  // First fit.
+  intptr_t offset = 0;
+  while (!RowFits(table, offset, row.cids)) {
+    offset += DispatchTable::kEntryLength;
+  }
+
+  const intptr_t length =
+      offset + DispatchTable::kEntryLength * (row.cids.Last() + 1);
+  if (length > table.Length()) {
+    const intptr_t new_length = Utils::RoundUp(
+        Utils::Maximum(length, table.Length() + (table.Length() >> 1)),
+        DispatchTable::kEntryLength);
+    table = Array::Grow(table, new_length, Heap::kOld);
+  }
+
+  // Store the target of an entry before the offset that validates it.
+  const Smi& key = Smi::Handle(Smi::New(offset));
+  for (intptr_t i = 0; i < row.cids.length(); i++) {
+    const intptr_t index = offset + DispatchTable::kEntryLength * row.cids[i];
+    table.SetAt(index + 1, *row.targets[i]);
+    table.SetAt(index, key);
+  }
+  table.SetAt(offset, key);
+  object_store->set_dispatch_table(table);
+  return offset;
+}
+
+
+// A selector being looked up, without allocating its key.
+class SelectorKey : public ValueObject {
+ public:
+  SelectorKey(const String& name, const Array& descriptor)
+      : name_(name), descriptor_(descriptor) {}
+
+  const String& name() const { return name_; }
+  const Array& descriptor() const { return descriptor_; }
+
+ private:
+  const String& name_;
+  const Array& descriptor_;
+};
+
+
+// Selector keys are (name, arguments descriptor) pairs of a symbol and a
+// canonical descriptor, so they are compared by identity.
+class SelectorTraits {
+ public:
+  enum {
+    kNameIndex = 0,
+    kDescriptorIndex,
+    kKeyLength,
+  };
+
+  static const char* Name() { return "SelectorTraits"; }
+  static bool ReportStats() { return false; }
+
+  static bool IsMatch(const SelectorKey& key, const Object& obj) {
+    const Array& pair = Array::Cast(obj);
+    return (pair.At(kNameIndex) == key.name().raw()) &&
+           (pair.At(kDescriptorIndex) == key.descriptor().raw());
+  }
+  static bool IsMatch(const Object& a, const Object& b) {
+    const Array& a_pair = Array::Cast(a);
+    const Array& b_pair = Array::Cast(b);
+    return (a_pair.At(kNameIndex) == b_pair.At(kNameIndex)) &&
+           (a_pair.At(kDescriptorIndex) == b_pair.At(kDescriptorIndex));
+  }
+
+  static uword Hash(const SelectorKey& key) {
+    return Hash(key.name(), key.descriptor());
+  }
+  static uword Hash(const Object& obj) {
+    const Array& pair = Array::Cast(obj);
+    return Hash(String::Handle(String::RawCast(pair.At(kNameIndex))),
+                Array::Handle(Array::RawCast(pair.At(kDescriptorIndex))));
+  }
+
+  static RawObject* NewKey(const SelectorKey& key) {
+    const Array& pair = Array::Handle(Array::New(kKeyLength, Heap::kOld));
+    pair.SetAt(kNameIndex, key.name());
+    pair.SetAt(kDescriptorIndex, key.descriptor());
+    return pair.raw();
+  }
+
+ private:
+  // Descriptors move, so their address can not be hashed.
+  static uword Hash(const String& name, const Array& descriptor) {
+    ArgumentsDescriptor args_desc(descriptor);
+    return name.Hash() * 31 + args_desc.Count() * 7 + args_desc.NamedCount();
+  }
+};
+typedef UnorderedHashMap<SelectorTraits> SelectorMap;
+
+
+bool DispatchTable::FindSelector(Isolate* isolate,
+                                 const String& name,
+                                 const Array& descriptor,
+                                 intptr_t* offset) {
+  ObjectStore* object_store = isolate->object_store();
+  if (object_store->dispatch_table_selectors() == Array::null()) {
+    return false;
+  }
+  SelectorMap selectors(object_store->dispatch_table_selectors());
+  bool present = false;
+  const Object& value = Object::Handle(
+      selectors.GetOrNull(SelectorKey(name, descriptor), &present));
+  ASSERT(selectors.Release().raw() ==
+         object_store->dispatch_table_selectors());
+  if (present) {
+    *offset = Smi::Cast(value).Value();
+  }
+  return present;
+}
+
+
+void DispatchTable::RecordSelector(Isolate* isolate,
+                                   const String& name,
+                                   const Array& descriptor,
+                                   intptr_t offset) {
+  ObjectStore* object_store = isolate->object_store();
+  if (object_store->dispatch_table_selectors() == Array::null()) {
+    object_store->set_dispatch_table_selectors(Array::Handle(
+        HashTables::New<SelectorMap>(16, Heap::kOld)));
+  }
+  SelectorMap selectors(object_store->dispatch_table_selectors());
+  selectors.InsertNewOrGetValue(SelectorKey(name, descriptor),
+                                Smi::Handle(Smi::New(offset)));
+  object_store->set_dispatch_table_selectors(selectors.Release());
+}
+
+
+intptr_t DispatchTable::LookupOffset(Isolate* isolate,
+                                     const String& name,
+                                     const Array& descriptor) {
+  intptr_t offset = kNoOffset;
+  FindSelector(isolate, name, descriptor, &offset);
+  return offset;
+}
+
+
+intptr_t DispatchTable::BuildRow(Isolate* isolate,
+                                 const String& name,
+                                 const Array& descriptor) {
+  DispatchRow row;
+  row.name = &name;
+  row.descriptor = &descriptor;
+  CollectTargets(Thread::Current(), &row);
+  return PlaceRow(isolate, row);
+}
+
+
+intptr_t DispatchTable::AddSelector(Isolate* isolate,
+                                    const String& name,
+                                    const Array& descriptor) {
+  intptr_t offset = kNoOffset;
+  if (!FindSelector(isolate, name, descriptor, &offset)) {
+    offset = BuildRow(isolate, name, descriptor);
+    RecordSelector(isolate, name, descriptor, offset);
+  }
+  return offset;
+}
+
+
+static int CompareRowSizes(DispatchRow* const* a, DispatchRow* const* b) {
+  // Largest first.
+  return (*b)->cids.length() - (*a)->cids.length();
+}
+
+
+void DispatchTable::AddSelectors(Isolate* isolate,
+                                 const GrowableObjectArray& selectors) {
+  Thread* thread = Thread::Current();
+  Zone* zone = thread->zone();
+  GrowableArray<DispatchRow*> rows;
+  intptr_t offset = kNoOffset;
+  for (intptr_t i = 0; i < selectors.Length(); i += 2) {
+    String& name = String::ZoneHandle(zone);
+    Array& descriptor = Array::ZoneHandle(zone);
+    name ^= selectors.At(i);
+    descriptor ^= selectors.At(i + 1);
+    if (FindSelector(isolate, name, descriptor, &offset)) {
+      continue;
+    }
+    DispatchRow* row = new(zone) DispatchRow();
+    row->name = &name;
+    row->descriptor = &descriptor;
+    CollectTargets(thread, row);
+    rows.Add(row);
+  }
+  rows.Sort(CompareRowSizes);
+  for (intptr_t i = 0; i < rows.length(); i++) {
+    const DispatchRow& row = *rows[i];
+    offset = PlaceRow(isolate, row);
+    RecordSelector(isolate, *row.name, *row.descriptor, offset);
+  }
+}
+
+
+void DispatchTable::UpdateMegamorphicCaches(Isolate* isolate) {
+  const GrowableObjectArray& caches = GrowableObjectArray::Handle(
+      isolate->object_store()->megamorphic_cache_table());
+  if (caches.IsNull()) {
+    return;
+  }
+  MegamorphicCache& cache = MegamorphicCache::Handle();
+  String& name = String::Handle();
+  Array& descriptor = Array::Handle();
+  for (intptr_t i = 0; i < caches.Length(); i++) {
+    cache ^= caches.At(i);
+    name = cache.target_name();
+    descriptor = cache.arguments_descriptor();
+    cache.set_dispatch_offset(LookupOffset(isolate, name, descriptor));
+  }
+}
+
+
+void DispatchTable::Reset(Isolate* isolate) {
+  ObjectStore* object_store = isolate->object_store();
+  const GrowableObjectArray& caches = GrowableObjectArray::Handle(
+      object_store->megamorphic_cache_table());
+  if (!caches.IsNull()) {
+    MegamorphicCache& cache = MegamorphicCache::Handle();
+    for (intptr_t i = 0; i < caches.Length(); i++) {
+      cache ^= caches.At(i);
+      cache.set_dispatch_offset(kNoOffset);
+    }
+  }
+  object_store->set_dispatch_table(Array::Handle());
+  object_store->set_dispatch_table_selectors(Array::Handle());
+}
+
+
+void DispatchTable::PrintSizes(Isolate* isolate) {
+  StackZone zone(Thread::Current());
+  ObjectStore* object_store = isolate->object_store();
+  const Array& table = Array::Handle(object_store->dispatch_table());
+  if (table.IsNull() ||
+      (object_store->dispatch_table_selectors() == Array::null())) {
+    return;
+  }
+  SelectorMap selectors(object_store->dispatch_table_selectors());
+  const intptr_t num_selectors = selectors.NumOccupied();
+  selectors.Release();
+  intptr_t used_entries = 0;
+  for (intptr_t i = 0; i < table.Length(); i += kEntryLength) {
+    if (table.At(i + 1) != Object::null()) {
+      used_entries++;
+    }
+  }
+  const intptr_t num_entries = table.Length() / kEntryLength;
+  OS::Print("Dispatch table with %" Pd " selectors using %" Pd "KB: "
+            "%" Pd " of %" Pd " entries used (%lf).\n",
+            num_selectors,
+            Array::InstanceSize(table.Length()) / KB,
+            used_entries, num_entries,
+            static_cast<double>(used_entries) /
+            static_cast<double>(num_entries));
+}
+
+}  // namespace dart
@@ -0,0 +1,85 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_DISPATCH_TABLE_H_
+#define VM_DISPATCH_TABLE_H_
+
+#include "vm/allocation.h"
+#include "vm/flags.h"
+
+namespace dart {
+
+class Array;
+class GrowableObjectArray;
+class Isolate;
+class String;
+
+DECLARE_FLAG(bool, use_dispatch_table);
+
+// The dispatch table is shared by the megamorphic instance calls of all
+// selectors (a target name with an arguments descriptor). Each selector owns
+// a row of the table, and the target for a receiver class id 'cid' is stored
+// at entry 'offset + 2 * cid' as a pair (offset, target function). Rows are
+// displaced into each other's holes, so an entry may belong to another row;
+// the megamorphic call stub compares the offset of the entry with the one of
+// its selector, and falls back to the megamorphic cache on a mismatch.
+//
+// Rows are built from the class hierarchy when the selector is added and are
+// not updated afterwards: receivers of classes finalized later, receivers
+// dispatching to noSuchMethod and lazily created method extractors all take
+// the megamorphic cache path.
+class DispatchTable : public AllStatic {
+ public:
+  static const intptr_t kNoOffset = -1;
+  // The row of a selector is built by the mutator on the first miss of its
+  // megamorphic cache, since resolving targets may allocate.
+  static const intptr_t kUnbuiltOffset = -2;
+
+  // Entries are (row offset, target function) pairs.
+  static const intptr_t kEntryLength = 2;
+
+  // Returns the offset of the selector's row, or kNoOffset if it has none.
+  static intptr_t LookupOffset(Isolate* isolate,
+                               const String& name,
+                               const Array& descriptor);
+
+  // Builds the row of the selector if it has none yet and returns its offset.
+  // Returns kNoOffset if no class implements the selector.
+  static intptr_t AddSelector(Isolate* isolate,
+                              const String& name,
+                              const Array& descriptor);
+
+  // Builds the rows of 'selectors', a list of (name, arguments descriptor)
+  // pairs. Placing the largest rows first packs the table more densely.
+  static void AddSelectors(Isolate* isolate,
+                           const GrowableObjectArray& selectors);
+
+  // Sets the dispatch offset of the existing megamorphic caches.
+  static void UpdateMegamorphicCaches(Isolate* isolate);
+
+  // Drops all rows, after detaching them from the existing megamorphic
+  // caches.
+  static void Reset(Isolate* isolate);
+
+  static void PrintSizes(Isolate* isolate);
+
+ private:
+  // Selectors are recorded in a hash table mapping (name, arguments
+  // descriptor) keys to the offsets of their rows.
+  static bool FindSelector(Isolate* isolate,
+                           const String& name,
+                           const Array& descriptor,
+                           intptr_t* offset);
+  static intptr_t BuildRow(Isolate* isolate,
+                           const String& name,
+                           const Array& descriptor);
+  static void RecordSelector(Isolate* isolate,
+                             const String& name,
+                             const Array& descriptor,
+                             intptr_t offset);
+};
+
+}  // namespace dart
+
+#endif  // VM_DISPATCH_TABLE_H_
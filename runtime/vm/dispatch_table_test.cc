@@ -0,0 +1,116 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "platform/assert.h"
+#include "vm/dart_api_impl.h"
+#include "vm/dart_entry.h"
+#include "vm/dispatch_table.h"
+#include "vm/object.h"
+#include "vm/os.h"
+#include "vm/symbols.h"
+#include "vm/unit_test.h"
+
+namespace dart {
+
+// Megamorphic calls, with and without named arguments, dispatched through the
+// dispatch table once the loop is optimized.
+TEST_CASE(DispatchTableMegamorphicCall) {
+  const char* kScriptChars =
+      "class A0 { int foo() => 0; int bar(x, {y: 0}) => x + y; }\n"
+      "class A1 { int foo() => 1; int bar(x, {y: 0}) => x + y + 1; }\n"
+      "class A2 { int foo() => 2; int bar(x, {y: 0}) => x + y + 2; }\n"
+      "class A3 { int foo() => 3; int bar(x, {y: 0}) => x + y + 3; }\n"
+      "class A4 { int foo() => 4; int bar(x, {y: 0}) => x + y + 4; }\n"
+      "class A5 { int foo() => 5; int bar(x, {y: 0}) => x + y + 5; }\n"
+      "class A6 { int foo() => 6; int bar(x, {y: 0}) => x + y + 6; }\n"
+      "class A7 { int foo() => 7; int bar(x, {y: 0}) => x + y + 7; }\n"
+      "class A8 extends A0 { int foo() => 8; }\n"
+      "class A9 extends A1 { }\n"
+      "\n"
+      "int test(int count) {\n"
+      "  var receivers = [new A0(), new A1(), new A2(), new A3(), new A4(),\n"
+      "                   new A5(), new A6(), new A7(), new A8(), new A9()];\n"
+      "  int sum = 0;\n"
+      "  for (int i = 0; i < count; i++) {\n"
+      "    var receiver = receivers[i % receivers.length];\n"
+      "    sum += receiver.foo() + receiver.bar(1, y: 2);\n"
+      "  }\n"
+      "  return sum;\n"
+      "}\n";
+  // Every 10 receivers, foo() sums up to 37 and bar(1, y: 2) to 59.
+  const int kCount = 1000;
+  const int64_t kExpected = (kCount / 10) * (37 + 59);
+
+  const bool old_dispatch_table = FLAG_use_dispatch_table;
+  const bool old_background_compilation = FLAG_background_compilation;
+  const int old_threshold = FLAG_optimization_counter_threshold;
+  FLAG_use_dispatch_table = true;
+  FLAG_background_compilation = false;
+  FLAG_optimization_counter_threshold = 100;
+
+  Dart_Handle lib = TestCase::LoadTestScript(kScriptChars, NULL);
+  EXPECT_VALID(lib);
+  Dart_Handle args[1];
+  args[0] = Dart_NewInteger(kCount);
+  // The first run optimizes the loop, the second one only runs optimized.
+  for (intptr_t i = 0; i < 2; i++) {
+    Dart_Handle result = Dart_Invoke(lib, NewString("test"), 1, args);
+    EXPECT_VALID(result);
+    int64_t value = 0;
+    EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+    EXPECT_EQ(kExpected, value);
+  }
+
+  {
+    TransitionNativeToVM transition(thread);
+    Isolate* isolate = thread->isolate();
+    const String& foo = String::Handle(Symbols::New(thread, "foo"));
+    const Array& foo_descriptor = Array::Handle(ArgumentsDescriptor::New(1));
+    const intptr_t foo_offset =
+        DispatchTable::AddSelector(isolate, foo, foo_descriptor);
+    EXPECT(foo_offset != DispatchTable::kNoOffset);
+
+    const String& bar = String::Handle(Symbols::New(thread, "bar"));
+    const Array& names = Array::Handle(Array::New(1));
+    names.SetAt(0, String::Handle(Symbols::New(thread, "y")));
+    const Array& bar_descriptor =
+        Array::Handle(ArgumentsDescriptor::New(3, names));
+    const intptr_t bar_offset =
+        DispatchTable::AddSelector(isolate, bar, bar_descriptor);
+    EXPECT(bar_offset != DispatchTable::kNoOffset);
+    EXPECT(bar_offset != foo_offset);
+    // The same name with another descriptor is another selector.
+    const Array& bar_positional = Array::Handle(ArgumentsDescriptor::New(2));
+    EXPECT(DispatchTable::AddSelector(isolate, bar, bar_positional) !=
+           bar_offset);
+
+    // Selectors no class implements have no row, and grow the table of
+    // selectors past its initial capacity.
+    String& name = String::Handle();
+    char buffer[16];
+    for (intptr_t i = 0; i < 40; i++) {
+      OS::SNPrint(buffer, sizeof(buffer), "missing%" Pd, i);
+      name = Symbols::New(thread, buffer);
+      EXPECT_EQ(DispatchTable::kNoOffset,
+                DispatchTable::AddSelector(isolate, name, foo_descriptor));
+    }
+    EXPECT_EQ(foo_offset,
+              DispatchTable::LookupOffset(isolate, foo, foo_descriptor));
+    EXPECT_EQ(bar_offset,
+              DispatchTable::LookupOffset(isolate, bar, bar_descriptor));
+  }
+
+  // Calls still dispatch to the same targets.
+  Dart_Handle result = Dart_Invoke(lib, NewString("test"), 1, args);
+  EXPECT_VALID(result);
+  int64_t value = 0;
+  EXPECT_VALID(Dart_IntegerToInt64(result, &value));
+  EXPECT_EQ(kExpected, value);
+
+  FLAG_use_dispatch_table = old_dispatch_table;
+  FLAG_background_compilation = old_background_compilation;
+  FLAG_optimization_counter_threshold = old_threshold;
+}
+
+}  // namespace dart
@@ -53,6 +53,8 @@ C(collect_code, false, true, bool, true,                                       \
   "Attempt to GC infrequently used code.")                                     \
 P(collect_dynamic_function_names, bool, true,                                  \
   "Collects all dynamic function names to identify unique targets")            \
+P(concurrent_mark, bool, false,                                                \
+  "Concurrent mark for old generation (interleaved with the mutator).")        \
 R(concurrent_sweep, USING_MULTICORE, bool, USING_MULTICORE,                    \
   "Concurrent sweep for old generation.")                                      \
 R(dedup_instructions, true, bool, false,                                       \
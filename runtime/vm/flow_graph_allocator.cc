@@ -5,6 +5,7 @@
 #include "vm/flow_graph_allocator.h"
 
 #include "vm/bit_vector.h"
+#include "vm/compiler_stats.h"
 #include "vm/intermediate_language.h"
 #include "vm/il_printer.h"
 #include "vm/flow_graph.h"
@@ -14,6 +15,10 @@
 
 namespace dart {
 
+DEFINE_FLAG(bool, loop_aware_allocation, false,
+    "Keep spills and reloads out of loop bodies when splitting live ranges "
+    "and prefer registers that need no moves around loops.");
+
 #if defined(DEBUG)
 #define TRACE_ALLOC(statement)                                                 \
   do {                                                                         \
@@ -1916,6 +1921,9 @@ void FlowGraphAllocator::SpillBetween(LiveRange* range,
   TRACE_ALLOC(THR_Print("spill v%" Pd " [%" Pd ", %" Pd ") "
                         "between [%" Pd ", %" Pd ")\n",
                         range->vreg(), range->Start(), range->End(), from, to));
+  if (FLAG_loop_aware_allocation) {
+    from = HoistSpillPosition(range, from, to);
+  }
   LiveRange* tail = range->SplitAt(from);
 
   if (tail->Start() < to) {
@@ -1955,6 +1963,28 @@ void FlowGraphAllocator::SpillAfter(LiveRange* range, intptr_t from) {
 }
 
 
+intptr_t FlowGraphAllocator::HoistSpillPosition(LiveRange* range,
+                                                intptr_t from,
+                                                intptr_t to) {
+  // Splitting the range inside of the loop leaves it in a register at the
+  // loop header and in the spill slot at the back edge, which costs a reload
+  // on every iteration. If the range is live across the whole loop, is not
+  // needed in a register before the loop exits and has no constrained uses
+  // in it, keep it in the spill slot for the whole loop instead.
+  BlockInfo* loop_header = BlockInfoAt(from)->loop_header();
+  while ((loop_header != NULL) &&
+         (range->Start() <= loop_header->entry()->start_pos()) &&
+         (loop_header->last_block()->end_pos() <= to) &&
+         RangeHasOnlyUnconstrainedUsesInLoop(range, loop_header->loop_id())) {
+    from = loop_header->entry()->start_pos();
+    TRACE_ALLOC(THR_Print("  moved spill position to loop header %" Pd "\n",
+                          from));
+    loop_header = loop_header->loop();
+  }
+  return from;
+}
+
+
 void FlowGraphAllocator::AllocateSpillSlotFor(LiveRange* range) {
 #if defined(TARGET_ARCH_DBC)
   // There is no need to support spilling on DBC because we have a lot of
@@ -2006,6 +2036,7 @@ void FlowGraphAllocator::AllocateSpillSlotFor(LiveRange* range) {
 
   if (idx == spill_slots_.length()) {
     // No free spill slot found. Allocate a new one.
+    INC_STAT(Thread::Current(), num_spill_slots, 1);
     spill_slots_.Add(0);
     quad_spill_slots_.Add(need_quad);
     untagged_spill_slots_.Add(need_untagged);
@@ -2079,6 +2110,7 @@ void FlowGraphAllocator::Spill(LiveRange* range) {
   }
   range->set_assigned_location(parent->spill_slot());
   ConvertAllUses(range);
+  INC_STAT(Thread::Current(), num_spilled_ranges, 1);
 }
 
 
@@ -2179,6 +2211,11 @@ bool FlowGraphAllocator::AllocateFreeRegister(LiveRange* unallocated) {
   // If hint is available try hint first.
   // TODO(vegorov): ensure that phis are hinted on the back edge.
   Location hint = unallocated->finger()->FirstHint();
+  if (FLAG_loop_aware_allocation &&
+      !hint.IsMachineRegister() &&
+      unallocated->is_loop_phi()) {
+    hint = LoopPhiEntryHint(unallocated);
+  }
   if (hint.IsMachineRegister()) {
     if (!blocked_registers_[hint.register_code()]) {
       free_until = FirstIntersectionWithAllocated(hint.register_code(),
@@ -2308,6 +2345,52 @@ bool FlowGraphAllocator::AllocateFreeRegister(LiveRange* unallocated) {
 }
 
 
+Location FlowGraphAllocator::LoopPhiEntryHint(LiveRange* phi_range) {
+  ASSERT(phi_range->is_loop_phi());
+  JoinEntryInstr* join =
+      BlockInfoAt(phi_range->Start())->entry()->AsJoinEntry();
+  ASSERT(join != NULL);
+
+  for (PhiIterator it(join); !it.Done(); it.Advance()) {
+    PhiInstr* phi = it.Current();
+    const intptr_t phi_vreg = phi->ssa_temp_index();
+    const bool is_second_half = phi->HasPairRepresentation() &&
+        (ToSecondPairVreg(phi_vreg) == phi_range->vreg());
+    if ((phi_vreg != phi_range->vreg()) && !is_second_half) continue;
+
+    for (intptr_t i = 0; i < phi->InputCount(); i++) {
+      // Blocks are numbered in reverse postorder: only the loop entry edge
+      // comes from a block preceding the header.
+      BlockEntryInstr* pred = join->PredecessorAt(i);
+      if (pred->start_pos() > join->start_pos()) continue;
+
+      Definition* input = phi->InputAt(i)->definition();
+      if (input->IsConstant()) continue;
+
+      const intptr_t vreg = is_second_half
+          ? ToSecondPairVreg(input->ssa_temp_index())
+          : input->ssa_temp_index();
+
+      // The phi move is placed right before the goto at the end of the
+      // predecessor. All siblings covering it start before the phi and
+      // were already allocated.
+      const intptr_t pos = pred->last_instruction()->lifetime_position() - 1;
+      for (LiveRange* range = GetLiveRange(vreg);
+           (range != NULL) && (range->Start() <= pos);
+           range = range->next_sibling()) {
+        if (range->Contains(pos) &&
+            (range->assigned_location().kind() == register_kind_)) {
+          return range->assigned_location();
+        }
+      }
+    }
+    break;
+  }
+
+  return Location::NoLocation();
+}
+
+
 bool FlowGraphAllocator::RangeHasOnlyUnconstrainedUsesInLoop(LiveRange* range,
                                                              intptr_t loop_id) {
   if (range->vreg() >= 0) {
@@ -2395,6 +2478,35 @@ void FlowGraphAllocator::AllocateAnyRegister(LiveRange* unallocated) {
 
   ASSERT(candidate != kNoRegister);
 
+  // Inside of a loop prefer evicting ranges that have no register uses in
+  // it: they can be spilled at the loop header instead of being reloaded
+  // on every iteration. Any such register is good enough as long as it
+  // stays free until the register use.
+  BlockInfo* loop_header = BlockInfoAt(unallocated->Start())->loop_header();
+  if (FLAG_loop_aware_allocation &&
+      (loop_header != NULL) &&
+      !IsCheapToEvictRegisterInLoop(loop_header, candidate)) {
+    for (intptr_t reg = 0; reg < NumberOfRegisters(); ++reg) {
+      if (blocked_registers_[reg] ||
+          (reg == candidate) ||
+          !IsCheapToEvictRegisterInLoop(loop_header, reg)) {
+        continue;
+      }
+
+      intptr_t reg_free_until = register_use_pos - 1;
+      intptr_t reg_blocked_at = kMaxPosition;
+      if (UpdateFreeUntil(reg, unallocated, &reg_free_until, &reg_blocked_at)) {
+        TRACE_ALLOC(THR_Print(
+            "found %s for v%" Pd " that is cheap to evict in the loop\n",
+            MakeRegisterLocation(reg).Name(),
+            unallocated->vreg()));
+        candidate = reg;
+        blocked_at = reg_blocked_at;
+        break;
+      }
+    }
+  }
+
   TRACE_ALLOC(THR_Print("assigning blocked register "));
   TRACE_ALLOC(MakeRegisterLocation(candidate).Print());
   TRACE_ALLOC(THR_Print(" to live range v%" Pd " until %" Pd "\n",
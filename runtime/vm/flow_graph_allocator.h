@@ -185,6 +185,10 @@ class FlowGraphAllocator : public ValueObject {
   // Try to find a free register for an unallocated live range.
   bool AllocateFreeRegister(LiveRange* unallocated);
 
+  // Returns the register holding the value that flows into the given loop
+  // phi from outside of the loop, if it is already known.
+  Location LoopPhiEntryHint(LiveRange* phi_range);
+
   // Try to find a register that can be used by a given live range.
   // If all registers are occupied consider evicting interference for
   // a register that is going to be used as far from the start of
@@ -238,6 +242,11 @@ class FlowGraphAllocator : public ValueObject {
   // position preceding the to position.
   void SpillBetween(LiveRange* range, intptr_t from, intptr_t to);
 
+  // Returns the header start of the outermost loop containing the given
+  // position that the range can be spilled at without being reloaded
+  // inside the loop, or the position itself if there is no such loop.
+  intptr_t HoistSpillPosition(LiveRange* range, intptr_t from, intptr_t to);
+
   // Mark the live range as a live object pointer at all safepoints
   // contained in the range.
   void MarkAsObjectAtSafepoints(LiveRange* range);
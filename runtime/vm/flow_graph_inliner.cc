@@ -50,6 +50,10 @@ DEFINE_FLAG(int, inlining_constant_arguments_max_size_threshold, 200,
 DEFINE_FLAG(int, inlining_constant_arguments_min_size_threshold, 60,
     "Inline function calls with sufficient constant arguments "
     "and up to the increased threshold on instructions");
+DEFINE_FLAG(int, inlining_budget, 0,
+    "Number of instructions that may be inlined into a function, spent on "
+    "the call sites with the most benefit per instruction first. If 0, "
+    "inlining decisions use the size thresholds.");
 DEFINE_FLAG(int, inlining_hotness, 10,
     "Inline only hotter calls, in percents (0 .. 100); "
     "default 10%: calls above-equal 10% of max-count are inlined.");
@@ -81,7 +85,8 @@ DECLARE_FLAG(bool, verify_compiler);
   do {                                                                         \
     if (FLAG_print_inlining_tree) {                                            \
       inlined_info_.Add(InlinedInfo(                                           \
-          caller, target, inlining_depth_, instance_call, comment));           \
+          caller, target, inlining_depth_, instance_call, comment,             \
+          benefit_));                                                          \
       }                                                                        \
   } while (false)                                                              \
 
@@ -172,16 +177,19 @@ struct InlinedInfo {
   intptr_t inlined_depth;
   const Definition* call_instr;
   const char* bailout_reason;
+  double benefit;
   InlinedInfo(const Function* caller_function,
               const Function* inlined_function,
               const intptr_t depth,
               const Definition* call,
-              const char* reason)
+              const char* reason,
+              double estimated_benefit = 0.0)
       : caller(caller_function),
         inlined(inlined_function),
         inlined_depth(depth),
         call_instr(call),
-        bailout_reason(reason) {}
+        bailout_reason(reason),
+        benefit(estimated_benefit) {}
 };
 
 
@@ -193,14 +201,19 @@ class CallSites : public ValueObject {
         closure_calls_(),
         instance_calls_() { }
 
+  // 'ratio' is the call count relative to the hottest call of the same
+  // graph, 'frequency' the estimated number of calls per invocation of the
+  // function being optimized.
   struct InstanceCallInfo {
     PolymorphicInstanceCallInstr* call;
     double ratio;
+    double frequency;
     const FlowGraph* caller_graph;
     InstanceCallInfo(PolymorphicInstanceCallInstr* call_arg,
                      FlowGraph* flow_graph)
         : call(call_arg),
           ratio(0.0),
+          frequency(0.0),
           caller_graph(flow_graph) {}
     const Function& caller() const { return caller_graph->function(); }
   };
@@ -208,10 +221,12 @@ class CallSites : public ValueObject {
   struct StaticCallInfo {
     StaticCallInstr* call;
     double ratio;
+    double frequency;
     FlowGraph* caller_graph;
     StaticCallInfo(StaticCallInstr* value, FlowGraph* flow_graph)
         : call(value),
           ratio(0.0),
+          frequency(0.0),
           caller_graph(flow_graph) {}
     const Function& caller() const { return caller_graph->function(); }
   };
@@ -256,7 +271,9 @@ class CallSites : public ValueObject {
   }
 
   void ComputeCallSiteRatio(intptr_t static_call_start_ix,
-                            intptr_t instance_call_start_ix) {
+                            intptr_t instance_call_start_ix,
+                            intptr_t entry_count,
+                            double graph_frequency) {
     const intptr_t num_static_calls =
         static_calls_.length() - static_call_start_ix;
     const intptr_t num_instance_calls =
@@ -291,14 +308,38 @@ class CallSites : public ValueObject {
       const double ratio = (max_count == 0) ?
           0.0 : static_cast<double>(instance_call_counts[i]) / max_count;
       instance_calls_[i + instance_call_start_ix].ratio = ratio;
+      instance_calls_[i + instance_call_start_ix].frequency =
+          graph_frequency * CallsPerEntry(instance_call_counts[i],
+                                          max_count,
+                                          entry_count);
     }
     for (intptr_t i = 0; i < num_static_calls; ++i) {
       const double ratio = (max_count == 0) ?
           0.0 : static_cast<double>(static_call_counts[i]) / max_count;
       static_calls_[i + static_call_start_ix].ratio = ratio;
+      static_calls_[i + static_call_start_ix].frequency =
+          graph_frequency * CallsPerEntry(static_call_counts[i],
+                                          max_count,
+                                          entry_count);
     }
   }
 
+  // Without edge counters the entry count of the graph is unknown, and the
+  // count relative to the hottest call stands in for the frequency. Without
+  // any call counts (e.g., when precompiling) every call is assumed to be
+  // executed once per entry.
+  static double CallsPerEntry(intptr_t count,
+                              intptr_t max_count,
+                              intptr_t entry_count) {
+    if (max_count == 0) {
+      return 1.0;
+    }
+    if (entry_count <= 0) {
+      return static_cast<double>(count) / static_cast<double>(max_count);
+    }
+    return static_cast<double>(count) / static_cast<double>(entry_count);
+  }
+
   static void RecordAllNotInlinedFunction(
       FlowGraph* graph,
       intptr_t depth,
@@ -334,8 +375,11 @@ class CallSites : public ValueObject {
   }
 
 
+  // 'graph_frequency' is the number of times 'graph' is entered per
+  // invocation of the function being optimized.
   void FindCallSites(FlowGraph* graph,
                      intptr_t depth,
+                     double graph_frequency,
                      GrowableArray<InlinedInfo>* inlined_info) {
     ASSERT(graph != NULL);
     if (depth > FLAG_inlining_depth_threshold) {
@@ -401,7 +445,10 @@ class CallSites : public ValueObject {
         }
       }
     }
-    ComputeCallSiteRatio(static_call_start_ix, instance_call_start_ix);
+    ComputeCallSiteRatio(static_call_start_ix,
+                         instance_call_start_ix,
+                         graph->graph_entry()->entry_count(),
+                         graph_frequency);
   }
 
  private:
@@ -501,6 +548,8 @@ class CallSiteInliner : public ValueObject {
         inlined_(false),
         initial_size_(inliner->flow_graph()->InstructionCount()),
         inlined_size_(0),
+        call_frequency_(1.0),
+        benefit_(0.0),
         inlined_recursive_call_(false),
         inlining_depth_(1),
         inlining_recursion_depth_(0),
@@ -529,6 +578,9 @@ class CallSiteInliner : public ValueObject {
       // Prevent methods becoming humongous and thus slow to compile.
       return false;
     }
+    if (FLAG_inlining_budget > 0) {
+      return WithinBudget(instr_count, const_arg_count);
+    }
     if (const_arg_count > 0) {
       if (instr_count > FLAG_inlining_constant_arguments_max_size_threshold) {
         return false;
@@ -550,6 +602,19 @@ class CallSiteInliner : public ValueObject {
     return false;
   }
 
+  // Call sites are ordered by benefit when inlining by budget, so that any
+  // callee that still fits the budget and the size limits is worth it.
+  bool WithinBudget(intptr_t instr_count, intptr_t const_arg_count) const {
+    // 'instr_count' can be 0 if it was not computed yet.
+    if (inlined_size_ + instr_count > FLAG_inlining_budget) {
+      return false;
+    }
+    if (const_arg_count > 0) {
+      return instr_count <= FLAG_inlining_constant_arguments_max_size_threshold;
+    }
+    return instr_count <= FLAG_inlining_callee_size_threshold;
+  }
+
   void InlineCalls() {
     // If inlining depth is less then one abort.
     if (FLAG_inlining_depth_threshold < 1) return;
@@ -566,6 +631,7 @@ class CallSiteInliner : public ValueObject {
     // Collect initial call sites.
     collected_call_sites_->FindCallSites(caller_graph_,
                                          inlining_depth_,
+                                         1.0,
                                          &inlined_info_);
     while (collected_call_sites_->HasCalls()) {
       TRACE_INLINING(THR_Print("  Depth %" Pd " ----------\n",
@@ -583,8 +649,12 @@ class CallSiteInliner : public ValueObject {
       inlining_call_sites_ = call_sites_temp;
       collected_call_sites_->Clear();
       // Inline call sites at the current depth.
-      InlineInstanceCalls();
-      InlineStaticCalls();
+      if (FLAG_inlining_budget > 0) {
+        InlineCallsByBenefit();
+      } else {
+        InlineInstanceCalls();
+        InlineStaticCalls();
+      }
       InlineClosureCalls();
       // Increment the inlining depths. Checked before subsequent inlining.
       ++inlining_depth_;
@@ -739,7 +809,8 @@ class CallSiteInliner : public ValueObject {
               new(Z) ZoneGrowableArray<const ICData*>();
         const bool clone_ic_data = Compiler::IsBackgroundCompilation();
         function.RestoreICDataMap(ic_data_array, clone_ic_data);
-        if (Compiler::IsBackgroundCompilation() &&
+        if (!FLAG_precompiled_mode &&
+            Compiler::IsBackgroundCompilation() &&
             (function.ic_data_array() == Array::null())) {
           Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
               "ICData cleared while inlining");
@@ -933,6 +1004,7 @@ class CallSiteInliner : public ValueObject {
             (function.IsInvokeFieldDispatcher() ||
              function.IsNoSuchMethodDispatcher()) ? 0 : inlining_depth_;
         collected_call_sites_->FindCallSites(callee_graph, depth,
+                                             call_frequency_,
                                              &inlined_info_);
 
         // Add the function to the cache.
@@ -1015,6 +1087,11 @@ class CallSiteInliner : public ValueObject {
           GrowthFactor(),
           initial_size_,
           inlined_size_);
+      if (FLAG_inlining_budget > 0) {
+        THR_Print("Budget: %" Pd " of %d instructions used\n",
+            inlined_size_,
+            FLAG_inlining_budget);
+      }
       PrintInlinedInfoFor(top, 1);
     }
   }
@@ -1044,9 +1121,17 @@ class CallSiteInliner : public ValueObject {
         for (int t = 0; t < depth; t++) {
           THR_Print("  ");
         }
-        THR_Print("%" Pd " %s\n",
-            info.call_instr->GetDeoptId(),
-            info.inlined->ToQualifiedCString());
+        if (FLAG_inlining_budget > 0) {
+          THR_Print("%" Pd " %s (benefit %.2f, cost %" Pd ")\n",
+              info.call_instr->GetDeoptId(),
+              info.inlined->ToQualifiedCString(),
+              info.benefit,
+              info.inlined->optimized_instruction_count());
+        } else {
+          THR_Print("%" Pd " %s\n",
+              info.call_instr->GetDeoptId(),
+              info.inlined->ToQualifiedCString());
+        }
         PrintInlinedInfoFor(*info.inlined, depth + 1);
         call_instructions_printed.Add(info.call_instr->GetDeoptId());
       }
@@ -1176,16 +1261,21 @@ class CallSiteInliner : public ValueObject {
             &call_info[call_idx].caller(), &call->function(), call);
         continue;
       }
-      GrowableArray<Value*> arguments(call->ArgumentCount());
-      for (int i = 0; i < call->ArgumentCount(); ++i) {
-        arguments.Add(call->PushArgumentAt(i)->value());
-      }
-      InlinedCallData call_data(
-          call, &arguments, call_info[call_idx].caller(),
-          call_info[call_idx].caller_graph->inlining_id());
-      if (TryInlining(call->function(), call->argument_names(), &call_data)) {
-        InlineCall(&call_data);
-      }
+      InlineStaticCall(call_info[call_idx]);
+    }
+  }
+
+  void InlineStaticCall(const CallSites::StaticCallInfo& info) {
+    StaticCallInstr* call = info.call;
+    GrowableArray<Value*> arguments(call->ArgumentCount());
+    for (int i = 0; i < call->ArgumentCount(); ++i) {
+      arguments.Add(call->PushArgumentAt(i)->value());
+    }
+    InlinedCallData call_data(
+        call, &arguments, info.caller(), info.caller_graph->inlining_id());
+    call_frequency_ = info.frequency;
+    if (TryInlining(call->function(), call->argument_names(), &call_data)) {
+      InlineCall(&call_data);
     }
   }
 
@@ -1246,11 +1336,7 @@ class CallSiteInliner : public ValueObject {
               call->instance_call()->function_name().ToCString()));
           continue;
         }
-        const Function& cl = call_info[call_idx].caller();
-        intptr_t caller_inlining_id =
-            call_info[call_idx].caller_graph->inlining_id();
-        PolymorphicInliner inliner(this, call, cl, caller_inlining_id);
-        inliner.Inline();
+        InlinePolymorphicCall(call_info[call_idx]);
         continue;
       }
 
@@ -1267,18 +1353,171 @@ class CallSiteInliner : public ValueObject {
             &call_info[call_idx].caller(), &target, call);
         continue;
       }
-      GrowableArray<Value*> arguments(call->ArgumentCount());
-      for (int arg_i = 0; arg_i < call->ArgumentCount(); ++arg_i) {
-        arguments.Add(call->PushArgumentAt(arg_i)->value());
+      InlineInstanceCall(call_info[call_idx], target);
+    }
+  }
+
+  void InlinePolymorphicCall(const CallSites::InstanceCallInfo& info) {
+    PolymorphicInliner inliner(
+        this, info.call, info.caller(), info.caller_graph->inlining_id());
+    call_frequency_ = info.frequency;
+    inliner.Inline();
+  }
+
+  void InlineInstanceCall(const CallSites::InstanceCallInfo& info,
+                          const Function& target) {
+    PolymorphicInstanceCallInstr* call = info.call;
+    GrowableArray<Value*> arguments(call->ArgumentCount());
+    for (int arg_i = 0; arg_i < call->ArgumentCount(); ++arg_i) {
+      arguments.Add(call->PushArgumentAt(arg_i)->value());
+    }
+    InlinedCallData call_data(
+        call, &arguments, info.caller(), info.caller_graph->inlining_id());
+    call_frequency_ = info.frequency;
+    if (TryInlining(target,
+                    call->instance_call()->argument_names(),
+                    &call_data)) {
+      InlineCall(&call_data);
+    }
+  }
+
+  // Instructions saved by inlining a call, beyond the call sequence itself,
+  // for each argument the callee can be specialized for.
+  static const intptr_t kCallOverhead = 10;
+  static const intptr_t kConstantArgumentBenefit = 5;
+  static const intptr_t kKnownCidArgumentBenefit = 2;
+
+  // Estimated number of instructions saved per invocation of the function
+  // being optimized.
+  static double InliningBenefit(Definition* call, double frequency) {
+    intptr_t saved = kCallOverhead;
+    for (intptr_t i = 0; i < call->ArgumentCount(); ++i) {
+      Value* argument = call->PushArgumentAt(i)->value();
+      if (argument->BindsToConstant()) {
+        saved += kConstantArgumentBenefit;
+      } else if (argument->Type()->ToCid() != kDynamicCid) {
+        saved += kKnownCidArgumentBenefit;
       }
-      InlinedCallData call_data(
-          call, &arguments, call_info[call_idx].caller(),
-          call_info[call_idx].caller_graph->inlining_id());
-      if (TryInlining(target,
-                      call->instance_call()->argument_names(),
-                      &call_data)) {
-        InlineCall(&call_data);
+    }
+    return frequency * saved;
+  }
+
+  // Estimated number of instructions added by inlining 'target'. The size of
+  // a function is known once it has been optimized or inlined.
+  static intptr_t InliningCost(const Function& target) {
+    const intptr_t size = target.optimized_instruction_count();
+    return (size > 0) ? size : FLAG_inlining_size_threshold;
+  }
+
+  struct InliningCandidate {
+    const CallSites::StaticCallInfo* static_call;
+    const CallSites::InstanceCallInfo* instance_call;
+    const Function* target;
+    double benefit;
+    intptr_t cost;
+    intptr_t order;
+  };
+
+  // Highest benefit per instruction first, in program order on ties.
+  static int CompareCandidates(const InliningCandidate* a,
+                               const InliningCandidate* b) {
+    const double a_score = a->benefit / a->cost;
+    const double b_score = b->benefit / b->cost;
+    if (a_score != b_score) {
+      return (a_score > b_score) ? -1 : 1;
+    }
+    return (a->order < b->order) ? -1 : ((a->order > b->order) ? 1 : 0);
+  }
+
+  // Inlines the monomorphic instance calls and the static calls of the
+  // current depth greedily by benefit per instruction, until the size of
+  // the inlined code reaches FLAG_inlining_budget. Polymorphic calls are
+  // inlined first, by PolymorphicInliner's own heuristics.
+  void InlineCallsByBenefit() {
+    const GrowableArray<CallSites::InstanceCallInfo>& instance_calls =
+        inlining_call_sites_->instance_calls();
+    const GrowableArray<CallSites::StaticCallInfo>& static_calls =
+        inlining_call_sites_->static_calls();
+    GrowableArray<InliningCandidate> candidates(
+        instance_calls.length() + static_calls.length());
+    for (intptr_t i = 0; i < instance_calls.length(); ++i) {
+      PolymorphicInstanceCallInstr* call = instance_calls[i].call;
+      if (call->with_checks()) {
+        if (!call->complete() && !FLAG_polymorphic_with_deopt) {
+          TRACE_INLINING(THR_Print(
+              "  => %s\n     Bailout: call with checks\n",
+              call->instance_call()->function_name().ToCString()));
+          continue;
+        }
+        InlinePolymorphicCall(instance_calls[i]);
+        continue;
+      }
+      InliningCandidate candidate;
+      candidate.static_call = NULL;
+      candidate.instance_call = &instance_calls[i];
+      candidate.target =
+          &Function::ZoneHandle(Z, call->ic_data().GetTargetAt(0));
+      candidate.benefit = InliningBenefit(call, instance_calls[i].frequency);
+      candidate.cost = InliningCost(*candidate.target);
+      candidate.order = candidates.length();
+      candidates.Add(candidate);
+    }
+    for (intptr_t i = 0; i < static_calls.length(); ++i) {
+      StaticCallInstr* call = static_calls[i].call;
+      InliningCandidate candidate;
+      candidate.static_call = &static_calls[i];
+      candidate.instance_call = NULL;
+      candidate.target = &call->function();
+      candidate.benefit = InliningBenefit(call, static_calls[i].frequency);
+      candidate.cost = InliningCost(*candidate.target);
+      candidate.order = candidates.length();
+      candidates.Add(candidate);
+    }
+    candidates.Sort(CompareCandidates);
+
+    TRACE_INLINING(THR_Print("  Calls by benefit (%" Pd ")\n",
+                             candidates.length()));
+    for (intptr_t i = 0; i < candidates.length(); ++i) {
+      const InliningCandidate& candidate = candidates[i];
+      const Function& target = *candidate.target;
+      Definition* call = (candidate.static_call != NULL)
+          ? static_cast<Definition*>(candidate.static_call->call)
+          : static_cast<Definition*>(candidate.instance_call->call);
+      const Function& caller = (candidate.static_call != NULL)
+          ? candidate.static_call->caller()
+          : candidate.instance_call->caller();
+      const double ratio = (candidate.static_call != NULL)
+          ? candidate.static_call->ratio
+          : candidate.instance_call->ratio;
+      if (!inliner_->AlwaysInline(target)) {
+        if ((ratio * 100) < FLAG_inlining_hotness) {
+          TRACE_INLINING(THR_Print(
+              "  => %s (deopt count %d)\n     Bailout: cold %f\n",
+              target.ToCString(),
+              target.deoptimization_counter(),
+              ratio));
+          PRINT_INLINING_TREE("Too cold", &caller, &target, call);
+          continue;
+        }
+        if (inlined_size_ + candidate.cost > FLAG_inlining_budget) {
+          TRACE_INLINING(THR_Print(
+              "  => %s\n     Bailout: cost %" Pd " over budget, "
+              "%" Pd " of %d used\n",
+              target.ToCString(),
+              candidate.cost,
+              inlined_size_,
+              FLAG_inlining_budget));
+          PRINT_INLINING_TREE("Over budget", &caller, &target, call);
+          continue;
+        }
+      }
+      benefit_ = candidate.benefit;
+      if (candidate.static_call != NULL) {
+        InlineStaticCall(*candidate.static_call);
+      } else {
+        InlineInstanceCall(*candidate.instance_call, target);
       }
+      benefit_ = 0.0;
     }
   }
 
@@ -1377,6 +1616,11 @@ class CallSiteInliner : public ValueObject {
   bool inlined_;
   const intptr_t initial_size_;
   intptr_t inlined_size_;
+  // Frequency of the call being inlined, which becomes the frequency of the
+  // call sites found in the callee.
+  double call_frequency_;
+  // Estimated benefit of the call being inlined, when inlining by budget.
+  double benefit_;
   bool inlined_recursive_call_;
   intptr_t inlining_depth_;
   intptr_t inlining_recursion_depth_;
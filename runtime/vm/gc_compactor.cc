@@ -0,0 +1,251 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/gc_compactor.h"
+
+#include "vm/become.h"
+#include "vm/freelist.h"
+#include "vm/growable_array.h"
+#include "vm/heap.h"
+#include "vm/isolate.h"
+#include "vm/object_id_ring.h"
+#include "vm/pages.h"
+#include "vm/raw_object.h"
+#include "vm/stack_frame.h"
+#include "vm/store_buffer.h"
+#include "vm/timeline.h"
+#include "vm/weak_table.h"
+
+namespace dart {
+
+static RawObject* ForwardedObject(RawObject* raw_obj) {
+  if (raw_obj->IsHeapObject() && raw_obj->IsForwardingCorpse()) {
+    uword addr = RawObject::ToAddr(raw_obj);
+    return reinterpret_cast<ForwardingCorpse*>(addr)->target();
+  }
+  return raw_obj;
+}
+
+
+bool GCCompactor::IsPinned(RawObject* raw_obj) {
+  const intptr_t cid = raw_obj->GetClassId();
+  return (cid == kClassCid) || (cid == kCodeCid);
+}
+
+
+intptr_t GCCompactor::CompactPages(PageSpace* old_space) {
+  Thread* thread = Thread::Current();
+  TIMELINE_FUNCTION_GC_DURATION(thread, "CompactPages");
+
+  // Measure the live words of the regular data pages and collect the sparse
+  // ones. Pages without live objects are released by the sweeper anyway.
+  MallocGrowableArray<HeapPage*> candidates;
+  intptr_t live_in_words = 0;
+  intptr_t capacity_in_words = 0;
+  intptr_t candidate_live_in_words = 0;
+  for (HeapPage* page = old_space->pages_;
+       page != NULL;
+       page = page->next()) {
+    if ((page->type() != HeapPage::kData) || page->embedder_allocated()) {
+      continue;
+    }
+    intptr_t page_live_in_words = 0;
+    bool is_pinned = false;
+    uword current = page->object_start();
+    const uword end = page->object_end();
+    while (current < end) {
+      RawObject* raw_obj = RawObject::FromAddr(current);
+      const intptr_t size = raw_obj->Size();
+      if (raw_obj->IsMarked()) {
+        page_live_in_words += (size >> kWordSizeLog2);
+        is_pinned = is_pinned || IsPinned(raw_obj);
+      }
+      current += size;
+    }
+    if (page_live_in_words == 0) {
+      continue;
+    }
+    const intptr_t page_capacity_in_words =
+        (end - page->object_start()) >> kWordSizeLog2;
+    live_in_words += page_live_in_words;
+    capacity_in_words += page_capacity_in_words;
+    if (!is_pinned &&
+        old_space->page_space_controller_.IsSparse(page_live_in_words,
+                                                   page_capacity_in_words)) {
+      candidates.Add(page);
+      candidate_live_in_words += page_live_in_words;
+    }
+  }
+  if (!old_space->page_space_controller_.NeedsCompaction(live_in_words,
+                                                         capacity_in_words)) {
+    return 0;
+  }
+  // Evacuation only pays off if it releases more pages than it fills.
+  const intptr_t page_capacity_in_words = PageSpace::kPageSizeInWords -
+      (HeapPage::ObjectStartOffset() >> kWordSizeLog2);
+  const intptr_t pages_needed =
+      (candidate_live_in_words / page_capacity_in_words) + 1;
+  if (candidates.length() <= pages_needed) {
+    return 0;
+  }
+
+  intptr_t evacuated_pages = 0;
+  for (intptr_t i = 0; i < candidates.length(); i++) {
+    if (!EvacuatePage(old_space, candidates[i])) {
+      break;
+    }
+    evacuated_pages++;
+  }
+  CloseDestination();
+  if (moved_words_ > 0) {
+    ForwardPointers(old_space);
+  }
+  return evacuated_pages;
+}
+
+
+bool GCCompactor::EvacuatePage(PageSpace* old_space, HeapPage* page) {
+  uword current = page->object_start();
+  const uword end = page->object_end();
+  while (current < end) {
+    RawObject* raw_obj = RawObject::FromAddr(current);
+    const intptr_t size = raw_obj->Size();
+    if (raw_obj->IsMarked()) {
+      if (static_cast<intptr_t>(destination_end_ - destination_top_) < size) {
+        CloseDestination();
+        HeapPage* destination = old_space->AllocatePage(HeapPage::kData);
+        if (destination == NULL) {
+          // Out of memory. The objects moved so far are still forwarded, and
+          // the rest of the page is swept as usual.
+          return false;
+        }
+        destination_top_ = destination->object_start();
+        destination_end_ = destination->object_end();
+      }
+      // The copy keeps the mark and remembered bits of the original, which
+      // turns into an unmarked forwarding corpse of the same size.
+      memmove(reinterpret_cast<void*>(destination_top_),
+              reinterpret_cast<void*>(current),
+              size);
+      RawObject* copy = RawObject::FromAddr(destination_top_);
+      ForwardingCorpse::AsForwarder(current, size)->set_target(copy);
+      destination_top_ += size;
+      moved_words_ += (size >> kWordSizeLog2);
+    }
+    current += size;
+  }
+  return true;
+}
+
+
+void GCCompactor::CloseDestination() {
+  if (destination_top_ < destination_end_) {
+    // Keep the page iterable. The sweeper adds the remainder to the freelist,
+    // where the bump allocator will find it as one large block.
+    FreeListElement::AsElement(destination_top_,
+                               destination_end_ - destination_top_);
+  }
+  destination_top_ = 0;
+  destination_end_ = 0;
+}
+
+
+static void ForwardMarkedObjects(HeapPage* pages,
+                                 ForwardPointersVisitor* visitor) {
+  for (HeapPage* page = pages; page != NULL; page = page->next()) {
+    uword current = page->object_start();
+    const uword end = page->object_end();
+    while (current < end) {
+      RawObject* raw_obj = RawObject::FromAddr(current);
+      if (raw_obj->IsMarked()) {
+        visitor->VisitingObject(raw_obj);
+        current += raw_obj->VisitPointers(visitor);
+      } else {
+        current += raw_obj->Size();
+      }
+    }
+  }
+  visitor->VisitingObject(NULL);
+}
+
+
+void GCCompactor::ForwardPointers(PageSpace* old_space) {
+  ForwardPointersVisitor visitor(isolate_);
+
+  // Heap pointers go first: visiting the stack frames among the roots reads
+  // the stack maps of the (pinned) code objects, whose fields must already
+  // refer to the moved copies. Unmarked old objects are garbage, including
+  // the forwarding corpses themselves.
+  {
+    // Code objects forward the literals embedded in their instructions.
+    WritableCodeLiteralsScope writable_code(heap_);
+    heap_->new_space()->VisitObjectPointers(&visitor);
+    ForwardMarkedObjects(old_space->pages_, &visitor);
+    ForwardMarkedObjects(old_space->exec_pages_, &visitor);
+    ForwardMarkedObjects(old_space->large_pages_, &visitor);
+  }
+
+  // C++ pointers.
+  isolate_->VisitObjectPointers(&visitor,
+                                StackFrameIterator::kDontValidateFrames);
+  ForwardHeapPointersHandleVisitor handle_visitor;
+  isolate_->VisitWeakPersistentHandles(&handle_visitor);
+#ifndef PRODUCT
+  if (FLAG_support_service) {
+    ObjectIdRing* ring = isolate_->object_id_ring();
+    ASSERT(ring != NULL);
+    ring->VisitPointers(&visitor);
+  }
+#endif  // !PRODUCT
+
+  ForwardStoreBuffer();
+  ForwardWeakTables();
+}
+
+
+void GCCompactor::ForwardStoreBuffer() {
+  // The store buffer holds the remembered old objects, some of which moved.
+  StoreBuffer* store_buffer = isolate_->store_buffer();
+  StoreBufferBlock* pending = store_buffer->Blocks();
+  StoreBufferBlock* forwarded = store_buffer->PopEmptyBlock();
+  while (pending != NULL) {
+    StoreBufferBlock* next = pending->next();
+    while (!pending->IsEmpty()) {
+      if (forwarded->IsFull()) {
+        store_buffer->PushBlock(forwarded, StoreBuffer::kIgnoreThreshold);
+        forwarded = store_buffer->PopEmptyBlock();
+      }
+      forwarded->Push(ForwardedObject(pending->Pop()));
+    }
+    pending->Reset();
+    store_buffer->PushBlock(pending, StoreBuffer::kIgnoreThreshold);
+    pending = next;
+  }
+  store_buffer->PushBlock(forwarded, StoreBuffer::kIgnoreThreshold);
+}
+
+
+void GCCompactor::ForwardWeakTables() {
+  // Rehash the weak tables, which are keyed by address.
+  for (int sel = 0;
+       sel < Heap::kNumWeakSelectors;
+       sel++) {
+    WeakTable* table = heap_->GetWeakTable(
+        Heap::kOld, static_cast<Heap::WeakSelector>(sel));
+    WeakTable* forwarded = WeakTable::NewFrom(table);
+    intptr_t size = table->size();
+    for (intptr_t i = 0; i < size; i++) {
+      if (table->IsValidEntryAt(i)) {
+        forwarded->SetValue(ForwardedObject(table->ObjectAt(i)),
+                            table->ValueAt(i));
+      }
+    }
+    heap_->SetWeakTable(Heap::kOld,
+                        static_cast<Heap::WeakSelector>(sel),
+                        forwarded);
+    delete table;
+  }
+}
+
+}  // namespace dart
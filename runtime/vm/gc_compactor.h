@@ -0,0 +1,70 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_GC_COMPACTOR_H_
+#define VM_GC_COMPACTOR_H_
+
+#include "vm/allocation.h"
+#include "vm/globals.h"
+
+namespace dart {
+
+// Forward declarations.
+class Heap;
+class HeapPage;
+class Isolate;
+class PageSpace;
+class RawObject;
+
+// The class GCCompactor is used after marking to reduce the fragmentation of
+// the old generation. It evacuates the live objects of sparsely used data
+// pages into fresh pages, leaving forwarding corpses behind (see become.h),
+// and redirects all references to the moved objects. The evacuated pages then
+// only contain unmarked objects, so the sweeper releases them.
+class GCCompactor : public ValueObject {
+ public:
+  GCCompactor(Isolate* isolate, Heap* heap)
+      : isolate_(isolate),
+        heap_(heap),
+        moved_words_(0),
+        destination_top_(0),
+        destination_end_(0) { }
+  ~GCCompactor() { }
+
+  // Evacuates the sparse data pages of 'old_space' if the page space
+  // controller deems it fragmented. Must be called after marking, with all
+  // pages iterable. Returns the number of evacuated pages.
+  intptr_t CompactPages(PageSpace* old_space);
+
+  intptr_t moved_words() const { return moved_words_; }
+
+ private:
+  // Objects that are read by the visitors while pointers are being forwarded:
+  // classes give instance sizes and code gives stack maps. Pages holding them
+  // are never evacuated.
+  static bool IsPinned(RawObject* raw_obj);
+
+  // Copies the marked objects of 'page' to the destination block, allocating
+  // new data pages as needed. Returns false if no page could be allocated.
+  bool EvacuatePage(PageSpace* old_space, HeapPage* page);
+  void CloseDestination();
+
+  void ForwardPointers(PageSpace* old_space);
+  void ForwardStoreBuffer();
+  void ForwardWeakTables();
+
+  Isolate* isolate_;
+  Heap* heap_;
+  intptr_t moved_words_;
+
+  // Bump allocation block in the current destination page.
+  uword destination_top_;
+  uword destination_end_;
+
+  DISALLOW_COPY_AND_ASSIGN(GCCompactor);
+};
+
+}  // namespace dart
+
+#endif  // VM_GC_COMPACTOR_H_
@@ -125,6 +125,11 @@ class MarkerWorkList : public ValueObject {
 
   void Finalize() {
     ASSERT(work_->IsEmpty());
+    Flush();
+  }
+
+  // Hands any remaining work back to the marking stack.
+  void Flush() {
     marking_stack_->PushBlock(work_);
     work_ = NULL;
     // Fail fast on attempts to mark after finalizing.
@@ -137,6 +142,16 @@ class MarkerWorkList : public ValueObject {
 };
 
 
+enum MarkingMode {
+  // All marking is done while the mutator is stopped.
+  kStopTheWorld,
+  // Marking alongside the running mutator.
+  kConcurrentMarking,
+  // Completion of a concurrent cycle while the mutator is stopped.
+  kRemark,
+};
+
+
 template<bool sync>
 class MarkingVisitorBase : public ObjectPointerVisitor {
  public:
@@ -144,7 +159,8 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
                  Heap* heap,
                  PageSpace* page_space,
                  MarkingStack* marking_stack,
-                 SkippedCodeFunctions* skipped_code_functions)
+                 SkippedCodeFunctions* skipped_code_functions,
+                 MarkingMode mode)
       : ObjectPointerVisitor(isolate),
         thread_(Thread::Current()),
         heap_(heap),
@@ -156,6 +172,8 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
         delayed_weak_properties_(NULL),
         visiting_old_object_(NULL),
         skipped_code_functions_(skipped_code_functions),
+        deferred_objects_(NULL),
+        mode_(mode),
         marked_bytes_(0) {
     ASSERT(heap_ != vm_heap_);
     ASSERT(thread_->isolate() == isolate);
@@ -177,6 +195,18 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     return class_stats_size_[class_id];
   }
 
+  intptr_t num_cids() const { return class_stats_count_.length(); }
+
+  // While marking concurrently, code pages are write-protected and objects on
+  // them are collected in 'deferred_objects' instead of being marked.
+  GrowableArray<RawObject*>* deferred_objects() const {
+    return deferred_objects_;
+  }
+  void set_deferred_objects(GrowableArray<RawObject*>* deferred_objects) {
+    ASSERT(mode_ == kConcurrentMarking);
+    deferred_objects_ = deferred_objects;
+  }
+
   bool ProcessPendingWeakProperties() {
     bool marked = false;
     RawWeakProperty* cur_weak = delayed_weak_properties_;
@@ -217,6 +247,9 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     }
     do {
       do {
+        if (mode_ == kConcurrentMarking) {
+          thread_->CheckForSafepoint();
+        }
         // First drain the marking stacks.
         VisitingOldObject(raw_obj);
         const intptr_t class_id = raw_obj->GetClassId();
@@ -246,6 +279,20 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     }
   }
 
+  // Marks the objects in one block recorded by the write barrier. Returns
+  // false if 'barrier_stack' had no such block.
+  bool ProcessBarrierBlock(MarkingStack* barrier_stack) {
+    MarkingStackBlock* block = barrier_stack->PopNonEmptyBlock();
+    if (block == NULL) {
+      return false;
+    }
+    while (!block->IsEmpty()) {
+      MarkObject(block->Pop(), NULL);
+    }
+    barrier_stack->PushBlock(block);
+    return true;
+  }
+
   bool visit_function_code() const {
     return skipped_code_functions_ == NULL;
   }
@@ -279,6 +326,20 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     return raw_weak->VisitPointers(this);
   }
 
+  // Called when a concurrent task stops marking; remaining work is left in
+  // the marking stack.
+  void Suspend() {
+    ASSERT(mode_ == kConcurrentMarking);
+    ASSERT(skipped_code_functions_ == NULL);
+    work_list_.Flush();
+  }
+
+  RawWeakProperty* DetachDelayedWeakProperties() {
+    RawWeakProperty* result = delayed_weak_properties_;
+    delayed_weak_properties_ = NULL;
+    return result;
+  }
+
   // Called when all marking is complete.
   void Finalize() {
     work_list_.Finalize();
@@ -315,10 +376,12 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
 
     // Push the marked object on the marking stack.
     ASSERT(raw_obj->IsMarked());
-    // We acquired the mark bit => no other task is modifying the header.
-    // TODO(koda): For concurrent mutator, this needs synchronization. Consider
-    // clearing these bits already in the CAS for the mark bit.
-    raw_obj->ClearRememberedBitUnsynchronized();
+    if (mode_ == kStopTheWorld) {
+      // We acquired the mark bit => no other task is modifying the header.
+      // A concurrent cycle keeps the store buffer (and remembered bits) as
+      // maintained by the mutator instead of rebuilding it.
+      raw_obj->ClearRememberedBitUnsynchronized();
+    }
     work_list_.Push(raw_obj);
   }
 
@@ -349,7 +412,15 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
     // if (marked) return;
     // ...
     if (raw_obj->IsNewObject()) {
-      ProcessNewSpaceObject(raw_obj, p);
+      if (mode_ == kStopTheWorld) {
+        ProcessNewSpaceObject(raw_obj, p);
+      }
+      return;
+    }
+
+    if ((deferred_objects_ != NULL) &&
+        (raw_obj->GetClassId() == kInstructionsCid)) {
+      deferred_objects_->Add(raw_obj);
       return;
     }
 
@@ -392,8 +463,17 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   }
 
   void UpdateLiveOld(intptr_t class_id, intptr_t size) {
-    // TODO(koda): Support growing the array once mutator runs concurrently.
-    ASSERT(class_id < class_stats_count_.length());
+    if (class_id >= class_stats_count_.length()) {
+      // The mutator registered classes since marking started.
+      ASSERT(mode_ != kStopTheWorld);
+      const intptr_t old_length = class_stats_count_.length();
+      class_stats_count_.SetLength(class_id + 1);
+      class_stats_size_.SetLength(class_id + 1);
+      for (intptr_t i = old_length; i <= class_id; ++i) {
+        class_stats_count_[i] = 0;
+        class_stats_size_[i] = 0;
+      }
+    }
     class_stats_count_[class_id] += 1;
     class_stats_size_[class_id] += size;
   }
@@ -408,6 +488,8 @@ class MarkingVisitorBase : public ObjectPointerVisitor {
   RawWeakProperty* delayed_weak_properties_;
   RawObject* visiting_old_object_;
   SkippedCodeFunctions* skipped_code_functions_;
+  GrowableArray<RawObject*>* deferred_objects_;
+  const MarkingMode mode_;
   uintptr_t marked_bytes_;
 
   DISALLOW_IMPLICIT_CONSTRUCTORS(MarkingVisitorBase);
@@ -418,6 +500,24 @@ typedef MarkingVisitorBase<false> UnsyncMarkingVisitor;
 typedef MarkingVisitorBase<true> SyncMarkingVisitor;
 
 
+template<class MarkingVisitorType>
+static void AccumulateLiveStats(MarkingVisitorType* visitor,
+                                MallocGrowableArray<intptr_t>* live_count,
+                                MallocGrowableArray<intptr_t>* live_size) {
+  for (intptr_t i = 0; i < visitor->num_cids(); ++i) {
+    const intptr_t count = visitor->live_count(i);
+    if (count > 0) {
+      while (live_count->length() <= i) {
+        live_count->Add(0);
+        live_size->Add(0);
+      }
+      (*live_count)[i] += count;
+      (*live_size)[i] += visitor->live_size(i);
+    }
+  }
+}
+
+
 static bool IsUnreachable(const RawObject* raw_obj) {
   if (!raw_obj->IsHeapObject()) {
     return false;
@@ -453,13 +553,30 @@ class MarkingWeakVisitor : public HandleVisitor {
 };
 
 
+GCMarker::GCMarker(Heap* heap)
+    : heap_(heap),
+      marked_bytes_(0),
+      concurrent_(false),
+      num_busy_(0),
+      delayed_weak_properties_(NULL) {
+}
+
+
+GCMarker::~GCMarker() {
+  ASSERT(delayed_weak_properties_ == NULL);
+  ASSERT(deferred_objects_.is_empty());
+}
+
+
 void GCMarker::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   if (invoke_api_callbacks && (isolate->gc_prologue_callback() != NULL)) {
     (isolate->gc_prologue_callback())();
   }
   isolate->PrepareForGC();
-  // The store buffers will be rebuilt as part of marking, reset them now.
-  isolate->store_buffer()->Reset();
+  if (!concurrent_) {
+    // The store buffers will be rebuilt as part of marking, reset them now.
+    isolate->store_buffer()->Reset();
+  }
 }
 
 
@@ -494,6 +611,24 @@ void GCMarker::IterateWeakRoots(Isolate* isolate, HandleVisitor* visitor) {
 }
 
 
+void GCMarker::ProcessWeakHandles(Thread* thread, Isolate* isolate) {
+  TIMELINE_FUNCTION_GC_DURATION(thread, "WeakHandleProcessing");
+  if (FLAG_background_finalization) {
+    FinalizationQueue* queue = new FinalizationQueue();
+    MarkingWeakVisitor mark_weak(thread, queue);
+    IterateWeakRoots(isolate, &mark_weak);
+    if (queue->length() > 0) {
+      Dart::thread_pool()->Run(new BackgroundFinalizer(isolate, queue));
+    } else {
+      delete queue;
+    }
+  } else {
+    MarkingWeakVisitor mark_weak(thread, NULL);
+    IterateWeakRoots(isolate, &mark_weak);
+  }
+}
+
+
 void GCMarker::ProcessWeakTables(PageSpace* page_space) {
   for (int sel = 0;
        sel < Heap::kNumWeakSelectors;
@@ -582,7 +717,7 @@ class MarkTask : public ThreadPool::Task {
       SkippedCodeFunctions* skipped_code_functions =
           collect_code_ ? new(zone) SkippedCodeFunctions() : NULL;
       SyncMarkingVisitor visitor(isolate_, heap_, page_space_, marking_stack_,
-                                 skipped_code_functions);
+                                 skipped_code_functions, kStopTheWorld);
       // Phase 1: Iterate over roots and drain marking stack in tasks.
       marker_->IterateRoots(isolate_, &visitor, task_index_, num_tasks_);
 
@@ -671,20 +806,96 @@ class MarkTask : public ThreadPool::Task {
 };
 
 
+class ConcurrentMarkTask : public ThreadPool::Task {
+ public:
+  ConcurrentMarkTask(GCMarker* marker,
+                     Isolate* isolate,
+                     PageSpace* page_space)
+      : marker_(marker),
+        isolate_(isolate),
+        page_space_(page_space) {
+  }
+
+  virtual void Run() {
+    // Unlike MarkTask, this task takes part in safepoint operations (e.g.,
+    // scavenges) that the mutator performs while marking is in progress.
+    bool result =
+        Thread::EnterIsolateAsHelper(isolate_, Thread::kMarkerTask, false);
+    ASSERT(result);
+    {
+      Thread* thread = Thread::Current();
+      TIMELINE_FUNCTION_GC_DURATION(thread, "ConcurrentMarkTask");
+      StackZone stack_zone(thread);
+      GrowableArray<RawObject*> deferred_objects;
+      MarkingStack* marking_stack = &marker_->marking_stack_;
+      MarkingStack* barrier_stack = &marker_->barrier_stack_;
+      uintptr_t* num_busy = &marker_->num_busy_;
+      SyncMarkingVisitor visitor(isolate_, marker_->heap_, page_space_,
+                                 marking_stack, NULL, kConcurrentMarking);
+      visitor.set_deferred_objects(&deferred_objects);
+      do {
+        visitor.DrainMarkingStack();
+        if (visitor.ProcessBarrierBlock(barrier_stack)) continue;
+
+        // Same termination protocol as MarkTask. Barrier blocks that show up
+        // after all tasks went idle are left for FinishConcurrentMark.
+        if (AtomicOperations::FetchAndDecrement(num_busy) == 1) {
+          // Let the mutator complete the collection.
+          isolate_->ScheduleVMInterrupts();
+          break;
+        }
+        while (marking_stack->IsEmpty() &&
+               barrier_stack->IsEmpty() &&
+               AtomicOperations::LoadRelaxed(num_busy) > 0) {
+          thread->CheckForSafepoint();
+        }
+        if (AtomicOperations::LoadRelaxed(num_busy) == 0) break;
+        AtomicOperations::FetchAndIncrement(num_busy);
+      } while (true);
+
+      if (FLAG_log_marker_tasks) {
+        THR_Print("Concurrent task marked %" Pd " bytes.\n",
+                  visitor.marked_bytes());
+      }
+      marker_->SuspendResultsFrom(&visitor);
+    }
+    Thread::ExitIsolateAsHelper(false);
+
+    // This task is done. Notify the original thread.
+    {
+      MonitorLocker ml(page_space_->tasks_lock());
+      page_space_->set_tasks(page_space_->tasks() - 1);
+      ml.NotifyAll();
+    }
+  }
+
+ private:
+  GCMarker* marker_;
+  Isolate* isolate_;
+  PageSpace* page_space_;
+
+  DISALLOW_COPY_AND_ASSIGN(ConcurrentMarkTask);
+};
+
+
 template<class MarkingVisitorType>
 void GCMarker::FinalizeResultsFrom(MarkingVisitorType* visitor) {
 #ifndef PRODUCT
   {
     MutexLocker ml(&stats_mutex_);
     marked_bytes_ += visitor->marked_bytes();
-    // Class heap stats are not themselves thread-safe yet, so we update the
-    // stats while holding stats_mutex_.
-    ClassTable* table = heap_->isolate()->class_table();
-    for (intptr_t i = 0; i < table->NumCids(); ++i) {
-      const intptr_t count = visitor->live_count(i);
-      if (count > 0) {
-        const intptr_t size = visitor->live_size(i);
-        table->UpdateLiveOld(i, size, count);
+    if (concurrent_) {
+      AccumulateLiveStats(visitor, &live_count_, &live_size_);
+    } else {
+      // Class heap stats are not themselves thread-safe yet, so we update the
+      // stats while holding stats_mutex_.
+      ClassTable* table = heap_->isolate()->class_table();
+      for (intptr_t i = 0; i < table->NumCids(); ++i) {
+        const intptr_t count = visitor->live_count(i);
+        if (count > 0) {
+          const intptr_t size = visitor->live_size(i);
+          table->UpdateLiveOld(i, size, count);
+        }
       }
     }
   }
@@ -693,6 +904,74 @@ void GCMarker::FinalizeResultsFrom(MarkingVisitorType* visitor) {
 }
 
 
+template<class MarkingVisitorType>
+void GCMarker::SuspendResultsFrom(MarkingVisitorType* visitor) {
+  MutexLocker ml(&stats_mutex_);
+#ifndef PRODUCT
+  marked_bytes_ += visitor->marked_bytes();
+  AccumulateLiveStats(visitor, &live_count_, &live_size_);
+#endif  // !PRODUCT
+  GrowableArray<RawObject*>* deferred_objects = visitor->deferred_objects();
+  for (intptr_t i = 0; i < deferred_objects->length(); i++) {
+    deferred_objects_.Add((*deferred_objects)[i]);
+  }
+  // Weak properties with unmarked keys are reconsidered at the end.
+  RawWeakProperty* cur_weak = visitor->DetachDelayedWeakProperties();
+  while (cur_weak != NULL) {
+    RawWeakProperty* next_weak =
+        reinterpret_cast<RawWeakProperty*>(cur_weak->ptr()->next_);
+    cur_weak->ptr()->next_ = reinterpret_cast<uword>(delayed_weak_properties_);
+    delayed_weak_properties_ = cur_weak;
+    cur_weak = next_weak;
+  }
+  visitor->Suspend();
+}
+
+
+void GCMarker::UpdateClassHeapStats(Isolate* isolate) {
+#ifndef PRODUCT
+  ClassTable* table = isolate->class_table();
+  const intptr_t num_cids = Utils::Minimum(table->NumCids(),
+                                           live_count_.length());
+  for (intptr_t i = 0; i < num_cids; ++i) {
+    const intptr_t count = live_count_[i];
+    if (count > 0) {
+      table->UpdateLiveOld(i, live_size_[i], count);
+    }
+  }
+#endif  // !PRODUCT
+  live_count_.Clear();
+  live_size_.Clear();
+}
+
+
+void GCMarker::FilterStoreBuffer(Isolate* isolate) {
+  // The store buffer was maintained by the mutator throughout a concurrent
+  // cycle rather than rebuilt by marking. Drop the entries of objects that
+  // are about to be swept.
+  StoreBuffer* store_buffer = isolate->store_buffer();
+  StoreBufferBlock* pending = store_buffer->Blocks();
+  StoreBufferBlock* live = store_buffer->PopEmptyBlock();
+  while (pending != NULL) {
+    StoreBufferBlock* next = pending->next();
+    while (!pending->IsEmpty()) {
+      RawObject* raw_object = pending->Pop();
+      if (raw_object->IsMarked()) {
+        if (live->IsFull()) {
+          store_buffer->PushBlock(live, StoreBuffer::kIgnoreThreshold);
+          live = store_buffer->PopEmptyBlock();
+        }
+        live->Push(raw_object);
+      }
+    }
+    pending->Reset();
+    store_buffer->PushBlock(pending, StoreBuffer::kIgnoreThreshold);
+    pending = next;
+  }
+  store_buffer->PushBlock(live, StoreBuffer::kIgnoreThreshold);
+}
+
+
 void GCMarker::MarkObjects(Isolate* isolate,
                            PageSpace* page_space,
                            bool invoke_api_callbacks,
@@ -712,25 +991,10 @@ void GCMarker::MarkObjects(Isolate* isolate,
       SkippedCodeFunctions* skipped_code_functions =
           collect_code ? new(zone) SkippedCodeFunctions() : NULL;
       UnsyncMarkingVisitor mark(isolate, heap_, page_space, &marking_stack,
-                                skipped_code_functions);
+                                skipped_code_functions, kStopTheWorld);
       IterateRoots(isolate, &mark, 0, 1);
       mark.DrainMarkingStack();
-      {
-        TIMELINE_FUNCTION_GC_DURATION(thread, "WeakHandleProcessing");
-        if (FLAG_background_finalization) {
-          FinalizationQueue* queue = new FinalizationQueue();
-          MarkingWeakVisitor mark_weak(thread, queue);
-          IterateWeakRoots(isolate, &mark_weak);
-          if (queue->length() > 0) {
-            Dart::thread_pool()->Run(new BackgroundFinalizer(isolate, queue));
-          } else {
-            delete queue;
-          }
-        } else {
-          MarkingWeakVisitor mark_weak(thread, NULL);
-          IterateWeakRoots(isolate, &mark_weak);
-        }
-      }
+      ProcessWeakHandles(thread, isolate);
       // All marking done; detach code, etc.
       FinalizeResultsFrom(&mark);
     } else {
@@ -770,22 +1034,7 @@ void GCMarker::MarkObjects(Isolate* isolate,
       } while (more_to_mark);
 
       // Phase 2: Weak processing on main thread.
-      {
-        TIMELINE_FUNCTION_GC_DURATION(thread, "WeakHandleProcessing");
-        if (FLAG_background_finalization) {
-          FinalizationQueue* queue = new FinalizationQueue();
-          MarkingWeakVisitor mark_weak(thread, queue);
-          IterateWeakRoots(isolate, &mark_weak);
-          if (queue->length() > 0) {
-            Dart::thread_pool()->Run(new BackgroundFinalizer(isolate, queue));
-          } else {
-            delete queue;
-          }
-        } else {
-          MarkingWeakVisitor mark_weak(thread, NULL);
-          IterateWeakRoots(isolate, &mark_weak);
-        }
-      }
+      ProcessWeakHandles(thread, isolate);
       barrier.Sync();
 
       // Phase 3: Finalize results from all markers (detach code, etc.).
@@ -797,4 +1046,85 @@ void GCMarker::MarkObjects(Isolate* isolate,
   Epilogue(isolate, invoke_api_callbacks);
 }
 
+
+void GCMarker::StartConcurrentMark(Isolate* isolate, PageSpace* page_space) {
+  Thread* thread = Thread::Current();
+  TIMELINE_FUNCTION_GC_DURATION(thread, "StartConcurrentMark");
+  ASSERT(!concurrent_);
+  concurrent_ = true;
+  marked_bytes_ = 0;
+  // From now on, stores of unmarked old objects are recorded in barrier_stack_.
+  isolate->EnableMarkingBarrier(&barrier_stack_);
+  {
+    // The roots are marked while the mutator is stopped; the tasks trace
+    // the rest of the old generation from there.
+    StackZone stack_zone(thread);
+    GrowableArray<RawObject*> deferred_objects;
+    UnsyncMarkingVisitor visitor(isolate, heap_, page_space, &marking_stack_,
+                                 NULL, kConcurrentMarking);
+    visitor.set_deferred_objects(&deferred_objects);
+    IterateRoots(isolate, &visitor, 0, 1);
+    SuspendResultsFrom(&visitor);
+  }
+  const intptr_t num_tasks = Utils::Maximum(1, FLAG_marker_tasks);
+  num_busy_ = num_tasks;
+  {
+    MonitorLocker ml(page_space->tasks_lock());
+    page_space->set_tasks(page_space->tasks() + num_tasks);
+  }
+  for (intptr_t i = 0; i < num_tasks; ++i) {
+    Dart::thread_pool()->Run(
+        new ConcurrentMarkTask(this, isolate, page_space));
+  }
+}
+
+
+bool GCMarker::IsConcurrentMarkDone() {
+  return AtomicOperations::LoadRelaxed(&num_busy_) == 0;
+}
+
+
+void GCMarker::FinishConcurrentMark(Isolate* isolate,
+                                    PageSpace* page_space,
+                                    bool invoke_api_callbacks) {
+  ASSERT(concurrent_);
+  ASSERT(AtomicOperations::LoadRelaxed(&num_busy_) == 0);
+  Prologue(isolate, invoke_api_callbacks);
+  {
+    Thread* thread = Thread::Current();
+    StackZone stack_zone(thread);
+    // Flush the write barrier of all threads into barrier_stack_.
+    isolate->DisableMarkingBarrier();
+    UnsyncMarkingVisitor mark(isolate, heap_, page_space, &marking_stack_,
+                              NULL, kRemark);
+    // Code pages are writable now.
+    for (intptr_t i = 0; i < deferred_objects_.length(); i++) {
+      mark.VisitPointers(&deferred_objects_[i], &deferred_objects_[i]);
+    }
+    deferred_objects_.Clear();
+    while (mark.ProcessBarrierBlock(&barrier_stack_)) {
+    }
+    RawWeakProperty* cur_weak = delayed_weak_properties_;
+    delayed_weak_properties_ = NULL;
+    while (cur_weak != NULL) {
+      uword next_weak = cur_weak->ptr()->next_;
+      cur_weak->ptr()->next_ = 0;
+      mark.EnqueueWeakProperty(cur_weak);
+      cur_weak = reinterpret_cast<RawWeakProperty*>(next_weak);
+    }
+    // Roots are not covered by the write barrier; rescan them, including
+    // the new generation.
+    IterateRoots(isolate, &mark, 0, 1);
+    mark.DrainMarkingStack();
+    ProcessWeakHandles(thread, isolate);
+    FinalizeResultsFrom(&mark);
+    UpdateClassHeapStats(isolate);
+    FilterStoreBuffer(isolate);
+    ProcessWeakTables(page_space);
+    ProcessObjectIdTable(isolate);
+  }
+  Epilogue(isolate, invoke_api_callbacks);
+  concurrent_ = false;
+}
+
 }  // namespace dart
@@ -6,7 +6,9 @@
 #define VM_GC_MARKER_H_
 
 #include "vm/allocation.h"
+#include "vm/growable_array.h"
 #include "vm/os_thread.h"  // Mutex.
+#include "vm/store_buffer.h"
 
 namespace dart {
 
@@ -16,21 +18,38 @@ class Heap;
 class Isolate;
 class ObjectPointerVisitor;
 class PageSpace;
+class RawObject;
 class RawWeakProperty;
+class Thread;
 
 // The class GCMarker is used to mark reachable old generation objects as part
 // of the mark-sweep collection. The marking bit used is defined in RawObject.
-class GCMarker : public ValueObject {
+//
+// Marking is either done all at once (MarkObjects) or concurrently with the
+// mutator: StartConcurrentMark marks the roots and spawns tasks that trace
+// the old generation while the mutator keeps running. Stores the mutator makes
+// meanwhile are recorded by the write barrier (see Thread::is_marking), and
+// FinishConcurrentMark processes them together with a rescan of the roots.
+class GCMarker {
  public:
-  explicit GCMarker(Heap* heap)
-      : heap_(heap), marked_bytes_(0) { }
-  ~GCMarker() { }
+  explicit GCMarker(Heap* heap);
+  ~GCMarker();
 
   void MarkObjects(Isolate* isolate,
                    PageSpace* page_space,
                    bool invoke_api_callbacks,
                    bool collect_code);
 
+  // Both must be called at a safepoint. The concurrent tasks are accounted
+  // for in the page space's tasks() and must have finished before
+  // FinishConcurrentMark is called.
+  void StartConcurrentMark(Isolate* isolate, PageSpace* page_space);
+  void FinishConcurrentMark(Isolate* isolate,
+                            PageSpace* page_space,
+                            bool invoke_api_callbacks);
+  // Whether the concurrent tasks ran out of work.
+  bool IsConcurrentMarkDone();
+
   intptr_t marked_words() { return marked_bytes_ >> kWordSizeLog2; }
 
  private:
@@ -42,12 +61,19 @@ class GCMarker : public ValueObject {
   void IterateWeakRoots(Isolate* isolate, HandleVisitor* visitor);
   template<class MarkingVisitorType>
   void IterateWeakReferences(Isolate* isolate, MarkingVisitorType* visitor);
+  void ProcessWeakHandles(Thread* thread, Isolate* isolate);
   void ProcessWeakTables(PageSpace* page_space);
   void ProcessObjectIdTable(Isolate* isolate);
+  void FilterStoreBuffer(Isolate* isolate);
 
   // Called by anyone: finalize and accumulate stats from 'visitor'.
   template<class MarkingVisitorType>
   void FinalizeResultsFrom(MarkingVisitorType* visitor);
+  // Called by the concurrent tasks: hand over the state of 'visitor' that
+  // can only be resolved by FinishConcurrentMark.
+  template<class MarkingVisitorType>
+  void SuspendResultsFrom(MarkingVisitorType* visitor);
+  void UpdateClassHeapStats(Isolate* isolate);
 
   Heap* heap_;
 
@@ -55,6 +81,19 @@ class GCMarker : public ValueObject {
   // TODO(koda): Remove after verifying it's redundant w.r.t. ClassHeapStats.
   uintptr_t marked_bytes_;
 
+  // State of a concurrent marking cycle, carried over from the concurrent
+  // tasks to FinishConcurrentMark.
+  bool concurrent_;
+  MarkingStack marking_stack_;
+  MarkingStack barrier_stack_;
+  uintptr_t num_busy_;
+  RawWeakProperty* delayed_weak_properties_;
+  // Objects on write-protected code pages that could not be marked yet.
+  MallocGrowableArray<RawObject*> deferred_objects_;
+  MallocGrowableArray<intptr_t> live_count_;
+  MallocGrowableArray<intptr_t> live_size_;
+
+  friend class ConcurrentMarkTask;
   friend class MarkTask;
   DISALLOW_IMPLICIT_CONSTRUCTORS(GCMarker);
 };
@@ -148,31 +148,15 @@ NOT_IN_PRODUCT(
   // Returns the entry that matches 'key', or -1 if none exists.
   template<typename Key>
   intptr_t FindKey(const Key& key) const {
-    const intptr_t num_entries = NumEntries();
-    ASSERT(NumOccupied() < num_entries);
-    // TODO(koda): Add salt.
-    NOT_IN_PRODUCT(intptr_t collisions = 0;)
-    uword hash = KeyTraits::Hash(key);
-    intptr_t probe = hash % num_entries;
-    // TODO(koda): Consider quadratic probing.
-    while (true) {
-      if (IsUnused(probe)) {
-        NOT_IN_PRODUCT(UpdateCollisions(collisions);)
-        return -1;
-      } else if (!IsDeleted(probe)) {
-        *key_handle_ = GetKey(probe);
-        if (KeyTraits::IsMatch(key, *key_handle_)) {
-          NOT_IN_PRODUCT(UpdateCollisions(collisions);)
-          return probe;
-        }
-        NOT_IN_PRODUCT(collisions += 1;)
-      }
-      // Advance probe.
-      probe++;
-      probe = (probe == num_entries) ? 0 : probe;
-    }
-    UNREACHABLE();
-    return -1;
+    return FindKeyImpl<true>(key);
+  }
+
+  // Like FindKey, but never writes to the backing array (no lookup
+  // statistics are recorded). This allows lookups that run concurrently
+  // with a writer which only ever fills unused entries.
+  template<typename Key>
+  intptr_t FindKeyReadOnly(const Key& key) const {
+    return FindKeyImpl<false>(key);
   }
 
   // Sets *entry to either:
@@ -345,6 +329,35 @@ NOT_IN_PRODUCT(
   static const intptr_t kFirstKeyIndex = kHeaderSize + kMetaDataSize;
   static const intptr_t kEntrySize = 1 + kPayloadSize;
 
+  template<bool kUpdateStats, typename Key>
+  intptr_t FindKeyImpl(const Key& key) const {
+    const intptr_t num_entries = NumEntries();
+    ASSERT(NumOccupied() < num_entries);
+    // TODO(koda): Add salt.
+    NOT_IN_PRODUCT(intptr_t collisions = 0;)
+    uword hash = KeyTraits::Hash(key);
+    intptr_t probe = hash % num_entries;
+    // TODO(koda): Consider quadratic probing.
+    while (true) {
+      if (IsUnused(probe)) {
+        NOT_IN_PRODUCT(if (kUpdateStats) UpdateCollisions(collisions);)
+        return -1;
+      } else if (!IsDeleted(probe)) {
+        *key_handle_ = GetKey(probe);
+        if (KeyTraits::IsMatch(key, *key_handle_)) {
+          NOT_IN_PRODUCT(if (kUpdateStats) UpdateCollisions(collisions);)
+          return probe;
+        }
+        NOT_IN_PRODUCT(collisions += 1;)
+      }
+      // Advance probe.
+      probe++;
+      probe = (probe == num_entries) ? 0 : probe;
+    }
+    UNREACHABLE();
+    return -1;
+  }
+
   intptr_t KeyIndex(intptr_t entry) const {
     ASSERT(0 <= entry && entry < NumEntries());
     return kFirstKeyIndex + (kEntrySize * entry);
@@ -665,6 +678,13 @@ class HashSet : public BaseIterTable {
     return (entry == -1) ? Object::null() : BaseIterTable::GetKey(entry);
   }
 
+  // Like GetOrNull, but does not write to the table (see FindKeyReadOnly).
+  template<typename Key>
+  RawObject* GetOrNullReadOnly(const Key& key) const {
+    intptr_t entry = BaseIterTable::FindKeyReadOnly(key);
+    return (entry == -1) ? Object::null() : BaseIterTable::GetKey(entry);
+  }
+
   template<typename Key>
   bool Remove(const Key& key) const {
     intptr_t entry = BaseIterTable::FindKey(key);
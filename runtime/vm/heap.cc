@@ -81,14 +81,16 @@ uword Heap::AllocateNew(intptr_t size) {
 
 
 uword Heap::AllocateOld(intptr_t size, HeapPage::PageType type) {
-  ASSERT(Thread::Current()->no_safepoint_scope_depth() == 0);
-  uword addr = old_space_.TryAllocate(size, type);
+  Thread* thread = Thread::Current();
+  ASSERT(thread->no_safepoint_scope_depth() == 0);
+  uword addr = ((type == HeapPage::kData) && (thread->heap() == this)) ?
+      old_space_.TryAllocateDataThreadLocal(thread, size) :
+      old_space_.TryAllocate(size, type);
   if (addr != 0) {
     return addr;
   }
   // If we are in the process of running a sweep, wait for the sweeper to free
   // memory.
-  Thread* thread = Thread::Current();
   {
     MonitorLocker ml(old_space_.tasks_lock());
     addr = old_space_.TryAllocate(size, type);
@@ -388,6 +390,12 @@ void Heap::CollectOldSpaceGarbage(Thread* thread,
                                   GCReason reason) {
   ASSERT((reason != kNewSpace));
   if (BeginOldSpaceGC(thread)) {
+    if ((reason == kPromotion) && old_space_.TryConcurrentMark()) {
+      // The collection is completed once the marker tasks are done (see
+      // Thread::HandleInterrupts), or when old space runs out of memory.
+      EndOldSpaceGC();
+      return;
+    }
     bool invoke_api_callbacks = (api_callbacks == kInvokeApiCallbacks);
     RecordBeforeGC(kOld, reason);
     VMTagScope tagScope(thread, VMTag::kGCOldSpaceTagId);
@@ -440,6 +448,13 @@ void Heap::CollectAllGarbage() {
 }
 
 
+void Heap::CompleteConcurrentMark() {
+  if (old_space_.IsConcurrentMarkInProgress()) {
+    CollectOldSpaceGarbage(Thread::Current(), kInvokeApiCallbacks, kOldSpace);
+  }
+}
+
+
 #if defined(DEBUG)
 void Heap::WaitForSweeperTasks() {
   Thread* thread = Thread::Current();
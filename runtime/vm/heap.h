@@ -118,6 +118,9 @@ class Heap {
   void CollectGarbage(Space space);
   void CollectGarbage(Space space, ApiCallbacks api_callbacks, GCReason reason);
   void CollectAllGarbage();
+  // Completes the old generation collection if it is being marked
+  // concurrently.
+  void CompleteConcurrentMark();
   bool NeedsGarbageCollection() const {
     return old_space_.NeedsGarbageCollection();
   }
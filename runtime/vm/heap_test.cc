@@ -13,6 +13,9 @@
 
 namespace dart {
 
+DECLARE_FLAG(int, scavenger_tasks);
+
+
 TEST_CASE(OldGC) {
   const char* kScriptChars =
   "main() {\n"
@@ -366,4 +369,177 @@ VM_TEST_CASE(BecomeForwardRememberedObject) {
   EXPECT(before_obj.raw() == after_obj.raw());
 }
 
+
+#if defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_DBC)
+VM_TEST_CASE(ConcurrentMarkWriteBarrier) {
+  const bool saved_concurrent_mark = FLAG_concurrent_mark;
+  FLAG_concurrent_mark = true;
+  Heap* heap = thread->isolate()->heap();
+  heap->CollectAllGarbage();
+
+  const Array& holder = Array::Handle(Array::New(1, Heap::kOld));
+  heap->CollectGarbage(Heap::kOld, Heap::kInvokeApiCallbacks,
+                       Heap::kPromotion);
+  EXPECT(heap->old_space()->IsConcurrentMarkInProgress());
+  EXPECT(thread->is_marking());
+  while (!heap->old_space()->IsConcurrentMarkDone()) {
+    OS::Sleep(1);
+  }
+  EXPECT(holder.raw()->IsMarked());
+  {
+    // The string is only reachable through the already marked holder.
+    HandleScope scope(thread);
+    const String& element = String::Handle(String::New("old", Heap::kOld));
+    EXPECT(!element.raw()->IsMarked());
+    holder.SetAt(0, element);
+  }
+  heap->CollectGarbage(Heap::kOld);
+  EXPECT(!heap->old_space()->IsConcurrentMarkInProgress());
+  EXPECT(!thread->is_marking());
+
+  const Object& element = Object::Handle(holder.At(0));
+  EXPECT(element.IsString());
+  EXPECT(String::Cast(element).Equals("old"));
+  FLAG_concurrent_mark = saved_concurrent_mark;
+}
+#endif  // defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_DBC)
+
+
+VM_TEST_CASE(CompactSparsePages) {
+  const bool saved_use_compactor = FLAG_use_compactor;
+  const bool saved_concurrent_sweep = FLAG_concurrent_sweep;
+  FLAG_use_compactor = true;
+  FLAG_concurrent_sweep = false;
+  Heap* heap = thread->isolate()->heap();
+  heap->CollectAllGarbage();
+
+  // Fill several pages with arrays of about 1KB, one in sixteen of which
+  // survives, so that the pages are sparse after the next collection.
+  const intptr_t kNumArrays = 16 * KB;
+  const intptr_t kSurvivorStride = 16;
+  const intptr_t kArrayLength = 126;
+  const Array& survivors = Array::Handle(
+      Array::New(kNumArrays / kSurvivorStride, Heap::kOld));
+  {
+    HandleScope scope(thread);
+    Array& array = Array::Handle();
+    for (intptr_t i = 0; i < kNumArrays; i++) {
+      array = Array::New(kArrayLength, Heap::kOld);
+      if ((i % kSurvivorStride) == 0) {
+        array.SetAt(0, Smi::Handle(Smi::New(i)));
+        survivors.SetAt(i / kSurvivorStride, array);
+      }
+    }
+  }
+  const intptr_t kSurvivor = survivors.Length() / 2;
+  Array& survivor = Array::Handle(Array::RawCast(survivors.At(kSurvivor)));
+  heap->SetHash(survivor.raw(), 42);
+  // Remembered, as it refers to a new object.
+  survivor.SetAt(1, String::Handle(String::New("new", Heap::kNew)));
+  EXPECT(survivor.raw()->IsRemembered());
+  RawObject* raw_survivor_before = survivor.raw();
+
+  const intptr_t capacity_before = heap->old_space()->CapacityInWords();
+  heap->CollectGarbage(Heap::kOld);
+  const intptr_t capacity_after = heap->old_space()->CapacityInWords();
+  EXPECT(capacity_after < capacity_before / 2);
+
+  // References from handles and from the heap were forwarded consistently.
+  EXPECT(survivor.raw() != raw_survivor_before);
+  EXPECT(survivor.raw() == survivors.At(kSurvivor));
+  EXPECT_EQ(42, heap->GetHash(survivor.raw()));
+  EXPECT(survivor.raw()->IsRemembered());
+  EXPECT(String::Handle(String::RawCast(survivor.At(1))).Equals("new"));
+  Array& array = Array::Handle();
+  for (intptr_t i = 0; i < survivors.Length(); i++) {
+    array ^= survivors.At(i);
+    EXPECT_EQ(kArrayLength, array.Length());
+    EXPECT_EQ(i * kSurvivorStride, Smi::Value(Smi::RawCast(array.At(0))));
+  }
+  // The moved array is still remembered, so a scavenge keeps its element.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(String::Handle(String::RawCast(survivor.At(1))).Equals("new"));
+
+  FLAG_use_compactor = saved_use_compactor;
+  FLAG_concurrent_sweep = saved_concurrent_sweep;
+}
+
+
+VM_TEST_CASE(ThreadLocalOldSpaceAllocation) {
+  Heap* heap = thread->isolate()->heap();
+  heap->CollectAllGarbage();
+  // Marking detaches the buffers of all threads.
+  EXPECT(thread->old_space_top() == 0);
+  EXPECT(thread->old_space_end() == 0);
+
+  // Consecutive small objects are bump allocated from the thread's buffer.
+  const Array& first = Array::Handle(Array::New(4, Heap::kOld));
+  const Array& second = Array::Handle(Array::New(4, Heap::kOld));
+  const uword first_end = RawObject::ToAddr(first.raw()) + first.raw()->Size();
+  EXPECT(first_end == RawObject::ToAddr(second.raw()));
+  const uword second_end =
+      RawObject::ToAddr(second.raw()) + second.raw()->Size();
+  EXPECT(thread->old_space_top() == second_end);
+  EXPECT(thread->old_space_top() < thread->old_space_end());
+
+  // Larger objects bypass the buffer.
+  const Array& large = Array::Handle(Array::New(8 * KB, Heap::kOld));
+  EXPECT(thread->old_space_top() == second_end);
+  EXPECT(!large.IsNull());
+
+  // The unused rest of the buffer is reclaimed by the sweeper.
+  heap->CollectAllGarbage();
+  EXPECT(thread->old_space_top() == 0);
+  EXPECT_EQ(4, first.Length());
+  EXPECT_EQ(4, second.Length());
+}
+
+
+VM_TEST_CASE(ParallelScavenge) {
+  const intptr_t saved_scavenger_tasks = FLAG_scavenger_tasks;
+  FLAG_scavenger_tasks = 4;
+  Heap* heap = thread->isolate()->heap();
+  const intptr_t kLength = 1000;
+  // The strings are reachable both through the store buffer and through a
+  // handle, so several tasks may race to copy them.
+  const Array& old_holder = Array::Handle(Array::New(kLength, Heap::kOld));
+  const Array& new_holder = Array::Handle(Array::New(kLength));
+  // Too large for the tasks' copy buffers.
+  const Array& large = Array::Handle(Array::New(2 * KB));
+  String& str = String::Handle();
+  for (intptr_t i = 0; i < kLength; i++) {
+    str = String::NewFormatted("%" Pd "", i);
+    old_holder.SetAt(i, str);
+    new_holder.SetAt(i, str);
+  }
+  large.SetAt(0, new_holder);
+  const WeakProperty& live_weak = WeakProperty::Handle(WeakProperty::New());
+  live_weak.set_key(str);
+  live_weak.set_value(str);
+  const WeakProperty& dead_weak = WeakProperty::Handle(WeakProperty::New());
+  {
+    HandleScope scope(thread);
+    const String& key = String::Handle(String::New("dead"));
+    dead_weak.set_key(key);
+    dead_weak.set_value(key);
+  }
+
+  heap->CollectGarbage(Heap::kNew);
+  // Survivors of the first scavenge are promoted by the second.
+  heap->CollectGarbage(Heap::kNew);
+  EXPECT(new_holder.raw()->IsOldObject());
+  EXPECT(large.raw()->IsOldObject());
+  EXPECT(large.At(0) == new_holder.raw());
+  for (intptr_t i = 0; i < kLength; i++) {
+    str ^= new_holder.At(i);
+    EXPECT(str.raw() == old_holder.At(i));
+    EXPECT(str.Equals(String::Handle(String::NewFormatted("%" Pd "", i))));
+  }
+  EXPECT(live_weak.key() == str.raw());
+  EXPECT(live_weak.value() == str.raw());
+  EXPECT(dead_weak.key() == Object::null());
+  EXPECT(dead_weak.value() == Object::null());
+  FLAG_scavenger_tasks = saved_scavenger_tasks;
+}
+
 }  // namespace dart
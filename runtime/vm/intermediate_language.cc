@@ -659,6 +659,10 @@ bool Value::NeedsStoreBuffer() {
     return false;
   }
 
+  if (FLAG_concurrent_mark && BindsToConstant()) {
+    // Constants may have to be recorded by the concurrent marking barrier.
+    return !BoundConstant().IsSmi();
+  }
   return !BindsToConstant();
 }
 
@@ -779,6 +779,7 @@ Isolate::Isolate(const Dart_IsolateFlags& api_flags)
       single_step_(false),
       thread_registry_(new ThreadRegistry()),
       safepoint_handler_(new SafepointHandler(this)),
+      marking_stack_(NULL),
       message_notify_callback_(NULL),
       name_(NULL),
       debugger_name_(NULL),
@@ -801,7 +802,6 @@ Isolate::Isolate(const Dart_IsolateFlags& api_flags)
       random_(),
       simulator_(NULL),
       mutex_(new Mutex()),
-      symbols_mutex_(new Mutex()),
       type_canonicalization_mutex_(new Mutex()),
       constant_canonicalization_mutex_(new Mutex()),
       megamorphic_lookup_mutex_(new Mutex()),
@@ -842,6 +842,9 @@ Isolate::Isolate(const Dart_IsolateFlags& api_flags)
       reload_context_(NULL),
       last_reload_timestamp_(OS::GetCurrentTimeMillis()) {
   NOT_IN_PRODUCT(FlagsCopyFrom(api_flags));
+  for (intptr_t i = 0; i < kNumSymbolTableShards; i++) {
+    symbols_mutexes_[i] = new Mutex();
+  }
   // TODO(asiva): A Thread is not available here, need to figure out
   // how the vm_tag (kEmbedderTagId) can be set, these tags need to
   // move to the OSThread structure.
@@ -868,8 +871,10 @@ Isolate::~Isolate() {
 #endif
   delete mutex_;
   mutex_ = NULL;  // Fail fast if interrupts are scheduled on a dead isolate.
-  delete symbols_mutex_;
-  symbols_mutex_ = NULL;
+  for (intptr_t i = 0; i < kNumSymbolTableShards; i++) {
+    delete symbols_mutexes_[i];
+    symbols_mutexes_[i] = NULL;
+  }
   delete type_canonicalization_mutex_;
   type_canonicalization_mutex_ = NULL;
   delete constant_canonicalization_mutex_;
@@ -1033,6 +1038,15 @@ void Isolate::ScheduleMessageInterrupts() {
 }
 
 
+void Isolate::ScheduleVMInterrupts() {
+  MonitorLocker ml(threads_lock());
+  Thread* mthread = mutator_thread();
+  if (mthread != NULL) {
+    mthread->ScheduleInterrupts(Thread::kVMInterrupt);
+  }
+}
+
+
 void Isolate::set_debugger_name(const char* name) {
   free(debugger_name_);
   debugger_name_ = strdup(name);
@@ -1702,6 +1716,10 @@ void Isolate::MaybeIncreaseReloadEveryNStackOverflowChecks() {
 void Isolate::Shutdown() {
   ASSERT(this == Isolate::Current());
   StopBackgroundCompiler();
+  if (heap_ != NULL) {
+    // Don't leave concurrent marker tasks and mark bits behind.
+    heap_->CompleteConcurrentMark();
+  }
 
 #if defined(DEBUG)
   if (heap_ != NULL) {
@@ -1873,6 +1891,20 @@ void Isolate::PrepareForGC() {
 }
 
 
+void Isolate::EnableMarkingBarrier(MarkingStack* marking_stack) {
+  ASSERT(marking_stack_ == NULL);
+  marking_stack_ = marking_stack;
+  thread_registry()->AcquireMarkingStackBlocks();
+}
+
+
+void Isolate::DisableMarkingBarrier() {
+  ASSERT(marking_stack_ != NULL);
+  thread_registry()->ReleaseMarkingStackBlocks();
+  marking_stack_ = NULL;
+}
+
+
 RawClass* Isolate::GetClassForHeapWalkAt(intptr_t cid) {
   RawClass* raw_class = NULL;
 #ifndef PRODUCT
@@ -38,6 +38,7 @@ class IsolateProfilerData;
 class IsolateReloadContext;
 class IsolateSpawnState;
 class Log;
+class MarkingStack;
 class MessageHandler;
 class Mutex;
 class Object;
@@ -155,6 +156,13 @@ class Isolate : public BaseIsolate {
 
   StoreBuffer* store_buffer() { return store_buffer_; }
 
+  // The stack receiving the write barrier's marking stack blocks while the
+  // old generation is marked concurrently; NULL otherwise.
+  MarkingStack* marking_stack() const { return marking_stack_; }
+  // Must be called at a safepoint.
+  void EnableMarkingBarrier(MarkingStack* marking_stack);
+  void DisableMarkingBarrier();
+
   ThreadRegistry* thread_registry() const { return thread_registry_; }
   SafepointHandler* safepoint_handler() const { return safepoint_handler_; }
 
@@ -211,6 +219,9 @@ class Isolate : public BaseIsolate {
 
   ObjectStore* object_store() const { return object_store_; }
   void set_object_store(ObjectStore* value) { object_store_ = value; }
+  static intptr_t object_store_offset() {
+    return OFFSET_OF(Isolate, object_store_);
+  }
 
   ApiState* api_state() const { return api_state_; }
   void set_api_state(ApiState* value) { api_state_ = value; }
@@ -242,6 +253,7 @@ class Isolate : public BaseIsolate {
       const uint8_t* instructions_snapshot_buffer);
 
   void ScheduleMessageInterrupts();
+  void ScheduleVMInterrupts();
 
   // Marks all libraries as loaded.
   void DoneLoading();
@@ -271,7 +283,14 @@ class Isolate : public BaseIsolate {
   void set_spawn_state(IsolateSpawnState* value) { spawn_state_ = value; }
 
   Mutex* mutex() const { return mutex_; }
-  Mutex* symbols_mutex() const { return symbols_mutex_; }
+  // The symbol table is split into shards which are each guarded by their
+  // own mutex (see Symbols::NewSymbol).
+  static const intptr_t kSymbolTableShardBits = 4;
+  static const intptr_t kNumSymbolTableShards = 1 << kSymbolTableShardBits;
+  Mutex* symbols_mutex(intptr_t shard) const {
+    ASSERT((shard >= 0) && (shard < kNumSymbolTableShards));
+    return symbols_mutexes_[shard];
+  }
   Mutex* type_canonicalization_mutex() const {
     return type_canonicalization_mutex_;
   }
@@ -708,6 +727,7 @@ class Isolate : public BaseIsolate {
 
   ThreadRegistry* thread_registry_;
   SafepointHandler* safepoint_handler_;
+  MarkingStack* marking_stack_;
   Dart_MessageNotifyCallback message_notify_callback_;
   char* name_;
   char* debugger_name_;
@@ -730,7 +750,8 @@ class Isolate : public BaseIsolate {
   Random random_;
   Simulator* simulator_;
   Mutex* mutex_;  // Protects compiler stats.
-  Mutex* symbols_mutex_;  // Protects concurrent access to the symbol table.
+  // Protect concurrent modification of the symbol table shards.
+  Mutex* symbols_mutexes_[kNumSymbolTableShards];
   Mutex* type_canonicalization_mutex_;  // Protects type canonicalization.
   Mutex* constant_canonicalization_mutex_;  // Protects const canonicalization.
   Mutex* megamorphic_lookup_mutex_;  // Protects megamorphic table lookup.
@@ -855,6 +876,7 @@ REUSABLE_HANDLE_LIST(REUSABLE_FRIEND_DECLARATION)
 #undef REUSABLE_FRIEND_DECLARATION
 
   friend class Become;  // VisitObjectPointers
+  friend class GCCompactor;  // VisitObjectPointers
   friend class GCMarker;  // VisitObjectPointers
   friend class SafepointHandler;
   friend class Scavenger;  // VisitObjectPointers
@@ -9,6 +9,7 @@
 #include "vm/code_generator.h"
 #include "vm/compiler.h"
 #include "vm/dart_api_impl.h"
+#include "vm/dispatch_table.h"
 #include "vm/hash_table.h"
 #include "vm/isolate.h"
 #include "vm/log.h"
@@ -1409,6 +1410,8 @@ void IsolateReloadContext::ResetUnoptimizedICsOnStack() {
 
 
 void IsolateReloadContext::ResetMegamorphicCaches() {
+  // The rows of the dispatch table refer to the old functions.
+  DispatchTable::Reset(isolate());
   object_store()->set_megamorphic_cache_table(GrowableObjectArray::Handle());
   // Since any current optimized code will not make any more calls, it may be
   // better to clear the table instead of clearing each of the caches, allow
@@ -0,0 +1,405 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#include "vm/loop_vectorizer.h"
+
+#include "vm/bit_vector.h"
+#include "vm/flow_graph.h"
+#include "vm/flow_graph_compiler.h"
+#include "vm/flow_graph_range_analysis.h"
+#include "vm/intermediate_language.h"
+
+namespace dart {
+
+DEFINE_FLAG(bool, loop_vectorization, false,
+    "Vectorize elementwise loops over Float32List using Float32x4 "
+    "operations.");
+DEFINE_FLAG(bool, trace_loop_vectorization, false,
+    "Print the loops rewritten by loop vectorization.");
+
+// Number of Float32List elements processed by one Float32x4 operation.
+static const intptr_t kLanes = 4;
+
+
+static bool IsFloat32Element(intptr_t class_id, intptr_t index_scale) {
+  // External typed data may alias the storage of other arrays at any offset,
+  // internal typed data only aliases itself.
+  return (class_id == kTypedDataFloat32ArrayCid) &&
+      (index_scale == Instance::ElementSizeFor(kTypedDataFloat32ArrayCid));
+}
+
+
+bool LoopVectorizer::IsLoopInvariant(Definition* defn) const {
+  BlockEntryInstr* block = defn->GetBlock();
+  return (block != header_) && (block != body_);
+}
+
+
+bool LoopVectorizer::HasUsesOutsideBody(Definition* defn) const {
+  for (Value* use = defn->input_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    if (use->instruction()->GetBlock() != body_) return true;
+  }
+  for (Value* use = defn->env_use_list();
+       use != NULL;
+       use = use->next_use()) {
+    if (use->instruction()->GetBlock() != body_) return true;
+  }
+  return false;
+}
+
+
+// Single precision operations on the operands of a double operation give the
+// same result as the double operation rounded to single precision if both
+// operands are single precision values: the double format has more than
+// twice the precision of the single format. Results of double operations are
+// thus not operands, so chains of operations are not vectorized.
+bool LoopVectorizer::IsFloatOperand(Value* value) const {
+  Definition* defn = value->definition();
+  if (defn->IsFloatToDouble()) {
+    return true;
+  }
+  if (defn->IsUnboxedConstant() &&
+      (defn->representation() == kUnboxedDouble)) {
+    const Object& constant = defn->AsUnboxedConstant()->value();
+    if (!constant.IsDouble()) return false;
+    const double d = Double::Cast(constant).value();
+    return static_cast<double>(static_cast<float>(d)) == d;
+  }
+  return false;
+}
+
+
+bool LoopVectorizer::MatchBodyInstruction(Instruction* instr) const {
+  if (LoadIndexedInstr* load = instr->AsLoadIndexed()) {
+    return IsFloat32Element(load->class_id(), load->index_scale()) &&
+        (load->index()->definition() == induction_) &&
+        IsLoopInvariant(load->array()->definition()) &&
+        !HasUsesOutsideBody(load);
+  }
+  if (FloatToDoubleInstr* convert = instr->AsFloatToDouble()) {
+    Definition* input = convert->value()->definition();
+    return input->IsLoadIndexed() &&
+        (input->GetBlock() == body_) &&
+        !HasUsesOutsideBody(convert);
+  }
+  if (BinaryDoubleOpInstr* op = instr->AsBinaryDoubleOp()) {
+    switch (op->op_kind()) {
+      case Token::kADD:
+      case Token::kSUB:
+      case Token::kMUL:
+      case Token::kDIV:
+        break;
+      default:
+        return false;
+    }
+    return IsFloatOperand(op->left()) &&
+        IsFloatOperand(op->right()) &&
+        !HasUsesOutsideBody(op);
+  }
+  if (DoubleToFloatInstr* convert = instr->AsDoubleToFloat()) {
+    Definition* input = convert->value()->definition();
+    return (input->IsBinaryDoubleOp() || input->IsFloatToDouble()) &&
+        (input->GetBlock() == body_) &&
+        !HasUsesOutsideBody(convert);
+  }
+  if (instr->IsUnboxedConstant()) {
+    // Operands are checked by the operations using them.
+    return true;
+  }
+  if (StoreIndexedInstr* store = instr->AsStoreIndexed()) {
+    Definition* value = store->value()->definition();
+    return IsFloat32Element(store->class_id(), store->index_scale()) &&
+        (store->index()->definition() == induction_) &&
+        IsLoopInvariant(store->array()->definition()) &&
+        value->IsDoubleToFloat() &&
+        (value->GetBlock() == body_);
+  }
+  return false;
+}
+
+
+// Matches a loop consisting of a header and a single body block:
+//
+//   B_header: i = phi(i_0, i_1)
+//             [CheckStackOverflow]
+//             Branch if i < bound goto B_body else goto B_exit
+//   B_body:   elementwise operations on Float32List elements at index i
+//             i_1 = i + 1
+//             goto B_header
+//
+// where 'bound' is a non-negative loop invariant Smi. Nothing in the body may
+// deoptimize or be used after the loop, other than the induction variable.
+bool LoopVectorizer::Match() {
+  if (header_->PredecessorCount() != 2) return false;
+  // The entry edge of a loop is discovered before its back edge.
+  preheader_ = header_->PredecessorAt(0);
+  body_ = header_->PredecessorAt(1);
+  BitVector* loop_blocks = header_->loop_info();
+  if ((loop_blocks == NULL) ||
+      loop_blocks->Contains(preheader_->preorder_number()) ||
+      !loop_blocks->Contains(body_->preorder_number()) ||
+      !preheader_->last_instruction()->IsGoto() ||
+      !body_->IsTargetEntry() ||
+      (body_->PredecessorAt(0) != header_) ||
+      !body_->last_instruction()->IsGoto()) {
+    return false;
+  }
+
+  if ((header_->phis() == NULL) || (header_->phis()->length() != 1)) {
+    return false;
+  }
+  induction_ = (*header_->phis())[0];
+  if (induction_->representation() != kTagged) return false;
+
+  BranchInstr* branch = NULL;
+  for (ForwardInstructionIterator it(header_); !it.Done(); it.Advance()) {
+    Instruction* instr = it.Current();
+    if (instr->IsCheckStackOverflow()) continue;
+    if (instr->IsBranch()) {
+      branch = instr->AsBranch();
+      continue;
+    }
+    return false;
+  }
+  if ((branch == NULL) || (branch->true_successor() != body_)) return false;
+  RelationalOpInstr* compare = branch->comparison()->AsRelationalOp();
+  if ((compare == NULL) ||
+      (compare->kind() != Token::kLT) ||
+      (compare->operation_cid() != kSmiCid) ||
+      (compare->left()->definition() != induction_)) {
+    return false;
+  }
+  bound_ = compare->right()->definition();
+  if (!IsLoopInvariant(bound_) || !RangeUtils::IsPositive(bound_->range())) {
+    return false;
+  }
+
+  BinarySmiOpInstr* increment =
+      induction_->InputAt(1)->definition()->AsBinarySmiOp();
+  if ((increment == NULL) ||
+      (increment->op_kind() != Token::kADD) ||
+      (increment->left()->definition() != induction_) ||
+      !increment->right()->BindsToConstant() ||
+      !increment->right()->BoundConstant().IsSmi() ||
+      (Smi::Cast(increment->right()->BoundConstant()).Value() != 1) ||
+      increment->CanDeoptimize() ||
+      (increment->GetBlock() != body_)) {
+    return false;
+  }
+  increment_ = increment;
+
+  bool has_store = false;
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* instr = it.Current();
+    if ((instr == increment_) || instr->IsGoto()) continue;
+    if (!MatchBodyInstruction(instr)) return false;
+    has_store = has_store || instr->IsStoreIndexed();
+  }
+  return has_store;
+}
+
+
+Definition* LoopVectorizer::VectorFor(Definition* scalar) const {
+  for (intptr_t i = 0; i < scalars_.length(); i++) {
+    if (scalars_[i] == scalar) return vectors_[i];
+  }
+  UNREACHABLE();
+  return NULL;
+}
+
+
+Definition* LoopVectorizer::VectorOperand(Value* value,
+                                          Instruction* preheader_end) {
+  Zone* zone = flow_graph_->zone();
+  Definition* scalar = value->definition();
+  if (scalar->GetBlock() == body_) {
+    if (scalar->IsFloatToDouble()) {
+      return VectorFor(scalar);
+    }
+    // A constant materialized in the body.
+    ASSERT(scalar->IsUnboxedConstant());
+    scalar = new(zone) UnboxedConstantInstr(
+        scalar->AsUnboxedConstant()->value(), kUnboxedDouble);
+    flow_graph_->InsertBefore(preheader_end, scalar, NULL, FlowGraph::kValue);
+  }
+  Float32x4SplatInstr* splat = new(zone) Float32x4SplatInstr(
+      new(zone) Value(scalar), Thread::kNoDeoptId);
+  flow_graph_->InsertBefore(preheader_end, splat, NULL, FlowGraph::kValue);
+  return splat;
+}
+
+
+// Inserts a vector loop running while 'i + kLanes <= bound' in front of the
+// scalar loop, which then processes the remaining elements:
+//
+//   B_pre:    limit = bound - (kLanes - 1)
+//             goto B_vheader
+//   B_vheader: v = phi(i_0, v_1)
+//             Branch if v < limit goto B_vbody else goto B_vexit
+//   B_vbody:  Float32x4 operations at index v
+//             v_1 = v + kLanes
+//             goto B_vheader
+//   B_vexit:  goto B_header
+//   B_header: i = phi(v, i_1)
+//             ...
+//
+// Neither 'limit' nor 'v_1' can overflow since 'bound' is a non-negative Smi.
+void LoopVectorizer::Vectorize() {
+  Zone* zone = flow_graph_->zone();
+  const intptr_t try_index = header_->try_index();
+  GotoInstr* preheader_goto = preheader_->last_instruction()->AsGoto();
+  BranchInstr* branch = header_->last_instruction()->AsBranch();
+
+  BinarySmiOpInstr* limit = new(zone) BinarySmiOpInstr(
+      Token::kSUB,
+      new(zone) Value(bound_),
+      new(zone) Value(flow_graph_->GetConstant(
+          Smi::Handle(zone, Smi::New(kLanes - 1)))),
+      Thread::kNoDeoptId);
+  limit->set_can_overflow(false);
+  flow_graph_->InsertBefore(preheader_goto, limit, NULL, FlowGraph::kValue);
+
+  JoinEntryInstr* vector_header =
+      new(zone) JoinEntryInstr(flow_graph_->allocate_block_id(), try_index);
+  TargetEntryInstr* vector_body =
+      new(zone) TargetEntryInstr(flow_graph_->allocate_block_id(), try_index);
+  TargetEntryInstr* vector_exit =
+      new(zone) TargetEntryInstr(flow_graph_->allocate_block_id(), try_index);
+
+  // Vector loop header.
+  PhiInstr* index = new(zone) PhiInstr(vector_header, 2);
+  Value* entry_value = new(zone) Value(induction_->InputAt(0)->definition());
+  index->SetInputAt(0, entry_value);
+  entry_value->definition()->AddInputUse(entry_value);
+  flow_graph_->AllocateSSAIndexes(index);
+  index->mark_alive();
+  vector_header->InsertPhi(index);
+
+  RelationalOpInstr* compare = new(zone) RelationalOpInstr(
+      branch->comparison()->token_pos(),
+      Token::kLT,
+      new(zone) Value(index),
+      new(zone) Value(limit),
+      kSmiCid,
+      Thread::kNoDeoptId);
+  BranchInstr* vector_branch = new(zone) BranchInstr(compare);
+  flow_graph_->AppendTo(vector_header, vector_branch, NULL, FlowGraph::kEffect);
+  vector_header->set_last_instruction(vector_branch);
+  *vector_branch->true_successor_address() = vector_body;
+  *vector_branch->false_successor_address() = vector_exit;
+
+  // Vector loop body, in the order of the scalar body.
+  Instruction* cursor = vector_body;
+  for (ForwardInstructionIterator it(body_); !it.Done(); it.Advance()) {
+    Instruction* instr = it.Current();
+    if (LoadIndexedInstr* load = instr->AsLoadIndexed()) {
+      LoadIndexedInstr* vector = new(zone) LoadIndexedInstr(
+          new(zone) Value(load->array()->definition()),
+          new(zone) Value(index),
+          load->index_scale(),
+          kTypedDataFloat32x4ArrayCid,
+          Thread::kNoDeoptId,
+          load->token_pos());
+      cursor = flow_graph_->AppendTo(cursor, vector, NULL, FlowGraph::kValue);
+      scalars_.Add(load);
+      vectors_.Add(vector);
+    } else if (FloatToDoubleInstr* convert = instr->AsFloatToDouble()) {
+      scalars_.Add(convert);
+      vectors_.Add(VectorFor(convert->value()->definition()));
+    } else if (BinaryDoubleOpInstr* op = instr->AsBinaryDoubleOp()) {
+      BinaryFloat32x4OpInstr* vector = new(zone) BinaryFloat32x4OpInstr(
+          op->op_kind(),
+          new(zone) Value(VectorOperand(op->left(), preheader_goto)),
+          new(zone) Value(VectorOperand(op->right(), preheader_goto)),
+          Thread::kNoDeoptId);
+      cursor = flow_graph_->AppendTo(cursor, vector, NULL, FlowGraph::kValue);
+      scalars_.Add(op);
+      vectors_.Add(vector);
+    } else if (DoubleToFloatInstr* convert = instr->AsDoubleToFloat()) {
+      scalars_.Add(convert);
+      vectors_.Add(VectorFor(convert->value()->definition()));
+    } else if (StoreIndexedInstr* store = instr->AsStoreIndexed()) {
+      StoreIndexedInstr* vector = new(zone) StoreIndexedInstr(
+          new(zone) Value(store->array()->definition()),
+          new(zone) Value(index),
+          new(zone) Value(VectorFor(store->value()->definition())),
+          kNoStoreBarrier,
+          store->index_scale(),
+          kTypedDataFloat32x4ArrayCid,
+          Thread::kNoDeoptId,
+          store->token_pos());
+      cursor = flow_graph_->AppendTo(cursor, vector, NULL, FlowGraph::kEffect);
+    }
+  }
+
+  BinarySmiOpInstr* next = new(zone) BinarySmiOpInstr(
+      Token::kADD,
+      new(zone) Value(index),
+      new(zone) Value(flow_graph_->GetConstant(
+          Smi::Handle(zone, Smi::New(kLanes)))),
+      Thread::kNoDeoptId);
+  next->set_can_overflow(false);
+  cursor = flow_graph_->AppendTo(cursor, next, NULL, FlowGraph::kValue);
+  GotoInstr* back_edge = new(zone) GotoInstr(vector_header);
+  flow_graph_->AppendTo(cursor, back_edge, NULL, FlowGraph::kEffect);
+  vector_body->set_last_instruction(back_edge);
+
+  Value* back_value = new(zone) Value(next);
+  index->SetInputAt(1, back_value);
+  next->AddInputUse(back_value);
+
+  // Enter the scalar loop with the index reached by the vector loop.
+  GotoInstr* exit_goto = new(zone) GotoInstr(header_);
+  flow_graph_->AppendTo(vector_exit, exit_goto, NULL, FlowGraph::kEffect);
+  vector_exit->set_last_instruction(exit_goto);
+
+  preheader_goto->set_successor(vector_header);
+  Value* scalar_entry = induction_->InputAt(0);
+  scalar_entry->RemoveFromUseList();
+  scalar_entry->set_definition(index);
+  index->AddInputUse(scalar_entry);
+}
+
+
+void LoopVectorizer::Optimize(FlowGraph* flow_graph) {
+  if (!FLAG_loop_vectorization ||
+      !FlowGraphCompiler::SupportsUnboxedSimd128()) {
+    return;
+  }
+
+  // Match all loops before changing the graph, which invalidates the block
+  // order the loop information refers to.
+  Zone* zone = flow_graph->zone();
+  const ZoneGrowableArray<BlockEntryInstr*>& headers =
+      flow_graph->LoopHeaders();
+  GrowableArray<LoopVectorizer*> loops;
+  for (intptr_t i = 0; i < headers.length(); i++) {
+    JoinEntryInstr* header = headers[i]->AsJoinEntry();
+    if (header == NULL) continue;
+    LoopVectorizer* loop = new(zone) LoopVectorizer(flow_graph, header);
+    if (loop->Match()) {
+      loops.Add(loop);
+    }
+  }
+  if (loops.is_empty()) {
+    return;
+  }
+
+  for (intptr_t i = 0; i < loops.length(); i++) {
+    if (FLAG_trace_loop_vectorization) {
+      THR_Print("Vectorizing loop at B%" Pd " in %s\n",
+                loops[i]->header_->block_id(),
+                flow_graph->function().ToFullyQualifiedCString());
+    }
+    loops[i]->Vectorize();
+  }
+
+  flow_graph->DiscoverBlocks();
+  GrowableArray<BitVector*> dominance_frontier;
+  flow_graph->ComputeDominators(&dominance_frontier);
+}
+
+}  // namespace dart
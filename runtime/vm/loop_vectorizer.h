@@ -0,0 +1,76 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+#ifndef VM_LOOP_VECTORIZER_H_
+#define VM_LOOP_VECTORIZER_H_
+
+#include "vm/allocation.h"
+#include "vm/growable_array.h"
+
+namespace dart {
+
+class BlockEntryInstr;
+class Definition;
+class FlowGraph;
+class Instruction;
+class JoinEntryInstr;
+class PhiInstr;
+class Value;
+
+// Rewrites counted loops that apply an elementwise arithmetic operation to
+// Float32List elements, e.g.
+//
+//   for (var i = 0; i < n; i++) c[i] = a[i] * b[i];
+//
+// into a loop processing four elements per iteration with Float32x4
+// instructions, followed by the original loop for the remaining elements.
+// Must run after range analysis: the bounds checks of the loop body have to
+// be eliminated or hoisted out of the loop.
+class LoopVectorizer : public ZoneAllocated {
+ public:
+  static void Optimize(FlowGraph* flow_graph);
+
+ private:
+  LoopVectorizer(FlowGraph* flow_graph, JoinEntryInstr* header)
+      : flow_graph_(flow_graph),
+        header_(header),
+        preheader_(NULL),
+        body_(NULL),
+        induction_(NULL),
+        bound_(NULL),
+        increment_(NULL),
+        scalars_(),
+        vectors_() { }
+
+  // Returns true if the loop has the shape handled by Vectorize.
+  bool Match();
+  bool MatchBodyInstruction(Instruction* instr) const;
+  bool IsLoopInvariant(Definition* defn) const;
+  bool IsFloatOperand(Value* value) const;
+  bool HasUsesOutsideBody(Definition* defn) const;
+
+  // Inserts the vector loop between the preheader and the header. Does not
+  // update the block order and the dominator tree.
+  void Vectorize();
+  Definition* VectorOperand(Value* value, Instruction* preheader_end);
+  Definition* VectorFor(Definition* scalar) const;
+
+  FlowGraph* flow_graph_;
+  JoinEntryInstr* header_;
+  BlockEntryInstr* preheader_;
+  BlockEntryInstr* body_;
+  PhiInstr* induction_;
+  Definition* bound_;
+  Definition* increment_;
+
+  // Scalar definitions of the body and their vector counterparts.
+  GrowableArray<Definition*> scalars_;
+  GrowableArray<Definition*> vectors_;
+
+  DISALLOW_COPY_AND_ASSIGN(LoopVectorizer);
+};
+
+}  // namespace dart
+
+#endif  // VM_LOOP_VECTORIZER_H_
@@ -5,6 +5,7 @@
 #include "vm/megamorphic_cache_table.h"
 
 #include <stdlib.h>
+#include "vm/dispatch_table.h"
 #include "vm/handles_impl.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
@@ -39,6 +40,13 @@ RawMegamorphicCache* MegamorphicCacheTable::Lookup(Isolate* isolate,
   }
 
   cache = MegamorphicCache::New(name, descriptor);
+  if (FLAG_precompiled_mode) {
+    // The rows were built by the precompiler.
+    cache.set_dispatch_offset(
+        DispatchTable::LookupOffset(isolate, name, descriptor));
+  } else if (FLAG_use_dispatch_table) {
+    cache.set_dispatch_offset(DispatchTable::kUnbuiltOffset);
+  }
   table.Add(cache, Heap::kOld);
   return cache.raw();
 }
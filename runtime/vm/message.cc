@@ -44,6 +44,7 @@ const char* Message::PriorityAsString(Priority priority) {
 MessageQueue::MessageQueue() {
   head_ = NULL;
   tail_ = NULL;
+  incoming_ = 0;
 }
 
 
@@ -57,6 +58,8 @@ MessageQueue::~MessageQueue() {
 void MessageQueue::Enqueue(Message* msg, bool before_events) {
   // Make sure messages are not reused.
   ASSERT(msg->next_ == NULL);
+  // Keep the order with messages that were enqueued concurrently.
+  ClaimConcurrentMessages();
   if (head_ == NULL) {
     // Only element in the queue.
     ASSERT(tail_ == NULL);
@@ -96,7 +99,64 @@ void MessageQueue::Enqueue(Message* msg, bool before_events) {
 }
 
 
+void MessageQueue::ConcurrentEnqueue(Message* msg) {
+  // Make sure messages are not reused.
+  ASSERT(msg->next_ == NULL);
+  uword new_incoming = reinterpret_cast<uword>(msg);
+  uword old_incoming = AtomicOperations::LoadRelaxed(&incoming_);
+  while (true) {
+    msg->next_ = reinterpret_cast<Message*>(old_incoming);
+    uword actual = AtomicOperations::CompareAndSwapWord(
+        &incoming_, old_incoming, new_incoming);
+    if (actual == old_incoming) {
+      return;
+    }
+    old_incoming = actual;
+  }
+}
+
+
+bool MessageQueue::ClaimConcurrentMessages() {
+  // Take the whole stack at once. Senders only ever push, so there is no ABA
+  // problem here.
+  uword incoming = AtomicOperations::LoadRelaxed(&incoming_);
+  while (incoming != 0) {
+    uword actual =
+        AtomicOperations::CompareAndSwapWord(&incoming_, incoming, 0);
+    if (actual == incoming) {
+      break;
+    }
+    incoming = actual;
+  }
+  if (incoming == 0) {
+    return false;
+  }
+
+  // The stack holds the newest message first; reverse it and append.
+  Message* newest = reinterpret_cast<Message*>(incoming);
+  Message* oldest = NULL;
+  Message* cur = newest;
+  while (cur != NULL) {
+    Message* next = cur->next_;
+    cur->next_ = oldest;
+    oldest = cur;
+    cur = next;
+  }
+  if (head_ == NULL) {
+    ASSERT(tail_ == NULL);
+    head_ = oldest;
+  } else {
+    tail_->next_ = oldest;
+  }
+  tail_ = newest;
+  return true;
+}
+
+
 Message* MessageQueue::Dequeue() {
+  if (head_ == NULL) {
+    ClaimConcurrentMessages();
+  }
   Message* result = head_;
   if (result != NULL) {
     head_ = result->next_;
@@ -114,6 +174,7 @@ Message* MessageQueue::Dequeue() {
 
 
 void MessageQueue::Clear() {
+  ClaimConcurrentMessages();
   Message* cur = head_;
   head_ = NULL;
   tail_ = NULL;
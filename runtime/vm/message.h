@@ -7,6 +7,7 @@
 
 #include "platform/assert.h"
 #include "vm/allocation.h"
+#include "vm/atomic.h"
 #include "vm/globals.h"
 #include "vm/raw_object.h"
 
@@ -119,6 +120,11 @@ class Message {
 };
 
 // There is a message queue per isolate.
+//
+// Senders on any thread may add messages with ConcurrentEnqueue without
+// holding a lock; those messages are kept on a separate lock-free stack until
+// the owner of the queue claims them. All other operations must be serialized
+// by the owner (the message handler's monitor).
 class MessageQueue {
  public:
   MessageQueue();
@@ -126,11 +132,24 @@ class MessageQueue {
 
   void Enqueue(Message* msg, bool before_events);
 
+  // Adds msg at the tail of the queue. Safe to call from any thread
+  // concurrently with other senders and with the owner of the queue.
+  void ConcurrentEnqueue(Message* msg);
+
+  // Moves concurrently enqueued messages to the tail of the queue in the
+  // order they were enqueued. Returns true if any messages were moved.
+  bool ClaimConcurrentMessages();
+
   // Gets the next message from the message queue or NULL if no
   // message is available.  This function will not block.
   Message* Dequeue();
 
-  bool IsEmpty() { return head_ == NULL; }
+  bool IsEmpty() {
+    return (head_ == NULL) && (AtomicOperations::LoadRelaxed(&incoming_) == 0);
+  }
+
+  // Returns true if messages that have already been claimed are pending.
+  bool HasClaimedMessages() const { return head_ != NULL; }
 
   // Clear all messages from the message queue.
   void Clear();
@@ -163,6 +182,9 @@ class MessageQueue {
  private:
   Message* head_;
   Message* tail_;
+  // Most recently added message of the concurrently enqueued ones, linked
+  // through next_ in reverse order of enqueueing.
+  uword incoming_;
 
   DISALLOW_COPY_AND_ASSIGN(MessageQueue);
 };
@@ -4,6 +4,7 @@
 
 #include "vm/message_handler.h"
 
+#include "vm/atomic.h"
 #include "vm/dart.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
@@ -127,31 +128,49 @@ void MessageHandler::Run(ThreadPool* pool,
 
 
 void MessageHandler::PostMessage(Message* message, bool before_events) {
-  Message::Priority saved_priority;
-  bool task_running = true;
-  {
-    MonitorLocker ml(&monitor_);
-    if (FLAG_trace_isolates) {
-      const char* source_name = "<native code>";
-      Isolate* source_isolate = Isolate::Current();
-      if (source_isolate) {
-        source_name = source_isolate->name();
-      }
-      OS::Print("[>] Posting message:\n"
-                "\tlen:        %" Pd "\n"
-                "\tsource:     %s\n"
-                "\tdest:       %s\n"
-                "\tdest_port:  %" Pd64 "\n",
-                message->len(), source_name, name(), message->dest_port());
+  Message::Priority saved_priority = message->priority();
+  if (FLAG_trace_isolates) {
+    const char* source_name = "<native code>";
+    Isolate* source_isolate = Isolate::Current();
+    if (source_isolate) {
+      source_name = source_isolate->name();
     }
+    OS::Print("[>] Posting message:\n"
+              "\tlen:        %" Pd "\n"
+              "\tsource:     %s\n"
+              "\tdest:       %s\n"
+              "\tdest_port:  %" Pd64 "\n",
+              message->len(), source_name, name(), message->dest_port());
+  }
 
-    saved_priority = message->priority();
+  if (!before_events) {
+    // Publish the message without taking the monitor. A running task is
+    // guaranteed to see it: either it dequeues the message, or it claims it
+    // after giving up task_ in ReleaseTaskLocked.
     if (message->IsOOB()) {
-      oob_queue_->Enqueue(message, before_events);
+      oob_queue_->ConcurrentEnqueue(message);
     } else {
-      queue_->Enqueue(message, before_events);
+      queue_->ConcurrentEnqueue(message);
     }
     message = NULL;  // Do not access message.  May have been deleted.
+    if (AtomicOperations::LoadRelaxed(&task_) != NULL) {
+      // Invoke any custom message notification.
+      MessageNotify(saved_priority);
+      return;
+    }
+  }
+
+  bool task_running = true;
+  {
+    MonitorLocker ml(&monitor_);
+    if (message != NULL) {
+      if (message->IsOOB()) {
+        oob_queue_->Enqueue(message, before_events);
+      } else {
+        queue_->Enqueue(message, before_events);
+      }
+      message = NULL;  // Do not access message.  May have been deleted.
+    }
 
     if ((pool_ != NULL) && (task_ == NULL)) {
       ASSERT(!delete_me_);
@@ -166,6 +185,26 @@ void MessageHandler::PostMessage(Message* message, bool before_events) {
 }
 
 
+void MessageHandler::ReleaseTaskLocked() {
+  // Senders that saw task_ set did not take the monitor and relied on this
+  // task to pick up their messages. Clear task_ with a full barrier before
+  // looking at the queues one last time so that no message can fall through
+  // the gap; each sender either sees task_ cleared or has its message claimed
+  // here.
+  AtomicOperations::CompareAndSwapWord(reinterpret_cast<uword*>(&task_),
+                                       reinterpret_cast<uword>(task_),
+                                       0);
+  const bool claimed_oob = oob_queue_->ClaimConcurrentMessages();
+  const bool claimed = queue_->ClaimConcurrentMessages();
+  if ((claimed_oob || claimed) && (pool_ != NULL)) {
+    ASSERT(!delete_me_);
+    task_ = new MessageHandlerTask(this);
+    bool task_running = pool_->Run(task_);
+    ASSERT(task_running);
+  }
+}
+
+
 Message* MessageHandler::DequeueMessage(Message::Priority min_priority) {
   // TODO(turnidge): Add assert that monitor_ is held here.
   Message* message = oob_queue_->Dequeue();
@@ -341,8 +380,8 @@ void MessageHandler::TaskCallback() {
       status = HandleMessages(&ml, false, false);
       if (ShouldPauseOnStart(status)) {
         // Still paused.
-        ASSERT(oob_queue_->IsEmpty());
-        task_ = NULL;  // No task in queue.
+        ASSERT(!oob_queue_->HasClaimedMessages());
+        ReleaseTaskLocked();
         return;
       } else {
         PausedOnStartLocked(&ml, false);
@@ -384,8 +423,8 @@ void MessageHandler::TaskCallback() {
         }
         if (ShouldPauseOnExit(status)) {
           // Still paused.
-          ASSERT(oob_queue_->IsEmpty());
-          task_ = NULL;  // No task in queue.
+          ASSERT(!oob_queue_->HasClaimedMessages());
+          ReleaseTaskLocked();
           return;
         } else {
           PausedOnExitLocked(&ml, false);
@@ -411,8 +450,8 @@ void MessageHandler::TaskCallback() {
 
     // Clear the task_ last.  This allows other tasks to potentially start
     // for this message handler.
-    ASSERT(oob_queue_->IsEmpty());
-    task_ = NULL;
+    ASSERT(!oob_queue_->HasClaimedMessages());
+    ReleaseTaskLocked();
   }
 
   // Message handlers either use delete_me or end_callback but not both.
@@ -563,6 +602,9 @@ MessageHandler::AcquiredQueues::AcquiredQueues(MessageHandler* handler)
     : handler_(handler), ml_(&handler->monitor_) {
   ASSERT(handler != NULL);
   handler_->oob_message_handling_allowed_ = false;
+  // Make messages posted without the monitor visible to iteration.
+  handler_->queue_->ClaimConcurrentMessages();
+  handler_->oob_queue_->ClaimConcurrentMessages();
 }
 
 
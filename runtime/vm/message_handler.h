@@ -228,6 +228,10 @@ class MessageHandler {
 
   void ClearOOBQueue();
 
+  // Clears task_ when the running task is done. Starts a new task if
+  // messages were posted concurrently while the task was finishing.
+  void ReleaseTaskLocked();
+
   // Handles any pending messages.
   MessageStatus HandleMessages(MonitorLocker* ml,
                                bool allow_normal_messages,
@@ -3,7 +3,9 @@
 // BSD-style license that can be found in the LICENSE file.
 
 #include "platform/assert.h"
+#include "vm/lockers.h"
 #include "vm/message.h"
+#include "vm/thread_pool.h"
 #include "vm/unit_test.h"
 
 namespace dart {
@@ -153,4 +155,112 @@ TEST_CASE(MessageQueue_Clear) {
   // msg1 and msg2 already delete by FlushAll.
 }
 
+
+TEST_CASE(MessageQueue_ConcurrentEnqueue) {
+  MessageQueue queue;
+  Dart_Port port = 1;
+
+  Message* msg1 = new Message(port, Smi::New(1), Message::kNormalPriority);
+  Message* msg2 = new Message(port, Smi::New(2), Message::kNormalPriority);
+  Message* msg3 = new Message(port, Smi::New(3), Message::kNormalPriority);
+  Message* msg4 = new Message(port, Smi::New(4), Message::kNormalPriority);
+
+  queue.ConcurrentEnqueue(msg1);
+  EXPECT(!queue.IsEmpty());
+  EXPECT(!queue.HasClaimedMessages());
+  queue.ConcurrentEnqueue(msg2);
+  // Regular enqueueing keeps the order with concurrently enqueued messages.
+  queue.Enqueue(msg3, false);
+  EXPECT(queue.HasClaimedMessages());
+  queue.ConcurrentEnqueue(msg4);
+  EXPECT(queue.Length() == 3);
+
+  EXPECT(queue.Dequeue() == msg1);
+  EXPECT(queue.Dequeue() == msg2);
+  EXPECT(queue.Dequeue() == msg3);
+  EXPECT(queue.Dequeue() == msg4);
+  EXPECT(queue.Dequeue() == NULL);
+  EXPECT(queue.IsEmpty());
+  EXPECT(!queue.ClaimConcurrentMessages());
+
+  delete msg1;
+  delete msg2;
+  delete msg3;
+  delete msg4;
+}
+
+
+class MessageSenderTask : public ThreadPool::Task {
+ public:
+  MessageSenderTask(MessageQueue* queue,
+                    intptr_t sender,
+                    intptr_t count,
+                    Monitor* sync,
+                    intptr_t* done)
+      : queue_(queue),
+        sender_(sender),
+        count_(count),
+        sync_(sync),
+        done_(done) {
+  }
+
+  virtual void Run() {
+    for (intptr_t i = 0; i < count_; i++) {
+      queue_->ConcurrentEnqueue(new Message(
+          sender_, Smi::New(i), Message::kNormalPriority));
+    }
+    MonitorLocker ml(sync_);
+    (*done_)++;
+    ml.Notify();
+  }
+
+ private:
+  MessageQueue* queue_;
+  intptr_t sender_;
+  intptr_t count_;
+  Monitor* sync_;
+  intptr_t* done_;
+};
+
+
+TEST_CASE(MessageQueue_ConcurrentSenders) {
+  const intptr_t kNumSenders = 4;
+  const intptr_t kMessagesPerSender = 10000;
+  MessageQueue queue;
+  ThreadPool thread_pool;
+  Monitor sync;
+  intptr_t done = 0;
+  for (intptr_t i = 0; i < kNumSenders; i++) {
+    thread_pool.Run(new MessageSenderTask(
+        &queue, i + 1, kMessagesPerSender, &sync, &done));
+  }
+
+  // Receive while the senders are running; every sender's messages must
+  // arrive complete and in order.
+  intptr_t next[kNumSenders + 1] = { 0 };
+  intptr_t received = 0;
+  while (received < (kNumSenders * kMessagesPerSender)) {
+    Message* msg = queue.Dequeue();
+    if (msg == NULL) {
+      OS::Sleep(0);
+      continue;
+    }
+    intptr_t sender = msg->dest_port();
+    EXPECT_EQ(next[sender], Smi::Value(Smi::RawCast(msg->raw_obj())));
+    next[sender]++;
+    received++;
+    delete msg;
+  }
+  {
+    MonitorLocker ml(&sync);
+    while (done < kNumSenders) {
+      ml.Wait();
+    }
+  }
+  EXPECT(queue.IsEmpty());
+  for (intptr_t i = 1; i <= kNumSenders; i++) {
+    EXPECT_EQ(kMessagesPerSender, next[i]);
+  }
+}
+
 }  // namespace dart
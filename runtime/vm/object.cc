@@ -22,6 +22,7 @@
 #include "vm/debugger.h"
 #include "vm/deopt_instructions.h"
 #include "vm/disassembler.h"
+#include "vm/dispatch_table.h"
 #include "vm/double_conversion.h"
 #include "vm/exceptions.h"
 #include "vm/growable_array.h"
@@ -1324,6 +1325,11 @@ NOT_IN_PRODUCT(
     RegisterPrivateClass(cls, Symbols::_SendPortImpl(), isolate_lib);
     pending_classes.Add(cls);
 
+    cls = Class::New<TransferableTypedData>();
+    RegisterPrivateClass(cls, Symbols::_TransferableTypedDataImpl(),
+                         isolate_lib);
+    pending_classes.Add(cls);
+
     const Class& stacktrace_cls = Class::Handle(zone,
                                                 Class::New<Stacktrace>());
     RegisterPrivateClass(stacktrace_cls, Symbols::_StackTrace(), core_lib);
@@ -1741,6 +1747,7 @@ NOT_IN_PRODUCT(
     cls = Class::New<Capability>();
     cls = Class::New<ReceivePort>();
     cls = Class::New<SendPort>();
+    cls = Class::New<TransferableTypedData>();
     cls = Class::New<Stacktrace>();
     cls = Class::New<RegExp>();
     cls = Class::New<Number>();
@@ -2629,6 +2636,10 @@ RawFunction* Class::GetInvocationDispatcher(const String& target_name,
   }
 
   if (dispatcher.IsNull() && create_if_absent) {
+    if (Compiler::IsBackgroundCompilation()) {
+      Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+          "Invocation dispatcher created while compiling");
+    }
     if (i == cache.Length()) {
       // Allocate new larger cache.
       intptr_t new_len = (cache.Length() == 0)
@@ -2707,6 +2718,10 @@ RawFunction* Function::CreateMethodExtractor(const String& getter_name) const {
   Thread* thread = Thread::Current();
   Zone* zone = thread->zone();
   ASSERT(Field::IsGetterName(getter_name));
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Method extractor created while compiling");
+  }
   const Function& closure_function =
       Function::Handle(zone, ImplicitClosureFunction());
 
@@ -6627,6 +6642,12 @@ RawFunction* Function::NewClosureFunction(const String& name,
                                           const Function& parent,
                                           TokenPosition token_pos) {
   ASSERT(!parent.IsNull());
+  // Closure functions are registered with the isolate, which only the mutator
+  // may do.
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Closure function created while compiling");
+  }
   // Use the owner defining the parent function and not the class containing it.
   const Object& parent_owner = Object::Handle(parent.raw_ptr()->owner_);
   ASSERT(!parent_owner.IsNull());
@@ -6855,6 +6876,10 @@ void Function::BuildSignatureParameters(
 
 RawInstance* Function::ImplicitStaticClosure() const {
   if (implicit_static_closure() == Instance::null()) {
+    if (Compiler::IsBackgroundCompilation()) {
+      Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+          "Implicit static closure created while compiling");
+    }
     Thread* thread = Thread::Current();
     Isolate* isolate = thread->isolate();
     Zone* zone = thread->zone();
@@ -14792,6 +14817,16 @@ void MegamorphicCache::set_filled_entry_count(intptr_t count) const {
 }
 
 
+intptr_t MegamorphicCache::dispatch_offset() const {
+  return Smi::Value(raw_ptr()->dispatch_offset_);
+}
+
+
+void MegamorphicCache::set_dispatch_offset(intptr_t offset) const {
+  StoreSmi(&raw_ptr()->dispatch_offset_, Smi::New(offset));
+}
+
+
 void MegamorphicCache::set_target_name(const String& value) const {
   StorePointer(&raw_ptr()->target_name_, value.raw());
 }
@@ -14811,6 +14846,7 @@ RawMegamorphicCache* MegamorphicCache::New() {
     result ^= raw;
   }
   result.set_filled_entry_count(0);
+  result.set_dispatch_offset(DispatchTable::kNoOffset);
   return result.raw();
 }
 
@@ -14837,6 +14873,7 @@ RawMegamorphicCache* MegamorphicCache::New(const String& target_name,
   result.set_target_name(target_name);
   result.set_arguments_descriptor(arguments_descriptor);
   result.set_filled_entry_count(0);
+  result.set_dispatch_offset(DispatchTable::kNoOffset);
   return result.raw();
 }
 
@@ -20064,6 +20101,50 @@ RawString* String::FromUTF8(const uint8_t* utf8_array,
 }
 
 
+static const uint8_t* TypedDataBytesAt(const Instance& typed_data,
+                                       intptr_t byte_offset) {
+  if (typed_data.IsTypedData()) {
+    return reinterpret_cast<const uint8_t*>(
+        TypedData::Cast(typed_data).DataAddr(byte_offset));
+  }
+  return reinterpret_cast<const uint8_t*>(
+      ExternalTypedData::Cast(typed_data).DataAddr(byte_offset));
+}
+
+
+RawString* String::FromUTF8(const Instance& typed_data,
+                            intptr_t byte_offset,
+                            intptr_t array_len,
+                            Heap::Space space) {
+  ASSERT(typed_data.IsTypedData() || typed_data.IsExternalTypedData());
+  if (array_len == 0) {
+    return Symbols::Empty().raw();
+  }
+  Utf8::Type type;
+  intptr_t len;
+  {
+    NoSafepointScope no_safepoint;
+    len = Utf8::CodeUnitCount(TypedDataBytesAt(typed_data, byte_offset),
+                              array_len, &type);
+  }
+  // The bytes are looked up again after allocating the result since the
+  // allocation may have moved them.
+  if (type == Utf8::kLatin1) {
+    const String& strobj = String::Handle(OneByteString::New(len, space));
+    NoSafepointScope no_safepoint;
+    Utf8::DecodeToLatin1(TypedDataBytesAt(typed_data, byte_offset), array_len,
+                         OneByteString::CharAddr(strobj, 0), len);
+    return strobj.raw();
+  }
+  ASSERT((type == Utf8::kBMP) || (type == Utf8::kSupplementary));
+  const String& strobj = String::Handle(TwoByteString::New(len, space));
+  NoSafepointScope no_safepoint;
+  Utf8::DecodeToUTF16(TypedDataBytesAt(typed_data, byte_offset), array_len,
+                      TwoByteString::CharAddr(strobj, 0), len);
+  return strobj.raw();
+}
+
+
 RawString* String::FromLatin1(const uint8_t* latin1_array,
                               intptr_t array_len,
                               Heap::Space space) {
@@ -20574,6 +20655,44 @@ void String::ToUTF8(uint8_t* utf8_array, intptr_t array_len) const {
 }
 
 
+void String::ToLatin1(uint8_t* latin1_array, intptr_t array_len) const {
+  ASSERT(CharSize() == kOneByteChar);
+  const intptr_t len = Length();
+  ASSERT(array_len >= len);
+  if (len == 0) {
+    return;
+  }
+  NoSafepointScope no_safepoint;
+  const uint8_t* chars = IsOneByteString()
+      ? OneByteString::CharAddr(*this, 0)
+      : ExternalOneByteString::CharAddr(*this, 0);
+  memmove(latin1_array, chars, len);
+}
+
+
+void String::ToUTF16(uint16_t* utf16_array, intptr_t array_len) const {
+  const intptr_t len = Length();
+  ASSERT(array_len >= len);
+  if (len == 0) {
+    return;
+  }
+  NoSafepointScope no_safepoint;
+  if (CharSize() == kOneByteChar) {
+    const uint8_t* chars = IsOneByteString()
+        ? OneByteString::CharAddr(*this, 0)
+        : ExternalOneByteString::CharAddr(*this, 0);
+    for (intptr_t i = 0; i < len; i++) {
+      utf16_array[i] = chars[i];
+    }
+  } else {
+    const uint16_t* chars = IsTwoByteString()
+        ? TwoByteString::CharAddr(*this, 0)
+        : ExternalTwoByteString::CharAddr(*this, 0);
+    memmove(utf16_array, chars, len * sizeof(*chars));
+  }
+}
+
+
 static FinalizablePersistentHandle* AddFinalizer(
     const Object& referent,
     void* peer,
@@ -21814,6 +21933,18 @@ RawLinkedHashMap* LinkedHashMap::NewDefault(Heap::Space space) {
 }
 
 
+RawLinkedHashMap* LinkedHashMap::NewWithoutIndex(intptr_t num_pairs,
+                                                 Heap::Space space) {
+  const intptr_t used_data = num_pairs << 1;
+  const intptr_t data_size = Utils::Maximum(
+      Utils::RoundUpToPowerOfTwo(used_data),
+      static_cast<uintptr_t>(kInitialIndexSize));
+  const Array& data = Array::Handle(Array::New(data_size, space));
+  // Prefer sentinel 0 over null for the hash mask, for better type feedback.
+  return LinkedHashMap::New(data, TypedData::Handle(), 0, used_data, 0, space);
+}
+
+
 RawLinkedHashMap* LinkedHashMap::New(const Array& data,
                                      const TypedData& index,
                                      intptr_t hash_mask,
@@ -22331,6 +22462,50 @@ const char* SendPort::ToCString() const {
 }
 
 
+void TransferableTypedDataPeer::Detach(Isolate* isolate) {
+  ASSERT(!IsDetached());
+  data_ = NULL;
+  length_ = 0;
+  if (handle_ != NULL) {
+    handle_->EnsureFreeExternal(isolate);
+  }
+}
+
+
+static void TransferableTypedDataFinalizer(void* isolate_callback_data,
+                                           Dart_WeakPersistentHandle handle,
+                                           void* peer) {
+  delete reinterpret_cast<TransferableTypedDataPeer*>(peer);
+}
+
+
+RawTransferableTypedData* TransferableTypedData::New(uint8_t* data,
+                                                     intptr_t length,
+                                                     Heap::Space space) {
+  TransferableTypedDataPeer* peer = new TransferableTypedDataPeer(data, length);
+  TransferableTypedData& result = TransferableTypedData::Handle();
+  {
+    RawObject* raw = Object::Allocate(TransferableTypedData::kClassId,
+                                      TransferableTypedData::InstanceSize(),
+                                      space);
+    NoSafepointScope no_safepoint;
+    result ^= raw;
+    result.StoreNonPointer(&result.raw_ptr()->peer_, peer);
+  }
+  // The finalizer frees the bytes if they are never sent or materialized.
+  peer->set_handle(dart::AddFinalizer(result,
+                                      peer,
+                                      &TransferableTypedDataFinalizer,
+                                      length));
+  return result.raw();
+}
+
+
+const char* TransferableTypedData::ToCString() const {
+  return "TransferableTypedData";
+}
+
+
 const char* Closure::ToCString() const {
   const Function& fun = Function::Handle(function());
   const bool is_implicit_closure = fun.IsImplicitClosureFunction();
@@ -5083,6 +5083,11 @@ class MegamorphicCache : public Object {
   intptr_t filled_entry_count() const;
   void set_filled_entry_count(intptr_t num) const;
 
+  // The offset of the selector's row in the dispatch table, or
+  // DispatchTable::kNoOffset if the selector has no row.
+  intptr_t dispatch_offset() const;
+  void set_dispatch_offset(intptr_t offset) const;
+
   static intptr_t buckets_offset() {
     return OFFSET_OF(RawMegamorphicCache, buckets_);
   }
@@ -5092,6 +5097,9 @@ class MegamorphicCache : public Object {
   static intptr_t arguments_descriptor_offset() {
     return OFFSET_OF(RawMegamorphicCache, args_descriptor_);
   }
+  static intptr_t dispatch_offset_offset() {
+    return OFFSET_OF(RawMegamorphicCache, dispatch_offset_);
+  }
 
   static RawMegamorphicCache* New(const String& target_name,
                                   const Array& arguments_descriptor);
@@ -6736,6 +6744,12 @@ class String : public Instance {
 
   void ToUTF8(uint8_t* utf8_array, intptr_t array_len) const;
 
+  // Copies the characters of a one-byte string into 'latin1_array'.
+  void ToLatin1(uint8_t* latin1_array, intptr_t array_len) const;
+
+  // Copies the UTF-16 code units of the string into 'utf16_array'.
+  void ToUTF16(uint16_t* utf16_array, intptr_t array_len) const;
+
   // Copies the string characters into the provided external array
   // and morphs the string object into an external string object.
   // The remaining unused part of the original string object is marked as
@@ -6756,6 +6770,15 @@ class String : public Instance {
                              intptr_t array_len,
                              Heap::Space space = Heap::kNew);
 
+  // Creates a new String object from the UTF-8 encoded characters at
+  // 'byte_offset' in 'typed_data', which is a TypedData or ExternalTypedData.
+  // Unlike the variant above, the characters may be moved by a garbage
+  // collection while the String is allocated.
+  static RawString* FromUTF8(const Instance& typed_data,
+                             intptr_t byte_offset,
+                             intptr_t array_len,
+                             Heap::Space space = Heap::kNew);
+
   // Creates a new String object from an array of Latin-1 encoded characters.
   static RawString* FromLatin1(const uint8_t* latin1_array,
                                intptr_t array_len,
@@ -8126,6 +8149,11 @@ class LinkedHashMap : public Instance {
                                intptr_t used_data,
                                intptr_t deleted_keys,
                                Heap::Space space = Heap::kNew);
+  // Allocates a map with room for 'num_pairs' key/value pairs, which the
+  // caller stores in order in data(). Like a map read from a snapshot, it
+  // has no index yet and regenerates it on first use.
+  static RawLinkedHashMap* NewWithoutIndex(intptr_t num_pairs,
+                                           Heap::Space space = Heap::kNew);
 
   virtual RawTypeArguments* GetTypeArguments() const {
     return raw_ptr()->type_arguments_;
@@ -8360,6 +8388,55 @@ class SendPort : public Instance {
 };
 
 
+// Owner of the malloc'd backing store of a TransferableTypedData. The bytes
+// move to the receiving isolate when the object is sent, or to an
+// ExternalTypedData when it is materialized; either way the peer is left
+// detached and only the peer itself is freed by the finalizer.
+class TransferableTypedDataPeer {
+ public:
+  TransferableTypedDataPeer(uint8_t* data, intptr_t length)
+      : data_(data), length_(length), handle_(NULL) { }
+  ~TransferableTypedDataPeer() { free(data_); }
+
+  uint8_t* data() const { return data_; }
+  intptr_t length() const { return length_; }
+  bool IsDetached() const { return data_ == NULL; }
+
+  FinalizablePersistentHandle* handle() const { return handle_; }
+  void set_handle(FinalizablePersistentHandle* handle) { handle_ = handle; }
+
+  // Gives up ownership of the bytes, which must have been handed over to a
+  // new owner by the caller.
+  void Detach(Isolate* isolate);
+
+ private:
+  uint8_t* data_;
+  intptr_t length_;
+  FinalizablePersistentHandle* handle_;
+
+  DISALLOW_COPY_AND_ASSIGN(TransferableTypedDataPeer);
+};
+
+
+class TransferableTypedData : public Instance {
+ public:
+  TransferableTypedDataPeer* peer() const { return raw_ptr()->peer_; }
+
+  static intptr_t InstanceSize() {
+    return RoundedAllocationSize(sizeof(RawTransferableTypedData));
+  }
+
+  // Takes ownership of 'data', which must have been allocated with malloc.
+  static RawTransferableTypedData* New(uint8_t* data,
+                                       intptr_t length,
+                                       Heap::Space space = Heap::kNew);
+
+ private:
+  FINAL_HEAP_OBJECT_IMPLEMENTATION(TransferableTypedData, Instance);
+  friend class Class;
+};
+
+
 // Internal stacktrace object used in exceptions for printing stack traces.
 class Stacktrace : public Instance {
  public:
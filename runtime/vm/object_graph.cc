@@ -161,6 +161,8 @@ ObjectGraph::ObjectGraph(Thread* thread)
   // The VM isolate has all its objects pre-marked, so iterating over it
   // would be a no-op.
   ASSERT(thread->isolate() != Dart::vm_isolate());
+  // The graph is traversed using the mark bits.
+  thread->isolate()->heap()->CompleteConcurrentMark();
   thread->isolate()->heap()->WriteProtectCode(false);
 }
 
@@ -1482,6 +1482,12 @@ void SendPort::PrintJSONImpl(JSONStream* stream, bool ref) const {
 }
 
 
+void TransferableTypedData::PrintJSONImpl(JSONStream* stream,
+                                          bool ref) const {
+  Instance::PrintJSONImpl(stream, ref);
+}
+
+
 void ClosureData::PrintJSONImpl(JSONStream* stream, bool ref) const {
   Object::PrintJSONImpl(stream, ref);
 }
@@ -96,9 +96,12 @@ ObjectStore::ObjectStore()
     unique_dynamic_targets_(Array::null()),
     token_objects_(GrowableObjectArray::null()),
     token_objects_map_(Array::null()),
+    dispatch_table_(Array::null()),
+    dispatch_table_selectors_(Array::null()),
     megamorphic_cache_table_(GrowableObjectArray::null()),
     megamorphic_miss_code_(Code::null()),
-    megamorphic_miss_function_(Function::null()) {
+    megamorphic_miss_function_(Function::null()),
+    snapshot_optimized_functions_(GrowableObjectArray::null()) {
   for (RawObject** current = from(); current <= to(); current++) {
     ASSERT(*current == Object::null());
   }
@@ -456,6 +456,21 @@ class ObjectStore {
     token_objects_map_ = value.raw();
   }
 
+  RawArray* dispatch_table() const { return dispatch_table_; }
+  void set_dispatch_table(const Array& value) {
+    dispatch_table_ = value.raw();
+  }
+  static intptr_t dispatch_table_offset() {
+    return OFFSET_OF(ObjectStore, dispatch_table_);
+  }
+
+  RawArray* dispatch_table_selectors() const {
+    return dispatch_table_selectors_;
+  }
+  void set_dispatch_table_selectors(const Array& value) {
+    dispatch_table_selectors_ = value.raw();
+  }
+
   RawGrowableObjectArray* megamorphic_cache_table() const {
     return megamorphic_cache_table_;
   }
@@ -468,6 +483,15 @@ class ObjectStore {
   RawFunction* megamorphic_miss_function() const {
     return megamorphic_miss_function_;
   }
+
+  // Functions that had optimized code when the app JIT snapshot this isolate
+  // was loaded from was created. Not part of the snapshot itself.
+  RawGrowableObjectArray* snapshot_optimized_functions() const {
+    return snapshot_optimized_functions_;
+  }
+  void set_snapshot_optimized_functions(const GrowableObjectArray& value) {
+    snapshot_optimized_functions_ = value.raw();
+  }
   void SetMegamorphicMissHandler(const Code& code, const Function& func) {
     // Hold onto the code so it is traced and not detached from the function.
     megamorphic_miss_code_ = code.raw();
@@ -588,9 +612,12 @@ class ObjectStore {
   V(RawArray*, unique_dynamic_targets_)                                        \
   V(RawGrowableObjectArray*, token_objects_)                                   \
   V(RawArray*, token_objects_map_)                                             \
+  V(RawArray*, dispatch_table_)                                                \
+  V(RawArray*, dispatch_table_selectors_)                                      \
   V(RawGrowableObjectArray*, megamorphic_cache_table_)                         \
   V(RawCode*, megamorphic_miss_code_)                                          \
   V(RawFunction*, megamorphic_miss_function_)                                  \
+  V(RawGrowableObjectArray*, snapshot_optimized_functions_)                    \
   // Please remember the last entry must be referred in the 'to' function below.
 
   RawObject** from() { return reinterpret_cast<RawObject**>(&object_class_); }
@@ -599,7 +626,7 @@ class ObjectStore {
 OBJECT_STORE_FIELD_LIST(DECLARE_OBJECT_STORE_FIELD)
 #undef DECLARE_OBJECT_STORE_FIELD
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&megamorphic_miss_function_);
+    return reinterpret_cast<RawObject**>(&snapshot_optimized_functions_);
   }
   RawObject** to_snapshot(Snapshot::Kind kind) {
     switch (kind) {
@@ -607,7 +634,7 @@ OBJECT_STORE_FIELD_LIST(DECLARE_OBJECT_STORE_FIELD)
         return reinterpret_cast<RawObject**>(&library_load_error_table_);
       case Snapshot::kAppWithJIT:
       case Snapshot::kAppNoJIT:
-        return to();
+        return reinterpret_cast<RawObject**>(&megamorphic_miss_function_);
       case Snapshot::kScript:
       case Snapshot::kMessage:
       case Snapshot::kNone:
@@ -6,12 +6,14 @@
 
 #include "platform/assert.h"
 #include "vm/compiler_stats.h"
+#include "vm/gc_compactor.h"
 #include "vm/gc_marker.h"
 #include "vm/gc_sweeper.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
 #include "vm/os_thread.h"
 #include "vm/safepoint.h"
+#include "vm/thread_registry.h"
 #include "vm/virtual_memory.h"
 
 namespace dart {
@@ -35,6 +37,12 @@ DEFINE_FLAG(bool, log_code_drop, false,
 DEFINE_FLAG(bool, always_drop_code, false,
             "Always try to drop code if the function's usage counter is >= 0");
 DEFINE_FLAG(bool, log_growth, false, "Log PageSpace growth policy decisions.");
+DEFINE_FLAG(bool, use_compactor, false,
+            "Evacuate sparse old gen data pages when the old gen is "
+            "fragmented after marking.");
+DEFINE_FLAG(int, old_gen_compaction_ratio, 50,
+            "The minimum percentage of free space in old gen data pages after "
+            "marking that triggers compaction");
 
 HeapPage* HeapPage::Initialize(VirtualMemory* memory, PageType type) {
   ASSERT(memory != NULL);
@@ -155,6 +163,7 @@ PageSpace::PageSpace(Heap* heap,
 #if defined(DEBUG)
       iterating_thread_(NULL),
 #endif
+      concurrent_marker_(NULL),
       page_space_controller_(heap,
                              FLAG_old_gen_growth_space_ratio,
                              FLAG_old_gen_growth_rate,
@@ -174,6 +183,7 @@ PageSpace::~PageSpace() {
       ml.Wait();
     }
   }
+  delete concurrent_marker_;
   FreePages(pages_);
   FreePages(exec_pages_);
   FreePages(large_pages_);
@@ -527,6 +537,15 @@ void PageSpace::AbandonBumpAllocation() {
 }
 
 
+void PageSpace::AbandonThreadLocalBuffers() {
+  if (heap_ == NULL) {
+    // Some unit tests.
+    return;
+  }
+  heap_->isolate()->thread_registry()->AbandonOldSpaceBuffers();
+}
+
+
 void PageSpace::UpdateMaxCapacityLocked() {
   if (heap_ == NULL) {
     // Some unit tests.
@@ -798,6 +817,52 @@ void PageSpace::WriteProtectCode(bool read_only) {
 }
 
 
+bool PageSpace::TryConcurrentMark() {
+#if defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_DBC)
+  // Only these targets emit the marking write barrier in generated code.
+  if (!FLAG_concurrent_mark) {
+    return false;
+  }
+  if (IsConcurrentMarkInProgress()) {
+    return !concurrent_marker_->IsConcurrentMarkDone();
+  }
+  Thread* thread = Thread::Current();
+  Isolate* isolate = heap_->isolate();
+  ASSERT(isolate == Isolate::Current());
+
+  // Wait for the sweeper to finish and then account for the driver task.
+  {
+    MonitorLocker locker(tasks_lock());
+    while (tasks() > 0) {
+      locker.WaitWithSafepointCheck(thread);
+    }
+    set_tasks(1);
+  }
+  {
+    SafepointOperationScope safepoint_scope(thread);
+    NoSafepointScope no_safepoints;
+    concurrent_marker_ = new GCMarker(heap_);
+    concurrent_marker_->StartConcurrentMark(isolate, this);
+  }
+  // Done, reset the task count (the marker tasks remain accounted for).
+  {
+    MonitorLocker ml(tasks_lock());
+    set_tasks(tasks() - 1);
+    ml.NotifyAll();
+  }
+  return true;
+#else
+  return false;
+#endif  // defined(TARGET_ARCH_X64) || defined(TARGET_ARCH_DBC)
+}
+
+
+bool PageSpace::IsConcurrentMarkDone() const {
+  return IsConcurrentMarkInProgress() &&
+         concurrent_marker_->IsConcurrentMarkDone();
+}
+
+
 void PageSpace::MarkSweep(bool invoke_api_callbacks) {
   Thread* thread = Thread::Current();
   Isolate* isolate = heap_->isolate();
@@ -832,7 +897,8 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
 
     if (FLAG_verify_before_gc) {
       OS::PrintErr("Verifying before marking...");
-      heap_->VerifyGC();
+      heap_->VerifyGC(IsConcurrentMarkInProgress() ? kAllowMarked
+                                                   : kForbidMarked);
       OS::PrintErr(" done.\n");
     }
 
@@ -845,17 +911,26 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
     SpaceUsage usage_before = GetCurrentUsage();
 
     // Mark all reachable old-gen objects.
-    bool collect_code = FLAG_collect_code &&
-                        ShouldCollectCode() &&
-                        !isolate->HasAttemptedReload();
-    GCMarker marker(heap_);
-    marker.MarkObjects(isolate, this, invoke_api_callbacks, collect_code);
-    usage_.used_in_words = marker.marked_words();
+    if (IsConcurrentMarkInProgress()) {
+      concurrent_marker_->FinishConcurrentMark(isolate, this,
+                                               invoke_api_callbacks);
+      usage_.used_in_words = concurrent_marker_->marked_words();
+      delete concurrent_marker_;
+      concurrent_marker_ = NULL;
+    } else {
+      bool collect_code = FLAG_collect_code &&
+                          ShouldCollectCode() &&
+                          !isolate->HasAttemptedReload();
+      GCMarker marker(heap_);
+      marker.MarkObjects(isolate, this, invoke_api_callbacks, collect_code);
+      usage_.used_in_words = marker.marked_words();
+    }
 
     int64_t mid1 = OS::GetCurrentTimeMicros();
 
     // Abandon the remainder of the bump allocation block.
     AbandonBumpAllocation();
+    AbandonThreadLocalBuffers();
     // Reset the freelists and setup sweeping.
     freelist_[HeapPage::kData].Reset();
     freelist_[HeapPage::kExecutable].Reset();
@@ -863,6 +938,18 @@ void PageSpace::MarkSweep(bool invoke_api_callbacks) {
     int64_t mid2 = OS::GetCurrentTimeMicros();
     int64_t mid3 = 0;
 
+    // Evacuate sparse data pages so that the sweeper can release them. Objects
+    // are not moved while a reload may still forward them with become.
+    if (FLAG_use_compactor && !isolate->HasAttemptedReload()) {
+      GCCompactor compactor(isolate, heap_);
+      intptr_t evacuated_pages = compactor.CompactPages(this);
+      if (FLAG_log_growth && (evacuated_pages > 0)) {
+        OS::PrintErr("compacted: %" Pd " pages, %" Pd " words moved\n",
+                     evacuated_pages,
+                     compactor.moved_words());
+      }
+    }
+
     {
       if (FLAG_verify_before_gc) {
         OS::PrintErr("Verifying before sweeping...");
@@ -1056,6 +1143,71 @@ uword PageSpace::TryAllocatePromoLocked(intptr_t size,
 }
 
 
+void PageSpace::FreePromoLocked(uword addr, intptr_t size) {
+  ASSERT(size < kAllocatablePageSize);
+  freelist_[HeapPage::kData].FreeLocked(addr, size);
+  AtomicOperations::DecrementBy(&(usage_.used_in_words),
+                                (size >> kWordSizeLog2));
+}
+
+
+uword PageSpace::TryAllocateDataThreadLocal(Thread* thread,
+                                            intptr_t size,
+                                            GrowthPolicy growth_policy) {
+  ASSERT(size >= kObjectAlignment);
+  ASSERT(Utils::IsAligned(size, kObjectAlignment));
+  ASSERT(thread->heap() == heap_);
+  uword top = thread->old_space_top();
+  uword end = thread->old_space_end();
+  if (static_cast<intptr_t>(end - top) < size) {
+    if (size > kThreadLocalObjectLimit) {
+      return TryAllocate(size, HeapPage::kData, growth_policy);
+    }
+    AbandonThreadLocalBuffer(thread);
+    // The whole buffer counts as used until its rest is given back.
+    top = freelist_[HeapPage::kData].TryAllocate(kThreadLocalBufferSize,
+                                                 false);
+    if (top != 0) {
+      AtomicOperations::IncrementBy(
+          &(usage_.used_in_words),
+          (kThreadLocalBufferSize >> kWordSizeLog2));
+    } else {
+      // Like the bump block, prefer a fresh page (if growth policy allows)
+      // over small free blocks. The rest of the page goes to the freelist.
+      top = TryAllocateInFreshPage(kThreadLocalBufferSize,
+                                   HeapPage::kData,
+                                   growth_policy,
+                                   false);
+      if (top == 0) {
+        return TryAllocate(size, HeapPage::kData, growth_policy);
+      }
+    }
+    end = top + kThreadLocalBufferSize;
+  }
+  uword result = top;
+  top += size;
+  // Keep the rest of the buffer walkable, as other threads may iterate over
+  // the heap while this thread is at a safepoint.
+  if (top < end) {
+    FreeListElement::AsElement(top, end - top);
+  }
+  thread->set_old_space_buffer(top, end);
+  return result;
+}
+
+
+void PageSpace::AbandonThreadLocalBuffer(Thread* thread) {
+  uword top = thread->old_space_top();
+  uword end = thread->old_space_end();
+  thread->set_old_space_buffer(0, 0);
+  if (top < end) {
+    freelist_[HeapPage::kData].Free(top, end - top);
+    AtomicOperations::DecrementBy(&(usage_.used_in_words),
+                                  ((end - top) >> kWordSizeLog2));
+  }
+}
+
+
 void PageSpace::SetupExternalPage(void* pointer,
                                   uword size,
                                   bool is_executable) {
@@ -1153,6 +1305,24 @@ bool PageSpaceController::NeedsGarbageCollection(SpaceUsage after) const {
 }
 
 
+bool PageSpaceController::NeedsCompaction(intptr_t live_in_words,
+                                          intptr_t capacity_in_words) const {
+  if ((capacity_in_words - live_in_words) <
+      (kMinCompactionPages * PageSpace::kPageSizeInWords)) {
+    return false;
+  }
+  return IsSparse(live_in_words, capacity_in_words);
+}
+
+
+bool PageSpaceController::IsSparse(intptr_t live_in_words,
+                                   intptr_t capacity_in_words) const {
+  // Compare the free percentage without dividing: free > ratio * capacity.
+  return (100 * (capacity_in_words - live_in_words)) >
+         (FLAG_old_gen_compaction_ratio * capacity_in_words);
+}
+
+
 void PageSpaceController::EvaluateGarbageCollection(
     SpaceUsage before, SpaceUsage after, int64_t start, int64_t end) {
   ASSERT(end >= start);
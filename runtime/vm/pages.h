@@ -18,8 +18,10 @@ namespace dart {
 DECLARE_FLAG(bool, log_code_drop);
 DECLARE_FLAG(bool, always_drop_code);
 DECLARE_FLAG(bool, write_protect_code);
+DECLARE_FLAG(bool, use_compactor);
 
 // Forward declarations.
+class GCMarker;
 class Heap;
 class JSONObject;
 class ObjectPointerVisitor;
@@ -133,6 +135,15 @@ class PageSpaceController {
   // (e.g., promotion), as it does not change the state of the controller.
   bool NeedsGarbageCollection(SpaceUsage after) const;
 
+  // Returns whether the data pages, of which 'live_in_words' out of
+  // 'capacity_in_words' survived marking, are fragmented enough to be
+  // compacted (see GCCompactor).
+  bool NeedsCompaction(intptr_t live_in_words,
+                       intptr_t capacity_in_words) const;
+
+  // Returns whether a page with this usage is worth evacuating.
+  bool IsSparse(intptr_t live_in_words, intptr_t capacity_in_words) const;
+
   // Should be called after each collection to update the controller state.
   void EvaluateGarbageCollection(SpaceUsage before,
                                  SpaceUsage after,
@@ -189,6 +200,9 @@ class PageSpaceController {
 
   PageSpaceGarbageCollectionHistory history_;
 
+  // Compaction must release at least this many pages to be worthwhile.
+  static const intptr_t kMinCompactionPages = 2;
+
   DISALLOW_IMPLICIT_CONSTRUCTORS(PageSpaceController);
 };
 
@@ -269,6 +283,15 @@ class PageSpace {
   // Collect the garbage in the page space using mark-sweep.
   void MarkSweep(bool invoke_api_callbacks);
 
+  // Starts marking concurrently with the mutator (see GCMarker) unless that
+  // is already in progress. Returns false if instead the collection should be
+  // performed now: concurrent marking is disabled or its tasks have finished.
+  bool TryConcurrentMark();
+  bool IsConcurrentMarkInProgress() const {
+    return concurrent_marker_ != NULL;
+  }
+  bool IsConcurrentMarkDone() const;
+
   void StartEndAddress(uword* start, uword* end) const;
 
   void InitGrowthControl() {
@@ -347,6 +370,17 @@ class PageSpace {
   uword TryAllocateDataBumpLocked(intptr_t size, GrowthPolicy growth_policy);
   // Prefer small freelist blocks, then chip away at the bump block.
   uword TryAllocatePromoLocked(intptr_t size, GrowthPolicy growth_policy);
+  // Gives back the unused end of a block from TryAllocatePromoLocked.
+  void FreePromoLocked(uword addr, intptr_t size);
+
+  // Allocates from the old-space buffer of 'thread', which is carved from the
+  // data freelist in large chunks. Threads other than the mutator (e.g., the
+  // background compiler) then rarely take the freelist lock.
+  uword TryAllocateDataThreadLocal(Thread* thread,
+                                   intptr_t size,
+                                   GrowthPolicy growth_policy = kControlGrowth);
+  // Returns the unused rest of the buffer of 'thread' to the freelist.
+  void AbandonThreadLocalBuffer(Thread* thread);
 
   // Bump block allocation from generated code.
   uword* TopAddress() { return &bump_top_; }
@@ -372,6 +406,10 @@ class PageSpace {
   };
 
   static const intptr_t kAllocatablePageSize = 64 * KB;
+  // Size of the chunks carved for thread-local allocation, and the largest
+  // object allocated from them.
+  static const intptr_t kThreadLocalBufferSize = 32 * KB;
+  static const intptr_t kThreadLocalObjectLimit = 4 * KB;
 
   uword TryAllocateInternal(intptr_t size,
                             HeapPage::PageType type,
@@ -389,6 +427,9 @@ class PageSpace {
   void MakeIterable() const;
   // Return any bump allocation block to the freelist.
   void AbandonBumpAllocation();
+  // Detaches the buffers of all threads before sweeping. Their unused rests
+  // are formatted as free list elements, so the sweeper reclaims them.
+  void AbandonThreadLocalBuffers();
   HeapPage* AllocatePage(HeapPage::PageType type);
   void FreePage(HeapPage* page, HeapPage* previous_page);
   HeapPage* AllocateLargePage(intptr_t size, HeapPage::PageType type);
@@ -445,6 +486,8 @@ class PageSpace {
 #if defined(DEBUG)
   Thread* iterating_thread_;
 #endif
+  // Non-NULL while the old generation is marked concurrently.
+  GCMarker* concurrent_marker_;
   PageSpaceController page_space_controller_;
 
   int64_t gc_time_micros_;
@@ -453,6 +496,7 @@ class PageSpace {
   friend class ExclusivePageIterator;
   friend class ExclusiveCodePageIterator;
   friend class ExclusiveLargePageIterator;
+  friend class GCCompactor;
   friend class HeapIterationScope;
   friend class PageSpaceController;
   friend class SweeperTask;
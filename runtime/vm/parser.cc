@@ -12494,6 +12494,11 @@ void Parser::CacheConstantValue(TokenPosition token_pos,
     // evaluated only once.
     return;
   }
+  if (Compiler::IsBackgroundCompilation()) {
+    // The constants map is only updated by the mutator. The value is
+    // canonical, so a later compilation will simply evaluate it again.
+    return;
+  }
   InsertCachedConstantValue(script_, token_pos, value);
 }
 
@@ -12559,6 +12564,10 @@ StaticGetterNode* Parser::RunStaticFieldInitializer(
     // not been evaluated. If the field is const, call the static getter method
     // to evaluate the expression and canonicalize the value.
     if (field.is_const()) {
+      if (Compiler::IsBackgroundCompilation()) {
+        Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+            "Static field initialized while compiling");
+      }
       NoReloadScope no_reload_scope(isolate(), thread());
       NoOOBMessageScope no_msg_scope(thread());
       field.SetStaticValue(Object::transition_sentinel());
@@ -12650,6 +12659,10 @@ RawObject* Parser::EvaluateConstConstructorCall(
   }
   const Array& args_descriptor = Array::Handle(Z,
       ArgumentsDescriptor::New(num_arguments, arguments->names()));
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "Const constructor invoked while compiling");
+  }
   const Object& result = Object::Handle(Z,
       DartEntry::InvokeFunction(constructor, arg_values, args_descriptor));
   if (result.IsError()) {
@@ -14156,6 +14169,10 @@ String& Parser::Interpolate(const GrowableArray<AstNode*>& values) {
   interpolate_arg.SetAt(0, value_arr);
 
   // Call interpolation function.
+  if (Compiler::IsBackgroundCompilation()) {
+    Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+        "String interpolation evaluated while compiling");
+  }
   Object& result = Object::Handle(Z);
   result = DartEntry::InvokeFunction(func, interpolate_arg);
   if (result.IsUnhandledException()) {
@@ -14507,6 +14524,10 @@ const Instance& Parser::EvaluateConstExpr(TokenPosition expr_pos,
     SequenceNode* seq = new(Z) SequenceNode(expr->token_pos(), empty_scope);
     seq->Add(ret);
 
+    if (Compiler::IsBackgroundCompilation()) {
+      Compiler::AbortBackgroundCompilation(Thread::kNoDeoptId,
+          "Constant expression evaluated while compiling");
+    }
     Object& result = Object::Handle(Z, Compiler::ExecuteOnce(seq));
     if (result.IsError()) {
       ReportErrors(Error::Cast(result),
@@ -6,6 +6,7 @@
 
 #include "vm/dart_entry.h"
 #include "platform/utils.h"
+#include "vm/atomic.h"
 #include "vm/dart_api_impl.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
@@ -14,16 +15,35 @@
 
 namespace dart {
 
-Mutex* PortMap::mutex_ = NULL;
-PortMap::Entry* PortMap::map_ = NULL;
 MessageHandler* PortMap::deleted_entry_ = reinterpret_cast<MessageHandler*>(1);
-intptr_t PortMap::capacity_ = 0;
-intptr_t PortMap::used_ = 0;
-intptr_t PortMap::deleted_ = 0;
-Random* PortMap::prng_ = NULL;
+PortMap::Shard* PortMap::shards_ = NULL;
+uintptr_t PortMap::next_shard_ = 0;
 
 
-intptr_t PortMap::FindPort(Dart_Port port) {
+PortMap::Shard::Shard()
+    : mutex_(new Mutex()),
+      map_(NULL),
+      capacity_(0),
+      used_(0),
+      deleted_(0),
+      prng_(new Random()) {
+  static const intptr_t kInitialCapacity = 8;
+  // TODO(iposva): Verify whether we want to keep exponentially growing.
+  ASSERT(Utils::IsPowerOfTwo(kInitialCapacity));
+  map_ = new Entry[kInitialCapacity];
+  memset(map_, 0, kInitialCapacity * sizeof(Entry));
+  capacity_ = kInitialCapacity;
+}
+
+
+PortMap::Shard::~Shard() {
+  delete[] map_;
+  delete prng_;
+  delete mutex_;
+}
+
+
+intptr_t PortMap::Shard::FindPort(Dart_Port port) const {
   // ILLEGAL_PORT (0) is used as a sentinel value in Entry.port. The loop below
   // could return the index to a deleted port when we are searching for
   // port id ILLEGAL_PORT. Return -1 immediately to indicate the port
@@ -32,7 +52,8 @@ intptr_t PortMap::FindPort(Dart_Port port) {
     return -1;
   }
   ASSERT(port != ILLEGAL_PORT);
-  intptr_t index = port % capacity_;
+  // All ports in this shard share their low bits.
+  intptr_t index = (port >> kShardBits) % capacity_;
   intptr_t start_index = index;
   Entry entry = map_[index];
   while (entry.handler != NULL) {
@@ -48,7 +69,7 @@ intptr_t PortMap::FindPort(Dart_Port port) {
 }
 
 
-void PortMap::Rehash(intptr_t new_capacity) {
+void PortMap::Shard::Rehash(intptr_t new_capacity) {
   Entry* new_ports = new Entry[new_capacity];
   memset(new_ports, 0, new_capacity * sizeof(Entry));
 
@@ -56,7 +77,7 @@ void PortMap::Rehash(intptr_t new_capacity) {
     Entry entry = map_[i];
     // Skip free and deleted entries.
     if (entry.port != 0) {
-      intptr_t new_index = entry.port % new_capacity;
+      intptr_t new_index = (entry.port >> kShardBits) % new_capacity;
       while (new_ports[new_index].port != 0) {
         new_index = (new_index + 1) % new_capacity;
       }
@@ -70,6 +91,60 @@ void PortMap::Rehash(intptr_t new_capacity) {
 }
 
 
+void PortMap::Shard::Insert(const Entry& entry) {
+  // Search for the first unused slot. Make use of the knowledge that here is
+  // currently no port with this id in the port map.
+  ASSERT(FindPort(entry.port) < 0);
+  intptr_t index = (entry.port >> kShardBits) % capacity_;
+  Entry cur = map_[index];
+  // Stop the search at the first found unused (free or deleted) slot.
+  while (cur.port != 0) {
+    index = (index + 1) % capacity_;
+    cur = map_[index];
+  }
+
+  // Insert the newly created port at the index.
+  ASSERT(index >= 0);
+  ASSERT(index < capacity_);
+  ASSERT(map_[index].port == 0);
+  ASSERT((map_[index].handler == NULL) ||
+         (map_[index].handler == deleted_entry_));
+  if (map_[index].handler == deleted_entry_) {
+    // Consuming a deleted entry.
+    deleted_--;
+  }
+  map_[index] = entry;
+
+  // Increment number of used slots and grow if necessary.
+  used_++;
+  MaintainInvariants();
+}
+
+
+void PortMap::Shard::Remove(intptr_t index) {
+  ASSERT(index >= 0);
+  ASSERT(index < capacity_);
+  ASSERT(map_[index].port != 0);
+  map_[index].port = 0;
+  map_[index].handler = deleted_entry_;
+  used_--;
+  deleted_++;
+}
+
+
+void PortMap::Shard::MaintainInvariants() {
+  intptr_t empty = capacity_ - used_ - deleted_;
+  if (used_ > ((capacity_ / 4) * 3)) {
+    // Grow the port map.
+    Rehash(capacity_ * 2);
+  } else if (empty < deleted_) {
+    // Rehash without growing the table to flush the deleted slots out of the
+    // map.
+    Rehash(capacity_);
+  }
+}
+
+
 const char* PortMap::PortStateString(PortState kind) {
   switch (kind) {
     case kNewPort:
@@ -85,93 +160,62 @@ const char* PortMap::PortStateString(PortState kind) {
 }
 
 
-Dart_Port PortMap::AllocatePort() {
+Dart_Port PortMap::AllocatePort(Shard* shard) {
   const Dart_Port kMASK = 0x3fffffff;
-  Dart_Port result = prng_->NextUInt32() & kMASK;
+  // The low bits of the port number select the shard it lives in.
+  const Dart_Port shard_bits = shard - shards_;
+  Dart_Port result =
+      (shard->prng()->NextUInt32() & kMASK & ~kShardMask) | shard_bits;
 
   // Keep getting new values while we have an illegal port number or the port
   // number is already in use.
-  while ((result == 0) || (FindPort(result) >= 0)) {
-    result = prng_->NextUInt32() & kMASK;
+  while ((result == 0) || (shard->FindPort(result) >= 0)) {
+    result = (shard->prng()->NextUInt32() & kMASK & ~kShardMask) | shard_bits;
   }
 
   ASSERT(result != 0);
-  ASSERT(FindPort(result) < 0);
+  ASSERT(ShardFor(result) == shard);
+  ASSERT(shard->FindPort(result) < 0);
   return result;
 }
 
 
 void PortMap::SetPortState(Dart_Port port, PortState state) {
-  MutexLocker ml(mutex_);
-  intptr_t index = FindPort(port);
+  Shard* shard = ShardFor(port);
+  MutexLocker ml(shard->mutex());
+  intptr_t index = shard->FindPort(port);
   ASSERT(index >= 0);
-  PortState old_state = map_[index].state;
+  Entry* entry = shard->At(index);
+  PortState old_state = entry->state;
   ASSERT(old_state == kNewPort);
-  map_[index].state = state;
+  entry->state = state;
   if (state == kLivePort) {
-    map_[index].handler->increment_live_ports();
+    entry->handler->increment_live_ports();
   }
   if (FLAG_trace_isolates) {
     OS::Print("[^] Port (%s) -> (%s): \n"
               "\thandler:    %s\n"
               "\tport:       %" Pd64 "\n",
               PortStateString(old_state), PortStateString(state),
-              map_[index].handler->name(), port);
-  }
-}
-
-
-void PortMap::MaintainInvariants() {
-  intptr_t empty = capacity_ - used_ - deleted_;
-  if (used_ > ((capacity_ / 4) * 3)) {
-    // Grow the port map.
-    Rehash(capacity_ * 2);
-  } else if (empty < deleted_) {
-    // Rehash without growing the table to flush the deleted slots out of the
-    // map.
-    Rehash(capacity_);
+              entry->handler->name(), port);
   }
 }
 
 
 Dart_Port PortMap::CreatePort(MessageHandler* handler) {
   ASSERT(handler != NULL);
-  MutexLocker ml(mutex_);
 #if defined(DEBUG)
   handler->CheckAccess();
 #endif
+  Shard* shard =
+      &shards_[AtomicOperations::FetchAndIncrement(&next_shard_) & kShardMask];
+  MutexLocker ml(shard->mutex());
 
   Entry entry;
-  entry.port = AllocatePort();
+  entry.port = AllocatePort(shard);
   entry.handler = handler;
   entry.state = kNewPort;
-
-  // Search for the first unused slot. Make use of the knowledge that here is
-  // currently no port with this id in the port map.
-  ASSERT(FindPort(entry.port) < 0);
-  intptr_t index = entry.port % capacity_;
-  Entry cur = map_[index];
-  // Stop the search at the first found unused (free or deleted) slot.
-  while (cur.port != 0) {
-    index = (index + 1) % capacity_;
-    cur = map_[index];
-  }
-
-  // Insert the newly created port at the index.
-  ASSERT(index >= 0);
-  ASSERT(index < capacity_);
-  ASSERT(map_[index].port == 0);
-  ASSERT((map_[index].handler == NULL) ||
-         (map_[index].handler == deleted_entry_));
-  if (map_[index].handler == deleted_entry_) {
-    // Consuming a deleted entry.
-    deleted_--;
-  }
-  map_[index] = entry;
-
-  // Increment number of used slots and grow if necessary.
-  used_++;
-  MaintainInvariants();
+  shard->Insert(entry);
 
   if (FLAG_trace_isolates) {
     OS::Print("[+] Opening port: \n"
@@ -187,32 +231,29 @@ Dart_Port PortMap::CreatePort(MessageHandler* handler) {
 bool PortMap::ClosePort(Dart_Port port) {
   MessageHandler* handler = NULL;
   {
-    MutexLocker ml(mutex_);
-    intptr_t index = FindPort(port);
+    Shard* shard = ShardFor(port);
+    MutexLocker ml(shard->mutex());
+    intptr_t index = shard->FindPort(port);
     if (index < 0) {
       return false;
     }
-    ASSERT(index < capacity_);
-    ASSERT(map_[index].port != 0);
-    ASSERT(map_[index].handler != deleted_entry_);
-    ASSERT(map_[index].handler != NULL);
+    Entry* entry = shard->At(index);
+    ASSERT(entry->port != 0);
+    ASSERT(entry->handler != deleted_entry_);
+    ASSERT(entry->handler != NULL);
 
-    handler = map_[index].handler;
+    handler = entry->handler;
 #if defined(DEBUG)
     handler->CheckAccess();
 #endif
     // Before releasing the lock mark the slot in the map as deleted. This makes
     // it possible to release the port map lock before flushing all of its
     // pending messages below.
-    map_[index].port = 0;
-    map_[index].handler = deleted_entry_;
-    if (map_[index].state == kLivePort) {
+    if (entry->state == kLivePort) {
       handler->decrement_live_ports();
     }
-
-    used_--;
-    deleted_++;
-    MaintainInvariants();
+    shard->Remove(index);
+    shard->MaintainInvariants();
   }
   handler->ClosePort(port);
   if (!handler->HasLivePorts() && handler->OwnedByPortMap()) {
@@ -224,37 +265,39 @@ bool PortMap::ClosePort(Dart_Port port) {
 
 
 void PortMap::ClosePorts(MessageHandler* handler) {
-  {
-    MutexLocker ml(mutex_);
-    for (intptr_t i = 0; i < capacity_; i++) {
-      if (map_[i].handler == handler) {
+  for (intptr_t s = 0; s < kNumShards; s++) {
+    Shard* shard = &shards_[s];
+    MutexLocker ml(shard->mutex());
+    for (intptr_t i = 0; i < shard->capacity(); i++) {
+      Entry* entry = shard->At(i);
+      if (entry->handler == handler) {
         // Mark the slot as deleted.
-        map_[i].port = 0;
-        map_[i].handler = deleted_entry_;
-        if (map_[i].state == kLivePort) {
+        if (entry->state == kLivePort) {
           handler->decrement_live_ports();
         }
-        used_--;
-        deleted_++;
+        shard->Remove(i);
       }
     }
-    MaintainInvariants();
+    shard->MaintainInvariants();
   }
   handler->CloseAllPorts();
 }
 
 
 bool PortMap::PostMessage(Message* message) {
-  MutexLocker ml(mutex_);
-  intptr_t index = FindPort(message->dest_port());
+  // Holding the shard lock keeps the handler from being deleted while the
+  // message is handed over; the handler enqueues without taking its own
+  // monitor while it is busy.
+  Shard* shard = ShardFor(message->dest_port());
+  MutexLocker ml(shard->mutex());
+  intptr_t index = shard->FindPort(message->dest_port());
   if (index < 0) {
     delete message;
     return false;
   }
-  ASSERT(index >= 0);
-  ASSERT(index < capacity_);
-  MessageHandler* handler = map_[index].handler;
-  ASSERT(map_[index].port != 0);
+  Entry* entry = shard->At(index);
+  MessageHandler* handler = entry->handler;
+  ASSERT(entry->port != 0);
   ASSERT((handler != NULL) && (handler != deleted_entry_));
   handler->PostMessage(message);
   return true;
@@ -262,43 +305,36 @@ bool PortMap::PostMessage(Message* message) {
 
 
 bool PortMap::IsLocalPort(Dart_Port id) {
-  MutexLocker ml(mutex_);
-  intptr_t index = FindPort(id);
+  Shard* shard = ShardFor(id);
+  MutexLocker ml(shard->mutex());
+  intptr_t index = shard->FindPort(id);
   if (index < 0) {
     // Port does not exist.
     return false;
   }
 
-  MessageHandler* handler = map_[index].handler;
+  MessageHandler* handler = shard->At(index)->handler;
   return handler->IsCurrentIsolate();
 }
 
 
 Isolate* PortMap::GetIsolate(Dart_Port id) {
-  MutexLocker ml(mutex_);
-  intptr_t index = FindPort(id);
+  Shard* shard = ShardFor(id);
+  MutexLocker ml(shard->mutex());
+  intptr_t index = shard->FindPort(id);
   if (index < 0) {
     // Port does not exist.
     return NULL;
   }
 
-  MessageHandler* handler = map_[index].handler;
+  MessageHandler* handler = shard->At(index)->handler;
   return handler->isolate();
 }
 
 
 void PortMap::InitOnce() {
-  mutex_ = new Mutex();
-  prng_ = new Random();
-
-  static const intptr_t kInitialCapacity = 8;
-  // TODO(iposva): Verify whether we want to keep exponentially growing.
-  ASSERT(Utils::IsPowerOfTwo(kInitialCapacity));
-  map_ = new Entry[kInitialCapacity];
-  memset(map_, 0, kInitialCapacity * sizeof(Entry));
-  capacity_ = kInitialCapacity;
-  used_ = 0;
-  deleted_ = 0;
+  shards_ = new Shard[kNumShards];
+  next_shard_ = 0;
 }
 
 
@@ -313,14 +349,16 @@ void PortMap::PrintPortsForMessageHandler(MessageHandler* handler,
   Object& msg_handler = Object::Handle();
   {
     JSONArray ports(&jsobj, "ports");
-    SafepointMutexLocker ml(mutex_);
-    for (intptr_t i = 0; i < capacity_; i++) {
-      if (map_[i].handler == handler) {
-        if (map_[i].state == kLivePort) {
+    for (intptr_t s = 0; s < kNumShards; s++) {
+      Shard* shard = &shards_[s];
+      SafepointMutexLocker ml(shard->mutex());
+      for (intptr_t i = 0; i < shard->capacity(); i++) {
+        Entry* entry = shard->At(i);
+        if ((entry->handler == handler) && (entry->state == kLivePort)) {
           JSONObject port(&ports);
           port.AddProperty("type", "_Port");
-          port.AddPropertyF("name", "Isolate Port (%" Pd64 ")", map_[i].port);
-          msg_handler = DartLibraryCalls::LookupHandler(map_[i].port);
+          port.AddPropertyF("name", "Isolate Port (%" Pd64 ")", entry->port);
+          msg_handler = DartLibraryCalls::LookupHandler(entry->port);
           port.AddProperty("handler", msg_handler);
         }
       }
@@ -331,13 +369,15 @@ void PortMap::PrintPortsForMessageHandler(MessageHandler* handler,
 
 
 void PortMap::DebugDumpForMessageHandler(MessageHandler* handler) {
-  SafepointMutexLocker ml(mutex_);
   Object& msg_handler = Object::Handle();
-  for (intptr_t i = 0; i < capacity_; i++) {
-    if (map_[i].handler == handler) {
-      if (map_[i].state == kLivePort) {
-        OS::Print("Live Port = %" Pd64 "\n", map_[i].port);
-        msg_handler = DartLibraryCalls::LookupHandler(map_[i].port);
+  for (intptr_t s = 0; s < kNumShards; s++) {
+    Shard* shard = &shards_[s];
+    SafepointMutexLocker ml(shard->mutex());
+    for (intptr_t i = 0; i < shard->capacity(); i++) {
+      Entry* entry = shard->At(i);
+      if ((entry->handler == handler) && (entry->state == kLivePort)) {
+        OS::Print("Live Port = %" Pd64 "\n", entry->port);
+        msg_handler = DartLibraryCalls::LookupHandler(entry->port);
         OS::Print("Handler = %s\n", msg_handler.ToCString());
       }
     }
@@ -74,30 +74,66 @@ class PortMap : public AllStatic {
     PortState state;
   } Entry;
 
+  // The port map is split into independently locked shards so that isolates
+  // posting to different ports do not contend on a single lock. The low bits
+  // of a port number select its shard.
+  static const intptr_t kShardBits = 5;
+  static const intptr_t kNumShards = 1 << kShardBits;
+  static const Dart_Port kShardMask = kNumShards - 1;
+
+  class Shard {
+   public:
+    Shard();
+    ~Shard();
+
+    // Lock protecting access to this shard.
+    Mutex* mutex() const { return mutex_; }
+
+    intptr_t FindPort(Dart_Port port) const;
+    Entry* At(intptr_t index) const { return &map_[index]; }
+    intptr_t capacity() const { return capacity_; }
+
+    // Inserts a port that is not yet in the shard.
+    void Insert(const Entry& entry);
+    // Marks the slot at index as deleted.
+    void Remove(intptr_t index);
+
+    void MaintainInvariants();
+
+    // Only accessed with the mutex held.
+    Random* prng() const { return prng_; }
+
+   private:
+    void Rehash(intptr_t new_capacity);
+
+    Mutex* mutex_;
+    Entry* map_;
+    intptr_t capacity_;
+    intptr_t used_;
+    intptr_t deleted_;
+    Random* prng_;
+
+    DISALLOW_COPY_AND_ASSIGN(Shard);
+  };
+
   static const char* PortStateString(PortState state);
 
-  // Allocate a new unique port.
-  static Dart_Port AllocatePort();
+  static Shard* ShardFor(Dart_Port port) {
+    return &shards_[port & kShardMask];
+  }
+
+  // Allocate a new unique port in shard. The shard's mutex must be held.
+  static Dart_Port AllocatePort(Shard* shard);
 
   static bool IsActivePort(Dart_Port id);
   static bool IsLivePort(Dart_Port id);
 
-  static intptr_t FindPort(Dart_Port port);
-  static void Rehash(intptr_t new_capacity);
-
-  static void MaintainInvariants();
-
-  // Lock protecting access to the port map.
-  static Mutex* mutex_;
-
-  // Hashmap of ports.
-  static Entry* map_;
   static MessageHandler* deleted_entry_;
-  static intptr_t capacity_;
-  static intptr_t used_;
-  static intptr_t deleted_;
 
-  static Random* prng_;
+  static Shard* shards_;
+
+  // Spreads new ports across the shards.
+  static uintptr_t next_shard_;
 };
 
 }  // namespace dart
@@ -15,17 +15,19 @@ namespace dart {
 class PortMapTestPeer {
  public:
   static bool IsActivePort(Dart_Port port) {
-    MutexLocker ml(PortMap::mutex_);
-    return (PortMap::FindPort(port) >= 0);
+    PortMap::Shard* shard = PortMap::ShardFor(port);
+    MutexLocker ml(shard->mutex());
+    return (shard->FindPort(port) >= 0);
   }
 
   static bool IsLivePort(Dart_Port port) {
-    MutexLocker ml(PortMap::mutex_);
-    intptr_t index = PortMap::FindPort(port);
+    PortMap::Shard* shard = PortMap::ShardFor(port);
+    MutexLocker ml(shard->mutex());
+    intptr_t index = shard->FindPort(port);
     if (index < 0) {
       return false;
     }
-    return PortMap::map_[index].state == PortMap::kLivePort;
+    return shard->At(index)->state == PortMap::kLivePort;
   }
 };
 
@@ -100,6 +102,29 @@ TEST_CASE(PortMap_CreateManyPorts) {
 }
 
 
+TEST_CASE(PortMap_CreateManyLivePorts) {
+  // Enough ports to grow every shard of the port map a few times.
+  const intptr_t kNumPorts = 1024;
+  PortTestMessageHandler handler;
+  Dart_Port ports[kNumPorts];
+  for (intptr_t i = 0; i < kNumPorts; i++) {
+    ports[i] = PortMap::CreatePort(&handler);
+    EXPECT_NE(0, ports[i]);
+    PortMap::SetPortState(ports[i], PortMap::kLivePort);
+  }
+  for (intptr_t i = 0; i < kNumPorts; i++) {
+    EXPECT(PortMapTestPeer::IsLivePort(ports[i]));
+  }
+  EXPECT_EQ(kNumPorts, handler.live_ports());
+
+  PortMap::ClosePorts(&handler);
+  EXPECT_EQ(0, handler.live_ports());
+  for (intptr_t i = 0; i < kNumPorts; i++) {
+    EXPECT(!PortMapTestPeer::IsActivePort(ports[i]));
+  }
+}
+
+
 TEST_CASE(PortMap_SetPortState) {
   PortTestMessageHandler handler;
 
@@ -13,10 +13,13 @@
 #include "vm/code_patcher.h"
 #include "vm/compiler.h"
 #include "vm/constant_propagator.h"
+#include "vm/dart.h"
 #include "vm/dart_entry.h"
 #include "vm/disassembler.h"
+#include "vm/dispatch_table.h"
 #include "vm/dil.h"
 #include "vm/dil_reader.h"
+#include "vm/dil_to_il.h"
 #include "vm/exceptions.h"
 #include "vm/flags.h"
 #include "vm/flow_graph.h"
@@ -29,8 +32,10 @@
 #include "vm/hash_table.h"
 #include "vm/il_printer.h"
 #include "vm/isolate.h"
+#include "vm/lockers.h"
 #include "vm/log.h"
 #include "vm/longjump.h"
+#include "vm/loop_vectorizer.h"
 #include "vm/object.h"
 #include "vm/object_store.h"
 #include "vm/os.h"
@@ -41,6 +46,7 @@
 #include "vm/resolver.h"
 #include "vm/symbols.h"
 #include "vm/tags.h"
+#include "vm/thread_pool.h"
 #include "vm/timeline.h"
 #include "vm/timer.h"
 #include "vm/type_table.h"
@@ -58,11 +64,14 @@ DEFINE_FLAG(bool, trace_precompiler, false, "Trace precompiler.");
 DEFINE_FLAG(int, max_speculative_inlining_attempts, 1,
     "Max number of attempts with speculative inlining (precompilation only)");
 DEFINE_FLAG(int, precompiler_rounds, 1, "Number of precompiler iterations");
+DEFINE_FLAG(int, precompiler_threads, 1,
+    "Number of threads compiling functions in parallel during precompilation");
 
 DECLARE_FLAG(bool, allocation_sinking);
 DECLARE_FLAG(bool, common_subexpression_elimination);
 DECLARE_FLAG(bool, constant_propagation);
 DECLARE_FLAG(bool, loop_invariant_code_motion);
+DECLARE_FLAG(bool, loop_vectorization);
 DECLARE_FLAG(bool, print_flow_graph);
 DECLARE_FLAG(bool, print_flow_graph_optimized);
 DECLARE_FLAG(bool, range_analysis);
@@ -154,11 +163,18 @@ class DartPrecompilationPipeline : public DartCompilationPipeline {
 
 class PrecompileParsedFunctionHelper : public ValueObject {
  public:
+  // If 'result_code' is not NULL, the code is stored there instead of being
+  // installed, and 'finalization_mutex' serializes the creation of the
+  // instructions with the other threads compiling in parallel.
   PrecompileParsedFunctionHelper(ParsedFunction* parsed_function,
-                                 bool optimized)
+                                 bool optimized,
+                                 Mutex* finalization_mutex = NULL,
+                                 Code* result_code = NULL)
       : parsed_function_(parsed_function),
         optimized_(optimized),
-        thread_(Thread::Current()) {
+        thread_(Thread::Current()),
+        finalization_mutex_(finalization_mutex),
+        result_code_(result_code) {
   }
 
   bool Compile(CompilationPipeline* pipeline);
@@ -176,6 +192,8 @@ class PrecompileParsedFunctionHelper : public ValueObject {
   ParsedFunction* parsed_function_;
   const bool optimized_;
   Thread* const thread_;
+  Mutex* const finalization_mutex_;
+  Code* const result_code_;
 
   DISALLOW_COPY_AND_ASSIGN(PrecompileParsedFunctionHelper);
 };
@@ -310,6 +328,9 @@ void Precompiler::DoCompileAll(
 
     BindStaticCalls();
     SwitchICCalls();
+    if (FLAG_use_dispatch_table) {
+      BuildDispatchTable();
+    }
 
     DedupStackmaps();
     DedupStackmapLists();
@@ -618,8 +639,13 @@ void Precompiler::Iterate() {
     changed_ = false;
 
     while (pending_functions_.Length() > 0) {
-      function ^= pending_functions_.RemoveLast();
-      ProcessFunction(function);
+      if ((FLAG_precompiler_threads > 1) &&
+          (pending_functions_.Length() > 1)) {
+        ProcessFunctionsInParallel();
+      } else {
+        function ^= pending_functions_.RemoveLast();
+        ProcessFunction(function);
+      }
     }
 
     CheckForNewDynamicFunctions();
@@ -1056,8 +1082,12 @@ RawFunction* Precompiler::CompileStaticInitializer(const Field& field,
         Symbols::FromConcat(thread, Symbols::InitPrefix(),
         String::Handle(zone, field.name())));
 
-    // Create a static final getter.
-    const dart::Class& owner = dart::Class::Handle(zone, field.Owner());
+    // Create a static final getter. Like the field, it belongs to the script
+    // the kernel node was read from, which differs from the class's script
+    // for patched members.
+    const Script& script = Script::Handle(zone, field.Script());
+    Object& owner = Object::Handle(zone, field.Owner());
+    owner = PatchClass::New(Class::Cast(owner), script);
     const Function& initializer_fun = Function::ZoneHandle(
         zone, dart::Function::New(init_name,
                                   RawFunction::kImplicitStaticFinalGetter,
@@ -2099,6 +2129,108 @@ void Precompiler::SwitchICCalls() {
 }
 
 
+// A (target name, arguments descriptor) pair of an instance call.
+struct Selector : public ZoneAllocated {
+  Selector(const String& name, const Array& descriptor)
+      : name(name), descriptor(descriptor) { }
+  const String& name;
+  const Array& descriptor;
+};
+
+
+class SelectorKeyValueTrait {
+ public:
+  // Typedefs needed for the DirectChainedHashMap template.
+  typedef const Selector* Key;
+  typedef const Selector* Value;
+  typedef const Selector* Pair;
+
+  static Key KeyOf(Pair kv) { return kv; }
+
+  static Value ValueOf(Pair kv) { return kv; }
+
+  static inline intptr_t Hashcode(Key key) {
+    return key->name.Hash();
+  }
+
+  static inline bool IsKeyEqual(Pair pair, Key key) {
+    return (pair->name.raw() == key->name.raw()) &&
+           (pair->descriptor.raw() == key->descriptor.raw());
+  }
+};
+
+
+void Precompiler::BuildDispatchTable() {
+#if !defined(TARGET_ARCH_DBC)
+  // Collect the selectors of the instance calls left in the object pools and
+  // lay out their rows in the dispatch table. Any of these calls may become
+  // megamorphic at runtime.
+  class CollectSelectorsVisitor : public FunctionVisitor {
+   public:
+    CollectSelectorsVisitor(Zone* zone,
+                            const GrowableObjectArray& selectors)
+        : zone_(zone),
+          selectors_(selectors),
+          code_(Code::Handle(zone)),
+          pool_(ObjectPool::Handle(zone)),
+          entry_(Object::Handle(zone)),
+          selector_set_() {
+    }
+
+    void Visit(const Function& function) {
+      if (!function.HasCode()) {
+        return;
+      }
+      code_ = function.CurrentCode();
+      pool_ = code_.object_pool();
+      for (intptr_t i = 0; i < pool_.Length(); i++) {
+        if (pool_.InfoAt(i) != ObjectPool::kTaggedObject) continue;
+        entry_ = pool_.ObjectAt(i);
+        if (entry_.IsICData()) {
+          const ICData& ic = ICData::Cast(entry_);
+          AddSelector(ic.target_name(), ic.arguments_descriptor());
+        } else if (entry_.IsMegamorphicCache()) {
+          const MegamorphicCache& cache = MegamorphicCache::Cast(entry_);
+          AddSelector(cache.target_name(), cache.arguments_descriptor());
+        }
+      }
+    }
+
+   private:
+    void AddSelector(RawString* name, RawArray* descriptor) {
+      Selector* selector = new(zone_) Selector(
+          String::ZoneHandle(zone_, name),
+          Array::ZoneHandle(zone_, descriptor));
+      if (selector_set_.Lookup(selector) != NULL) {
+        return;
+      }
+      selector_set_.Insert(selector);
+      selectors_.Add(selector->name);
+      selectors_.Add(selector->descriptor);
+    }
+
+    Zone* zone_;
+    const GrowableObjectArray& selectors_;
+    Code& code_;
+    ObjectPool& pool_;
+    Object& entry_;
+    DirectChainedHashMap<SelectorKeyValueTrait> selector_set_;
+  };
+
+  ASSERT(!I->compilation_allowed());
+  const GrowableObjectArray& selectors =
+      GrowableObjectArray::Handle(Z, GrowableObjectArray::New());
+  CollectSelectorsVisitor visitor(Z, selectors);
+  VisitFunctions(&visitor);
+  DispatchTable::AddSelectors(I, selectors);
+  DispatchTable::UpdateMegamorphicCaches(I);
+  if (FLAG_trace_precompiler) {
+    DispatchTable::PrintSizes(I);
+  }
+#endif
+}
+
+
 void Precompiler::DedupStackmaps() {
   class DedupStackmapsVisitor : public FunctionVisitor {
    public:
@@ -2533,8 +2665,15 @@ void PrecompileParsedFunctionHelper::FinalizeCompilation(
            deopt_info_array.Length() * sizeof(uword));
   // Allocates instruction object. Since this occurs only at safepoint,
   // there can be no concurrent access to the instruction page.
-  const Code& code = Code::Handle(
-      Code::FinalizeCode(function, assembler, optimized()));
+  Code& code = Code::Handle(zone);
+  if (finalization_mutex_ != NULL) {
+    // Instruction pages are written and write-protected by one thread at a
+    // time.
+    SafepointMutexLocker ml(finalization_mutex_);
+    code = Code::FinalizeCode(function, assembler, optimized());
+  } else {
+    code = Code::FinalizeCode(function, assembler, optimized());
+  }
   code.set_is_optimized(optimized());
   code.set_owner(function);
   if (!function.IsOptimizable()) {
@@ -2568,7 +2707,10 @@ void PrecompileParsedFunctionHelper::FinalizeCompilation(
   graph_compiler->FinalizeExceptionHandlers(code);
   graph_compiler->FinalizeStaticCallTargetsTable(code);
 
-  if (optimized()) {
+  if (result_code_ != NULL) {
+    // The caller installs the code on the mutator thread.
+    *result_code_ = code.raw();
+  } else if (optimized()) {
     // Installs code while at safepoint.
     ASSERT(thread()->IsMutatorThread());
     function.InstallOptimizedCode(code, /* is_osr = */ false);
@@ -2913,6 +3055,17 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
           DEBUG_ASSERT(flow_graph->VerifyUseLists());
         }
 
+        if (FLAG_loop_vectorization) {
+#ifndef PRODUCT
+          TimelineDurationScope tds2(thread(),
+                                     compiler_timeline,
+                                     "LoopVectorizer");
+#endif  // !PRODUCT
+          // Needs the bounds checks eliminated by range analysis.
+          LoopVectorizer::Optimize(flow_graph);
+          DEBUG_ASSERT(flow_graph->VerifyUseLists());
+        }
+
         // Recompute types after code movement was done to ensure correct
         // reaching types for hoisted values.
         FlowGraphTypePropagator::Propagate(flow_graph);
@@ -3050,7 +3203,7 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
                                   compiler_timeline,
                                   "FinalizeCompilation");
 #endif  // !PRODUCT
-        ASSERT(thread()->IsMutatorThread());
+        ASSERT(thread()->IsMutatorThread() || (result_code_ != NULL));
         FinalizeCompilation(&assembler, &graph_compiler, flow_graph);
       }
       // Mark that this isolate now has compiled code.
@@ -3101,8 +3254,11 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
       }
 
       // Clear the error if it was not a real error, but just a bailout.
+      // Aborted background compilations are reported to the caller, which
+      // compiles the function again on the mutator thread.
       if (error.IsLanguageError() &&
-          (LanguageError::Cast(error).kind() == Report::kBailout)) {
+          (LanguageError::Cast(error).kind() == Report::kBailout) &&
+          (error.raw() != Object::background_compilation_error().raw())) {
         thread()->clear_sticky_error();
       }
       is_compiled = false;
@@ -3116,7 +3272,9 @@ bool PrecompileParsedFunctionHelper::Compile(CompilationPipeline* pipeline) {
 
 static RawError* PrecompileFunctionHelper(CompilationPipeline* pipeline,
                                           const Function& function,
-                                          bool optimized) {
+                                          bool optimized,
+                                          Mutex* finalization_mutex = NULL,
+                                          Code* result_code = NULL) {
   // Check that we optimize, except if the function is not optimizable.
   ASSERT(FLAG_precompiled_mode);
   ASSERT(!function.IsOptimizable() || optimized);
@@ -3156,7 +3314,10 @@ static RawError* PrecompileFunctionHelper(CompilationPipeline* pipeline,
                num_tokens_after - num_tokens_before);
     }
 
-    PrecompileParsedFunctionHelper helper(parsed_function, optimized);
+    PrecompileParsedFunctionHelper helper(parsed_function,
+                                          optimized,
+                                          finalization_mutex,
+                                          result_code);
     const bool success = helper.Compile(pipeline);
     if (!success) {
       // Encountered error.
@@ -3165,12 +3326,18 @@ static RawError* PrecompileFunctionHelper(CompilationPipeline* pipeline,
       error = thread->sticky_error();
       thread->clear_sticky_error();
       ASSERT(error.IsLanguageError() &&
-             LanguageError::Cast(error).kind() != Report::kBailout);
+             ((LanguageError::Cast(error).kind() != Report::kBailout) ||
+              (error.raw() == Object::background_compilation_error().raw())));
       return error.raw();
     }
 
     per_compile_timer.Stop();
 
+    if (result_code != NULL) {
+      // The code is disassembled when it is installed.
+      return Error::null();
+    }
+
     if (trace_compiler) {
       THR_Print("--> '%s' entry: %#" Px " size: %" Pd " time: %" Pd64 " us\n",
                 function.ToFullyQualifiedCString(),
@@ -3195,8 +3362,12 @@ static RawError* PrecompileFunctionHelper(CompilationPipeline* pipeline,
     error = thread->sticky_error();
     thread->clear_sticky_error();
     // Precompilation may encounter compile-time errors.
-    // Do not attempt to optimize functions that can cause errors.
-    function.set_is_optimizable(false);
+    // Do not attempt to optimize functions that can cause errors. Functions
+    // that failed on a parallel compilation thread are compiled again by the
+    // mutator, which reports the error.
+    if (result_code == NULL) {
+      function.set_is_optimizable(false);
+    }
     return error.raw();
   }
   UNREACHABLE();
@@ -3217,6 +3388,189 @@ RawError* Precompiler::CompileFunction(Thread* thread,
   return PrecompileFunctionHelper(&pipeline, function, optimized);
 }
 
+
+// The functions of one parallel compilation wave and the code compiled for
+// them. Compilation threads claim the functions one by one.
+class PrecompilationWave : public ValueObject {
+ public:
+  PrecompilationWave(const Array& functions, const Array& code)
+      : functions_(functions),
+        code_(code),
+        next_index_(0),
+        running_tasks_(0) { }
+
+  const Array& functions() const { return functions_; }
+  const Array& code() const { return code_; }
+  Mutex* finalization_mutex() { return &finalization_mutex_; }
+
+  // Returns -1 when all functions have been claimed.
+  intptr_t ClaimNextIndex() {
+    MonitorLocker ml(&monitor_);
+    if (next_index_ == functions_.Length()) {
+      return -1;
+    }
+    return next_index_++;
+  }
+
+  void TaskStarted() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_++;
+  }
+
+  void AggregateCompilerStats(Thread* thread) {
+#ifndef PRODUCT
+    MonitorLocker ml(&monitor_);
+    Isolate* isolate = thread->isolate();
+    isolate->aggregate_compiler_stats()->Add(*thread->compiler_stats());
+    thread->compiler_stats()->Clear();
+#endif  // !PRODUCT
+  }
+
+  void TaskFinished() {
+    MonitorLocker ml(&monitor_);
+    running_tasks_--;
+    ml.NotifyAll();
+  }
+
+  void WaitForTasks(Thread* thread) {
+    MonitorLocker ml(&monitor_);
+    while (running_tasks_ > 0) {
+      ml.WaitWithSafepointCheck(thread);
+    }
+  }
+
+ private:
+  const Array& functions_;
+  const Array& code_;
+  Monitor monitor_;
+  Mutex finalization_mutex_;
+  intptr_t next_index_;
+  intptr_t running_tasks_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrecompilationWave);
+};
+
+
+class PrecompilationTask : public ThreadPool::Task {
+ public:
+  PrecompilationTask(Isolate* isolate, PrecompilationWave* wave)
+      : isolate_(isolate), wave_(wave) {
+    wave_->TaskStarted();
+  }
+
+  virtual void Run() {
+    bool result = Thread::EnterIsolateAsHelper(isolate_,
+                                               Thread::kCompilerTask);
+    ASSERT(result);
+    {
+      Thread* thread = Thread::Current();
+      StackZone stack_zone(thread);
+      Zone* zone = stack_zone.GetZone();
+      HANDLESCOPE(thread);
+      Function& function = Function::Handle(zone);
+      Code& code = Code::Handle(zone);
+      Error& error = Error::Handle(zone);
+      intptr_t index = wave_->ClaimNextIndex();
+      while (index >= 0) {
+        thread->CheckForSafepoint();
+        function ^= wave_->functions().At(index);
+        if (!function.HasCode()) {
+          VMTagScope tagScope(thread, VMTag::kCompileUnoptimizedTagId);
+          code = Code::null();
+          DartPrecompilationPipeline pipeline(zone);
+          error = PrecompileFunctionHelper(&pipeline,
+                                           function,
+                                           function.IsOptimizable(),
+                                           wave_->finalization_mutex(),
+                                           &code);
+          // On errors the slot stays empty, and the mutator compiles the
+          // function again.
+          if (error.IsNull()) {
+            ASSERT(!code.IsNull());
+            wave_->code().SetAt(index, code);
+          }
+        }
+        index = wave_->ClaimNextIndex();
+      }
+      wave_->AggregateCompilerStats(thread);
+    }
+    // Exit isolate cleanly *before* notifying the mutator, which may release
+    // the wave.
+    Thread::ExitIsolateAsHelper();
+    wave_->TaskFinished();
+  }
+
+ private:
+  Isolate* isolate_;
+  PrecompilationWave* wave_;
+
+  DISALLOW_COPY_AND_ASSIGN(PrecompilationTask);
+};
+
+
+// Compiles all pending functions on FLAG_precompiler_threads threads, then
+// installs the code and adds the callees on the mutator. The front end may
+// not change shared state off the mutator (e.g., create closure functions or
+// evaluate constants), so compilations needing that are aborted on the
+// compilation threads and redone here.
+void Precompiler::ProcessFunctionsInParallel() {
+  const intptr_t length = pending_functions_.Length();
+  const Array& functions = Array::Handle(Z, Array::New(length, Heap::kOld));
+  const Array& code_array = Array::Handle(Z, Array::New(length, Heap::kOld));
+  Function& function = Function::Handle(Z);
+  for (intptr_t i = 0; i < length; i++) {
+    function ^= pending_functions_.RemoveLast();
+    // Kernel bodies are read lazily into an arena that is not thread-safe,
+    // so read them here before the tasks look at them.
+    dil::ReadLazyBody(function);
+    functions.SetAt(i, function);
+  }
+
+  {
+    PrecompilationWave wave(functions, code_array);
+    const intptr_t num_tasks =
+        Utils::Minimum(static_cast<intptr_t>(FLAG_precompiler_threads), length);
+    for (intptr_t i = 0; i < num_tasks; i++) {
+      Dart::thread_pool()->Run(new PrecompilationTask(I, &wave));
+    }
+    wave.WaitForTasks(T);
+  }
+
+  Code& code = Code::Handle(Z);
+  for (intptr_t i = 0; i < length; i++) {
+    function ^= functions.At(i);
+    code ^= code_array.At(i);
+    if (code.IsNull() || function.HasCode()) {
+      ProcessFunction(function);
+      continue;
+    }
+    function_count_++;
+    if (FLAG_trace_precompiler) {
+      THR_Print("Precompiling %" Pd " %s (%s, %s)\n",
+                function_count_,
+                function.ToLibNamePrefixedQualifiedCString(),
+                function.token_pos().ToCString(),
+                Function::KindToCString(function.kind()));
+    }
+    if (code.is_optimized()) {
+      function.InstallOptimizedCode(code, /* is_osr = */ false);
+    } else {
+      function.set_unoptimized_code(code);
+      function.AttachCode(code);
+    }
+    if (FLAG_disassemble && FlowGraphPrinter::ShouldPrint(function)) {
+      Disassembler::DisassembleCode(function, code.is_optimized());
+    } else if (FLAG_disassemble_optimized &&
+               code.is_optimized() &&
+               FlowGraphPrinter::ShouldPrint(function)) {
+      Disassembler::DisassembleCode(function, true);
+    }
+    // Used in the JIT to save type-feedback across compilations.
+    function.ClearICDataArray();
+    AddCalleesOf(function);
+  }
+}
+
 #endif  // DART_PRECOMPILER
 
 }  // namespace dart
@@ -330,6 +330,7 @@ class Precompiler : public ValueObject {
   bool IsSent(const String& selector);
 
   void ProcessFunction(const Function& function);
+  void ProcessFunctionsInParallel();
   void CheckForNewDynamicFunctions();
   void TraceConstFunctions();
   void CollectCallbackFields();
@@ -346,6 +347,7 @@ class Precompiler : public ValueObject {
 
   void BindStaticCalls();
   void SwitchICCalls();
+  void BuildDispatchTable();
   void DedupStackmaps();
   void DedupStackmapLists();
   void DedupInstructions();
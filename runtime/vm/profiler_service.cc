@@ -2878,7 +2878,8 @@ void ProfilerService::PrintTimelineJSON(JSONStream* stream,
   const intptr_t thread_task_mask = Thread::kMutatorTask |
                                     Thread::kCompilerTask |
                                     Thread::kSweeperTask |
-                                    Thread::kMarkerTask;
+                                    Thread::kMarkerTask |
+                                    Thread::kScavengerTask;
   NoAllocationSampleFilter filter(isolate,
                                   thread_task_mask,
                                   time_origin_micros,
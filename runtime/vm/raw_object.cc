@@ -51,11 +51,11 @@ void RawObject::Validate(Isolate* isolate) const {
 }
 
 
-intptr_t RawObject::SizeFromClass() const {
+intptr_t RawObject::SizeFromClass(uword tags) const {
   // Only reasonable to be called on heap objects.
   ASSERT(IsHeapObject());
 
-  intptr_t class_id = GetClassId();
+  intptr_t class_id = ClassIdTag::decode(tags);
   intptr_t instance_size = 0;
   switch (class_id) {
     case kCodeCid: {
@@ -119,9 +119,9 @@ intptr_t RawObject::SizeFromClass() const {
     CLASS_LIST_TYPED_DATA(SIZE_FROM_CLASS) {
       const RawTypedData* raw_obj =
           reinterpret_cast<const RawTypedData*>(this);
-      intptr_t cid = raw_obj->GetClassId();
       intptr_t array_len = Smi::Value(raw_obj->ptr()->length_);
-      intptr_t lengthInBytes = array_len * TypedData::ElementSizeInBytes(cid);
+      intptr_t lengthInBytes =
+          array_len * TypedData::ElementSizeInBytes(class_id);
       instance_size = TypedData::InstanceSize(lengthInBytes);
       break;
     }
@@ -188,7 +188,7 @@ intptr_t RawObject::SizeFromClass() const {
       if (!class_table->IsValidIndex(class_id) ||
           !class_table->HasValidClassAt(class_id)) {
         FATAL2("Invalid class id: %" Pd " from tags %" Px "\n",
-               class_id, ptr()->tags_);
+               class_id, tags);
       }
 #endif  // DEBUG
       RawClass* raw_class = isolate->GetClassForHeapWalkAt(class_id);
@@ -198,7 +198,6 @@ intptr_t RawObject::SizeFromClass() const {
   }
   ASSERT(instance_size != 0);
 #if defined(DEBUG)
-  uword tags = ptr()->tags_;
   intptr_t tags_size = SizeTag::decode(tags);
   if ((class_id == kArrayCid) && (instance_size > tags_size && tags_size > 0)) {
     // TODO(22501): Array::MakeArray could be in the process of shrinking
@@ -921,6 +920,14 @@ intptr_t RawSendPort::VisitSendPortPointers(RawSendPort* raw_obj,
 }
 
 
+intptr_t RawTransferableTypedData::VisitTransferableTypedDataPointers(
+    RawTransferableTypedData* raw_obj, ObjectPointerVisitor* visitor) {
+  // Make sure that we got here with the tagged pointer as this.
+  ASSERT(raw_obj->IsHeapObject());
+  return TransferableTypedData::InstanceSize();
+}
+
+
 intptr_t RawStacktrace::VisitStacktracePointers(RawStacktrace* raw_obj,
                                                 ObjectPointerVisitor* visitor) {
   // Make sure that we got here with the tagged pointer as this.
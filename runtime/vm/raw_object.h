@@ -73,6 +73,7 @@ namespace dart {
     V(Capability)                                                              \
     V(ReceivePort)                                                             \
     V(SendPort)                                                                \
+    V(TransferableTypedData)                                                   \
     V(Stacktrace)                                                              \
     V(RegExp)                                                                  \
     V(WeakProperty)                                                            \
@@ -140,6 +141,7 @@ namespace dart {
 
 // Forward declarations.
 class Isolate;
+class TransferableTypedDataPeer;
 #define DEFINE_FORWARD_DECLARATION(clazz)                                      \
   class Raw##clazz;
 CLASS_LIST(DEFINE_FORWARD_DECLARATION)
@@ -466,6 +468,19 @@ CLASS_LIST_TYPED_DATA(DEFINE_IS_CID)
     return result;
   }
 
+  // Like Size(), but using the header word 'tags' previously read by the
+  // caller, for headers that may be concurrently overwritten (e.g., with a
+  // forwarding address by another scavenger task).
+  intptr_t Size(uword tags) const {
+    intptr_t result = SizeTag::decode(tags);
+    if (result != 0) {
+      return result;
+    }
+    result = SizeFromClass(tags);
+    ASSERT(result > SizeTag::kMaxSizeTag);
+    return result;
+  }
+
   bool Contains(uword addr) const {
     intptr_t this_size = Size();
     uword this_addr = RawObject::ToAddr(this);
@@ -533,7 +548,8 @@ CLASS_LIST_TYPED_DATA(DEFINE_IS_CID)
         reinterpret_cast<uword>(this) - kHeapObjectTag);
   }
 
-  intptr_t SizeFromClass() const;
+  intptr_t SizeFromClass() const { return SizeFromClass(ptr()->tags_); }
+  intptr_t SizeFromClass(uword tags) const;
 
   intptr_t GetClassId() const {
     uword tags = ptr()->tags_;
@@ -580,10 +596,18 @@ CLASS_LIST_TYPED_DATA(DEFINE_IS_CID)
     *const_cast<type*>(addr) = value;
     // Filter stores based on source and target.
     if (!value->IsHeapObject()) return;
-    if (value->IsNewObject() && this->IsOldObject() &&
-        !this->IsRemembered()) {
-      this->SetRememberedBit();
-      Thread::Current()->StoreBufferAddObject(this);
+    if (value->IsNewObject()) {
+      if (this->IsOldObject() && !this->IsRemembered()) {
+        this->SetRememberedBit();
+        Thread::Current()->StoreBufferAddObject(this);
+      }
+    } else if (FLAG_concurrent_mark && !value->IsMarked()) {
+      // Concurrent marking barrier: shade the stored value, as the marker may
+      // already have visited this object.
+      Thread* thread = Thread::Current();
+      if (thread->is_marking()) {
+        thread->MarkingStackAddObject(value);
+      }
     }
   }
 
@@ -609,6 +633,7 @@ CLASS_LIST_TYPED_DATA(DEFINE_IS_CID)
   friend class ForwardPointersVisitor;  // StorePointer
   friend class FreeListElement;
   friend class Function;
+  friend class GCCompactor;  // GetClassId
   friend class GCMarker;
   friend class ExternalTypedData;
   friend class ForwardList;
@@ -1548,8 +1573,9 @@ class RawMegamorphicCache : public RawObject {
   RawSmi* mask_;
   RawString* target_name_;     // Name of target function.
   RawArray* args_descriptor_;  // Arguments descriptor.
+  RawSmi* dispatch_offset_;    // Row of the selector in the dispatch table.
   RawObject** to() {
-    return reinterpret_cast<RawObject**>(&ptr()->args_descriptor_);
+    return reinterpret_cast<RawObject**>(&ptr()->dispatch_offset_);
   }
 
   int32_t filled_entry_count_;
@@ -2127,6 +2153,14 @@ class RawSendPort : public RawInstance {
 };
 
 
+class RawTransferableTypedData : public RawInstance {
+  RAW_HEAP_OBJECT_IMPLEMENTATION(TransferableTypedData);
+
+  // Owns the malloc'd bytes until they are sent or materialized.
+  TransferableTypedDataPeer* peer_;
+};
+
+
 class RawReceivePort : public RawInstance {
   RAW_HEAP_OBJECT_IMPLEMENTATION(ReceivePort);
 
@@ -2883,6 +2883,52 @@ void RawSendPort::WriteTo(SnapshotWriter* writer,
 }
 
 
+RawTransferableTypedData* TransferableTypedData::ReadFrom(
+    SnapshotReader* reader,
+    intptr_t object_id,
+    intptr_t tags,
+    Snapshot::Kind kind,
+    bool as_reference) {
+  ASSERT(kind == Snapshot::kMessage);
+  uint8_t* data = reinterpret_cast<uint8_t*>(reader->ReadRawPointerValue());
+  intptr_t length = reader->Read<int64_t>();
+
+  // The receiving isolate takes over the bytes the sender detached from.
+  TransferableTypedData& result = TransferableTypedData::ZoneHandle(
+      reader->zone(), TransferableTypedData::New(data, length));
+  reader->AddBackRef(object_id, &result, kIsDeserialized);
+  return result.raw();
+}
+
+
+void RawTransferableTypedData::WriteTo(SnapshotWriter* writer,
+                                       intptr_t object_id,
+                                       Snapshot::Kind kind,
+                                       bool as_reference) {
+  ASSERT(kind == Snapshot::kMessage);
+  TransferableTypedDataPeer* peer = ptr()->peer_;
+  if (peer->IsDetached()) {
+    writer->SetWriteException(Exceptions::kArgument,
+                              "Illegal argument in isolate message"
+                              " : (TransferableTypedData has been transferred"
+                              " or materialized already)");
+  }
+
+  // Write out the serialization header value for this object.
+  writer->WriteInlinedObjectHeader(object_id);
+
+  // Write out the class and tags information.
+  writer->WriteIndexedObject(kTransferableTypedDataCid);
+  writer->WriteTags(writer->GetObjectTags(this));
+
+  // Only the address moves; the sender detaches once the whole message has
+  // been written.
+  writer->WriteRawPointerValue(reinterpret_cast<intptr_t>(peer->data()));
+  writer->Write<int64_t>(peer->length());
+  writer->AddTransferable(peer);
+}
+
+
 RawStacktrace* Stacktrace::ReadFrom(SnapshotReader* reader,
                                     intptr_t object_id,
                                     intptr_t tags,
@@ -6,6 +6,7 @@
 
 #include "vm/dart.h"
 #include "vm/dart_api_state.h"
+#include "vm/freelist.h"
 #include "vm/isolate.h"
 #include "vm/lockers.h"
 #include "vm/object.h"
@@ -13,6 +14,8 @@
 #include "vm/safepoint.h"
 #include "vm/stack_frame.h"
 #include "vm/store_buffer.h"
+#include "vm/thread_barrier.h"
+#include "vm/thread_pool.h"
 #include "vm/thread_registry.h"
 #include "vm/timeline.h"
 #include "vm/verifier.h"
@@ -27,6 +30,9 @@ DEFINE_FLAG(int, early_tenuring_threshold, 66,
 DEFINE_FLAG(int, new_gen_garbage_threshold, 90,
             "Grow new gen when less than this percentage is garbage.");
 DEFINE_FLAG(int, new_gen_growth_factor, 4, "Grow new gen by this factor.");
+DEFINE_FLAG(int, scavenger_tasks, 0,
+            "The number of tasks to spawn during scavenging (0 means "
+            "perform the scavenge on main thread).");
 
 // Scavenger uses RawObject::kMarkBit to distinguish forwaded and non-forwarded
 // objects. The kMarkBit does not intersect with the target address because of
@@ -58,11 +64,103 @@ static inline void ForwardTo(uword original, uword target) {
 }
 
 
+// Forwards 'original' unless its header is no longer 'header', i.e., another
+// scavenger task forwarded it first. Returns the header found.
+static inline uword CompareAndForwardTo(uword original,
+                                        uword header,
+                                        uword target) {
+  ASSERT((target & kForwardingMask) == 0);
+  return AtomicOperations::CompareAndSwapWord(
+      reinterpret_cast<uword*>(original), header, target | kForwarded);
+}
+
+
+// Parallel scavenger tasks copy and promote objects into private buffers of
+// this size. Objects of at least kLargeCopySize bytes are allocated on their
+// own.
+static const intptr_t kCopyBufferSize = 32 * KB;
+static const intptr_t kLargeCopySize = kCopyBufferSize / 4;
+
+
+// Work shared by the tasks of a parallel scavenge: the store buffer blocks
+// left to visit, and ranges of copied objects that were handed off unscanned
+// by the task that copied them.
+class ScavengerWorkList {
+ public:
+  explicit ScavengerWorkList(StoreBufferBlock* store_buffer_blocks)
+      : store_buffer_blocks_(store_buffer_blocks),
+        num_ranges_(0),
+        store_buffer_entries_(0),
+        bytes_promoted_(0) { }
+
+  StoreBufferBlock* PopStoreBufferBlock() {
+    MutexLocker ml(&mutex_);
+    StoreBufferBlock* block = store_buffer_blocks_;
+    if (block != NULL) {
+      store_buffer_blocks_ = block->next();
+    }
+    return block;
+  }
+
+  void PushRange(uword start, uword end) {
+    ASSERT(start < end);
+    MutexLocker ml(&mutex_);
+    ranges_.Add(start);
+    ranges_.Add(end);
+    num_ranges_++;
+  }
+
+  bool PopRange(uword* start, uword* end) {
+    MutexLocker ml(&mutex_);
+    if (num_ranges_ == 0) {
+      return false;
+    }
+    *end = ranges_.RemoveLast();
+    *start = ranges_.RemoveLast();
+    num_ranges_--;
+    return true;
+  }
+
+  // Unsynchronized; only a hint for idle tasks whether to look for work.
+  bool IsEmpty() {
+    return (AtomicOperations::LoadRelaxed(&store_buffer_blocks_) == NULL) &&
+           (AtomicOperations::LoadRelaxed(&num_ranges_) == 0);
+  }
+
+  // Protects the scavenger and class table while tasks report results.
+  Mutex* results_mutex() { return &results_mutex_; }
+
+  void AddResults(intptr_t store_buffer_entries, intptr_t bytes_promoted) {
+    DEBUG_ASSERT(results_mutex_.IsOwnedByCurrentThread());
+    store_buffer_entries_ += store_buffer_entries;
+    bytes_promoted_ += bytes_promoted;
+  }
+  intptr_t store_buffer_entries() const { return store_buffer_entries_; }
+  intptr_t bytes_promoted() const { return bytes_promoted_; }
+
+ private:
+  Mutex mutex_;
+  StoreBufferBlock* store_buffer_blocks_;
+  MallocGrowableArray<uword> ranges_;
+  intptr_t num_ranges_;
+
+  Mutex results_mutex_;
+  intptr_t store_buffer_entries_;
+  intptr_t bytes_promoted_;
+
+  DISALLOW_COPY_AND_ASSIGN(ScavengerWorkList);
+};
+
+
+// Copies objects for a scavenge. With a 'work_list', the visitor is one of
+// several parallel tasks: it copies into its own buffers and scans the
+// objects it copied, and shares work with the other tasks through the list.
 class ScavengerVisitor : public ObjectPointerVisitor {
  public:
-  explicit ScavengerVisitor(Isolate* isolate,
-                            Scavenger* scavenger,
-                            SemiSpace* from)
+  ScavengerVisitor(Isolate* isolate,
+                   Scavenger* scavenger,
+                   SemiSpace* from,
+                   ScavengerWorkList* work_list)
       : ObjectPointerVisitor(isolate),
         thread_(Thread::Current()),
         scavenger_(scavenger),
@@ -70,8 +168,17 @@ class ScavengerVisitor : public ObjectPointerVisitor {
         heap_(scavenger->heap_),
         vm_heap_(Dart::vm_isolate()->heap()),
         page_space_(scavenger->heap_->old_space()),
+        work_list_(work_list),
+        delayed_weak_properties_(NULL),
         bytes_promoted_(0),
-        visiting_old_object_(NULL) { }
+        store_buffer_entries_(0),
+        visiting_old_object_(NULL),
+        copy_scan_(0),
+        copy_top_(0),
+        copy_end_(0),
+        promo_scan_(0),
+        promo_top_(0),
+        promo_end_(0) { }
 
   void VisitPointers(RawObject** first, RawObject** last) {
     ASSERT((visiting_old_object_ != NULL) ||
@@ -89,6 +196,137 @@ class ScavengerVisitor : public ObjectPointerVisitor {
 
   intptr_t bytes_promoted() const { return bytes_promoted_; }
 
+  // Visits the old objects remembered in 'block' and returns their number.
+  intptr_t VisitStoreBufferBlock(StoreBufferBlock* block) {
+    // Generated code appends to store buffers; tell MemorySanitizer.
+    MSAN_UNPOISON(block, sizeof(*block));
+    intptr_t count = block->Count();
+    while (!block->IsEmpty()) {
+      RawObject* raw_object = block->Pop();
+      if (raw_object->IsForwardingCorpse()) {
+        // A source object in a become was a remembered object, but we do
+        // not visit the store buffer during become to remove it.
+        continue;
+      }
+      ASSERT(raw_object->IsRemembered());
+      raw_object->ClearRememberedBit();
+      VisitingOldObject(raw_object);
+      raw_object->VisitPointers(this);
+    }
+    VisitingOldObject(NULL);
+    return count;
+  }
+
+  void EnqueueWeakProperty(RawWeakProperty* raw_weak) {
+    if (work_list_ == NULL) {
+      scavenger_->EnqueueWeakProperty(raw_weak);
+      return;
+    }
+    ASSERT(raw_weak->ptr()->next_ == 0);
+    raw_weak->ptr()->next_ = reinterpret_cast<uword>(delayed_weak_properties_);
+    delayed_weak_properties_ = raw_weak;
+  }
+
+  // Scans copied objects and takes work from the work list until neither
+  // has anything left.
+  void Drain() {
+    ASSERT(work_list_ != NULL);
+    while (true) {
+      ProcessCopiedObjects();
+      StoreBufferBlock* block = work_list_->PopStoreBufferBlock();
+      if (block != NULL) {
+        store_buffer_entries_ += VisitStoreBufferBlock(block);
+        block->Reset();
+        // Return the emptied block for recycling (no need to check threshold).
+        isolate()->store_buffer()->PushBlock(block,
+                                             StoreBuffer::kIgnoreThreshold);
+        continue;
+      }
+      uword start = 0;
+      uword end = 0;
+      if (work_list_->PopRange(&start, &end)) {
+        while (start < end) {
+          RawObject* raw_obj = RawObject::FromAddr(start);
+          start += raw_obj->Size();
+          ScanObject(raw_obj);
+        }
+        continue;
+      }
+      break;
+    }
+  }
+
+  // Visits the pending weak properties whose keys have been copied since
+  // they were enqueued, possibly by another task. Returns true if any were.
+  bool ProcessPendingWeakProperties() {
+    bool found = false;
+    RawWeakProperty* cur_weak = delayed_weak_properties_;
+    delayed_weak_properties_ = NULL;
+    while (cur_weak != NULL) {
+      uword next_weak = cur_weak->ptr()->next_;
+      ASSERT(cur_weak->IsNewObject());
+      RawObject* raw_key = cur_weak->ptr()->key_;
+      ASSERT(raw_key->IsNewObject());
+      uword raw_addr = RawObject::ToAddr(raw_key);
+      ASSERT(from_->Contains(raw_addr));
+      uword header = *reinterpret_cast<uword*>(raw_addr);
+      // Reset the next pointer in the weak property.
+      cur_weak->ptr()->next_ = 0;
+      if (IsForwarding(header)) {
+        cur_weak->VisitPointers(this);
+        found = true;
+      } else {
+        EnqueueWeakProperty(cur_weak);
+      }
+      cur_weak = reinterpret_cast<RawWeakProperty*>(next_weak);
+    }
+    return found;
+  }
+
+  // Called by a parallel task when the scavenge is complete: gives back
+  // unused buffer space and reports results.
+  void Finalize() {
+    ASSERT(work_list_ != NULL);
+    ASSERT(copy_scan_ == copy_top_);
+    ASSERT(promo_scan_ == promo_top_);
+    if (copy_top_ < copy_end_) {
+      // Keep to-space iterable.
+      FreeListElement::AsElement(copy_top_, copy_end_ - copy_top_);
+    }
+    if (promo_top_ < promo_end_) {
+      page_space_->AcquireDataLock();
+      page_space_->FreePromoLocked(promo_top_, promo_end_ - promo_top_);
+      page_space_->ReleaseDataLock();
+    }
+    copy_scan_ = copy_top_ = copy_end_ = 0;
+    promo_scan_ = promo_top_ = promo_end_ = 0;
+
+    MutexLocker ml(work_list_->results_mutex());
+    work_list_->AddResults(store_buffer_entries_, bytes_promoted_);
+    // The remaining weak properties have unreachable keys; the scavenger
+    // clears them after the weak handles have been processed.
+    RawWeakProperty* cur_weak = delayed_weak_properties_;
+    delayed_weak_properties_ = NULL;
+    while (cur_weak != NULL) {
+      uword next_weak = cur_weak->ptr()->next_;
+      cur_weak->ptr()->next_ = 0;
+      scavenger_->EnqueueWeakProperty(cur_weak);
+      cur_weak = reinterpret_cast<RawWeakProperty*>(next_weak);
+    }
+#ifndef PRODUCT
+    ClassTable* class_table = isolate()->class_table();
+    for (intptr_t cid = 0; cid < class_stats_.length(); ++cid) {
+      const AllocStats<intptr_t>& stats = class_stats_[cid];
+      if (stats.new_count > 0) {
+        class_table->UpdateLiveNew(cid, stats.new_size, stats.new_count);
+      }
+      if (stats.old_count > 0) {
+        class_table->UpdateAllocatedOld(cid, stats.old_size, stats.old_count);
+      }
+    }
+#endif  // !PRODUCT
+  }
+
  private:
   void UpdateStoreBuffer(RawObject** p, RawObject* obj) {
     uword ptr = reinterpret_cast<uword>(p);
@@ -122,6 +360,8 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     if (IsForwarding(header)) {
       // Get the new location of the object.
       new_addr = ForwardedAddr(header);
+    } else if (work_list_ != NULL) {
+      new_addr = ParallelCopy(raw_addr, header);
     } else {
       intptr_t size = raw_obj->Size();
       NOT_IN_PRODUCT(intptr_t cid = raw_obj->GetClassId());
@@ -162,6 +402,12 @@ class ScavengerVisitor : public ObjectPointerVisitor {
               size);
       // Remember forwarding address.
       ForwardTo(raw_addr, new_addr);
+      if (thread_->is_marking() &&
+          RawObject::FromAddr(new_addr)->IsOldObject()) {
+        // A promoted object is unknown to the concurrent marker, but may
+        // already be referenced by marked objects.
+        thread_->MarkingStackAddObject(RawObject::FromAddr(new_addr));
+      }
     }
     // Update the reference.
     RawObject* new_obj = RawObject::FromAddr(new_addr);
@@ -172,16 +418,205 @@ class ScavengerVisitor : public ObjectPointerVisitor {
     }
   }
 
+  // Copies the object at 'raw_addr' (with header word 'header') in a
+  // parallel scavenge, racing with other tasks that may copy it as well.
+  // Returns the address of the copy that won.
+  uword ParallelCopy(uword raw_addr, uword header) {
+    RawObject* raw_obj = RawObject::FromAddr(raw_addr);
+    // Once another task forwards the object, only 'header' describes it.
+    const intptr_t size = raw_obj->Size(header);
+    uword new_addr = 0;
+    bool promoted = false;
+    if (raw_addr < scavenger_->survivor_end_) {
+      // A survivor of a previous scavenge. Attempt to promote the object.
+      new_addr = TryAllocatePromo(size);
+      promoted = (new_addr != 0);
+    }
+    if (new_addr == 0) {
+      new_addr = TryAllocateCopy(size);
+      if (new_addr == 0) {
+        // Unused ends of copy buffers can leave too little of to-space for
+        // all surviving objects; promote the rest.
+        new_addr = TryAllocatePromo(size);
+        promoted = true;
+      }
+    }
+    ASSERT(new_addr != 0);
+    memmove(reinterpret_cast<void*>(new_addr),
+            reinterpret_cast<void*>(raw_addr),
+            size);
+    *reinterpret_cast<uword*>(new_addr) = header;
+    uword old_header = CompareAndForwardTo(raw_addr, header, new_addr);
+    if (old_header != header) {
+      // Another task copied the object first; drop this copy.
+      UndoAllocation(new_addr, size, promoted);
+      return ForwardedAddr(old_header);
+    }
+    NOT_IN_PRODUCT(UpdateClassStats(RawObject::ClassIdTag::decode(header),
+                                    size, promoted));
+    if (promoted) {
+      bytes_promoted_ += size;
+      if (thread_->is_marking()) {
+        // A promoted object is unknown to the concurrent marker.
+        thread_->MarkingStackAddObject(RawObject::FromAddr(new_addr));
+      }
+    }
+    if (size >= kLargeCopySize) {
+      // Allocated outside of this task's buffers, so scan it separately.
+      work_list_->PushRange(new_addr, new_addr + size);
+    }
+    return new_addr;
+  }
+
+  // Allocates 'size' bytes in to-space for a parallel task.
+  uword TryAllocateCopy(intptr_t size) {
+    intptr_t buffer_size = 0;
+    if (size >= kLargeCopySize) {
+      return scavenger_->TryAllocateCopyBuffer(size, size, &buffer_size);
+    }
+    if (static_cast<intptr_t>(copy_end_ - copy_top_) < size) {
+      // Let other tasks scan the rest of the full buffer.
+      if (copy_scan_ < copy_top_) {
+        work_list_->PushRange(copy_scan_, copy_top_);
+      }
+      if (copy_top_ < copy_end_) {
+        // Keep to-space iterable.
+        FreeListElement::AsElement(copy_top_, copy_end_ - copy_top_);
+      }
+      uword buffer =
+          scavenger_->TryAllocateCopyBuffer(size, kCopyBufferSize,
+                                            &buffer_size);
+      copy_scan_ = copy_top_ = buffer;
+      copy_end_ = buffer + buffer_size;
+      if (buffer == 0) {
+        return 0;
+      }
+    }
+    uword result = copy_top_;
+    copy_top_ += size;
+    return result;
+  }
+
+  // Allocates 'size' bytes in old space for a parallel task.
+  uword TryAllocatePromo(intptr_t size) {
+    if (size >= kLargeCopySize) {
+      page_space_->AcquireDataLock();
+      uword result =
+          page_space_->TryAllocatePromoLocked(size, PageSpace::kForceGrowth);
+      page_space_->ReleaseDataLock();
+      return result;
+    }
+    if (static_cast<intptr_t>(promo_end_ - promo_top_) < size) {
+      // Let other tasks scan the rest of the full buffer.
+      if (promo_scan_ < promo_top_) {
+        work_list_->PushRange(promo_scan_, promo_top_);
+      }
+      page_space_->AcquireDataLock();
+      if (promo_top_ < promo_end_) {
+        page_space_->FreePromoLocked(promo_top_, promo_end_ - promo_top_);
+      }
+      uword buffer = page_space_->TryAllocatePromoLocked(
+          kCopyBufferSize, PageSpace::kForceGrowth);
+      page_space_->ReleaseDataLock();
+      promo_scan_ = promo_top_ = buffer;
+      promo_end_ = (buffer == 0) ? 0 : (buffer + kCopyBufferSize);
+      if (buffer == 0) {
+        return 0;
+      }
+    }
+    uword result = promo_top_;
+    promo_top_ += size;
+    return result;
+  }
+
+  void UndoAllocation(uword addr, intptr_t size, bool promoted) {
+    if (size >= kLargeCopySize) {
+      // Leave a dead object behind.
+      FreeListElement::AsElement(addr, size);
+    } else if (promoted) {
+      ASSERT(promo_top_ == (addr + size));
+      promo_top_ = addr;
+    } else {
+      ASSERT(copy_top_ == (addr + size));
+      copy_top_ = addr;
+    }
+  }
+
+  // Scans the objects this task copied into its buffers so far.
+  void ProcessCopiedObjects() {
+    while ((copy_scan_ < copy_top_) || (promo_scan_ < promo_top_)) {
+      // Step over each object before scanning it: scanning can hand the rest
+      // of the buffer off to other tasks.
+      while (copy_scan_ < copy_top_) {
+        RawObject* raw_obj = RawObject::FromAddr(copy_scan_);
+        copy_scan_ += raw_obj->Size();
+        ScanObject(raw_obj);
+      }
+      while (promo_scan_ < promo_top_) {
+        RawObject* raw_obj = RawObject::FromAddr(promo_scan_);
+        promo_scan_ += raw_obj->Size();
+        ScanObject(raw_obj);
+      }
+    }
+  }
+
+  void ScanObject(RawObject* raw_obj) {
+    if (raw_obj->IsOldObject()) {
+      // Promoted objects are not remembered yet; visiting them may add them
+      // to the store buffer.
+      ASSERT(!raw_obj->IsRemembered());
+      VisitingOldObject(raw_obj);
+      raw_obj->VisitPointers(this);
+      VisitingOldObject(NULL);
+    } else if (raw_obj->GetClassId() == kWeakPropertyCid) {
+      scavenger_->ProcessWeakProperty(
+          reinterpret_cast<RawWeakProperty*>(raw_obj), this);
+    } else {
+      raw_obj->VisitPointers(this);
+    }
+  }
+
+#ifndef PRODUCT
+  void UpdateClassStats(intptr_t cid, intptr_t size, bool promoted) {
+    if (cid >= class_stats_.length()) {
+      AllocStats<intptr_t> empty;
+      empty.Reset();
+      while (class_stats_.length() <= cid) {
+        class_stats_.Add(empty);
+      }
+    }
+    if (promoted) {
+      class_stats_[cid].AddOld(size);
+    } else {
+      class_stats_[cid].AddNew(size);
+    }
+  }
+#endif  // !PRODUCT
+
   Thread* thread_;
   Scavenger* scavenger_;
   SemiSpace* from_;
   Heap* heap_;
   Heap* vm_heap_;
   PageSpace* page_space_;
+  ScavengerWorkList* work_list_;
+  // Only used in a parallel scavenge.
   RawWeakProperty* delayed_weak_properties_;
   intptr_t bytes_promoted_;
+  intptr_t store_buffer_entries_;
   RawObject* visiting_old_object_;
 
+  // Buffers of a parallel task, and how far their objects have been scanned.
+  uword copy_scan_;
+  uword copy_top_;
+  uword copy_end_;
+  uword promo_scan_;
+  uword promo_top_;
+  uword promo_end_;
+#ifndef PRODUCT
+  MallocGrowableArray<AllocStats<intptr_t> > class_stats_;
+#endif  // !PRODUCT
+
   friend class Scavenger;
 
   DISALLOW_COPY_AND_ASSIGN(ScavengerVisitor);
@@ -218,6 +653,113 @@ class ScavengerWeakVisitor : public HandleVisitor {
 };
 
 
+class ParallelScavengerTask : public ThreadPool::Task {
+ public:
+  ParallelScavengerTask(Scavenger* scavenger,
+                        Isolate* isolate,
+                        SemiSpace* from,
+                        ScavengerWorkList* work_list,
+                        ThreadBarrier* barrier,
+                        intptr_t task_index,
+                        intptr_t num_tasks,
+                        uintptr_t* num_busy)
+      : scavenger_(scavenger),
+        isolate_(isolate),
+        from_(from),
+        work_list_(work_list),
+        barrier_(barrier),
+        task_index_(task_index),
+        num_tasks_(num_tasks),
+        num_busy_(num_busy) {
+  }
+
+  virtual void Run() {
+    bool result =
+        Thread::EnterIsolateAsHelper(isolate_, Thread::kScavengerTask, true);
+    ASSERT(result);
+    {
+      Thread* thread = Thread::Current();
+      TIMELINE_FUNCTION_GC_DURATION(thread, "ScavengerTask");
+      StackZone stack_zone(thread);
+      ScavengerVisitor visitor(isolate_, scavenger_, from_, work_list_);
+      // Phase 1: Copy the roots; all tasks share the store buffer blocks.
+      scavenger_->IterateRoots(isolate_, &visitor, task_index_, num_tasks_);
+
+      bool more_to_scavenge = false;
+      do {
+        do {
+          visitor.Drain();
+
+          // I can't find more work right now. If no other task is busy,
+          // then there will never be more work (NB: 1 is *before* decrement).
+          if (AtomicOperations::FetchAndDecrement(num_busy_) == 1) break;
+
+          // Wait for some work to appear.
+          while (work_list_->IsEmpty() &&
+                 AtomicOperations::LoadRelaxed(num_busy_) > 0) {
+          }
+
+          // If no tasks are busy, there will never be more work.
+          if (AtomicOperations::LoadRelaxed(num_busy_) == 0) break;
+
+          // I saw some work; get busy and compete for it.
+          AtomicOperations::FetchAndIncrement(num_busy_);
+        } while (true);
+        // Wait for all tasks to stop.
+        barrier_->Sync();
+#if defined(DEBUG)
+        ASSERT(AtomicOperations::LoadRelaxed(num_busy_) == 0);
+        // Caveat: must not allow any task to continue past the barrier
+        // before we checked num_busy, otherwise one of them might rush
+        // ahead and increment it.
+        barrier_->Sync();
+#endif
+        // Check if we have any pending weak properties with copied keys.
+        // Those might have been copied by another task.
+        more_to_scavenge = visitor.ProcessPendingWeakProperties();
+        if (more_to_scavenge) {
+          // We have more work to do. Notify others.
+          AtomicOperations::FetchAndIncrement(num_busy_);
+        }
+
+        // Wait for all other tasks to finish processing their pending
+        // weak properties and decide if they need to continue scavenging.
+        // Caveat: we need two barriers here to make this decision in lock step
+        // between all tasks and the main thread.
+        barrier_->Sync();
+        if (!more_to_scavenge &&
+            (AtomicOperations::LoadRelaxed(num_busy_) > 0)) {
+          // All tasks continue to scavenge as long as any single task has
+          // some work to do.
+          AtomicOperations::FetchAndIncrement(num_busy_);
+          more_to_scavenge = true;
+        }
+        barrier_->Sync();
+      } while (more_to_scavenge);
+
+      // Phase 2: Release buffers and report results.
+      visitor.Finalize();
+    }
+    Thread::ExitIsolateAsHelper(true);
+
+    // This task is done. Notify the original thread.
+    barrier_->Exit();
+  }
+
+ private:
+  Scavenger* scavenger_;
+  Isolate* isolate_;
+  SemiSpace* from_;
+  ScavengerWorkList* work_list_;
+  ThreadBarrier* barrier_;
+  const intptr_t task_index_;
+  const intptr_t num_tasks_;
+  uintptr_t* num_busy_;
+
+  DISALLOW_COPY_AND_ASSIGN(ParallelScavengerTask);
+};
+
+
 // Visitor used to verify that all old->new references have been added to the
 // StoreBuffers.
 class VerifyStoreBufferPointerVisitor : public ObjectPointerVisitor {
@@ -383,6 +925,31 @@ intptr_t Scavenger::NewSizeInWords(intptr_t old_size_in_words) const {
 }
 
 
+uword Scavenger::TryAllocateCopyBuffer(intptr_t min_size,
+                                       intptr_t max_size,
+                                       intptr_t* size) {
+  ASSERT(scavenging_);
+  ASSERT(Utils::IsAligned(min_size, kObjectAlignment));
+  ASSERT(Utils::IsAligned(max_size, kObjectAlignment));
+  uword top = AtomicOperations::LoadRelaxed(&top_);
+  while (true) {
+    const intptr_t remaining = Utils::RoundDown(end_ - top, kObjectAlignment);
+    if (remaining < min_size) {
+      *size = 0;
+      return 0;
+    }
+    const intptr_t buffer_size = Utils::Minimum(remaining, max_size);
+    const uword old_top =
+        AtomicOperations::CompareAndSwapWord(&top_, top, top + buffer_size);
+    if (old_top == top) {
+      *size = buffer_size;
+      return top;
+    }
+    top = old_top;
+  }
+}
+
+
 SemiSpace* Scavenger::Prologue(Isolate* isolate, bool invoke_api_callbacks) {
   if (invoke_api_callbacks && (isolate->gc_prologue_callback() != NULL)) {
     (isolate->gc_prologue_callback())();
@@ -456,22 +1023,7 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
   intptr_t total_count = 0;
   while (pending != NULL) {
     StoreBufferBlock* next = pending->next();
-    // Generated code appends to store buffers; tell MemorySanitizer.
-    MSAN_UNPOISON(pending, sizeof(*pending));
-    intptr_t count = pending->Count();
-    total_count += count;
-    while (!pending->IsEmpty()) {
-      RawObject* raw_object = pending->Pop();
-      if (raw_object->IsForwardingCorpse()) {
-        // A source object in a become was a remembered object, but we do
-        // not visit the store buffer during become to remove it.
-        continue;
-      }
-      ASSERT(raw_object->IsRemembered());
-      raw_object->ClearRememberedBit();
-      visitor->VisitingOldObject(raw_object);
-      raw_object->VisitPointers(visitor);
-    }
+    total_count += visitor->VisitStoreBufferBlock(pending);
     pending->Reset();
     // Return the emptied block for recycling (no need to check threshold).
     isolate->store_buffer()->PushBlock(pending, StoreBuffer::kIgnoreThreshold);
@@ -480,8 +1032,6 @@ void Scavenger::IterateStoreBuffers(Isolate* isolate,
   heap_->RecordData(kStoreBufferEntries, total_count);
   heap_->RecordData(kDataUnused1, 0);
   heap_->RecordData(kDataUnused2, 0);
-  // Done iterating through old objects remembered in the store buffers.
-  visitor->VisitingOldObject(NULL);
 }
 
 
@@ -516,6 +1066,21 @@ void Scavenger::IterateRoots(Isolate* isolate, ScavengerVisitor* visitor) {
 }
 
 
+void Scavenger::IterateRoots(Isolate* isolate,
+                             ScavengerVisitor* visitor,
+                             intptr_t slice_index,
+                             intptr_t num_slices) {
+  ASSERT(0 <= slice_index && slice_index < num_slices);
+  if (slice_index == 0) {
+    isolate->VisitObjectPointers(visitor,
+                                 StackFrameIterator::kDontValidateFrames);
+  }
+  if (slice_index == (num_slices - 1)) {
+    IterateObjectIdTable(isolate, visitor);
+  }
+}
+
+
 bool Scavenger::IsUnreachable(RawObject** p) {
   RawObject* raw_obj = *p;
   if (!raw_obj->IsHeapObject()) {
@@ -606,6 +1171,51 @@ void Scavenger::ProcessToSpace(ScavengerVisitor* visitor) {
 }
 
 
+intptr_t Scavenger::ParallelScavenge(Isolate* isolate, SemiSpace* from) {
+  const intptr_t num_tasks = FLAG_scavenger_tasks;
+  ASSERT(num_tasks > 0);
+  // The tasks share the blocks of the store buffer; blocks filled during the
+  // scavenge go back to the store buffer itself.
+  ScavengerWorkList work_list(isolate->store_buffer()->Blocks());
+  {
+    ThreadBarrier barrier(num_tasks + 1,
+                          heap_->barrier(),
+                          heap_->barrier_done());
+    // Used to coordinate draining among tasks; all start out as 'busy'.
+    uintptr_t num_busy = num_tasks;
+    for (intptr_t i = 0; i < num_tasks; ++i) {
+      ParallelScavengerTask* task =
+          new ParallelScavengerTask(this, isolate, from, &work_list, &barrier,
+                                    i, num_tasks, &num_busy);
+      Dart::thread_pool()->Run(task);
+    }
+    bool more_to_scavenge = false;
+    do {
+      // Wait for all tasks to stop.
+      barrier.Sync();
+#if defined(DEBUG)
+      ASSERT(AtomicOperations::LoadRelaxed(&num_busy) == 0);
+      // Caveat: must not allow any task to continue past the barrier
+      // before we checked num_busy, otherwise one of them might rush
+      // ahead and increment it.
+      barrier.Sync();
+#endif
+      // Wait for all tasks to go through weak properties and verify
+      // that there are no more objects to copy.
+      // Note: we need to have two barriers here because we want all tasks
+      // and main thread to make decisions in lock step.
+      barrier.Sync();
+      more_to_scavenge = AtomicOperations::LoadRelaxed(&num_busy) > 0;
+      barrier.Sync();
+    } while (more_to_scavenge);
+    barrier.Exit();
+    // The barrier waits for all tasks to report their results.
+  }
+  heap_->RecordData(kStoreBufferEntries, work_list.store_buffer_entries());
+  return work_list.bytes_promoted();
+}
+
+
 void Scavenger::UpdateMaxHeapCapacity() {
   if (heap_ == NULL) {
     // Some unit tests.
@@ -657,7 +1267,7 @@ uword Scavenger::ProcessWeakProperty(RawWeakProperty* raw_weak,
     uword header = *reinterpret_cast<uword*>(raw_addr);
     if (!IsForwarding(header)) {
       // Key is white.  Enqueue the weak property.
-      EnqueueWeakProperty(raw_weak);
+      visitor->EnqueueWeakProperty(raw_weak);
       return raw_weak->Size();
     }
   }
@@ -788,7 +1398,8 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   NoSafepointScope no_safepoints;
 
   // TODO(koda): Make verification more compatible with concurrent sweep.
-  if (FLAG_verify_before_gc && !FLAG_concurrent_sweep) {
+  if (FLAG_verify_before_gc && !FLAG_concurrent_sweep &&
+      !page_space->IsConcurrentMarkInProgress()) {
     OS::PrintErr("Verifying before Scavenge...");
     heap_->Verify(kForbidMarked);
     OS::PrintErr(" done.\n");
@@ -803,13 +1414,25 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
   // depend on zone allocations surviving beyond the epilogue callback.
   {
     StackZone zone(thread);
-    // Setup the visitor and run the scavenge.
-    ScavengerVisitor visitor(isolate, this, from);
-    page_space->AcquireDataLock();
-    IterateRoots(isolate, &visitor);
-    int64_t start = OS::GetCurrentTimeMicros();
-    ProcessToSpace(&visitor);
-    int64_t middle = OS::GetCurrentTimeMicros();
+    int64_t start = 0;
+    int64_t middle = 0;
+    intptr_t bytes_promoted = 0;
+    if (FLAG_scavenger_tasks == 0) {
+      // Setup the visitor and run the scavenge.
+      ScavengerVisitor visitor(isolate, this, from, NULL);
+      page_space->AcquireDataLock();
+      IterateRoots(isolate, &visitor);
+      start = OS::GetCurrentTimeMicros();
+      ProcessToSpace(&visitor);
+      middle = OS::GetCurrentTimeMicros();
+      bytes_promoted = visitor.bytes_promoted();
+    } else {
+      // The tasks take the data lock only to allocate promotion buffers.
+      start = OS::GetCurrentTimeMicros();
+      bytes_promoted = ParallelScavenge(isolate, from);
+      middle = OS::GetCurrentTimeMicros();
+      page_space->AcquireDataLock();
+    }
     {
       TIMELINE_FUNCTION_GC_DURATION(thread, "WeakHandleProcessing");
       if (FLAG_background_finalization) {
@@ -837,12 +1460,13 @@ void Scavenger::Scavenge(bool invoke_api_callbacks) {
         ScavengeStats(start, end,
                       usage_before, GetCurrentUsage(),
                       promo_candidate_words,
-                      visitor.bytes_promoted() >> kWordSizeLog2));
+                      bytes_promoted >> kWordSizeLog2));
   }
   Epilogue(isolate, from, invoke_api_callbacks);
 
   // TODO(koda): Make verification more compatible with concurrent sweep.
-  if (FLAG_verify_after_gc && !FLAG_concurrent_sweep) {
+  if (FLAG_verify_after_gc && !FLAG_concurrent_sweep &&
+      !page_space->IsConcurrentMarkInProgress()) {
     OS::PrintErr("Verifying after Scavenge...");
     heap_->Verify(kForbidMarked);
     OS::PrintErr(" done.\n");
@@ -227,14 +227,24 @@ class Scavenger {
   };
 
   uword FirstObjectStart() const { return to_->start() | object_alignment_; }
+  // Claims between 'min_size' and 'max_size' bytes of to-space for a parallel
+  // scavenger task; returns 0 if less than 'min_size' bytes are left.
+  uword TryAllocateCopyBuffer(intptr_t min_size,
+                              intptr_t max_size,
+                              intptr_t* size);
   SemiSpace* Prologue(Isolate* isolate, bool invoke_api_callbacks);
   void IterateStoreBuffers(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateObjectIdTable(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateRoots(Isolate* isolate, ScavengerVisitor* visitor);
+  void IterateRoots(Isolate* isolate,
+                    ScavengerVisitor* visitor,
+                    intptr_t slice_index,
+                    intptr_t num_slices);
   void IterateWeakProperties(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakReferences(Isolate* isolate, ScavengerVisitor* visitor);
   void IterateWeakRoots(Isolate* isolate, HandleVisitor* visitor);
   void ProcessToSpace(ScavengerVisitor* visitor);
+  intptr_t ParallelScavenge(Isolate* isolate, SemiSpace* from);
   void EnqueueWeakProperty(RawWeakProperty* raw_weak);
   uword ProcessWeakProperty(RawWeakProperty* raw_weak,
                             ScavengerVisitor* visitor);
@@ -306,6 +316,7 @@ class Scavenger {
   // The total size of external data associated with objects in this scavenger.
   intptr_t external_size_;
 
+  friend class ParallelScavengerTask;
   friend class ScavengerVisitor;
   friend class ScavengerWeakVisitor;
 
@@ -1233,7 +1233,8 @@ SnapshotWriter::SnapshotWriter(Thread* thread,
       forward_list_(forward_list),
       exception_type_(Exceptions::kNone),
       exception_msg_(NULL),
-      can_send_any_object_(can_send_any_object) {
+      can_send_any_object_(can_send_any_object),
+      transferables_(thread->zone(), 0) {
   ASSERT(forward_list_ != NULL);
 }
 
@@ -1772,6 +1773,14 @@ void SnapshotWriter::CheckForNativeFields(RawClass* cls) {
 }
 
 
+void SnapshotWriter::DetachTransferables() {
+  for (intptr_t i = 0; i < transferables_.length(); i++) {
+    transferables_[i]->Detach(isolate());
+  }
+  transferables_.Clear();
+}
+
+
 void SnapshotWriter::SetWriteException(Exceptions::ExceptionType type,
                                        const char* msg) {
   set_exception_type(type);
@@ -1964,6 +1973,7 @@ void MessageWriter::WriteMessage(const Object& obj) {
   if (setjmp(*jump.Set()) == 0) {
     NoSafepointScope no_safepoint;
     WriteObject(obj.raw());
+    DetachTransferables();
   } else {
     ThrowException(exception_type(), exception_msg());
   }
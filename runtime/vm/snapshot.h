@@ -83,6 +83,7 @@ class RawStackmap;
 class RawStacktrace;
 class RawSubtypeTestCache;
 class RawTokenStream;
+class RawTransferableTypedData;
 class RawTwoByteString;
 class RawType;
 class RawTypeArguments;
@@ -94,6 +95,7 @@ class RawUnresolvedClass;
 class RawWeakProperty;
 class String;
 class TokenStream;
+class TransferableTypedDataPeer;
 class TypeArguments;
 class TypedData;
 class UnhandledException;
@@ -953,6 +955,13 @@ class SnapshotWriter : public BaseWriter {
   bool AllowObjectsInDartLibrary(RawLibrary* library);
   intptr_t FindVmSnapshotObject(RawObject* rawobj);
 
+  // Transferables written into a message are detached from the sender only
+  // after the whole message was written successfully.
+  void AddTransferable(TransferableTypedDataPeer* peer) {
+    transferables_.Add(peer);
+  }
+  void DetachTransferables();
+
   ObjectStore* object_store() const { return object_store_; }
 
  private:
@@ -964,6 +973,7 @@ class SnapshotWriter : public BaseWriter {
   Exceptions::ExceptionType exception_type_;  // Exception type.
   const char* exception_msg_;  // Message associated with exception.
   bool can_send_any_object_;  // True if any Dart instance can be sent.
+  GrowableArray<TransferableTypedDataPeer*> transferables_;
 
   friend class RawArray;
   friend class RawClass;
@@ -988,6 +998,7 @@ class SnapshotWriter : public BaseWriter {
   friend class RawStacktrace;
   friend class RawSubtypeTestCache;
   friend class RawTokenStream;
+  friend class RawTransferableTypedData;
   friend class RawType;
   friend class RawTypeArguments;
   friend class RawTypeParameter;
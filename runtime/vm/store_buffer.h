@@ -173,6 +173,9 @@ class MarkingStack : public BlockStack<kMarkingStackBlockSize> {
 };
 
 
+typedef MarkingStack::Block MarkingStackBlock;
+
+
 }  // namespace dart
 
 #endif  // VM_STORE_BUFFER_H_
@@ -20,6 +20,16 @@ class SnapshotWriter;
 class Serializer;
 class Deserializer;
 
+// Stubs for the concurrent marking write barrier, on the targets whose
+// generated code supports it.
+#if defined(TARGET_ARCH_X64)
+#define VM_MARKING_STUB_CODE_LIST(V)                                           \
+  V(MarkingBarrier)                                                            \
+
+#else
+#define VM_MARKING_STUB_CODE_LIST(V)
+#endif  // defined(TARGET_ARCH_X64)
+
 // List of stubs created in the VM isolate, these stubs are shared by different
 // isolates running in this dart process.
 #if !defined(TARGET_ARCH_DBC)
@@ -27,6 +37,7 @@ class Deserializer;
   V(GetStackPointer)                                                           \
   V(JumpToExceptionHandler)                                                    \
   V(UpdateStoreBuffer)                                                         \
+  VM_MARKING_STUB_CODE_LIST(V)                                                 \
   V(PrintStopMessage)                                                          \
   V(CallToRuntime)                                                             \
   V(LazyCompile)                                                               \
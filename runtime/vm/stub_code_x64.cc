@@ -8,6 +8,7 @@
 #include "vm/assembler.h"
 #include "vm/compiler.h"
 #include "vm/dart_entry.h"
+#include "vm/dispatch_table.h"
 #include "vm/flow_graph_compiler.h"
 #include "vm/heap.h"
 #include "vm/instructions.h"
@@ -1024,6 +1025,56 @@ void StubCode::GenerateUpdateStoreBufferStub(Assembler* assembler) {
 }
 
 
+// Helper stub to implement the concurrent marking barrier of
+// Assembler::StoreIntoObject; only called while the thread is marking.
+// Input parameters:
+//   RDX: Value being stored
+void StubCode::GenerateMarkingBarrierStub(Assembler* assembler) {
+  // Smis, new objects and marked objects need not be recorded.
+  Label done;
+  __ testq(RDX, Immediate(kSmiTagMask));
+  __ j(ZERO, &done, Assembler::kNearJump);
+  __ testq(RDX, Immediate(kNewObjectAlignmentOffset));
+  __ j(NOT_ZERO, &done, Assembler::kNearJump);
+  __ testb(FieldAddress(RDX, Object::tags_offset()),
+           Immediate(1 << RawObject::kMarkBit));
+  __ j(NOT_ZERO, &done, Assembler::kNearJump);
+
+  // Load the MarkingStack block out of the thread. Then load top_ out of the
+  // MarkingStackBlock and add the value to the pointers_.
+  // RDX: Value being stored
+  __ pushq(RAX);
+  __ pushq(RCX);
+  __ movq(RAX, Address(THR, Thread::marking_stack_block_offset()));
+  __ movl(RCX, Address(RAX, MarkingStackBlock::top_offset()));
+  __ movq(Address(RAX, RCX, TIMES_8, MarkingStackBlock::pointers_offset()),
+          RDX);
+
+  // Increment top_ and check for overflow.
+  // RCX: top_
+  // RAX: MarkingStackBlock
+  Label L;
+  __ incq(RCX);
+  __ movl(Address(RAX, MarkingStackBlock::top_offset()), RCX);
+  __ cmpl(RCX, Immediate(MarkingStackBlock::kSize));
+  // Restore values.
+  __ popq(RCX);
+  __ popq(RAX);
+  __ j(EQUAL, &L, Assembler::kNearJump);
+  __ Bind(&done);
+  __ ret();
+
+  // Handle overflow: Call the runtime leaf function.
+  __ Bind(&L);
+  // Setup frame, push callee-saved registers.
+  __ EnterCallRuntimeFrame(0);
+  __ movq(CallingConventions::kArg1Reg, THR);
+  __ CallRuntime(kMarkingStackBlockProcessRuntimeEntry, 1);
+  __ LeaveCallRuntimeFrame();
+  __ ret();
+}
+
+
 // Called for inline allocation of objects.
 // Input parameters:
 //   RSP + 8 : type arguments object (only if class is parameterized).
@@ -2021,13 +2072,43 @@ void StubCode::GenerateMegamorphicCallStub(Assembler* assembler) {
   Label smi_case;
   __ testq(RDI, Immediate(kSmiTagMask));
   // Jump out of line for smi case.
-  __ j(ZERO, &smi_case, Assembler::kNearJump);
+  __ j(ZERO, &smi_case);
 
   // Loads the cid of the object.
   __ LoadClassId(RAX, RDI);
 
   Label cid_loaded;
   __ Bind(&cid_loaded);
+
+  // Try the row of the selector in the dispatch table first. The entry for
+  // the cid is at index 'offset + 2 * cid' and is valid if it has the row's
+  // offset as key.
+  Label probe_cache;
+  __ movq(R9, FieldAddress(RBX, MegamorphicCache::dispatch_offset_offset()));
+  // R9: smi tagged offset of the row.
+  __ testq(R9, R9);
+  __ j(NEGATIVE, &probe_cache, Assembler::kNearJump);
+  __ LoadIsolate(RDI);
+  __ movq(RDI, Address(RDI, Isolate::object_store_offset()));
+  __ movq(RDI, Address(RDI, ObjectStore::dispatch_table_offset()));
+  // RDI: dispatch table.
+  ASSERT(DispatchTable::kEntryLength == 2);
+  // Smi tagged entry index.
+  __ leaq(RCX, Address(R9, RAX, TIMES_4, 0));
+  __ cmpq(RCX, FieldAddress(RDI, Array::length_offset()));
+  __ j(ABOVE_EQUAL, &probe_cache, Assembler::kNearJump);
+  // RCX is smi tagged, so TIMES_4 gives word offsets.
+  __ cmpq(R9, FieldAddress(RDI, RCX, TIMES_4, Array::data_offset()));
+  __ j(NOT_EQUAL, &probe_cache, Assembler::kNearJump);
+  __ movq(RAX,
+          FieldAddress(RDI, RCX, TIMES_4, Array::data_offset() + kWordSize));
+  __ movq(R10,
+          FieldAddress(RBX, MegamorphicCache::arguments_descriptor_offset()));
+  __ movq(RCX, FieldAddress(RAX, Function::entry_point_offset()));
+  __ movq(CODE_REG, FieldAddress(RAX, Function::code_offset()));
+  __ jmp(RCX);
+
+  __ Bind(&probe_cache);
   __ movq(R9, FieldAddress(RBX, MegamorphicCache::mask_offset()));
   __ movq(RDI, FieldAddress(RBX, MegamorphicCache::buckets_offset()));
   // R9: mask.
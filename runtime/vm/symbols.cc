@@ -4,6 +4,7 @@
 
 #include "vm/symbols.h"
 
+#include "vm/atomic.h"
 #include "vm/handles.h"
 #include "vm/handles_impl.h"
 #include "vm/hash_table.h"
@@ -191,18 +192,55 @@ class SymbolTraits {
   }
   template<typename CharType>
   static RawObject* NewKey(const CharArray<CharType>& array) {
-    return array.ToSymbol();
+    return Publish(array.ToSymbol());
   }
   static RawObject* NewKey(const StringSlice& slice) {
-    return slice.ToSymbol();
+    return Publish(slice.ToSymbol());
   }
   static RawObject* NewKey(const ConcatString& concat) {
-    return concat.ToSymbol();
+    return Publish(concat.ToSymbol());
+  }
+
+ private:
+  // Symbol tables are read without holding their mutex, so a new symbol
+  // must be fully initialized before it is stored into a table.
+  static RawObject* Publish(RawString* symbol) {
+    AtomicOperations::ThreadFence();
+    return symbol;
   }
 };
 typedef UnorderedHashSet<SymbolTraits> SymbolTable;
 
 
+// The symbol table of the vm isolate is a single SymbolTable, which is
+// read-only once the vm isolate is initialized. The symbol table of any other
+// isolate is an array of Isolate::kNumSymbolTableShards SymbolTables, each
+// guarded by its own mutex. A symbol lives in the shard selected by the top
+// bits of its hash, which are not used to pick an entry within the shard.
+//
+// Lookups do not take a mutex: a shard is only modified by filling an unused
+// entry with a fully initialized symbol, or by replacing it with a grown copy,
+// so a reader sees either a stale but consistent table or the new symbol. A
+// miss is therefore only conclusive once it is confirmed under the mutex.
+static intptr_t SymbolTableShardIndex(uword hash) {
+  return (hash >> (String::kHashBits - Isolate::kSymbolTableShardBits)) &
+      (Isolate::kNumSymbolTableShards - 1);
+}
+
+
+static RawArray* NewSymbolTableShards(intptr_t capacity) {
+  const intptr_t shard_capacity = capacity / Isolate::kNumSymbolTableShards;
+  const Array& shards = Array::Handle(
+      Array::New(Isolate::kNumSymbolTableShards, Heap::kOld));
+  Array& shard = Array::Handle();
+  for (intptr_t i = 0; i < Isolate::kNumSymbolTableShards; i++) {
+    shard = HashTables::New<SymbolTable>(shard_capacity, Heap::kOld);
+    shards.SetAt(i, shard);
+  }
+  return shards.raw();
+}
+
+
 const char* Symbols::Name(SymbolId symbol) {
   ASSERT((symbol > kIllegal) && (symbol < kNullCharId));
   return names[symbol];
@@ -311,10 +349,13 @@ void Symbols::SetupSymbolTable(Isolate* isolate) {
   ASSERT(isolate != NULL);
 
   // Setup the symbol table used within the String class.
-  const intptr_t initial_size = (isolate == Dart::vm_isolate()) ?
-      kInitialVMIsolateSymtabSize : kInitialSymtabSize;
-  Array& array =
-      Array::Handle(HashTables::New<SymbolTable>(initial_size, Heap::kOld));
+  Array& array = Array::Handle();
+  if (isolate == Dart::vm_isolate()) {
+    array = HashTables::New<SymbolTable>(kInitialVMIsolateSymtabSize,
+                                         Heap::kOld);
+  } else {
+    array = NewSymbolTableShards(kInitialSymtabSize);
+  }
   isolate->object_store()->set_symbol_table(array);
 }
 
@@ -329,8 +370,14 @@ RawArray* Symbols::UnifiedSymbolTable() {
 
   SymbolTable vm_table(zone,
                        Dart::vm_isolate()->object_store()->symbol_table());
-  SymbolTable table(zone, isolate->object_store()->symbol_table());
-  intptr_t unified_size = vm_table.NumOccupied() + table.NumOccupied();
+  const Array& shards =
+      Array::Handle(zone, isolate->object_store()->symbol_table());
+  intptr_t unified_size = vm_table.NumOccupied();
+  for (intptr_t i = 0; i < shards.Length(); i++) {
+    SymbolTable table(zone, Array::RawCast(shards.At(i)));
+    unified_size += table.NumOccupied();
+    table.Release();
+  }
   SymbolTable unified_table(zone, HashTables::New<SymbolTable>(unified_size,
                                                                Heap::kOld));
   String& symbol = String::Handle(zone);
@@ -344,14 +391,17 @@ RawArray* Symbols::UnifiedSymbolTable() {
   }
   vm_table.Release();
 
-  SymbolTable::Iterator iter(&table);
-  while (iter.MoveNext()) {
-    symbol ^= table.GetKey(iter.Current());
-    ASSERT(!symbol.IsNull());
-    bool present = unified_table.Insert(symbol);
-    ASSERT(!present);
+  for (intptr_t i = 0; i < shards.Length(); i++) {
+    SymbolTable table(zone, Array::RawCast(shards.At(i)));
+    SymbolTable::Iterator iter(&table);
+    while (iter.MoveNext()) {
+      symbol ^= table.GetKey(iter.Current());
+      ASSERT(!symbol.IsNull());
+      bool present = unified_table.Insert(symbol);
+      ASSERT(!present);
+    }
+    table.Release();
   }
-  table.Release();
 
   return unified_table.Release().raw();
 }
@@ -390,28 +440,42 @@ void Symbols::Compact(Isolate* isolate) {
   isolate->heap()->IterateObjects(&visitor);
 
   // 3. Build a new table from the surviving symbols.
-  Array& array =
-      Array::Handle(zone, HashTables::New<SymbolTable>(symbols.length() * 4 / 3,
-                                                       Heap::kOld));
-  SymbolTable table(zone, array.raw());
+  const Array& shards =
+      Array::Handle(zone, NewSymbolTableShards(symbols.length() * 4 / 3));
   for (intptr_t i = 0; i < symbols.length(); i++) {
     String& symbol = *symbols[i];
     ASSERT(symbol.IsString());
     ASSERT(symbol.IsCanonical());
+    const intptr_t shard = SymbolTableShardIndex(symbol.Hash());
+    SymbolTable table(zone, Array::RawCast(shards.At(shard)));
     bool present = table.Insert(symbol);
     ASSERT(!present);
+    shards.SetAt(shard, table.Release());
   }
-  isolate->object_store()->set_symbol_table(table.Release());
+  isolate->object_store()->set_symbol_table(shards);
 }
 #endif   // DART_PRECOMPILER
 
 
 void Symbols::GetStats(Isolate* isolate, intptr_t* size, intptr_t* capacity) {
   ASSERT(isolate != NULL);
-  SymbolTable table(isolate->object_store()->symbol_table());
-  *size = table.NumOccupied();
-  *capacity = table.NumEntries();
-  table.Release();
+  if (isolate == Dart::vm_isolate()) {
+    SymbolTable table(isolate->object_store()->symbol_table());
+    *size = table.NumOccupied();
+    *capacity = table.NumEntries();
+    table.Release();
+    return;
+  }
+  const Array& shards =
+      Array::Handle(isolate->object_store()->symbol_table());
+  *size = 0;
+  *capacity = 0;
+  for (intptr_t i = 0; i < shards.Length(); i++) {
+    SymbolTable table(Array::RawCast(shards.At(i)));
+    *size += table.NumOccupied();
+    *capacity += table.NumEntries();
+    table.Release();
+  }
 }
 
 
@@ -587,11 +651,28 @@ RawString* Symbols::NewSymbol(Thread* thread, const StringType& str) {
   }
   if (symbol.IsNull()) {
     Isolate* isolate = thread->isolate();
-    SafepointMutexLocker ml(isolate->symbols_mutex());
-    data ^= isolate->object_store()->symbol_table();
-    SymbolTable table(&key, &value, &data);
-    symbol ^= table.InsertNewOrGet(str);
-    isolate->object_store()->set_symbol_table(table.Release());
+    const Array& shards =
+        Array::Handle(thread->zone(), isolate->object_store()->symbol_table());
+    const intptr_t shard = SymbolTableShardIndex(SymbolTraits::Hash(str));
+    {
+      data ^= shards.At(shard);
+      SymbolTable table(&key, &value, &data);
+      symbol ^= table.GetOrNullReadOnly(str);
+      table.Release();
+    }
+    if (symbol.IsNull()) {
+      SafepointMutexLocker ml(isolate->symbols_mutex(shard));
+      data ^= shards.At(shard);
+      SymbolTable table(&key, &value, &data);
+      symbol ^= table.InsertNewOrGet(str);
+      const Array& result = table.Release();
+      if (result.raw() != shards.At(shard)) {
+        // The shard grew: make the copied entries visible before the new
+        // table is published to lock-free readers.
+        AtomicOperations::ThreadFence();
+        shards.SetAt(shard, result);
+      }
+    }
   }
   ASSERT(symbol.IsSymbol());
   ASSERT(symbol.HasHash());
@@ -617,11 +698,22 @@ RawString* Symbols::Lookup(Thread* thread, const StringType& str) {
   }
   if (symbol.IsNull()) {
     Isolate* isolate = thread->isolate();
-    SafepointMutexLocker ml(isolate->symbols_mutex());
-    data ^= isolate->object_store()->symbol_table();
-    SymbolTable table(&key, &value, &data);
-    symbol ^= table.GetOrNull(str);
-    table.Release();
+    const Array& shards =
+        Array::Handle(thread->zone(), isolate->object_store()->symbol_table());
+    const intptr_t shard = SymbolTableShardIndex(SymbolTraits::Hash(str));
+    {
+      data ^= shards.At(shard);
+      SymbolTable table(&key, &value, &data);
+      symbol ^= table.GetOrNullReadOnly(str);
+      table.Release();
+    }
+    if (symbol.IsNull()) {
+      SafepointMutexLocker ml(isolate->symbols_mutex(shard));
+      data ^= shards.At(shard);
+      SymbolTable table(&key, &value, &data);
+      symbol ^= table.GetOrNull(str);
+      table.Release();
+    }
   }
   ASSERT(symbol.IsNull() || symbol.IsSymbol());
   ASSERT(symbol.IsNull() || symbol.HasHash());
@@ -629,6 +721,13 @@ RawString* Symbols::Lookup(Thread* thread, const StringType& str) {
 }
 
 
+RawString* Symbols::LookupFromUTF16(Thread* thread,
+                                    const uint16_t* utf16_array,
+                                    intptr_t len) {
+  return Lookup(thread, UTF16Array(utf16_array, len));
+}
+
+
 RawString* Symbols::LookupFromConcat(
     Thread* thread, const String& str1, const String& str2) {
   if (str1.Length() == 0) {
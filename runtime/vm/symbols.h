@@ -203,6 +203,7 @@ class ObjectPointerVisitor;
   V(_CapabilityImpl, "_CapabilityImpl")                                        \
   V(_RawReceivePortImpl, "_RawReceivePortImpl")                                \
   V(_SendPortImpl, "_SendPortImpl")                                            \
+  V(_TransferableTypedDataImpl, "_TransferableTypedDataImpl")                  \
   V(_StackTrace, "_StackTrace")                                                \
   V(_RegExp, "_RegExp")                                                        \
   V(RegExp, "RegExp")                                                          \
@@ -640,6 +641,11 @@ class Symbols : public AllStatic {
   template<typename StringType>
   static RawString* Lookup(Thread* thread, const StringType& str);
 
+  // Returns Symbol::Null if no symbol is found.
+  static RawString* LookupFromUTF16(Thread* thread,
+                                    const uint16_t* utf16_array,
+                                    intptr_t len);
+
   // Returns Symbol::Null if no symbol is found.
   static RawString* LookupFromConcat(Thread* thread,
                                      const String& str1,
@@ -67,6 +67,7 @@ Thread::Thread(Isolate* isolate)
       heap_(NULL),
       top_exit_frame_info_(0),
       store_buffer_block_(NULL),
+      marking_stack_block_(NULL),
       vm_tag_(0),
       task_kind_(kUnknownTask),
       dart_stream_(NULL),
@@ -89,6 +90,8 @@ Thread::Thread(Isolate* isolate)
       deferred_interrupts_mask_(0),
       deferred_interrupts_(0),
       stack_overflow_count_(0),
+      old_space_top_(0),
+      old_space_end_(0),
       cha_(NULL),
       deopt_id_(0),
       pending_functions_(GrowableObjectArray::null()),
@@ -246,6 +249,7 @@ bool Thread::EnterIsolate(Isolate* isolate) {
     ASSERT(thread->store_buffer_block_ == NULL);
     thread->task_kind_ = kMutatorTask;
     thread->StoreBufferAcquire();
+    thread->MarkingStackAcquire();
     return true;
   }
   return false;
@@ -263,6 +267,8 @@ void Thread::ExitIsolate() {
   // Clear since GC will not visit the thread once it is unscheduled.
   thread->ClearReusableHandles();
   thread->StoreBufferRelease();
+  thread->MarkingStackRelease();
+  thread->OldSpaceBufferRelease();
   if (isolate->is_runnable()) {
     thread->set_vm_tag(VMTag::kIdleTagId);
   } else {
@@ -286,6 +292,7 @@ bool Thread::EnterIsolateAsHelper(Isolate* isolate,
     // before Scavenge.
     thread->store_buffer_block_ =
         thread->isolate()->store_buffer()->PopEmptyBlock();
+    thread->MarkingStackAcquire();
     // This thread should not be the main mutator.
     thread->task_kind_ = kind;
     ASSERT(!thread->IsMutatorThread());
@@ -304,6 +311,8 @@ void Thread::ExitIsolateAsHelper(bool bypass_safepoint) {
   // Clear since GC will not visit the thread once it is unscheduled.
   thread->ClearReusableHandles();
   thread->StoreBufferRelease();
+  thread->MarkingStackRelease();
+  thread->OldSpaceBufferRelease();
   Isolate* isolate = thread->isolate();
   ASSERT(isolate != NULL);
   const bool kIsNotMutatorThread = false;
@@ -483,6 +492,12 @@ RawError* Thread::HandleInterrupts() {
       }
       heap()->CollectGarbage(Heap::kNew);
     }
+    if (heap()->old_space()->IsConcurrentMarkDone()) {
+      if (FLAG_verbose_gc) {
+        OS::PrintErr("Old space collection completes concurrent marking.\n");
+      }
+      heap()->CollectGarbage(Heap::kOld);
+    }
   }
   if ((interrupt_bits & kMessageInterrupt) != 0) {
     MessageHandler::MessageStatus status =
@@ -546,6 +561,44 @@ void Thread::StoreBufferAcquire() {
 }
 
 
+void Thread::MarkingStackBlockProcess() {
+  MarkingStackRelease();
+  MarkingStackAcquire();
+}
+
+
+void Thread::MarkingStackAddObject(RawObject* obj) {
+  ASSERT(obj->IsOldObject());
+  marking_stack_block_->Push(obj);
+  if (marking_stack_block_->IsFull()) {
+    MarkingStackBlockProcess();
+  }
+}
+
+
+void Thread::MarkingStackRelease() {
+  MarkingStackBlock* block = marking_stack_block_;
+  if (block != NULL) {
+    marking_stack_block_ = NULL;
+    isolate()->marking_stack()->PushBlock(block);
+  }
+}
+
+
+void Thread::OldSpaceBufferRelease() {
+  heap()->old_space()->AbandonThreadLocalBuffer(this);
+}
+
+
+void Thread::MarkingStackAcquire() {
+  ASSERT(marking_stack_block_ == NULL);
+  MarkingStack* marking_stack = isolate()->marking_stack();
+  if (marking_stack != NULL) {
+    marking_stack_block_ = marking_stack->PopEmptyBlock();
+  }
+}
+
+
 bool Thread::IsMutatorThread() const {
   return ((isolate_ != NULL) && (isolate_->mutator_thread() == this));
 }
@@ -73,12 +73,27 @@ class Zone;
   V(TypeParameter)                                                             \
 
 
+#if defined(TARGET_ARCH_X64)
+#define CACHED_MARKING_STUBS_LIST(V)                                           \
+  V(RawCode*, marking_barrier_code_,                                           \
+    StubCode::MarkingBarrier_entry()->code(), NULL)                            \
+
+#define CACHED_MARKING_STUBS_ADDRESSES_LIST(V)                                 \
+  V(uword, marking_barrier_entry_point_,                                       \
+    StubCode::MarkingBarrier_entry()->EntryPoint(), 0)                         \
+
+#else
+#define CACHED_MARKING_STUBS_LIST(V)
+#define CACHED_MARKING_STUBS_ADDRESSES_LIST(V)
+#endif
+
 #if defined(TARGET_ARCH_DBC)
 #define CACHED_VM_STUBS_LIST(V)
 #else
 #define CACHED_VM_STUBS_LIST(V)                                                \
   V(RawCode*, update_store_buffer_code_,                                       \
     StubCode::UpdateStoreBuffer_entry()->code(), NULL)                         \
+  CACHED_MARKING_STUBS_LIST(V)                                                 \
   V(RawCode*, fix_callers_target_code_,                                        \
     StubCode::FixCallersTarget_entry()->code(), NULL)                          \
   V(RawCode*, fix_allocation_stub_code_,                                       \
@@ -107,6 +122,7 @@ class Zone;
 #define CACHED_VM_STUBS_ADDRESSES_LIST(V)                                      \
   V(uword, update_store_buffer_entry_point_,                                   \
     StubCode::UpdateStoreBuffer_entry()->EntryPoint(), 0)                      \
+  CACHED_MARKING_STUBS_ADDRESSES_LIST(V)                                       \
   V(uword, call_to_runtime_entry_point_,                                       \
     StubCode::CallToRuntime_entry()->EntryPoint(), 0)                          \
   V(uword, megamorphic_call_checked_entry_,                                    \
@@ -152,6 +168,7 @@ class Thread : public BaseThread {
     kSweeperTask = 0x4,
     kMarkerTask = 0x8,
     kFinalizerTask = 0x10,
+    kScavengerTask = 0x20,
   };
   ~Thread();
 
@@ -326,6 +343,25 @@ class Thread : public BaseThread {
     return OFFSET_OF(Thread, store_buffer_block_);
   }
 
+  // While the old generation is marked concurrently, every thread owns a
+  // marking stack block that the write barrier fills with stored values
+  // which are not yet marked. NULL when no concurrent marking is in progress.
+  bool is_marking() const { return marking_stack_block_ != NULL; }
+  void MarkingStackAddObject(RawObject* obj);
+  void MarkingStackBlockProcess();
+  static intptr_t marking_stack_block_offset() {
+    return OFFSET_OF(Thread, marking_stack_block_);
+  }
+
+  // The old-space allocation buffer of this thread, see
+  // PageSpace::TryAllocateDataThreadLocal.
+  uword old_space_top() const { return old_space_top_; }
+  uword old_space_end() const { return old_space_end_; }
+  void set_old_space_buffer(uword top, uword end) {
+    old_space_top_ = top;
+    old_space_end_ = end;
+  }
+
   uword top_exit_frame_info() const {
     return top_exit_frame_info_;
   }
@@ -651,6 +687,7 @@ LEAF_RUNTIME_ENTRY_LIST(DEFINE_OFFSET_METHOD)
   Heap* heap_;
   uword top_exit_frame_info_;
   StoreBufferBlock* store_buffer_block_;
+  MarkingStackBlock* marking_stack_block_;
   uword vm_tag_;
   TaskKind task_kind_;
   // State that is cached in the TLS for fast access in generated code.
@@ -689,6 +726,8 @@ LEAF_RUNTIME_ENTRY_LIST(DECLARE_MEMBERS)
   uint16_t deferred_interrupts_mask_;
   uint16_t deferred_interrupts_;
   int32_t stack_overflow_count_;
+  uword old_space_top_;
+  uword old_space_end_;
 
   // Compiler state:
   CHA* cha_;
@@ -726,6 +765,11 @@ LEAF_RUNTIME_ENTRY_LIST(DECLARE_MEMBERS)
       StoreBuffer::ThresholdPolicy policy = StoreBuffer::kCheckThreshold);
   void StoreBufferAcquire();
 
+  void MarkingStackRelease();
+  void MarkingStackAcquire();
+
+  void OldSpaceBufferRelease();
+
   void set_zone(Zone* zone) {
     zone_ = zone;
   }
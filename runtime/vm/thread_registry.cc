@@ -91,6 +91,36 @@ void ThreadRegistry::PrepareForGC() {
 }
 
 
+void ThreadRegistry::AcquireMarkingStackBlocks() {
+  MonitorLocker ml(threads_lock());
+  Thread* thread = active_list_;
+  while (thread != NULL) {
+    thread->MarkingStackAcquire();
+    thread = thread->next_;
+  }
+}
+
+
+void ThreadRegistry::ReleaseMarkingStackBlocks() {
+  MonitorLocker ml(threads_lock());
+  Thread* thread = active_list_;
+  while (thread != NULL) {
+    thread->MarkingStackRelease();
+    thread = thread->next_;
+  }
+}
+
+
+void ThreadRegistry::AbandonOldSpaceBuffers() {
+  MonitorLocker ml(threads_lock());
+  Thread* thread = active_list_;
+  while (thread != NULL) {
+    thread->set_old_space_buffer(0, 0);
+    thread = thread->next_;
+  }
+}
+
+
 void ThreadRegistry::AddToActiveListLocked(Thread* thread) {
   ASSERT(thread != NULL);
   ASSERT(threads_lock()->IsOwnedByCurrentThread());
@@ -26,6 +26,9 @@ class ThreadRegistry {
 
   void VisitObjectPointers(ObjectPointerVisitor* visitor, bool validate_frames);
   void PrepareForGC();
+  void AcquireMarkingStackBlocks();
+  void ReleaseMarkingStackBlocks();
+  void AbandonOldSpaceBuffers();
   Thread* mutator_thread() const { return mutator_thread_; }
 
  private:
@@ -9,6 +9,7 @@
 #include "vm/profiler.h"
 #include "vm/safepoint.h"
 #include "vm/stack_frame.h"
+#include "vm/symbols.h"
 #include "vm/thread_pool.h"
 
 namespace dart {
@@ -638,4 +639,78 @@ VM_TEST_CASE(HelperAllocAndGC) {
   }
 }
 
+
+class InternSymbolsTask : public ThreadPool::Task {
+ public:
+  static const intptr_t kNumSymbols = 2000;
+
+  InternSymbolsTask(Isolate* isolate,
+                    Monitor* done_monitor,
+                    intptr_t* done)
+    : isolate_(isolate),
+      done_monitor_(done_monitor),
+      done_(done) {
+  }
+
+  virtual void Run() {
+    Thread::EnterIsolateAsHelper(isolate_, Thread::kUnknownTask);
+    {
+      Thread* thread = Thread::Current();
+      StackZone stack_zone(thread);
+      Zone* zone = stack_zone.GetZone();
+      HANDLESCOPE(thread);
+      String& symbol = String::Handle(zone);
+      char buffer[64];
+      for (intptr_t i = 0; i < kNumSymbols; i++) {
+        OS::SNPrint(buffer, sizeof(buffer), "concurrent_symbol_%" Pd, i);
+        symbol = Symbols::New(thread, buffer);
+        EXPECT(symbol.IsSymbol());
+        EXPECT_EQ(symbol.raw(), Symbols::New(thread, buffer));
+      }
+    }
+    Thread::ExitIsolateAsHelper();
+    // Tell main thread that we are done.
+    {
+      MonitorLocker ml(done_monitor_);
+      (*done_)++;
+      ml.Notify();
+    }
+  }
+
+ private:
+  Isolate* isolate_;
+  Monitor* done_monitor_;
+  intptr_t* done_;
+};
+
+
+VM_TEST_CASE(HelperInternSymbols) {
+  const intptr_t kTaskCount = 4;
+  Monitor done_monitor;
+  intptr_t done = 0;
+  Isolate* isolate = thread->isolate();
+  intptr_t size_before = 0;
+  intptr_t capacity = 0;
+  Symbols::GetStats(isolate, &size_before, &capacity);
+  for (intptr_t i = 0; i < kTaskCount; i++) {
+    Dart::thread_pool()->Run(
+        new InternSymbolsTask(isolate, &done_monitor, &done));
+  }
+  {
+    while (true) {
+      TransitionVMToBlocked transition(thread);
+      MonitorLocker ml(&done_monitor);
+      if (done == kTaskCount) {
+        break;
+      }
+    }
+  }
+  // Every name was interned exactly once, even though all tasks raced to
+  // intern the same names.
+  intptr_t size_after = 0;
+  Symbols::GetStats(isolate, &size_after, &capacity);
+  EXPECT_EQ(InternSymbolsTask::kNumSymbols, size_after - size_before);
+  EXPECT_LE(size_after, capacity);
+}
+
 }  // namespace dart
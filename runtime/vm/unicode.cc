@@ -4,6 +4,13 @@
 
 #include "vm/unicode.h"
 
+#if defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32)
+#include <emmintrin.h>  // NOLINT
+#elif defined(HOST_ARCH_ARM64)
+#include <arm_neon.h>  // NOLINT
+#endif
+
+#include "platform/utils.h"
 #include "vm/allocation.h"
 #include "vm/globals.h"
 #include "vm/object.h"
@@ -53,6 +60,47 @@ const uint32_t Utf8::kOverlongMinimum[7] = {
 };
 
 
+intptr_t Utf8::AsciiPrefixLength(const uint8_t* utf8_array,
+                                 intptr_t array_len) {
+  static const intptr_t kBlockSize = 16;
+  intptr_t i = 0;
+#if defined(HOST_ARCH_X64) || defined(HOST_ARCH_IA32)
+  for (; (i + kBlockSize) <= array_len; i += kBlockSize) {
+    const __m128i block = _mm_loadu_si128(
+        reinterpret_cast<const __m128i*>(&utf8_array[i]));
+    // Gathers the top bit of each byte, which is only set for non-ASCII.
+    const int non_ascii = _mm_movemask_epi8(block);
+    if (non_ascii != 0) {
+      return i + Utils::CountTrailingZeros(non_ascii);
+    }
+  }
+#elif defined(HOST_ARCH_ARM64)
+  for (; (i + kBlockSize) <= array_len; i += kBlockSize) {
+    const uint8x16_t block = vld1q_u8(&utf8_array[i]);
+    if (vmaxvq_u8(block) > kMaxOneByteChar) {
+      break;  // The scalar loop below finds the exact position.
+    }
+  }
+#else
+  // Check a word at a time.
+  const uword kTopBitOfEachByte = (~static_cast<uword>(0) / 0xFF) * 0x80;
+  for (; (i + kWordSize) <= array_len; i += kWordSize) {
+    uword word;
+    memmove(&word, &utf8_array[i], kWordSize);
+    if ((word & kTopBitOfEachByte) != 0) {
+      break;  // The scalar loop below finds the exact position.
+    }
+  }
+#endif
+  for (; i < array_len; i++) {
+    if (utf8_array[i] > kMaxOneByteChar) {
+      break;
+    }
+  }
+  return i;
+}
+
+
 // Returns the most restricted coding form in which the sequence of utf8
 // characters in 'utf8_array' can be represented in, and the number of
 // code units needed in that form.
@@ -63,6 +111,14 @@ intptr_t Utf8::CodeUnitCount(const uint8_t* utf8_array,
   Type char_type = kLatin1;
   for (intptr_t i = 0; i < array_len; i++) {
     uint8_t code_unit = utf8_array[i];
+    if (code_unit <= kMaxOneByteChar) {
+      // Skip the whole run of ASCII characters.
+      const intptr_t ascii_len =
+          AsciiPrefixLength(&utf8_array[i], array_len - i);
+      len += ascii_len;
+      i += ascii_len - 1;
+      continue;
+    }
     if (!IsTrailByte(code_unit)) {
       ++len;
       if (!IsLatin1SequenceStart(code_unit)) {  // > U+00FF
@@ -85,6 +141,10 @@ bool Utf8::IsValid(const uint8_t* utf8_array, intptr_t array_len) {
   intptr_t i = 0;
   while (i < array_len) {
     uint32_t ch = utf8_array[i] & 0xFF;
+    if (ch <= static_cast<uint32_t>(kMaxOneByteChar)) {
+      i += AsciiPrefixLength(&utf8_array[i], array_len - i);
+      continue;
+    }
     intptr_t j = 1;
     if (ch >= 0x80) {
       int8_t num_trail_bytes = kTrailBytes[ch];
@@ -218,6 +278,14 @@ bool Utf8::DecodeToLatin1(const uint8_t* utf8_array,
   intptr_t j = 0;
   intptr_t num_bytes;
   for (; (i < array_len) && (j < len); i += num_bytes, ++j) {
+    if (utf8_array[i] <= kMaxOneByteChar) {
+      // Copy the whole run of ASCII characters.
+      num_bytes = AsciiPrefixLength(&utf8_array[i],
+                                    Utils::Minimum(array_len - i, len - j));
+      memmove(&dst[j], &utf8_array[i], num_bytes);
+      j += num_bytes - 1;
+      continue;
+    }
     int32_t ch;
     ASSERT(IsLatin1SequenceStart(utf8_array[i]));
     num_bytes = Utf8::Decode(&utf8_array[i], (array_len - i), &ch);
@@ -242,6 +310,16 @@ bool Utf8::DecodeToUTF16(const uint8_t* utf8_array,
   intptr_t j = 0;
   intptr_t num_bytes;
   for (; (i < array_len) && (j < len); i += num_bytes, ++j) {
+    if (utf8_array[i] <= kMaxOneByteChar) {
+      // Widen the whole run of ASCII characters.
+      num_bytes = AsciiPrefixLength(&utf8_array[i],
+                                    Utils::Minimum(array_len - i, len - j));
+      for (intptr_t k = 0; k < num_bytes; k++) {
+        dst[j + k] = utf8_array[i + k];
+      }
+      j += num_bytes - 1;
+      continue;
+    }
     int32_t ch;
     bool is_supplementary = IsSupplementarySequenceStart(utf8_array[i]);
     num_bytes = Utf8::Decode(&utf8_array[i], (array_len - i), &ch);
@@ -270,6 +348,16 @@ bool Utf8::DecodeToUTF32(const uint8_t* utf8_array,
   intptr_t j = 0;
   intptr_t num_bytes;
   for (; (i < array_len) && (j < len); i += num_bytes, ++j) {
+    if (utf8_array[i] <= kMaxOneByteChar) {
+      // Widen the whole run of ASCII characters.
+      num_bytes = AsciiPrefixLength(&utf8_array[i],
+                                    Utils::Minimum(array_len - i, len - j));
+      for (intptr_t k = 0; k < num_bytes; k++) {
+        dst[j + k] = utf8_array[i + k];
+      }
+      j += num_bytes - 1;
+      continue;
+    }
     int32_t ch;
     num_bytes = Utf8::Decode(&utf8_array[i], (array_len - i), &ch);
     if (ch == -1) {
@@ -1032,4 +1032,54 @@ TEST_CASE(Utf8Decode) {
   }
 }
 
+
+TEST_CASE(Utf8AsciiPrefixLength) {
+  uint8_t buffer[100];
+  memset(buffer, 'a', sizeof(buffer));
+  EXPECT_EQ(100, Utf8::AsciiPrefixLength(buffer, 100));
+  EXPECT_EQ(0, Utf8::AsciiPrefixLength(buffer, 0));
+  // Place a non-ASCII byte at every position, both inside and after the
+  // blocks that are checked at once.
+  for (intptr_t i = 0; i < 100; i++) {
+    buffer[i] = 0xC3;
+    EXPECT_EQ(i, Utf8::AsciiPrefixLength(buffer, 100));
+    EXPECT_EQ(i, Utf8::AsciiPrefixLength(buffer, i + 1));
+    buffer[i] = 'a';
+  }
+}
+
+
+TEST_CASE(Utf8DecodeAsciiRuns) {
+  // Long ASCII runs around multi-byte sequences are decoded in bulk.
+  const char* src =
+      "0123456789abcdefghijklmnopqrstuvwxyz\xC3\xB1"
+      "0123456789abcdefghijklmnopqrstuvwxyz\xE2\x82\xAC"
+      "0123456789abcdefghijklmnopqrstuvwxyz\xF0\x9D\x84\x9E"
+      "0123456789";
+  const uint8_t* utf8 = reinterpret_cast<const uint8_t*>(src);
+  const intptr_t utf8_len = strlen(src);
+  EXPECT(Utf8::IsValid(utf8, utf8_len));
+  Utf8::Type type;
+  const intptr_t len = Utf8::CodeUnitCount(utf8, utf8_len, &type);
+  EXPECT_EQ(Utf8::kSupplementary, type);
+  EXPECT_EQ(36 + 1 + 36 + 1 + 36 + 2 + 10, len);
+  uint16_t dst[36 + 1 + 36 + 1 + 36 + 2 + 10];
+  EXPECT(Utf8::DecodeToUTF16(utf8, utf8_len, dst, len));
+  EXPECT_EQ('0', dst[0]);
+  EXPECT_EQ('z', dst[35]);
+  EXPECT_EQ(0xF1, dst[36]);
+  EXPECT_EQ('0', dst[37]);
+  EXPECT_EQ(0x20AC, dst[73]);
+  EXPECT_EQ(0xD834, dst[110]);
+  EXPECT_EQ(0xDD1E, dst[111]);
+  EXPECT_EQ('9', dst[121]);
+  // Output overflow in the middle of an ASCII run is detected.
+  EXPECT(!Utf8::DecodeToUTF16(utf8, utf8_len, dst, 20));
+
+  // Invalid input after a long ASCII prefix.
+  const char* invalid = "0123456789abcdefghijklmnopqrstuvwxyz\xC3";
+  EXPECT(!Utf8::IsValid(reinterpret_cast<const uint8_t*>(invalid),
+                        strlen(invalid)));
+}
+
 }  // namespace dart
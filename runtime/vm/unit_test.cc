@@ -501,4 +501,66 @@ void ElideJSONSubstring(const char* prefix, const char* in, char* out) {
 }
 
 
+void WriteDilProgram(DilBufferWriter* writer, intptr_t count) {
+  const uint32_t kMagicProgramFile = 0x90ABCDEFu;
+  const uint8_t kNothing = 0;
+  const uint8_t kSomething = 1;
+  const uint8_t kProcedure = 6;
+  const uint8_t kReturnStatement = 74;
+  const uint8_t kDynamicType = 91;
+  const uint8_t kLibraryProcedureReference = 105;
+  const uint8_t kSpecialIntLiteral = 144;
+
+  writer->WriteUInt32(kMagicProgramFile);
+
+  // String table: library name, library uri and the procedure names.
+  char name[32];
+  writer->WriteUInt(count + 2);
+  writer->WriteString("bench");
+  writer->WriteString("file:///bench.dart");
+  for (intptr_t i = 0; i < count; i++) {
+    OS::SNPrint(name, sizeof(name), "f%" Pd "", i);
+    writer->WriteString(name);
+  }
+
+  // Source uri table and the (empty) line starts of its single entry.
+  writer->WriteUInt(1);
+  writer->WriteString("file:///bench.dart");
+  writer->WriteUInt(0);
+
+  writer->WriteUInt(1);  // Library count.
+  writer->WriteByte(0);  // Flags.
+  writer->WriteUInt(0);  // Name.
+  writer->WriteUInt(1);  // Import uri.
+  writer->WriteUInt(0);  // Source uri index.
+  writer->WriteUInt(0);  // Classes.
+  writer->WriteUInt(0);  // Fields.
+  writer->WriteUInt(count);
+  for (intptr_t i = 0; i < count; i++) {
+    writer->WriteByte(kProcedure);
+    writer->WriteByte(0);  // Kind.
+    writer->WriteByte(0);  // Flags.
+    writer->WriteUInt(i + 2);  // Name.
+    writer->WriteUInt(0);  // Source uri index.
+    writer->WriteUInt(0);  // Annotations.
+    writer->WriteByte(kSomething);
+    writer->WriteByte(0);  // Async marker.
+    writer->WriteUInt(0);  // Type parameters.
+    writer->WriteUInt(0);  // Required parameter count.
+    writer->WriteUInt(0);  // Positional parameters.
+    writer->WriteUInt(0);  // Named parameters.
+    writer->WriteByte(kDynamicType);
+    writer->WriteByte(kNothing);  // Inferred return value.
+    writer->WriteByte(kSomething);
+    writer->WriteByte(kReturnStatement);
+    writer->WriteByte(kSomething);
+    writer->WriteByte(kSpecialIntLiteral | (i & 7));
+  }
+
+  // Main method.
+  writer->WriteByte(kLibraryProcedureReference);
+  writer->WriteUInt(0);
+  writer->WriteUInt(0);
+}
+
 }  // namespace dart
@@ -617,6 +617,50 @@ class SetFlagScope : public ValueObject {
   T original_value_;
 };
 
+
+// Writes kernel (.dil) binaries for tests and benchmarks.
+class DilBufferWriter {
+ public:
+  void WriteByte(uint8_t byte) { buffer_.Add(byte); }
+
+  void WriteUInt32(uint32_t value) {
+    WriteByte(value >> 24);
+    WriteByte(value >> 16);
+    WriteByte(value >> 8);
+    WriteByte(value);
+  }
+
+  void WriteUInt(uint32_t value) {
+    if (value < 0x80) {
+      WriteByte(value);
+    } else if (value < 0x4000) {
+      WriteByte((value >> 8) | 0x80);
+      WriteByte(value);
+    } else {
+      WriteUInt32(value | 0xc0000000);
+    }
+  }
+
+  void WriteString(const char* string) {
+    intptr_t length = strlen(string);
+    WriteUInt(length);
+    for (intptr_t i = 0; i < length; i++) {
+      WriteByte(string[i]);
+    }
+  }
+
+  const uint8_t* buffer() { return buffer_.data(); }
+  intptr_t length() { return buffer_.length(); }
+
+ private:
+  MallocGrowableArray<uint8_t> buffer_;
+};
+
+
+// Writes a program with a single library of [count] static procedures, each
+// of the form `f<i>() { return <small int>; }`.
+void WriteDilProgram(DilBufferWriter* writer, intptr_t count);
+
 }  // namespace dart
 
 #endif  // VM_UNIT_TEST_H_
@@ -9,6 +9,7 @@ import 'dart:_isolate_helper' show CapabilityImpl,
                                    IsolateNatives,
                                    ReceivePortImpl,
                                    RawReceivePortImpl;
+import 'dart:typed_data' show TypedData;
 
 @patch
 class Isolate {
@@ -235,3 +236,11 @@ class Capability {
   @patch
   factory Capability() = CapabilityImpl;
 }
+
+@patch
+class TransferableTypedData {
+  @patch
+  factory TransferableTypedData.fromList(List<TypedData> list) {
+    throw new UnsupportedError('TransferableTypedData.fromList');
+  }
+}
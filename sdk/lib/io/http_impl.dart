@@ -1007,6 +1007,60 @@ class _HttpOutgoing implements StreamConsumer<List<int>> {
       }
       return close();
     }
+    if (_canSendFile(stream)) {
+      return _addFileStream(stream);
+    }
+    return _addStream(stream);
+  }
+
+  // Whether [stream] reads a file which can be sent to the socket as is, so
+  // the socket can send it straight from the file.
+  bool _canSendFile(Stream<List<int>> stream) {
+    if (stream is! _FileStream) return false;
+    _FileStream fileStream = stream;
+    if (fileStream._path == null) return false;
+    if (headersWritten) return !chunked && contentLength != null;
+    return !outbound.headers.chunkedTransferEncoding &&
+        outbound.headers.contentLength >= 0;
+  }
+
+  // Adds a file stream without reading it. As the data is not seen here, the
+  // content length is checked against the size of the file range up front.
+  Future _addFileStream(_FileStream stream) {
+    return new File(stream._path).length().then((int length) {
+      int end = (stream._end == null) ? length : min(stream._end, length);
+      int bytes = end - stream._position;
+      if (stream._position < 0 ||
+          bytes < 0 ||
+          _socketError ||
+          (headersWritten && _bytesWritten + bytes > contentLength) ||
+          (!headersWritten && bytes > outbound.headers.contentLength)) {
+        // Let the stream report the error.
+        return _addStream(stream);
+      }
+      Future send() {
+        if (_socketError) {
+          return new Future.value(outbound);
+        }
+        _bytesWritten += bytes;
+        // Write the headers and any buffered data ahead of the file.
+        if (_length > 0) {
+          socket.add(new Uint8List.view(_buffer.buffer, 0, _length));
+        }
+        _buffer =
+            outbound.bufferOutput ? new Uint8List(_OUTGOING_BUFFER_SIZE) : null;
+        _length = 0;
+        return _socketAddStream(stream);
+      }
+      if (!headersWritten) {
+        var future = writeHeaders();
+        if (future != null) return future.then((_) => send());
+      }
+      return send();
+    }, onError: (_) => _addStream(stream));
+  }
+
+  Future _addStream(Stream<List<int>> stream) {
     StreamSubscription<List<int>> sub;
     // Use new stream so we are able to pause (see below listen). The
     // alternative is to use stream.extand, but that won't give us a way of
@@ -1058,7 +1112,11 @@ class _HttpOutgoing implements StreamConsumer<List<int>> {
         sub.pause(future);
       }
     }
-    return socket.addStream(controller.stream)
+    return _socketAddStream(controller.stream);
+  }
+
+  Future _socketAddStream(Stream<List<int>> stream) {
+    return socket.addStream(stream)
         .then((_) {
           return outbound;
         }, onError: (error, stackTrace) {
@@ -0,0 +1,76 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+import "dart:isolate";
+import "dart:typed_data";
+import "package:expect/expect.dart";
+import "package:async_helper/async_helper.dart";
+
+const int kLength = 1024 * 1024;
+
+void sumBytes(List args) {
+  SendPort replyPort = args[0];
+  TransferableTypedData transferable = args[1];
+  Uint8List bytes = transferable.materialize().asUint8List();
+  int sum = 0;
+  for (int i = 0; i < bytes.length; i++) {
+    sum += bytes[i];
+  }
+  // Hand the same bytes back without copying them again.
+  replyPort.send(
+      [bytes.length, sum, new TransferableTypedData.fromList([bytes])]);
+}
+
+void testCreation() {
+  var bytes = new Uint8List.fromList([1, 2, 3]);
+  var words = new Uint16List.fromList([0x0504]);
+  var view = new Uint8List.view(new Uint8List.fromList([0, 6, 7, 8]).buffer, 1);
+  var transferable = new TransferableTypedData.fromList([bytes, words, view]);
+  Expect.listEquals([1, 2, 3, 4, 5, 6, 7, 8],
+                    transferable.materialize().asUint8List());
+  // A transferable is single-use.
+  Expect.throws(() => transferable.materialize(), (e) => e is ArgumentError);
+  Expect.throws(() => new TransferableTypedData.fromList([bytes, 42]));
+}
+
+void testSendToSelf() {
+  asyncStart();
+  var transferable = new TransferableTypedData.fromList(
+      [new Uint8List.fromList([9, 8, 7])]);
+  var port = new RawReceivePort();
+  port.handler = (TransferableTypedData received) {
+    Expect.listEquals([9, 8, 7], received.materialize().asUint8List());
+    port.close();
+    asyncEnd();
+  };
+  port.sendPort.send(transferable);
+  // The sender gave up the bytes.
+  Expect.throws(() => transferable.materialize(), (e) => e is ArgumentError);
+  Expect.throws(() => port.sendPort.send(transferable),
+                (e) => e is ArgumentError);
+}
+
+void testSendToIsolate() {
+  asyncStart();
+  var data = new Uint8List(kLength);
+  for (int i = 0; i < kLength; i++) {
+    data[i] = i & 0xff;
+  }
+  var port = new RawReceivePort();
+  port.handler = (List reply) {
+    Expect.equals(kLength, reply[0]);
+    Expect.equals((kLength ~/ 256) * (255 * 256 ~/ 2), reply[1]);
+    Expect.listEquals(data, reply[2].materialize().asUint8List());
+    port.close();
+    asyncEnd();
+  };
+  Isolate.spawn(sumBytes, [port.sendPort,
+                           new TransferableTypedData.fromList([data])]);
+}
+
+void main() {
+  testCreation();
+  testSendToSelf();
+  testSendToIsolate();
+}
@@ -0,0 +1,147 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Tests complete JSON texts, which the VM decodes natively, against the
+// results of the Dart parser.
+
+import "package:expect/expect.dart";
+import 'dart:convert';
+import 'dart:typed_data';
+
+final utf8Decoder = UTF8.decoder.fuse(JSON.decoder);
+
+Uint8List bytesOf(String string) =>
+    new Uint8List.fromList(UTF8.encode(string));
+
+void expectJsonEquals(expected, actual) {
+  if (expected is List) {
+    Expect.isTrue(actual is List);
+    Expect.equals(expected.length, actual.length);
+    for (int i = 0; i < expected.length; i++) {
+      expectJsonEquals(expected[i], actual[i]);
+    }
+  } else if (expected is Map) {
+    Expect.isTrue(actual is Map);
+    Expect.listEquals(expected.keys.toList(), actual.keys.toList());
+    for (var key in expected.keys) {
+      expectJsonEquals(expected[key], actual[key]);
+    }
+  } else {
+    Expect.equals(expected is double, actual is double);
+    Expect.equals(expected, actual);
+  }
+}
+
+// Decodes [json] from a string and from UTF-8 bytes, and checks that both
+// match the result of the Dart parser, which runs when there is a reviver.
+decode(String json) {
+  var expected = JSON.decode(json, reviver: (key, value) => value);
+  var fromString = JSON.decode(json);
+  var fromBytes = utf8Decoder.convert(bytesOf(json));
+  expectJsonEquals(expected, fromString);
+  expectJsonEquals(expected, fromBytes);
+  return fromString;
+}
+
+void testValues() {
+  Expect.equals(null, decode("null"));
+  Expect.equals(true, decode(" true "));
+  Expect.equals(false, decode("\tfalse\r\n"));
+  Expect.equals("", decode('""'));
+  Expect.equals("abc", decode('"abc"'));
+  Expect.listEquals([], decode("[]"));
+  Expect.mapEquals({}, decode("{ }"));
+  decode('[1, "two", [3.0, {"four": [null, true, false]}], {}]');
+  decode('{"a": {"b": {"c": [[], [[]], {"d": {}}]}}}');
+}
+
+void testNumbers() {
+  Expect.identical(0, decode("0"));
+  Expect.identical(0, decode("-0"));
+  Expect.isTrue(decode("-0.0").isNegative);
+  Expect.equals(123456789012345678, decode("123456789012345678"));
+  Expect.equals(-9223372036854775808, decode("-9223372036854775808"));
+  Expect.equals(123456789012345678901234567890,
+                decode("123456789012345678901234567890"));
+  Expect.equals(1.5, decode("1.5"));
+  Expect.equals(-1e-7, decode("-1e-7"));
+  Expect.equals(1.7976931348623157e308, decode("1.7976931348623157e308"));
+  Expect.equals(5e-324, decode("5e-324"));
+  Expect.equals(double.INFINITY, decode("1e400"));
+  Expect.equals(0.1, decode("0.1"));
+  Expect.equals(12345678.9e+3, decode("12345678.9E+3"));
+  Expect.isTrue(decode("1e2") is double);
+}
+
+void testStrings() {
+  Expect.equals('"\\/\b\f\n\r\t', decode(r'"\"\\\/\b\f\n\r\t"'));
+  Expect.equals("é€\u{1F600}", decode(r'"é€😀"'));
+  Expect.equals("\ud800", decode(r'"\ud800"'));  // Lone surrogate.
+  Expect.equals("Frédéric € \u{1F600}", decode('"Frédéric € \u{1F600}"'));
+  // Long strings cross the blocks that are scanned at once.
+  var long = "0123456789abcdef" * 20;
+  Expect.equals(long, decode('"$long"'));
+  Expect.equals("$long\n$long", decode('"$long\\n$long"'));
+  Expect.equals("$long€$long", decode('"$long€$long"'));
+}
+
+void testMaps() {
+  Map map = decode('{"a": 1, "b": 2, "a": 3}');
+  Expect.equals(2, map.length);
+  Expect.listEquals(["a", "b"], map.keys.toList());
+  Expect.listEquals([3, 2], map.values.toList());
+
+  // Decoded maps and lists can be modified.
+  map["c"] = [];
+  map.remove("a");
+  Expect.listEquals(["b", "c"], map.keys.toList());
+  List list = decode("[1, 2]");
+  list.add(3);
+  Expect.listEquals([1, 2, 3], list);
+
+  // Repeated keys share one string.
+  List objects = decode('[{"name": 1, "id": 2}, {"id": 3, "name": 4}]');
+  Expect.identical(objects[0].keys.first, objects[1].keys.last);
+
+  // Many keys, which grow the key cache, in nested objects.
+  var big = {};
+  for (int i = 0; i < 1000; i++) {
+    big["key$i"] = {"key${999 - i}": i, "x": [i]};
+  }
+  expectJsonEquals(big, decode(JSON.encode(big)));
+}
+
+void testDeepNesting() {
+  const depth = 100000;
+  var json = "${'[' * depth}${']' * depth}";
+  var value = JSON.decode(json);
+  for (int i = 1; i < depth; i++) {
+    value = value[0];
+  }
+  Expect.listEquals([], value);
+}
+
+void testMalformed() {
+  for (var json in ["", " ", "[", "]", "[1,]", '{"a":1,}', '{"a"}', "{1:2}",
+                    "01", "-", "1.", "1e", ".5", "tru", "nulll", "[1 2]",
+                    '"abc', '"\t"', r'"\x"', r'"\u12"', "1 2", "'a'"]) {
+    Expect.throws(() => JSON.decode(json), (e) => e is FormatException, json);
+    Expect.throws(() => utf8Decoder.convert(bytesOf(json)),
+                  (e) => e is FormatException, json);
+  }
+  // Malformed UTF-8 inside a string.
+  var bytes = new Uint8List.fromList([0x22, 0x61, 0xC3, 0x22]);
+  Expect.throws(() => utf8Decoder.convert(bytes), (e) => e is FormatException);
+  Expect.equals("a\u{FFFD}", new Utf8Decoder(allowMalformed: true)
+                                 .fuse(JSON.decoder).convert(bytes));
+}
+
+void main() {
+  testValues();
+  testNumbers();
+  testStrings();
+  testMaps();
+  testDeepNesting();
+  testMalformed();
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+
+// Tests UTF-8 decoding of typed byte lists, which the VM decodes natively.
+
+import "package:expect/expect.dart";
+import 'dart:convert';
+import 'dart:typed_data';
+
+const String ASCII = "The quick brown fox jumps over the lazy dog. 0123456789";
+const String LATIN1 = "Frédéric Chopin à été très";
+const String BMP = "€ uro фунт 中文";
+const String SUPPLEMENTARY = "\u{1D11E} clef \u{1F600} smile";
+
+Uint8List bytesOf(String string) =>
+    new Uint8List.fromList(UTF8.encode(string));
+
+void testRoundTrip(String string) {
+  Uint8List bytes = bytesOf(string);
+  Expect.equals(string, UTF8.decode(bytes));
+  Expect.equals(string, new Utf8Decoder().convert(bytes));
+
+  // A view with a non-zero offset into a larger buffer.
+  Uint8List padded = new Uint8List(bytes.length + 8);
+  padded.setRange(5, 5 + bytes.length, bytes);
+  Uint8List view = new Uint8List.view(padded.buffer, 5, bytes.length);
+  Expect.equals(string, UTF8.decode(view));
+
+  // Explicit start and end.
+  Expect.equals(string,
+                new Utf8Decoder().convert(padded, 5, 5 + bytes.length));
+
+  // Long inputs exercise the blocks that are checked for ASCII at once.
+  String long = string * 100;
+  Expect.equals(long, UTF8.decode(bytesOf(long)));
+}
+
+void testMalformed() {
+  Uint8List bytes = new Uint8List.fromList(
+      []..addAll(UTF8.encode(ASCII))..add(0xC3)..addAll(UTF8.encode(ASCII)));
+  Expect.throws(() => UTF8.decode(bytes), (e) => e is FormatException);
+  Expect.equals("$ASCII\u{FFFD}$ASCII",
+                UTF8.decode(bytes, allowMalformed: true));
+
+  // Truncated sequence at the end of the input.
+  bytes = new Uint8List.fromList([0x61, 0xE2, 0x82]);
+  Expect.throws(() => UTF8.decode(bytes), (e) => e is FormatException);
+}
+
+void testByteOrderMark() {
+  Uint8List bytes = new Uint8List.fromList(
+      [0xEF, 0xBB, 0xBF]..addAll(UTF8.encode(BMP)));
+  Expect.equals(BMP, UTF8.decode(bytes));
+  Expect.equals("", UTF8.decode(new Uint8List.fromList([0xEF, 0xBB, 0xBF])));
+}
+
+void testRange() {
+  Uint8List bytes = bytesOf(ASCII);
+  Expect.equals("", new Utf8Decoder().convert(bytes, 3, 3));
+  Expect.equals("quick", new Utf8Decoder().convert(bytes, 4, 9));
+  Expect.throws(() => new Utf8Decoder().convert(bytes, 4, bytes.length + 1),
+                (e) => e is RangeError);
+}
+
+void testJson() {
+  var decoder = UTF8.decoder.fuse(JSON.decoder);
+  var value = {
+    "ascii": ASCII,
+    "latin1": LATIN1,
+    "bmp": BMP,
+    "supplementary": SUPPLEMENTARY,
+  };
+  Uint8List bytes = bytesOf(JSON.encode(value));
+  Expect.mapEquals(value, decoder.convert(bytes));
+}
+
+void main() {
+  testRoundTrip("");
+  testRoundTrip(ASCII);
+  testRoundTrip(LATIN1);
+  testRoundTrip(BMP);
+  testRoundTrip(SUPPLEMENTARY);
+  testRoundTrip("$ASCII$LATIN1$BMP$SUPPLEMENTARY");
+  testMalformed();
+  testByteOrderMark();
+  testRange();
+  testJson();
+}
@@ -0,0 +1,119 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that pausing a socket stops reading from it, also when the event
+// handler reads ahead of the isolate, so a sender can not complete writing
+// more data than fits into the socket buffers.
+//
+// VMOptions=
+// VMOptions=--prefetch_socket_reads
+// VMOptions=--prefetch_socket_reads --short_socket_read
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+// Well above what the socket buffers on both ends hold.
+const int SIZE = 64 * 1024 * 1024;
+
+void testPause() {
+  asyncStart();
+  ServerSocket.bind("127.0.0.1", 0).then((server) {
+    var data = new Uint8List(SIZE);
+    for (int i = 0; i < SIZE; i++) data[i] = i & 0xff;
+    bool written = false;
+    server.listen((socket) {
+      socket.add(data);
+      socket.flush().then((_) {
+        written = true;
+        socket.destroy();
+        server.close();
+      });
+    });
+    Socket.connect("127.0.0.1", server.port).then((socket) {
+      int received = 0;
+      bool paused = false;
+      bool pausedOnce = false;
+      var subscription;
+      subscription = socket.listen((bytes) {
+        Expect.isFalse(paused);
+        for (int i = 0; i < bytes.length; i++) {
+          if (bytes[i] != ((received + i) & 0xff)) {
+            Expect.fail("Unexpected byte at ${received + i}");
+          }
+        }
+        received += bytes.length;
+        if (!pausedOnce) {
+          pausedOnce = true;
+          paused = true;
+          subscription.pause();
+          new Timer(const Duration(seconds: 1), () {
+            // The sender is blocked while nothing is read.
+            Expect.isFalse(written);
+            Expect.isTrue(received < SIZE);
+            paused = false;
+            subscription.resume();
+          });
+        }
+      }, onDone: () {
+        Expect.equals(SIZE, received);
+        Expect.isTrue(written);
+        socket.destroy();
+        asyncEnd();
+      });
+    });
+  });
+}
+
+void testReadEventsDisabled() {
+  asyncStart();
+  ServerSocket.bind("127.0.0.1", 0).then((server) {
+    var data = new Uint8List(SIZE);
+    bool written = false;
+    server.listen((socket) {
+      socket.add(data);
+      socket.flush().then((_) {
+        written = true;
+        socket.destroy();
+        server.close();
+      });
+    });
+    RawSocket.connect("127.0.0.1", server.port).then((socket) {
+      int received = 0;
+      bool disabledOnce = false;
+      socket.listen((event) {
+        switch (event) {
+          case RawSocketEvent.READ:
+            var bytes = socket.read();
+            if (bytes == null) break;
+            received += bytes.length;
+            if (!disabledOnce) {
+              disabledOnce = true;
+              socket.readEventsEnabled = false;
+              new Timer(const Duration(seconds: 1), () {
+                Expect.isFalse(written);
+                socket.readEventsEnabled = true;
+              });
+            }
+            break;
+          case RawSocketEvent.READ_CLOSED:
+            Expect.equals(SIZE, received);
+            Expect.isTrue(written);
+            socket.close();
+            asyncEnd();
+            break;
+        }
+      });
+      socket.writeEventsEnabled = false;
+    });
+  });
+}
+
+void main() {
+  testPause();
+  testReadEventsDisabled();
+}
@@ -0,0 +1,164 @@
+// Copyright (c) 2016, the Dart project authors.  Please see the AUTHORS file
+// for details. All rights reserved. Use of this source code is governed by a
+// BSD-style license that can be found in the LICENSE file.
+//
+// Test that data added to a socket faster than it can be written, which is
+// written with gathered writes, and files piped to a socket or an HTTP
+// response, which are sent straight from the file, arrive intact.
+//
+// VMOptions=
+// VMOptions=--short_socket_write
+// VMOptions=--short_socket_read --short_socket_write
+
+import "dart:async";
+import "dart:io";
+import "dart:typed_data";
+
+import "package:async_helper/async_helper.dart";
+import "package:expect/expect.dart";
+
+const int FILE_SIZE = 1024 * 1024 + 17;
+
+List<int> pattern(int length, int seed) {
+  var data = new Uint8List(length);
+  for (int i = 0; i < length; i++) data[i] = (i * 31 + seed) & 0xff;
+  return data;
+}
+
+// Connects a client to a new server and returns all bytes the server
+// receives from the client after [write] has been called on it.
+Future<List<int>> receive(Future write(Socket socket)) {
+  return ServerSocket.bind("127.0.0.1", 0).then((server) {
+    var received = new BytesBuilder();
+    var done = new Completer<List<int>>();
+    server.listen((socket) {
+      socket.listen(received.add, onDone: () {
+        socket.close();
+        server.close();
+        done.complete(received.takeBytes());
+      });
+    });
+    return Socket.connect("127.0.0.1", server.port).then((socket) {
+      return write(socket).then((_) => socket.close());
+    }).then((_) => done.future);
+  });
+}
+
+Future testManySmallWrites() {
+  var expected = new BytesBuilder();
+  return receive((socket) {
+    // Adding everything in one go makes the socket fall behind, so the data
+    // piles up and is written with gathered writes.
+    for (int i = 0; i < 5000; i++) {
+      var data = pattern(i % 97, i);
+      expected.add(data);
+      socket.add(data);
+    }
+    var large = pattern(256 * 1024, 3);
+    expected.add(large);
+    socket.add(large);
+    return socket.flush();
+  }).then((received) {
+    Expect.listEquals(expected.takeBytes(), received);
+  });
+}
+
+Future testPipeFile(Directory temp) {
+  var data = pattern(FILE_SIZE, 7);
+  var file = new File("${temp.path}/data");
+  file.writeAsBytesSync(data);
+  return receive((socket) => socket.addStream(file.openRead()))
+      .then((received) {
+    Expect.listEquals(data, received);
+    return receive((socket) {
+      // A range of the file, preceded and followed by regular writes.
+      socket.add([1, 2, 3]);
+      return socket.addStream(file.openRead(1000, 200000)).then((_) {
+        socket.add([4, 5]);
+        // A range past the end of the file is cut off as for reading.
+        return socket.addStream(
+            file.openRead(FILE_SIZE - 10, FILE_SIZE + 10));
+      });
+    });
+  }).then((received) {
+    var expected = [1, 2, 3]
+        ..addAll(data.sublist(1000, 200000))
+        ..addAll([4, 5])
+        ..addAll(data.sublist(FILE_SIZE - 10));
+    Expect.listEquals(expected, received);
+  });
+}
+
+Future testPipeMissingFile(Directory temp) {
+  return ServerSocket.bind("127.0.0.1", 0).then((server) {
+    server.listen((socket) {
+      socket.drain().whenComplete(() {
+        socket.destroy();
+        server.close();
+      });
+    });
+    return Socket.connect("127.0.0.1", server.port).then((socket) {
+      var file = new File("${temp.path}/missing");
+      return socket.addStream(file.openRead()).then((_) {
+        Expect.fail("Missing file sent");
+      }, onError: (error) {
+        Expect.isTrue(error is FileSystemException);
+        socket.destroy();
+      });
+    });
+  });
+}
+
+Future testHttpResponseFile(Directory temp) {
+  var data = pattern(FILE_SIZE, 11);
+  var file = new File("${temp.path}/http_data");
+  file.writeAsBytesSync(data);
+  return HttpServer.bind("127.0.0.1", 0).then((server) {
+    server.listen((request) {
+      var response = request.response;
+      if (request.uri.path == "/range") {
+        // Buffered data ahead of a range of the file.
+        response.contentLength = 2 + 100;
+        response.add([1, 2]);
+        response.addStream(file.openRead(5, 105)).then((_) {
+          response.close();
+        });
+      } else {
+        response.contentLength = FILE_SIZE;
+        file.openRead().pipe(response);
+      }
+    });
+    var client = new HttpClient();
+    Future<List<int>> get(String path) {
+      return client.get("127.0.0.1", server.port, path)
+          .then((request) => request.close())
+          .then((response) {
+            Expect.equals(HttpStatus.OK, response.statusCode);
+            return response.fold(new BytesBuilder(), (builder, bytes) {
+              builder.add(bytes);
+              return builder;
+            });
+          }).then((builder) => builder.takeBytes());
+    }
+    return get("/").then((received) {
+      Expect.listEquals(data, received);
+      return get("/range");
+    }).then((received) {
+      Expect.listEquals([1, 2]..addAll(data.sublist(5, 105)), received);
+      client.close();
+      server.close();
+    });
+  });
+}
+
+void main() {
+  asyncStart();
+  Directory.systemTemp.createTemp('dart_socket_write_file').then((temp) {
+    return Future.wait([
+        testManySmallWrites(),
+        testPipeFile(temp),
+        testPipeMissingFile(temp),
+        testHttpResponseFile(temp)])
+        .whenComplete(() => temp.deleteSync(recursive: true));
+  }).then((_) => asyncEnd());
+}